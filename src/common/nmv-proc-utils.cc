@@ -23,6 +23,7 @@
  *See COPYRIGHT file copyright information.
  */
 #include "config.h"
+#include <cstdlib>
 #include <cstring>
 #include <ctype.h>
 #include <unistd.h>
@@ -286,6 +287,69 @@ is_libtool_executable_wrapper (const UString &a_path)
     return true;
 }
 
+/// Read the state and the CPU usage of a thread of a local process
+/// from /proc/<pid>/task/<tid>/stat and status.
+///
+/// \param a_pid the id of the process.
+///
+/// \param a_tid the kernel id of the thread.
+///
+/// \param a_stat out parameter.  The state of the thread.
+///
+/// \return true upon successful completion, false if the thread
+/// can't be found, e.g because it exited or isn't a local one.
+bool
+read_thread_stat (int a_pid, int a_tid, ThreadStat &a_stat)
+{
+    UString dir;
+    dir.printf ("/proc/%d/task/%d/", a_pid, a_tid);
+
+    std::ifstream stat_file ((dir + "stat").c_str ());
+    string line;
+    if (!std::getline (stat_file, line))
+        return false;
+    // The line is "tid (name) state ppid ...".  The name can contain
+    // spaces and parenthesis, so it ends at the last ')'.
+    string::size_type open = line.find ('(');
+    string::size_type close = line.rfind (')');
+    if (open == string::npos || close == string::npos || close < open)
+        return false;
+    a_stat.name = line.substr (open + 1, close - open - 1);
+    std::vector<string> fields;
+    string::size_type start = close + 1;
+    while (start < line.size ()) {
+        string::size_type end = line.find (' ', start);
+        if (end == string::npos)
+            end = line.size ();
+        if (end > start)
+            fields.push_back (line.substr (start, end - start));
+        start = end + 1;
+    }
+    // fields[0] is the third field of the line, see proc(5).
+    if (fields.size () < 37)
+        return false;
+    static double ticks_per_second = sysconf (_SC_CLK_TCK);
+    a_stat.state = fields[0][0];
+    a_stat.user_time = strtoull (fields[11].c_str (), 0, 10)
+                       / ticks_per_second;
+    a_stat.system_time = strtoull (fields[12].c_str (), 0, 10)
+                         / ticks_per_second;
+    a_stat.processor = atoi (fields[36].c_str ());
+
+    a_stat.cpus_allowed.clear ();
+    std::ifstream status_file ((dir + "status").c_str ());
+    while (std::getline (status_file, line)) {
+        static const string key = "Cpus_allowed_list:";
+        if (line.compare (0, key.size (), key) != 0)
+            continue;
+        start = line.find_first_not_of (" \t", key.size ());
+        if (start != string::npos)
+            a_stat.cpus_allowed = line.substr (start);
+        break;
+    }
+    return true;
+}
+
 }//end namespace
 }//end namespace nemiver
 
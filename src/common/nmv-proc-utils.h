@@ -45,6 +45,36 @@ void NEMIVER_API attach_channel_to_loop_context_as_source
                          const Glib::RefPtr<Glib::MainContext>&a_ctxt);
 
 bool NEMIVER_API is_libtool_executable_wrapper (const UString &a_path);
+
+/// What the kernel tells about a thread of a process.
+struct NEMIVER_API ThreadStat {
+    /// The state of the thread, as shown by ps: R (running), S
+    /// (sleeping), D (uninterruptible sleep), T (stopped), t (stopped
+    /// by the debugger), Z (zombie), etc.
+    char state;
+    /// The name of the thread.
+    UString name;
+    /// The CPU time spent by the thread in user and in kernel mode,
+    /// in seconds.
+    double user_time;
+    double system_time;
+    /// The processor the thread last ran on.
+    int processor;
+    /// The processors the thread is allowed to run on, e.g "0-3,6".
+    UString cpus_allowed;
+
+    ThreadStat () :
+        state ('?'),
+        user_time (0),
+        system_time (0),
+        processor (-1)
+    {
+    }
+};
+
+bool NEMIVER_API read_thread_stat (int a_pid,
+                                   int a_tid,
+                                   ThreadStat &a_stat);
 }//end namspace common
 }//end namespace nemiver
 #endif //__NMV_PROC_UTILS_H__
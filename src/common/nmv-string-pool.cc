@@ -0,0 +1,104 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <deque>
+#include <map>
+#include <glibmm/thread.h>
+#include "nmv-string-pool.h"
+#include "nmv-exception.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+NEMIVER_BEGIN_NAMESPACE (common)
+
+struct StringPool::Priv {
+    mutable Glib::Mutex mutex;
+    // A deque never moves its elements when it grows, so the
+    // references handed out by StringPool::get stay valid.
+    std::deque<UString> strings;
+    std::map<std::string, Id> ids;
+
+    Priv ()
+    {
+        strings.push_back ("");
+    }
+};//end struct StringPool::Priv
+
+StringPool::StringPool () :
+    m_priv (new Priv)
+{
+}
+
+StringPool::~StringPool ()
+{
+}
+
+StringPool&
+StringPool::default_pool ()
+{
+    static StringPool s_pool;
+    return s_pool;
+}
+
+/// Adds a string to the pool, if it is not there yet.
+///
+/// \param a_str the string to add.
+/// \return the id of the string in the pool.
+StringPool::Id
+StringPool::intern (const std::string &a_str)
+{
+    if (a_str.empty ())
+        return 0;
+
+    Glib::Mutex::Lock lock (m_priv->mutex);
+    std::map<std::string, Id>::const_iterator it = m_priv->ids.find (a_str);
+    if (it != m_priv->ids.end ())
+        return it->second;
+
+    Id id = m_priv->strings.size ();
+    m_priv->strings.push_back (a_str);
+    m_priv->ids.insert (std::make_pair (a_str, id));
+    return id;
+}
+
+/// \return the string designated by a_id.
+const UString&
+StringPool::get (Id a_id) const
+{
+    Glib::Mutex::Lock lock (m_priv->mutex);
+    THROW_IF_FAIL (a_id < m_priv->strings.size ());
+    return m_priv->strings[a_id];
+}
+
+/// \return the number of strings in the pool, including the empty
+/// string.
+size_t
+StringPool::size () const
+{
+    Glib::Mutex::Lock lock (m_priv->mutex);
+    return m_priv->strings.size ();
+}
+
+NEMIVER_END_NAMESPACE (common)
+NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,71 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_STRING_POOL_H__
+#define __NMV_STRING_POOL_H__
+
+#include "nmv-api-macros.h"
+#include "nmv-ustring.h"
+#include "nmv-safe-ptr-utils.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+NEMIVER_BEGIN_NAMESPACE (common)
+
+/// \brief A table of interned strings.
+///
+/// Each distinct string added to the pool is stored only once and
+/// is designated by a small integer id afterwards.  The id 0 always
+/// designates the empty string.  Strings are never removed from the
+/// pool, so a reference returned by StringPool::get stays valid for
+/// the lifetime of the pool.
+///
+/// This is meant for strings that are repeated a lot but have few
+/// distinct values, like the function and file names of the frames
+/// of a deep call stack.
+class NEMIVER_API StringPool {
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+    //non copyable
+    StringPool (const StringPool &);
+    StringPool& operator= (const StringPool &);
+
+public:
+    typedef unsigned int Id;
+
+    StringPool ();
+    ~StringPool ();
+
+    /// \return the pool shared by the whole process.
+    static StringPool& default_pool ();
+
+    Id intern (const std::string &a_str);
+    const UString& get (Id a_id) const;
+    size_t size () const;
+};//end class StringPool
+
+NEMIVER_END_NAMESPACE (common)
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif // __NMV_STRING_POOL_H__
@@ -42,6 +42,7 @@ extern const char* CONF_KEY_SHOW_SOURCE_LINE_NUMBERS;
 extern const char* CONF_KEY_CONFIRM_BEFORE_RELOAD_SOURCE;
 extern const char* CONF_KEY_ALLOW_AUTO_RELOAD_SOURCE;
 extern const char* CONF_KEY_HIGHLIGHT_SOURCE_CODE;
+extern const char* CONF_KEY_SHOW_INLINE_VALUES;
 extern const char* CONF_KEY_SOURCE_FILE_ENCODING_LIST;
 extern const char* CONF_KEY_USE_SYSTEM_FONT;
 extern const char* CONF_KEY_CUSTOM_FONT_NAME;
@@ -61,6 +62,8 @@ extern const char* CONF_KEY_DEFAULT_NUM_ASM_INSTRS;
 extern const char* CONF_KEY_FOLLOW_FORK_MODE;
 extern const char* CONF_KEY_DISASSEMBLY_FLAVOR;
 extern const char* CONF_KEY_PRETTY_PRINTING;
+extern const char* CONF_KEY_TYPE_VISUALIZER_POLICIES;
+extern const char* CONF_KEY_NON_STOP_MODE;
 extern const char* CONF_KEY_CONTEXT_PANE_LOCATION;
 extern const char* CONF_KEY_NEMIVER_CALLSTACK_EXPANSION_CHUNK;
 extern const char* CONF_KEY_DBG_PERSPECTIVE_LAYOUT;
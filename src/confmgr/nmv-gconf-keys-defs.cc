@@ -48,6 +48,8 @@ const char* CONF_KEY_ALLOW_AUTO_RELOAD_SOURCE =
                 "/apps/nemiver/dbgperspective/allow-auto-reload-source";
 const char* CONF_KEY_HIGHLIGHT_SOURCE_CODE =
                 "/apps/nemiver/dbgperspective/highlight-source-code";
+const char* CONF_KEY_SHOW_INLINE_VALUES =
+                "/apps/nemiver/dbgperspective/show-inline-values";
 const char* CONF_KEY_SOURCE_FILE_ENCODING_LIST =
                 "/apps/nemiver/dbgperspective/source-file-encoding-list";
 const char* CONF_KEY_USE_SYSTEM_FONT =
@@ -86,6 +88,10 @@ const char* CONF_KEY_DISASSEMBLY_FLAVOR =
                 "/apps/nemiver/dbgperspective/disassembly-flavor";
 const char* CONF_KEY_PRETTY_PRINTING =
     "/apps/nemiver/dbgperspective/pretty-printing";
+const char* CONF_KEY_TYPE_VISUALIZER_POLICIES =
+    "/apps/nemiver/dbgperspective/type-visualizer-policies";
+const char* CONF_KEY_NON_STOP_MODE =
+    "/apps/nemiver/dbgperspective/non-stop-mode";
 
 const char* CONF_KEY_CONTEXT_PANE_LOCATION =
                 "/apps/nemiver/dbgperspective/context-pane-location";
@@ -41,6 +41,7 @@ const char* CONF_KEY_CONFIRM_BEFORE_RELOAD_SOURCE =
                 "confirm-before-reload-source";
 const char* CONF_KEY_ALLOW_AUTO_RELOAD_SOURCE = "allow-auto-reload-source";
 const char* CONF_KEY_HIGHLIGHT_SOURCE_CODE = "highlight-source-code";
+const char* CONF_KEY_SHOW_INLINE_VALUES = "show-inline-values";
 const char* CONF_KEY_SOURCE_FILE_ENCODING_LIST = "source-file-encoding-list";
 const char* CONF_KEY_USE_SYSTEM_FONT = "use-system-font";
 const char* CONF_KEY_CUSTOM_FONT_NAME = "custom-font-name";
@@ -67,6 +68,8 @@ const char* CONF_KEY_GDB_BINARY = "gdb-binary";
 const char* CONF_KEY_FOLLOW_FORK_MODE = "follow-fork-mode";
 const char* CONF_KEY_DISASSEMBLY_FLAVOR = "disassembly-flavor";
 const char* CONF_KEY_PRETTY_PRINTING = "pretty-printing";
+const char* CONF_KEY_TYPE_VISUALIZER_POLICIES = "type-visualizer-policies";
+const char* CONF_KEY_NON_STOP_MODE = "non-stop-mode";
 const char* CONF_KEY_CONTEXT_PANE_LOCATION = "context-pane-location";
 const char* CONF_KEY_NEMIVER_CALLSTACK_EXPANSION_CHUNK =
                 "callstack-expansion-chunk";
@@ -93,13 +93,15 @@ class Command {
     IDebugger::VariableSafePtr m_var;
     sigc::slot_base m_slot;
     bool m_should_emit_signal;
+    bool m_may_be_pipelined;
 
 public:
 
     Command () :
     m_tag2 (0),
       m_slot (0),
-      m_should_emit_signal (true)
+      m_should_emit_signal (true),
+      m_may_be_pipelined (false)
     {
         clear ();
     }
@@ -109,7 +111,8 @@ public:
     m_value (a_value),
       m_tag2 (0),
       m_slot (0),
-      m_should_emit_signal (true)
+      m_should_emit_signal (true),
+      m_may_be_pipelined (false)
     {
     }
 
@@ -118,7 +121,8 @@ public:
       m_value (a_value),
       m_tag2 (0),
       m_slot (0),
-      m_should_emit_signal (true)
+      m_should_emit_signal (true),
+      m_may_be_pipelined (false)
     {
     }
 
@@ -130,7 +134,8 @@ public:
       m_value (a_value),
       m_tag2 (0),
       m_slot (0),
-      m_should_emit_signal (true)
+      m_should_emit_signal (true),
+      m_may_be_pipelined (false)
     {
     }
 
@@ -185,6 +190,14 @@ public:
     bool should_emit_signal () const {return m_should_emit_signal;}
     void should_emit_signal (bool a) {m_should_emit_signal = a;}
 
+    /// If true, this command can be sent to the debugger before the
+    /// results of the previous commands have been received, provided
+    /// that these previous commands can be pipelined as well.  This
+    /// is only meant for commands that don't change the state of the
+    /// inferior, nor the selected thread or frame.
+    bool may_be_pipelined () const {return m_may_be_pipelined;}
+    void may_be_pipelined (bool a) {m_may_be_pipelined = a;}
+
     /// @}
 
     void clear ()
@@ -197,6 +210,7 @@ public:
         m_tag3.clear ();
         m_tag4.clear ();
 	m_should_emit_signal = true;
+        m_may_be_pipelined = false;
     }
 };//end class Command
 
@@ -272,6 +286,9 @@ public:
         IDebugger::StopReason m_stop_reason;
         bool m_has_frame;
         bool m_thread_selected;
+        bool m_thread_created;
+        bool m_thread_exited;
+        bool m_objfiles_changed;
         IDebugger::Frame m_frame;
         long m_breakpoint_number;
         long m_thread_id;
@@ -279,6 +296,9 @@ public:
         UString m_signal_meaning;
         bool m_has_modified_breakpoint;
         IDebugger::Breakpoint m_modified_breakpoint;
+        bool m_has_created_breakpoint;
+        IDebugger::Breakpoint m_created_breakpoint;
+        string m_deleted_breakpoint_id;
 
     public:
 
@@ -369,6 +389,21 @@ public:
         bool thread_selected () const {return m_thread_selected;}
         void thread_selected (bool a_in) {m_thread_selected = a_in;}
 
+        /// True if GDB reported that the thread designated by
+        /// thread_id () got created.
+        bool thread_created () const {return m_thread_created;}
+        void thread_created (bool a_in) {m_thread_created = a_in;}
+
+        /// True if GDB reported that the thread designated by
+        /// thread_id () exited.
+        bool thread_exited () const {return m_thread_exited;}
+        void thread_exited (bool a_in) {m_thread_exited = a_in;}
+
+        /// True if GDB reported that a shared library got loaded or
+        /// unloaded.
+        bool objfiles_changed () const {return m_objfiles_changed;}
+        void objfiles_changed (bool a_in) {m_objfiles_changed = a_in;}
+
         long thread_id () const {return m_thread_id;}
         void thread_id (long a_in) {m_thread_id = a_in;}
 
@@ -403,6 +438,46 @@ public:
             m_has_modified_breakpoint = true;
         }
 
+        /// Getter of the "created_breakpoint" flag.  This flag is
+        /// true if the underlying debugging engine reports that a
+        /// breakpoint was created other than by a GDB/MI command,
+        /// e.g by a console command or a script.
+        bool has_created_breakpoint () const
+        {return m_has_created_breakpoint;}
+
+        /// Getter of the created breakpoint carried by this out of
+        /// band record.  What this returns is meaningful only if
+        /// has_created_breakpoint() returns true.
+        IDebugger::Breakpoint& created_breakpoint ()
+        {return m_created_breakpoint;}
+
+        void created_breakpoint (const IDebugger::Breakpoint& b)
+        {
+            m_created_breakpoint = b;
+            m_has_created_breakpoint = true;
+        }
+
+        /// Whether the underlying debugging engine reports that a
+        /// breakpoint was deleted other than by a GDB/MI command.
+        bool has_deleted_breakpoint () const
+        {return !m_deleted_breakpoint_id.empty ();}
+
+        /// The ID of the deleted breakpoint.  Meaningful only if
+        /// has_deleted_breakpoint() returns true.
+        const string& deleted_breakpoint_id () const
+        {return m_deleted_breakpoint_id;}
+        void deleted_breakpoint_id (const string &a_id)
+        {m_deleted_breakpoint_id = a_id;}
+
+        /// Whether this record reports a breakpoint that was
+        /// created, modified or deleted.
+        bool has_breakpoint_notification () const
+        {
+            return (has_modified_breakpoint ()
+                    || has_created_breakpoint ()
+                    || has_deleted_breakpoint ());
+        }
+
         /// @}
 
 	void clear ()
@@ -414,12 +489,18 @@ public:
 	    m_stop_reason = IDebugger::UNDEFINED_REASON;
 	    m_has_frame = false;
 	    m_thread_selected = false;
+	    m_thread_created = false;
+	    m_thread_exited = false;
+	    m_objfiles_changed = false;
 	    m_frame.clear ();
 	    m_breakpoint_number = 0;
 	    m_thread_id = -1;
 	    m_signal_type.clear ();
 	    m_has_modified_breakpoint = 0;
 	    m_modified_breakpoint.clear();
+	    m_has_created_breakpoint = false;
+	    m_created_breakpoint.clear ();
+	    m_deleted_breakpoint_id.clear ();
 	}
     };//end class OutOfBandRecord
     typedef list<OutOfBandRecord> OutOfBandRecords;
@@ -450,10 +531,15 @@ public:
         map<string, IDebugger::Breakpoint> m_breakpoints;
         map<UString, UString> m_attrs;
 
-        //call stack listed members
-        vector<IDebugger::Frame> m_call_stack;
+        //call stack listed members.  The frames are shared by the
+        //copies of the record rather than copied along with it.
+        std::shared_ptr<const vector<IDebugger::Frame> > m_call_stack;
         bool m_has_call_stack;
 
+        //stack depth members
+        int m_stack_depth;
+        bool m_has_stack_depth;
+
         //frame parameters listed members
         map<int, list<IDebugger::VariableSafePtr> > m_frames_parameters;
         bool m_has_frames_parameters;
@@ -461,6 +547,9 @@ public:
         //local variable listed members
         list<IDebugger::VariableSafePtr> m_local_variables;
         bool m_has_local_variables;
+        list<IDebugger::VariableSafePtr> m_frame_local_variables;
+        list<IDebugger::VariableSafePtr> m_frame_arguments;
+        bool m_has_frame_variables;
 
         //variable value evaluated members
         IDebugger::VariableSafePtr m_variable_value;
@@ -470,6 +559,11 @@ public:
         std::list<int> m_thread_list;
         bool m_has_thread_list;
 
+        //-thread-info members
+        vector<IDebugger::ThreadInfo> m_thread_infos;
+        int m_current_thread_id;
+        bool m_has_thread_infos;
+
         //files listed members
         std::vector<UString> m_file_list;
         bool m_has_file_list;
@@ -547,16 +641,24 @@ public:
             m_kind = UNDEFINED;
             m_breakpoints.clear ();
             m_attrs.clear ();
-            m_call_stack.clear ();
+            m_call_stack.reset ();
             m_has_call_stack = false;
+            m_stack_depth = 0;
+            m_has_stack_depth = false;
             m_frames_parameters.clear ();
             m_has_frames_parameters = false;
             m_local_variables.clear ();
             m_has_local_variables = false;
+            m_frame_local_variables.clear ();
+            m_frame_arguments.clear ();
+            m_has_frame_variables = false;
             m_variable_value.reset ();
             m_has_variable_value = false;
             m_thread_list.clear ();
             m_has_thread_list = false;
+            m_thread_infos.clear ();
+            m_current_thread_id = 0;
+            m_has_thread_infos = false;
             m_thread_id = 0;
             m_frame_in_thread.clear ();
             m_thread_id_got_selected = false;
@@ -604,13 +706,27 @@ public:
         bool has_call_stack () const {return m_has_call_stack;}
         void has_call_stack (bool a_flag) {m_has_call_stack = a_flag;}
 
-        const vector<IDebugger::Frame>& call_stack () const {return m_call_stack;}
-        vector<IDebugger::Frame>& call_stack () {return m_call_stack;}
-        void call_stack (const vector<IDebugger::Frame> &a_in)
+        const vector<IDebugger::Frame>& call_stack () const
+        {
+            static const vector<IDebugger::Frame> s_empty_stack;
+            return m_call_stack ? *m_call_stack : s_empty_stack;
+        }
+        void call_stack
+            (const std::shared_ptr<const vector<IDebugger::Frame> > &a_in)
         {
             m_call_stack = a_in;
             has_call_stack (true);
         }
+
+        bool has_stack_depth () const {return m_has_stack_depth;}
+        void has_stack_depth (bool a_flag) {m_has_stack_depth = a_flag;}
+
+        int stack_depth () const {return m_stack_depth;}
+        void stack_depth (int a_in)
+        {
+            m_stack_depth = a_in;
+            has_stack_depth (true);
+        }
         bool has_register_names () const { return m_has_register_names; }
         void has_register_names (bool a_flag) { m_has_register_names = a_flag; }
         const std::map<IDebugger::register_id_t, UString>& register_names () const
@@ -709,6 +825,24 @@ public:
         bool has_local_variables () const {return m_has_local_variables;}
         void has_local_variables (bool a_in) {m_has_local_variables = a_in;}
 
+        const list<IDebugger::VariableSafePtr>& frame_local_variables () const
+        {
+            return m_frame_local_variables;
+        }
+        const list<IDebugger::VariableSafePtr>& frame_arguments () const
+        {
+            return m_frame_arguments;
+        }
+        void frame_variables (const list<IDebugger::VariableSafePtr> &a_locals,
+                              const list<IDebugger::VariableSafePtr> &a_args)
+        {
+            m_frame_local_variables = a_locals;
+            m_frame_arguments = a_args;
+            has_frame_variables (true);
+        }
+        bool has_frame_variables () const {return m_has_frame_variables;}
+        void has_frame_variables (bool a_in) {m_has_frame_variables = a_in;}
+
         const IDebugger::VariableSafePtr& variable_value () const
         {
             return m_variable_value;
@@ -732,6 +866,24 @@ public:
             has_thread_list (true);
         }
 
+        bool has_thread_infos () const {return m_has_thread_infos;}
+        void has_thread_infos (bool a_in) {m_has_thread_infos = a_in;}
+
+        const vector<IDebugger::ThreadInfo>& thread_infos () const
+        {
+            return m_thread_infos;
+        }
+        void thread_infos (const vector<IDebugger::ThreadInfo> &a_in)
+        {
+            m_thread_infos = a_in;
+            has_thread_infos (true);
+        }
+
+        /// The id of the current thread, as reported along with the
+        /// thread infos, or 0 if there is none.
+        int current_thread_id () const {return m_current_thread_id;}
+        void current_thread_id (int a_in) {m_current_thread_id = a_in;}
+
         bool thread_id_got_selected () const {return m_thread_id_got_selected;}
         void thread_id_got_selected (bool a_in) {m_thread_id_got_selected = a_in;}
 
@@ -23,6 +23,8 @@
  *See COPYRIGHT file copyright information.
  */
 #include <iostream>
+#include <cstdlib>
+#include <glib.h>
 #include "nmv-debugger-utils.h"
 #include "common/nmv-exception.h"
 
@@ -160,6 +162,80 @@ string_to_variable_format (const std::string &a_str)
     return result;
 }
 
+/// Parse an entry of the table of per type visualizer policies.
+///
+/// \param a_entry the entry to parse.  It has the form
+/// PATTERN=POLICY, where POLICY is either "full", "raw" or
+/// "limit:N", N being greater than zero.
+///
+/// \param a_type_pattern out parameter.  The glob pattern of the
+/// entry.
+///
+/// \param a_policy out parameter.  The policy of the entry.
+///
+/// \param a_max_nb_children out parameter.  N for a "limit:N"
+/// policy, 0 otherwise.
+///
+/// \return true if a_entry is well formed, false otherwise.
+bool
+parse_type_visualizer_policy (const UString &a_entry,
+                              UString &a_type_pattern,
+                              IDebugger::VisualizerPolicy &a_policy,
+                              unsigned &a_max_nb_children)
+{
+    UString::size_type sep = a_entry.rfind ('=');
+    if (sep == UString::npos)
+        return false;
+    UString pattern = a_entry.substr (0, sep);
+    pattern.chomp ();
+    if (pattern.empty ())
+        return false;
+    UString policy = a_entry.substr (sep + 1);
+    policy.chomp ();
+
+    unsigned max_nb_children = 0;
+    if (policy == "full") {
+        a_policy = IDebugger::VISUALIZER_POLICY_FULL;
+    } else if (policy == "raw") {
+        a_policy = IDebugger::VISUALIZER_POLICY_RAW;
+    } else if (!policy.compare (0, 6, "limit:")
+               && atoi (policy.c_str () + 6) > 0) {
+        a_policy = IDebugger::VISUALIZER_POLICY_LIMIT_CHILDREN;
+        max_nb_children = atoi (policy.c_str () + 6);
+    } else {
+        return false;
+    }
+    a_type_pattern = pattern;
+    a_max_nb_children = max_nb_children;
+    return true;
+}
+
+/// Test if a type is matched by the glob pattern of a visualizer
+/// policy.  A const type, or a reference to a type, is matched as
+/// the type itself.
+///
+/// \param a_type_pattern the glob pattern, e.g. "std::map<*".
+///
+/// \param a_type the type to test.
+///
+/// \return true if a_type_pattern matches a_type.
+bool
+type_matches_visualizer_pattern (const UString &a_type_pattern,
+                                 const UString &a_type)
+{
+    UString type = a_type;
+    type.chomp ();
+    if (!type.compare (0, 6, "const "))
+        type.erase (0, 6);
+    if (!type.empty () && type[type.size () - 1] == '&') {
+        type.erase (type.size () - 1);
+        type.chomp ();
+    }
+    if (type.empty ())
+        return false;
+    return g_pattern_match_simple (a_type_pattern.c_str (), type.c_str ());
+}
+
 /// Serialize an IDebugger::Variable::Format enum into a string.
 /// \param a_format the instance of format to serialize.
 /// \return the resulting serialization.
@@ -79,6 +79,14 @@ IDebugger::Variable::Format string_to_variable_format (const std::string &);
 
 std::string variable_format_to_string (IDebugger::Variable::Format);
 
+bool parse_type_visualizer_policy (const UString &a_entry,
+                                   UString &a_type_pattern,
+                                   IDebugger::VisualizerPolicy &a_policy,
+                                   unsigned &a_max_nb_children);
+
+bool type_matches_visualizer_pattern (const UString &a_type_pattern,
+                                      const UString &a_type);
+
 IDebuggerSafePtr load_debugger_iface_with_gconf ();
 
 // Template implementations.
@@ -31,6 +31,7 @@
 #include <sstream>
 #include <algorithm>
 #include <memory>
+#include <set>
 #include <fstream>
 #include <iostream>
 #include "nmv-i-debugger.h"
@@ -67,6 +68,13 @@ static const char* DEFAULT_GDB_BINARY = "default-gdb-binary";
 static const char* GDB_DEFAULT_PRETTY_PRINTING_VISUALIZER =
     "gdb.default_visualizer";
 static const char* GDB_NULL_PRETTY_PRINTING_VISUALIZER = "None";
+/// The maximum number of commands that can be sent to GDB before
+/// their results have been received.  See Command::may_be_pipelined.
+static const unsigned MAX_NB_PIPELINED_COMMANDS = 32;
+/// The maximum number of breakpoint IDs sent in a single command,
+/// like "-break-disable 1 2 3".  This keeps the command lines well
+/// below the size of the line buffer of the terminal GDB reads from.
+static const unsigned MAX_NB_BREAKPOINTS_PER_COMMAND = 128;
 
 NEMIVER_BEGIN_NAMESPACE (nemiver)
 
@@ -74,6 +82,8 @@ extern const char* CONF_KEY_GDB_BINARY;
 extern const char* CONF_KEY_FOLLOW_FORK_MODE;
 extern const char* CONF_KEY_DISASSEMBLY_FLAVOR;
 extern const char* CONF_KEY_PRETTY_PRINTING;
+extern const char* CONF_KEY_TYPE_VISUALIZER_POLICIES;
+extern const char* CONF_KEY_NON_STOP_MODE;
 
 // Helper function to handle escaping the arguments 
 static UString
@@ -170,6 +180,47 @@ location_to_string (const Loc &a_loc,
     }
 }
 
+/// Generate the -break-insert command that sets a breakpoint.
+///
+/// \param a_loc_str the location of the breakpoint, as generated by
+/// location_to_string.
+///
+/// \param a_condition the condition of the breakpoint, or an empty
+/// string if it has none.
+///
+/// \param a_ignore_count the number of hits to ignore, or a negative
+/// number for a countpoint.
+///
+/// \param a_thread_id the only thread the breakpoint stops, or 0 if
+/// it stops any thread.
+///
+/// \param a_enabled false if the breakpoint is to be set disabled.
+///
+/// \return the command.
+static UString
+break_insert_command (const UString &a_loc_str,
+                      const UString &a_condition,
+                      int a_ignore_count,
+                      int a_thread_id,
+                      bool a_enabled)
+{
+    UString break_cmd ("-break-insert -f");
+    if (!a_enabled)
+        break_cmd += " -d";
+    if (!a_condition.empty ()) {
+        LOG_DD ("setting breakpoint with condition: " << a_condition);
+        break_cmd += " -c \"" + a_condition + "\"";
+    } else {
+        LOG_DD ("setting breakpoint without condition");
+    }
+    if (a_ignore_count >= 0)
+        break_cmd += " -i " + UString::from_int (a_ignore_count);
+    if (a_thread_id > 0)
+        break_cmd += " -p " + UString::from_int (a_thread_id);
+    break_cmd += " " + a_loc_str;
+    return break_cmd;
+}
+
 //**************************************************************
 // </Helper functions to generate a serialized form of location>
 //**************************************************************
@@ -235,11 +286,100 @@ public:
     UString disassembly_flavor;
     GDBMIParser gdbmi_parser;
     bool enable_pretty_printing;
+    // Whether GDB is to be put in non-stop mode the next time it is
+    // launched, as per the configuration.
+    bool non_stop_mode_wanted;
+    // Whether the current GDB is in non-stop mode.  In that mode, a
+    // thread can stop while the others keep running.
+    bool non_stop_mode;
+    // In non-stop mode, the ids of the threads that are stopped.
+    // The other threads are running.
+    std::set<int> stopped_threads;
     // Once pretty printing has been globally enabled once, there is
     // no command to globally disable it.  So once it has been enabled
     // globally, we shouldn't try to globally enable it again.  So
     // let's keep track of if we enabled it once.
     bool pretty_printing_enabled_once;
+    // The descriptions returned by "ptype", keyed by the name of the
+    // type they describe.  The cache only holds descriptions of the
+    // current objfiles generation, see objfiles_generation.
+    map<UString, UString> type_cache;
+    // Incremented each time the set of objfiles of the inferior
+    // might have changed, that is, when a shared library gets loaded
+    // or unloaded, or when the inferior is (re-)run.  Type
+    // descriptions obtained for a previous generation are dropped.
+    int objfiles_generation;
+    // The replies to get_variable_type requests that were served from
+    // type_cache, waiting to be emitted from the event loop.
+    list<pair<VariableSafePtr, UString> > cached_type_replies;
+    sigc::connection cached_type_replies_connection;
+    // The get_variable_type requests waiting for the description of
+    // a type that is being fetched already, keyed by the name of
+    // that type.  A key is present as long as its "ptype" is in
+    // flight.
+    map<UString, list<pair<VariableSafePtr, UString> > > type_waiters;
+    // The policy applied to variables which type matches a given
+    // glob pattern.  The first matching entry applies.
+    struct TypeVisualizerPolicy {
+        UString type_pattern;
+        IDebugger::VisualizerPolicy policy;
+        unsigned max_nb_children;
+    };
+    // The policies set through IDebugger::set_type_visualizer_policy.
+    // They take precedence over those of the configuration, and
+    // survive its changes.
+    vector<TypeVisualizerPolicy> type_visualizer_policies;
+    // The policies read from CONF_KEY_TYPE_VISUALIZER_POLICIES.
+    vector<TypeVisualizerPolicy> conf_type_visualizer_policies;
+    // The state of a pending IDebugger::evaluate_expressions request.
+    struct ExpressionBatch {
+        vector<IDebugger::ExpressionResult> results;
+        unsigned nb_pending;
+        IDebugger::ExpressionResultsSlot slot;
+    };
+    // The pending IDebugger::evaluate_expressions requests, keyed by
+    // an identifier carried by each of their commands.
+    map<int, ExpressionBatch> expression_batches;
+    int last_expression_batch_id;
+    // The state of a pending IDebugger::list_threads_frames request.
+    struct ThreadFramesBatch {
+        map<int, vector<IDebugger::Frame> > frames;
+        unsigned nb_pending;
+        IDebugger::ThreadsFramesSlot slot;
+    };
+    // The pending IDebugger::list_threads_frames requests, keyed by
+    // an identifier carried by each of their commands.
+    map<int, ThreadFramesBatch> thread_frames_batches;
+    int last_thread_frames_batch_id;
+    // Where a pending IDebugger::sample_threads_stacks request is at.
+    enum SamplingPhase {
+        SAMPLING_NONE = 0,
+        // The inferior is being interrupted.
+        SAMPLING_INTERRUPTING,
+        // The threads and their frames are being listed.
+        SAMPLING_LISTING
+    };
+    SamplingPhase sampling_phase;
+    int sampling_max_depth;
+    // Whether the inferior is to be resumed once sampled.
+    bool sampling_resumes;
+    // Whether the interrupt sent to sample the inferior is yet to
+    // be reported by a stop.
+    bool sampling_interrupt_pending;
+    // Whether the user asked to stop the inferior while it was
+    // being sampled.  It is then not resumed.
+    bool sampling_stop_requested;
+    // The stop caused by the sampling, reported after all if the
+    // user asked to stop the inferior in the meantime.
+    Output::OutOfBandRecord sampling_stop_record;
+    // In non-stop mode, the threads which stop caused by the
+    // sampling was consumed already.
+    std::set<int> sampling_stopped_threads;
+    IDebugger::ThreadsFramesSlot sampling_slot;
+    // Whether the threads of the inferior are running, as far as
+    // we know.  In non-stop mode, this is true while any thread
+    // may be running.
+    bool inferior_is_running;
     sigc::signal<void> gdb_died_signal;
     sigc::signal<void, const UString& > master_pty_signal;
     sigc::signal<void, const UString& > gdb_stdout_signal;
@@ -282,6 +422,11 @@ public:
                          const string&,
                          const UString&> breakpoint_deleted_signal;
 
+    mutable sigc::signal<void,
+                         const IDebugger::Breakpoint&,
+                         const string&,
+                         const UString&> breakpoint_modified_signal;
+
     mutable sigc::signal<void, const IDebugger::Breakpoint&, int>
                                                 breakpoint_disabled_signal;
 
@@ -305,6 +450,17 @@ public:
                          const Frame * const,
                          const UString&> thread_selected_signal;
 
+    mutable sigc::signal<void,
+                         const vector<IDebugger::ThreadInfo>&,
+                         int,
+                         const UString&> threads_info_listed_signal;
+
+    mutable sigc::signal<void, int> thread_created_signal;
+
+    mutable sigc::signal<void, int> thread_exited_signal;
+
+    mutable sigc::signal<void, int, bool> thread_state_changed_signal;
+
     mutable sigc::signal<void, const vector<IDebugger::Frame>&, const UString&>
                                                     frames_listed_signal;
 
@@ -543,16 +699,13 @@ public:
                 LOG_DD ("here");
                 if (!started_commands.empty ()) {
                     started_commands.erase (started_commands.begin ());
-                    LOG_DD ("clearing the line");
-                    // we can send another cmd down the wire
-                    line_busy = false;
-                }
-                if (!line_busy
-                    && started_commands.empty ()
-                    && !queued_commands.empty ()) {
-                    issue_command (*queued_commands.begin ());
-                    queued_commands.erase (queued_commands.begin ());
+                    if (started_commands.empty ()) {
+                        LOG_DD ("clearing the line");
+                        // we can send another cmd down the wire
+                        line_busy = false;
+                    }
                 }
+                issue_queued_commands ();
             }
         }
         gdbmi_parser.pop_input ();
@@ -576,7 +729,18 @@ public:
         disassembly_flavor ("att"),
         gdbmi_parser (GDBMIParser::BROKEN_MODE),
         enable_pretty_printing (true),
-        pretty_printing_enabled_once (false)
+        non_stop_mode_wanted (false),
+        non_stop_mode (false),
+        pretty_printing_enabled_once (false),
+        objfiles_generation (0),
+        last_expression_batch_id (0),
+        last_thread_frames_batch_id (0),
+        sampling_phase (SAMPLING_NONE),
+        sampling_max_depth (0),
+        sampling_resumes (false),
+        sampling_interrupt_pending (false),
+        sampling_stop_requested (false),
+        inferior_is_running (false)
     {
         memset (&tty_attributes, 0, sizeof (tty_attributes));
 
@@ -604,6 +768,9 @@ public:
 
         frames_listed_signal.connect (sigc::mem_fun
                (*this, &Priv::on_frames_listed_signal));
+
+        thread_exited_signal.connect (sigc::mem_fun
+               (*this, &Priv::on_thread_exited_signal));
     }
 
     void free_resources ()
@@ -652,10 +819,27 @@ public:
         //have to be issued to the underlying debugger, leading to
         //the state being switched to IDebugger::RUNNING
         if (a_state == IDebugger::READY &&
-            !queued_commands.empty ()) {
+            (!queued_commands.empty () || started_commands.size () > 1)) {
+            return;
+        }
+
+        //While the stacks of the threads are being sampled, the
+        //inferior is only briefly stopped behind the back of the
+        //user.  Don't let the rest of the world think it's stopped.
+        if (a_state == IDebugger::READY
+            && sampling_phase != SAMPLING_NONE) {
             return;
         }
 
+        //In non-stop mode, GDB accepts commands while threads are
+        //running.  But as far as the user is concerned, the
+        //debugger is busy as long as the thread in focus runs.
+        if (a_state == IDebugger::READY
+            && non_stop_mode
+            && is_thread_running (cur_thread_num)) {
+            a_state = IDebugger::RUNNING;
+        }
+
         //don't emit any signal if a_state equals the
         //current state.
         if (state == a_state) {
@@ -672,6 +856,30 @@ public:
         return false;
     }
 
+    /// Return true if a given thread is running.  Outside of
+    /// non-stop mode, all the threads run or stop together.
+    bool is_thread_running (int a_thread_id) const
+    {
+        if (!non_stop_mode)
+            return state == IDebugger::RUNNING;
+        return !stopped_threads.count (a_thread_id);
+    }
+
+    /// Put the freshly launched GDB in non-stop mode, if the
+    /// configuration says so.  This must be done before the
+    /// inferior is started.
+    void set_non_stop_mode_if_wanted ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        non_stop_mode = non_stop_mode_wanted;
+        stopped_threads.clear ();
+        if (!non_stop_mode)
+            return;
+        queue_command (Command ("set-non-stop-mode", "-gdb-set mi-async on"));
+        queue_command (Command ("set-non-stop-mode", "-gdb-set non-stop on"));
+    }
+
     void kill_gdb ()
     {
         if (is_gdb_running ()) {
@@ -921,7 +1129,8 @@ public:
         if (master_pty_channel->write
                 (a_command.value () + "\n") == Glib::IO_STATUS_NORMAL) {
             master_pty_channel->flush ();
-            THROW_IF_FAIL (started_commands.size () <= 1);
+            THROW_IF_FAIL (started_commands.size ()
+                           <= MAX_NB_PIPELINED_COMMANDS);
 
             if (a_do_record)
                 started_commands.push_back (a_command);
@@ -937,16 +1146,85 @@ public:
         return false;
     }
 
+    /// Return true if a given command can be sent to GDB right away.
+    /// That is the case if no command is waiting for its result, or
+    /// if both the given command and all the commands waiting for
+    /// their results can be pipelined.
+    bool can_issue_command_now (const Command &a_command) const
+    {
+        if (started_commands.empty ())
+            return !line_busy;
+
+        if (!a_command.may_be_pipelined ()
+            || started_commands.size () >= MAX_NB_PIPELINED_COMMANDS)
+            return false;
+
+        list<Command>::const_iterator it;
+        for (it = started_commands.begin ();
+             it != started_commands.end ();
+             ++it)
+            if (!it->may_be_pipelined ())
+                return false;
+        return true;
+    }
+
+    /// Send to GDB as many queued commands as possible.
+    ///
+    /// \return true if at least one command was issued.
+    bool issue_queued_commands ()
+    {
+        bool result = false;
+        while (!queued_commands.empty ()
+               && can_issue_command_now (queued_commands.front ())) {
+            Command command = queued_commands.front ();
+            queued_commands.erase (queued_commands.begin ());
+            if (!issue_command (command, true))
+                break;
+            result = true;
+        }
+        return result;
+    }
+
     bool queue_command (const Command &a_command)
     {
-        bool result (false);
         LOG_DD ("queuing command: '" << a_command.value () << "'");
         queued_commands.push_back (a_command);
-        if (!line_busy && started_commands.empty ()) {
-            result = issue_command (*queued_commands.begin (), true);
-            queued_commands.erase (queued_commands.begin ());
+        return issue_queued_commands ();
+    }
+
+    /// Queue a breakpoint command that applies to several
+    /// breakpoints at once, like "-break-disable 1 2 3".  If there
+    /// are many breakpoints, several such commands are queued.  The
+    /// tag0 of each command is the list of the IDs it applies to,
+    /// separated by spaces.
+    ///
+    /// \param a_name the name of the commands.
+    ///
+    /// \param a_mi_command the GDB/MI command, e.g "-break-disable".
+    ///
+    /// \param a_break_nums the IDs of the breakpoints.
+    ///
+    /// \param a_cookie the cookie of the commands.
+    void queue_breakpoints_command (const UString &a_name,
+                                    const UString &a_mi_command,
+                                    const vector<string> &a_break_nums,
+                                    const UString &a_cookie)
+    {
+        vector<string>::const_iterator it = a_break_nums.begin ();
+        while (it != a_break_nums.end ()) {
+            UString ids;
+            for (unsigned nb = 0;
+                 nb < MAX_NB_BREAKPOINTS_PER_COMMAND
+                     && it != a_break_nums.end ();
+                 ++nb, ++it) {
+                if (!ids.empty ())
+                    ids += " ";
+                ids += *it;
+            }
+            Command command (a_name, a_mi_command + " " + ids, a_cookie);
+            command.tag0 (ids);
+            queue_command (command);
         }
-        return result;
     }
 
     /// Resets the GDB command queue so that it is in its initial
@@ -961,6 +1239,13 @@ public:
 
         started_commands.clear ();
         queued_commands.clear ();
+        expression_batches.clear ();
+        thread_frames_batches.clear ();
+        type_waiters.clear ();
+        sampling_phase = SAMPLING_NONE;
+        sampling_interrupt_pending = false;
+        sampling_stop_requested = false;
+        sampling_stopped_threads.clear ();
         line_busy = false;
     }
 
@@ -985,6 +1270,56 @@ public:
                                         disassembly_flavor);
         get_conf_mgr ()->get_key_value (CONF_KEY_PRETTY_PRINTING,
                                         enable_pretty_printing);
+        get_conf_mgr ()->get_key_value (CONF_KEY_NON_STOP_MODE,
+                                        non_stop_mode_wanted);
+        read_type_visualizer_policies ();
+    }
+
+    /// Load the table of per type visualizer policies from the
+    /// configuration.  Each entry of the table has the form
+    /// PATTERN=POLICY, where POLICY is either "full", "raw" or
+    /// "limit:N".
+    void read_type_visualizer_policies ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        std::list<UString> entries;
+        get_conf_mgr ()->get_key_value (CONF_KEY_TYPE_VISUALIZER_POLICIES,
+                                        entries);
+        conf_type_visualizer_policies.clear ();
+        std::list<UString>::const_iterator it;
+        for (it = entries.begin (); it != entries.end (); ++it) {
+            TypeVisualizerPolicy entry;
+            if (!debugger_utils::parse_type_visualizer_policy
+                                    (*it, entry.type_pattern,
+                                     entry.policy, entry.max_nb_children)) {
+                LOG_ERROR ("wrong type visualizer policy: " << *it);
+                continue;
+            }
+            conf_type_visualizer_policies.push_back (entry);
+        }
+    }
+
+    /// Look for the first policy of a table that applies to a type.
+    ///
+    /// \return true if a policy of a_policies matches a_type.
+    static bool
+    find_type_visualizer_policy
+                (const vector<TypeVisualizerPolicy> &a_policies,
+                 const UString &a_type,
+                 IDebugger::VisualizerPolicy &a_policy,
+                 unsigned &a_max_nb_children)
+    {
+        vector<TypeVisualizerPolicy>::const_iterator it;
+        for (it = a_policies.begin (); it != a_policies.end (); ++it) {
+            if (debugger_utils::type_matches_visualizer_pattern
+                                        (it->type_pattern, a_type)) {
+                a_policy = it->policy;
+                a_max_nb_children = it->max_nb_children;
+                return true;
+            }
+        }
+        return false;
     }
 
     /// Lists the frames which numbers are in a given range.
@@ -1209,6 +1544,35 @@ public:
         is_running = true;
     }
 
+    /// Emit IDebugger::variable_type_set_signal for a variable
+    /// which type description was found in the type cache.  The
+    /// signal is emitted from the event loop, like for the replies
+    /// that come from GDB, so that callers always get it after
+    /// IDebugger::get_variable_type returned.
+    void queue_cached_type_reply (const VariableSafePtr a_var,
+                                  const UString &a_cookie)
+    {
+        if (cached_type_replies.empty ())
+            cached_type_replies_connection =
+                get_event_loop_context ()->signal_idle ().connect
+                    (sigc::mem_fun (*this, &Priv::emit_cached_type_replies));
+        cached_type_replies.push_back (make_pair (a_var, a_cookie));
+    }
+
+    bool emit_cached_type_replies ()
+    {
+        NEMIVER_TRY
+
+        list<pair<VariableSafePtr, UString> > replies;
+        replies.swap (cached_type_replies);
+        list<pair<VariableSafePtr, UString> >::const_iterator it;
+        for (it = replies.begin (); it != replies.end (); ++it)
+            variable_type_set_signal.emit (it->first, it->second);
+
+        NEMIVER_CATCH_NOX
+        return false;
+    }
+
     void on_state_changed_signal (IDebugger::State a_state)
     {
         state = a_state;
@@ -1228,6 +1592,11 @@ public:
         NEMIVER_CATCH_NOX
     }
 
+    void on_thread_exited_signal (int a_thread_id)
+    {
+        stopped_threads.erase (a_thread_id);
+    }
+
     /// Callback function invoked when the IDebugger::stopped_signal
     /// event is fired.
     void on_stopped_signal (IDebugger::StopReason a_reason,
@@ -1241,8 +1610,10 @@ public:
 
         NEMIVER_TRY;
 
-        if (IDebugger::is_exited (a_reason))
+        if (IDebugger::is_exited (a_reason)) {
             is_running = false;
+            stopped_threads.clear ();
+        }
 
         if (a_has_frame)
             // List frames so that we can get the @ of the current frame.
@@ -1288,6 +1659,11 @@ public:
                     pretty_printing_enabled_once = true;
                 }
             }
+        } else if (a_key == CONF_KEY_TYPE_VISUALIZER_POLICIES) {
+            read_type_visualizer_policies ();
+        } else if (a_key == CONF_KEY_NON_STOP_MODE) {
+            // This takes effect the next time GDB is launched.
+            conf_mgr->get_key_value (a_key, non_stop_mode_wanted, a_namespace);
         } else if (a_key == CONF_KEY_DISASSEMBLY_FLAVOR
                    && conf_mgr->get_key_value (a_key,
                                                disassembly_flavor,
@@ -1313,6 +1689,7 @@ public:
 
     ~Priv ()
     {
+        cached_type_replies_connection.disconnect ();
         kill_gdb ();
     }
 };//end GDBEngine::Priv
@@ -1493,41 +1870,58 @@ struct OnBreakpointHandler: OutputHandler {
         return false;
     }
 
-    /// \return true if the output has an out of band containing a
-    /// breakpoint-modified async output, and if so, set an iterator
-    /// over the out of band record that contains the first modified
-    /// breakpoint.
-    ///
-    /// \param a_in the debugging command sent and its output.
+    /// \param a_in command sent and its output.
     ///
-    /// \param b_ib out parameter.  Set to the out of band record that
-    /// contains the modified breakpoint, iff the function returned
-    /// true.
+    /// \return true if there is an out of band record that reports a
+    /// breakpoint that was created, modified or deleted.
     bool
-    has_modified_breakpoint (CommandAndOutput &a_in,
-                             Output::OutOfBandRecords::iterator &b_i) const
+    has_breakpoint_notification (CommandAndOutput &a_in) const
     {
-        for (Output::OutOfBandRecords::iterator i =
+        for (Output::OutOfBandRecords::const_iterator i =
                  a_in.output ().out_of_band_records ().begin ();
              i != a_in.output ().out_of_band_records ().end ();
              ++i) {
-            if (i->has_modified_breakpoint ()) {
-                b_i = i;
+            if (i->has_breakpoint_notification ())
                 return true;
-            }
         }
         return false;
     }
 
-    /// \param a_in command sent and its output.
+    /// Update the cached version of a breakpoint that GDB reported
+    /// as modified, and notify the listeners about that breakpoint
+    /// only.
     ///
-    /// \return true if there is an out of band record that contains a
-    /// modified breakpoint.
-    bool
-    has_modified_breakpoint (CommandAndOutput &a_in) const
+    /// A breakpoint that has, or had, multiple locations might have
+    /// gained or lost sub-breakpoints, so in that case the listeners
+    /// are told that the previous version was deleted and the new
+    /// one set instead.
+    ///
+    /// \param b the new version of the breakpoint.
+    void
+    update_bp_in_cache_and_notify_bp_modified (IDebugger::Breakpoint &b)
     {
-        Output::OutOfBandRecords::iterator i;
-        return has_modified_breakpoint (a_in, i);
+        map<string, IDebugger::Breakpoint> &breaks =
+            m_engine->get_cached_breakpoints ();
+        map<string, IDebugger::Breakpoint>::iterator it =
+            breaks.find (b.id ());
+
+        if (it == breaks.end ()) {
+            LOG_DD ("bp " << b.id () << ": add to cache and notify set");
+            append_bp_to_cache_and_notify_bp_set (b);
+        } else if (it->second.has_multiple_locations ()
+                   || b.has_multiple_locations ()) {
+            LOG_DD ("bp " << b.id () << ": notify deleted then set");
+            notify_breakpoint_deleted_signal (b.id ());
+            append_bp_to_cache_and_notify_bp_set (b);
+        } else {
+            LOG_DD ("bp " << b.id () << ": update cache and notify modified");
+            m_engine->append_breakpoint_to_cache (b);
+            it = breaks.find (b.id ());
+            THROW_IF_FAIL (it != breaks.end ());
+            m_engine->breakpoint_modified_signal ().emit (it->second,
+                                                          it->first,
+                                                          "");
+        }
     }
 
     /// Look if we have a breakpoint of a given id in the cache.  If
@@ -1579,7 +1973,7 @@ struct OnBreakpointHandler: OutputHandler {
     {
         if (!a_in.output ().has_result_record ()
             && !has_overloads_prompt (a_in)
-            && !has_modified_breakpoint (a_in)) {
+            && !has_breakpoint_notification (a_in)) {
             return false;
         }
         LOG_DD ("handler selected");
@@ -1614,26 +2008,25 @@ struct OnBreakpointHandler: OutputHandler {
             return;
         }
 
-        // If there is modified breakpoint, delete its previous
-        // version from the cache, notify the listeners about its
-        // deletion, add the new version to the cache and notify the
-        // listeners about its addition.
-        {
-            Output::OutOfBandRecords::iterator i, end;
-            if (has_modified_breakpoint (a_in, i)) {
-                LOG_DD ("has modified breakpoints!");
+        // Apply the breakpoints that GDB reports as created, modified
+        // or deleted to the cache, one by one, and notify the
+        // listeners about each of them.
+        if (has_breakpoint_notification (a_in)) {
+            LOG_DD ("has breakpoint notifications!");
+            Output::OutOfBandRecords::iterator i,
                 end = a_in.output ().out_of_band_records ().end ();
-                for (; i != end; ++i) {
-                    if (!i->has_modified_breakpoint ())
-                        continue;
-                    IDebugger::Breakpoint &b = i->modified_breakpoint ();
-                    LOG_DD ("bp " << b.id () << ": notify deleted");
-                    notify_breakpoint_deleted_signal (b.id ());
-                    LOG_DD ("bp "
-                            << b.id ()
-                            << ": add to cache and notify set");
-                    append_bp_to_cache_and_notify_bp_set (b);
-                }
+            for (i = a_in.output ().out_of_band_records ().begin ();
+                 i != end;
+                 ++i) {
+                if (i->has_modified_breakpoint ())
+                    update_bp_in_cache_and_notify_bp_modified
+                        (i->modified_breakpoint ());
+                else if (i->has_created_breakpoint ())
+                    update_bp_in_cache_and_notify_bp_modified
+                        (i->created_breakpoint ());
+                else if (i->has_deleted_breakpoint ())
+                    notify_breakpoint_deleted_signal
+                        (i->deleted_breakpoint_id ());
             }
         }
 
@@ -1674,6 +2067,11 @@ struct OnBreakpointHandler: OutputHandler {
             LOG_DD ("Emitting IDebugger::breakpoints_set_signal()");
             m_engine->breakpoints_set_signal ().emit
                 (bps, a_in.command ().cookie ());
+            // The breakpoint replaces another one, e.g. with a
+            // different thread restriction.  Now that the new one is
+            // set, the old one can go.
+            if (!c.tag3 ().empty ())
+                m_engine->delete_breakpoint (c.tag3 ().raw ());
             m_engine->set_state (IDebugger::READY);
         } else if (a_in.output ().has_result_record ()
             && a_in.output ().result_record ().kind ()
@@ -1685,9 +2083,17 @@ struct OnBreakpointHandler: OutputHandler {
             tmp = tmp.erase (0, 13);
             if (tmp.size () == 0) {return;}
             tmp.chomp ();
-            string bkpt_number = tmp;
-            if (!bkpt_number.empty ()) {
-                notify_breakpoint_deleted_signal (bkpt_number);
+            // The command might have deleted several breakpoints.
+            vector<UString> bkpt_numbers = tmp.split (" ");
+            vector<UString>::const_iterator it;
+            bool deleted = false;
+            for (it = bkpt_numbers.begin (); it != bkpt_numbers.end (); ++it) {
+                if (it->empty ())
+                    continue;
+                notify_breakpoint_deleted_signal (it->raw ());
+                deleted = true;
+            }
+            if (deleted) {
                 m_engine->set_state (IDebugger::READY);
             } else {
                 LOG_ERROR ("Got deleted breakpoint number '"
@@ -1761,10 +2167,42 @@ struct OnStoppedHandler: OutputHandler {
         int thread_id = m_out_of_band_record.thread_id ();
         string breakpoint_number;
         IDebugger::StopReason reason = m_out_of_band_record.stop_reason ();
+
+        // The inferior interrupted to sample its stacks is resumed
+        // right away, so nobody else needs to know about that stop.
+        if (m_engine->is_sampling_stacks ()
+            && m_engine->consume_sampling_stop (m_out_of_band_record))
+            return;
         if (reason == IDebugger::BREAKPOINT_HIT
             || reason == IDebugger::WATCHPOINT_SCOPE)
             breakpoint_number = m_out_of_band_record.breakpoint_number ();
 
+        if (m_engine->is_non_stop_mode ()
+            && thread_id > 0
+            && !IDebugger::is_exited (reason)) {
+            // Only thread_id stopped; the other threads keep
+            // running.
+            m_engine->set_thread_state (thread_id, false);
+            int cur_thread_id = m_engine->get_current_thread ();
+            if (thread_id != cur_thread_id) {
+                if (!m_engine->is_thread_running (cur_thread_id)) {
+                    // The thread in focus was already stopped and
+                    // is being inspected.  Don't pull the views
+                    // over to thread_id; its new state shows up in
+                    // the thread list.
+                    LOG_DD ("thread " << thread_id
+                            << " stopped out of focus");
+                    m_engine->set_state (IDebugger::READY);
+                    return;
+                }
+                // The thread in focus is running, so the stopped
+                // thread gets the focus.
+                m_engine->select_thread (thread_id, "");
+            }
+        } else {
+            m_engine->set_thread_state (-1, false);
+        }
+
         if (m_out_of_band_record.has_frame ()) {
             m_engine->set_current_frame_level
                     (m_out_of_band_record.frame ().level ());
@@ -1850,6 +2288,85 @@ struct OnThreadListHandler : OutputHandler {
     }
 };//end OnThreadListHandler
 
+struct OnThreadInfoHandler : OutputHandler {
+    GDBEngine *m_engine;
+
+    OnThreadInfoHandler (GDBEngine *a_engine) :
+        m_engine (a_engine)
+    {}
+
+    bool can_handle (CommandAndOutput &a_in)
+    {
+        THROW_IF_FAIL (m_engine);
+        if (a_in.output ().has_result_record ()
+            && a_in.output ().result_record ().has_thread_infos ()) {
+            return true;
+        }
+        return false;
+    }
+
+    void do_handle (CommandAndOutput &a_in)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        THROW_IF_FAIL (m_engine);
+        if (a_in.command ().name () == "sample-threads-info"
+            && a_in.command ().has_slot ()) {
+            typedef sigc::slot<void,
+                               const vector<IDebugger::ThreadInfo>&> SlotType;
+            SlotType slot = a_in.command ().get_slot<SlotType> ();
+            slot (a_in.output ().result_record ().thread_infos ());
+            return;
+        }
+        m_engine->threads_info_listed_signal ().emit
+            (a_in.output ().result_record ().thread_infos (),
+             a_in.output ().result_record ().current_thread_id (),
+             a_in.command ().cookie ());
+    }
+};//end OnThreadInfoHandler
+
+struct OnThreadCreatedOrExitedHandler : OutputHandler {
+    GDBEngine *m_engine;
+
+    OnThreadCreatedOrExitedHandler (GDBEngine *a_engine) :
+        m_engine (a_engine)
+    {}
+
+    bool can_handle (CommandAndOutput &a_in)
+    {
+        if (!a_in.output ().has_out_of_band_record ())
+            return false;
+        list<Output::OutOfBandRecord>::const_iterator it;
+        for (it = a_in.output ().out_of_band_records ().begin ();
+             it != a_in.output ().out_of_band_records ().end ();
+             ++it) {
+            if (it->thread_created () || it->thread_exited ()) {
+                LOG_DD ("handler selected");
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void do_handle (CommandAndOutput &a_in)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        THROW_IF_FAIL (m_engine);
+        // Several threads can come and go in the same output, so
+        // walk all the records, in order.
+        list<Output::OutOfBandRecord>::const_iterator it;
+        for (it = a_in.output ().out_of_band_records ().begin ();
+             it != a_in.output ().out_of_band_records ().end ();
+             ++it) {
+            if (it->thread_created ())
+                m_engine->thread_created_signal ().emit (it->thread_id ());
+            else if (it->thread_exited ())
+                m_engine->thread_exited_signal ().emit (it->thread_id ());
+        }
+    }
+};//end OnThreadCreatedOrExitedHandler
+
 struct OnThreadSelectedHandler : OutputHandler {
     GDBEngine *m_engine;
     long thread_id;
@@ -1864,9 +2381,11 @@ struct OnThreadSelectedHandler : OutputHandler {
     bool can_handle (CommandAndOutput &a_in)
     {
         THROW_IF_FAIL (m_engine);
+        has_frame = false;
         if (a_in.output ().has_result_record ()
             && a_in.output ().result_record ().thread_id_got_selected ()) {
             thread_id = a_in.output ().result_record ().thread_id ();
+            has_frame = true;
             return true;
         }
         if (a_in.output ().has_out_of_band_record ()) {
@@ -1899,6 +2418,37 @@ struct OnThreadSelectedHandler : OutputHandler {
     }
 };//end OnThreadSelectedHandler
 
+struct OnObjfilesChangedHandler : OutputHandler {
+    GDBEngine *m_engine;
+
+    OnObjfilesChangedHandler (GDBEngine *a_engine) :
+        m_engine (a_engine)
+    {}
+
+    bool can_handle (CommandAndOutput &a_in)
+    {
+        if (!a_in.output ().has_out_of_band_record ())
+            return false;
+        list<Output::OutOfBandRecord>::const_iterator it;
+        for (it = a_in.output ().out_of_band_records ().begin ();
+             it != a_in.output ().out_of_band_records ().end ();
+             ++it) {
+            if (it->objfiles_changed ()) {
+                LOG_DD ("handler selected");
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void do_handle (CommandAndOutput &)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        THROW_IF_FAIL (m_engine);
+        m_engine->invalidate_type_cache ();
+    }
+};//end OnObjfilesChangedHandler
+
 struct OnCommandDoneHandler : OutputHandler {
 
     GDBEngine *m_engine;
@@ -1928,6 +2478,66 @@ struct OnCommandDoneHandler : OutputHandler {
         return true;
     }
 
+    /// Apply to the cached breakpoints the change made by a
+    /// breakpoint command GDB acknowledged, and notify the
+    /// listeners about these breakpoints only.  GDB doesn't report
+    /// the breakpoints changed by GDB/MI commands, so otherwise they
+    /// would have to be listed again.
+    ///
+    /// Sub-breakpoints are not cached on their own, and enabling
+    /// the parent of sub-breakpoints changes them all, so in those
+    /// cases the breakpoints are listed again nevertheless.
+    ///
+    /// \param a_command the breakpoint command.  Its tag0 is the ID
+    /// of the breakpoint, or the IDs of the breakpoints separated by
+    /// spaces.
+    void update_cached_breakpoints (Command &a_command)
+    {
+        typedef map<string, IDebugger::Breakpoint> BPMap;
+        BPMap &bp_cache = m_engine->get_cached_breakpoints ();
+        vector<UString> ids = a_command.tag0 ().split (" ");
+        vector<BPMap::iterator> bps;
+        for (vector<UString>::const_iterator i = ids.begin ();
+             i != ids.end ();
+             ++i) {
+            if (i->empty ())
+                continue;
+            BPMap::iterator it = bp_cache.find (i->raw ());
+            if (it == bp_cache.end ()
+                || it->second.has_multiple_locations ()) {
+                m_engine->list_breakpoints (a_command.cookie ());
+                return;
+            }
+            bps.push_back (it);
+        }
+
+        const UString &name = a_command.name ();
+        BPMap changed_bps;
+        vector<BPMap::iterator>::const_iterator it;
+        for (it = bps.begin (); it != bps.end (); ++it) {
+            IDebugger::Breakpoint &bp = (*it)->second;
+            if (name == "enable-breakpoint") {
+                bp.enabled (true);
+            } else if (name == "disable-breakpoint") {
+                bp.enabled (false);
+            } else if (name == "set-breakpoint-condition") {
+                bp.condition (a_command.tag1 ());
+            } else if (name == "set-breakpoint-ignore-count") {
+                bp.ignore_count (a_command.tag2 ());
+            }
+            changed_bps[(*it)->first] = bp;
+        }
+
+        if (a_command.has_slot ()) {
+            IDebugger::BreakpointsSlot slot =
+                a_command.get_slot<IDebugger::BreakpointsSlot> ();
+            slot (changed_bps);
+        }
+        for (it = bps.begin (); it != bps.end (); ++it)
+            m_engine->breakpoint_modified_signal ().emit
+                ((*it)->second, (*it)->first, a_command.cookie ());
+    }
+
     bool can_handle (CommandAndOutput &a_in)
     {
         if (a_in.output ().has_result_record () &&
@@ -1962,15 +2572,30 @@ struct OnCommandDoneHandler : OutputHandler {
         }
         if (a_in.command ().name () == "enable-countpoint"
             || a_in.command ().name () == "disable-countpoint") {
+            bool flagged = false;
             if (a_in.command ().name () == "enable-countpoint") {
-                flag_breakpoint_as_countpoint (a_in.command ().tag0 (), true);
+                flagged =
+                    flag_breakpoint_as_countpoint (a_in.command ().tag0 (),
+                                                   true);
             } else if (a_in.command ().name () == "disable-countpoint") {
-                flag_breakpoint_as_countpoint (a_in.command ().tag0 (), false);
+                flagged =
+                    flag_breakpoint_as_countpoint (a_in.command ().tag0 (),
+                                                   false);
             }
 
-            m_engine->breakpoints_list_signal ().emit
-                (m_engine->get_cached_breakpoints (),
-                 a_in.command ().cookie ());
+            IDebugger::Breakpoint bp;
+            if (flagged
+                && m_engine->get_breakpoint_from_cache
+                                (a_in.command ().tag0 (), bp))
+                m_engine->breakpoint_modified_signal ().emit
+                    (bp, a_in.command ().tag0 (), a_in.command ().cookie ());
+        }
+
+        if (a_in.command ().name () == "enable-breakpoint"
+            || a_in.command ().name () == "disable-breakpoint"
+            || a_in.command ().name () == "set-breakpoint-condition"
+            || a_in.command ().name () == "set-breakpoint-ignore-count") {
+            update_cached_breakpoints (a_in.command ());
         }
 
         if (a_in.command ().name () == "query-variable-path-expr"
@@ -2051,23 +2676,38 @@ struct OnRunningHandler : OutputHandler {
             m_engine->inferior_re_run_signal ().emit ();
         }
 
-        m_engine->running_signal ().emit ();
+        // In non-stop mode, resuming a thread doesn't necessarily
+        // resume the thread in focus.  OnThreadRunningHandler tells
+        // the world about it, if need be.
+        // The inferior resuming after its stacks were sampled is not
+        // news either, as its stop was not reported.
+        if (!m_engine->is_non_stop_mode ()
+            && a_in.command ().name () != "resume-after-sample")
+            m_engine->running_signal ().emit ();
     }
 };//struct OnRunningHandler
 
-struct OnConnectedHandler : OutputHandler {
+/// Handles the *running notifications that tell which threads
+/// resumed.
+struct OnThreadRunningHandler : OutputHandler {
     GDBEngine *m_engine;
 
-    OnConnectedHandler (GDBEngine *a_engine) :
+    OnThreadRunningHandler (GDBEngine *a_engine) :
         m_engine (a_engine)
     {}
 
     bool can_handle (CommandAndOutput &a_in)
     {
-        if (a_in.output ().has_result_record () &&
-            a_in.output ().result_record ().kind () ==
-              Output::ResultRecord::CONNECTED) {
-            return true;
+        if (!a_in.output ().has_out_of_band_record ())
+            return false;
+        list<Output::OutOfBandRecord>::const_iterator it;
+        for (it = a_in.output ().out_of_band_records ().begin ();
+             it != a_in.output ().out_of_band_records ().end ();
+             ++it) {
+            if (it->is_running ()) {
+                LOG_DD ("handler selected");
+                return true;
+            }
         }
         return false;
     }
@@ -2075,26 +2715,71 @@ struct OnConnectedHandler : OutputHandler {
     void do_handle (CommandAndOutput &a_in)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
-        if (a_in.has_command ()) {}
-        m_engine->set_state (IDebugger::READY);
-        m_engine->connected_to_server_signal ().emit ();
-    }
 
-};//struct OnConnectedHandler
-struct OnFramesListedHandler : OutputHandler {
+        THROW_IF_FAIL (m_engine);
+        bool focus_resumed = false;
+        int cur_thread_id = m_engine->get_current_thread ();
+        list<Output::OutOfBandRecord>::const_iterator it;
+        for (it = a_in.output ().out_of_band_records ().begin ();
+             it != a_in.output ().out_of_band_records ().end ();
+             ++it) {
+            if (!it->is_running ())
+                continue;
+            // A thread id of -1 means all the threads.
+            int thread_id = it->thread_id ();
+            m_engine->set_thread_state (thread_id, true);
+            if (thread_id < 0 || thread_id == cur_thread_id)
+                focus_resumed = true;
+        }
+        if (m_engine->is_non_stop_mode () && focus_resumed)
+            m_engine->running_signal ().emit ();
+    }
+};//struct OnThreadRunningHandler
 
+struct OnConnectedHandler : OutputHandler {
     GDBEngine *m_engine;
 
-    OnFramesListedHandler (GDBEngine *a_engine) :
+    OnConnectedHandler (GDBEngine *a_engine) :
+        m_engine (a_engine)
+    {}
+
+    bool can_handle (CommandAndOutput &a_in)
+    {
+        if (a_in.output ().has_result_record () &&
+            a_in.output ().result_record ().kind () ==
+              Output::ResultRecord::CONNECTED) {
+            return true;
+        }
+        return false;
+    }
+
+    void do_handle (CommandAndOutput &a_in)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        if (a_in.has_command ()) {}
+        m_engine->set_state (IDebugger::READY);
+        m_engine->connected_to_server_signal ().emit ();
+    }
+
+};//struct OnConnectedHandler
+struct OnFramesListedHandler : OutputHandler {
+
+    GDBEngine *m_engine;
+
+    OnFramesListedHandler (GDBEngine *a_engine) :
         m_engine (a_engine)
     {}
 
     bool can_handle (CommandAndOutput &a_in)
     {
+        // The frames of the threads listed by
+        // IDebugger::list_threads_frames are reported to its caller
+        // instead.
         if (a_in.output ().has_result_record ()
             && (a_in.output ().result_record ().kind ()
                 == Output::ResultRecord::DONE)
-            && (a_in.output ().result_record ().has_call_stack ())) {
+            && (a_in.output ().result_record ().has_call_stack ())
+            && a_in.command ().name () != "list-thread-frames") {
             LOG_DD ("handler selected");
             return true;
         }
@@ -2111,7 +2796,7 @@ struct OnFramesListedHandler : OutputHandler {
             m_engine->set_current_frame_address
             (a_in.output ().result_record ().call_stack ()[0].address ());
 
-        vector<IDebugger::Frame> &frames =
+        const vector<IDebugger::Frame> &frames =
             a_in.output ().result_record ().call_stack ();
 
         if (a_in.command ().has_slot ()) {
@@ -2136,13 +2821,24 @@ struct OnFramesParamsListedHandler : OutputHandler {
 
     bool can_handle (CommandAndOutput &a_in)
     {
-        if (a_in.output ().has_result_record ()
-            && (a_in.output ().result_record ().kind ()
-                == Output::ResultRecord::DONE)
+        if (!a_in.output ().has_result_record ())
+            return false;
+        if ((a_in.output ().result_record ().kind ()
+             == Output::ResultRecord::DONE)
             && (a_in.output ().result_record ().has_frames_parameters ())) {
             LOG_DD ("handler selected");
             return true;
         }
+        // Let the caller of IDebugger::list_frames_arguments know
+        // that its request is over.  OnErrorHandler reports the
+        // error itself.
+        if ((a_in.output ().result_record ().kind ()
+             == Output::ResultRecord::ERROR)
+            && a_in.command ().name () == "list-frames-arguments"
+            && a_in.command ().has_slot ()) {
+            LOG_DD ("handler selected");
+            return true;
+        }
         return false;
     }
 
@@ -2150,7 +2846,14 @@ struct OnFramesParamsListedHandler : OutputHandler {
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
-        
+        if (a_in.output ().result_record ().kind ()
+            == Output::ResultRecord::ERROR) {
+            IDebugger::FrameArgsSlot slot =
+                a_in.command ().get_slot<IDebugger::FrameArgsSlot> ();
+            slot (map<int, list<IDebugger::VariableSafePtr> > ());
+            return;
+        }
+
         const map<int, list<IDebugger::VariableSafePtr> > &frame_args =
             a_in.output ().result_record ().frames_parameters ();
 
@@ -2167,6 +2870,41 @@ struct OnFramesParamsListedHandler : OutputHandler {
     }
 };//struct OnFramesParamsListedHandler
 
+/// Handles the result of -stack-info-depth, sent by
+/// GDBEngine::query_stack_depth.
+struct OnStackDepthHandler : OutputHandler {
+
+    GDBEngine *m_engine;
+
+    OnStackDepthHandler (GDBEngine *a_engine) :
+        m_engine (a_engine)
+    {}
+
+    bool can_handle (CommandAndOutput &a_in)
+    {
+        if (a_in.output ().has_result_record ()
+            && (a_in.output ().result_record ().kind ()
+                == Output::ResultRecord::DONE)
+            && (a_in.output ().result_record ().has_stack_depth ())) {
+            LOG_DD ("handler selected");
+            return true;
+        }
+        return false;
+    }
+
+    void do_handle (CommandAndOutput &a_in)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        if (a_in.command ().has_slot ()) {
+            IDebugger::StackDepthSlot slot =
+                a_in.command ().get_slot<IDebugger::StackDepthSlot> ();
+            slot (a_in.output ().result_record ().stack_depth ());
+        }
+        m_engine->set_state (IDebugger::READY);
+    }
+};//struct OnStackDepthHandler
+
 struct OnCurrentFrameHandler : OutputHandler {
     GDBEngine *m_engine;
 
@@ -2269,6 +3007,41 @@ struct OnLocalVariablesListedHandler : OutputHandler {
     }
 };//struct OnLocalVariablesListedHandler
 
+struct OnFrameVariablesListedHandler : OutputHandler {
+
+    GDBEngine *m_engine;
+
+    OnFrameVariablesListedHandler (GDBEngine *a_engine) :
+        m_engine (a_engine)
+    {}
+
+    bool can_handle (CommandAndOutput &a_in)
+    {
+        if (a_in.output ().has_result_record ()
+            && (a_in.output ().result_record ().kind ()
+                == Output::ResultRecord::DONE)
+            && (a_in.output ().result_record ().has_frame_variables ())) {
+            LOG_DD ("handler selected");
+            return true;
+        }
+        return false;
+    }
+
+    void do_handle (CommandAndOutput &a_in)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        THROW_IF_FAIL (m_engine);
+
+        if (a_in.command ().has_slot ()) {
+            typedef IDebugger::FrameVariablesSlot SlotType;
+            SlotType slot = a_in.command ().get_slot<SlotType> ();
+            slot (a_in.output ().result_record ().frame_local_variables (),
+                  a_in.output ().result_record ().frame_arguments ());
+        }
+        m_engine->set_state (IDebugger::READY);
+    }
+};//struct OnFrameVariablesListedHandler
+
 struct OnGlobalVariablesListedHandler : OutputHandler {
 
     GDBEngine *m_engine;
@@ -2505,6 +3278,82 @@ struct OnResultRecordHandler : OutputHandler {
     }
 };//struct OnResultRecordHandler
 
+/// Handles the result of each of the commands sent by
+/// GDBEngine::evaluate_expressions, be it a value or an error.
+struct OnExpressionsEvaluatedHandler : OutputHandler {
+    GDBEngine *m_engine;
+
+    OnExpressionsEvaluatedHandler (GDBEngine *a_engine) :
+        m_engine (a_engine)
+    {}
+
+    bool can_handle (CommandAndOutput &a_in)
+    {
+        if (a_in.command ().name () == "evaluate-expressions"
+            && a_in.output ().has_result_record ()) {
+            LOG_DD ("handler selected");
+            return true;
+        }
+        return false;
+    }
+
+    void do_handle (CommandAndOutput &a_in)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        THROW_IF_FAIL (m_engine);
+
+        int batch_id = atoi (a_in.command ().tag0 ().c_str ());
+        int index = a_in.command ().tag2 ();
+        Output::ResultRecord &record = a_in.output ().result_record ();
+        if (record.kind () == Output::ResultRecord::DONE
+            && record.has_variable_value ()
+            && record.variable_value ()) {
+            m_engine->record_expression_result
+                (batch_id, index, record.variable_value ()->value (),
+                 "", false);
+        } else {
+            m_engine->record_expression_result
+                (batch_id, index, "", record.attrs ()["msg"], true);
+        }
+        m_engine->set_state (IDebugger::READY);
+    }
+};//struct OnExpressionsEvaluatedHandler
+
+/// Handles the result of each of the commands sent by
+/// GDBEngine::list_threads_frames, be it a call stack or an error.
+struct OnThreadFramesListedHandler : OutputHandler {
+    GDBEngine *m_engine;
+
+    OnThreadFramesListedHandler (GDBEngine *a_engine) :
+        m_engine (a_engine)
+    {}
+
+    bool can_handle (CommandAndOutput &a_in)
+    {
+        if (a_in.command ().name () == "list-thread-frames"
+            && a_in.output ().has_result_record ()) {
+            LOG_DD ("handler selected");
+            return true;
+        }
+        return false;
+    }
+
+    void do_handle (CommandAndOutput &a_in)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        THROW_IF_FAIL (m_engine);
+
+        int batch_id = atoi (a_in.command ().tag0 ().c_str ());
+        int thread_id = a_in.command ().tag2 ();
+        const Output::ResultRecord &record = a_in.output ().result_record ();
+        // A thread that exited or is running in the meantime yields
+        // an error; it is then reported with no frame.
+        m_engine->record_thread_frames (batch_id, thread_id,
+                                        record.call_stack ());
+        m_engine->set_state (IDebugger::READY);
+    }
+};//struct OnThreadFramesListedHandler
+
 struct OnVariableTypeHandler : OutputHandler {
     GDBEngine *m_engine;
 
@@ -2516,8 +3365,19 @@ struct OnVariableTypeHandler : OutputHandler {
 
     bool can_handle (CommandAndOutput &a_in)
     {
+        // Let the requests waiting for the same type description
+        // know the "ptype" failed.
+        if (a_in.command ().name () == "get-variable-type"
+            && !a_in.command ().tag3 ().empty ()
+            && a_in.output ().has_result_record ()
+            && (a_in.output ().result_record ().kind ()
+                == Output::ResultRecord::ERROR)) {
+            LOG_DD ("handler selected");
+            return true;
+        }
         if ((a_in.command ().name () == "print-variable-type"
-            ||a_in.command ().name () == "get-variable-type")
+             || a_in.command ().name () == "get-variable-type"
+             || a_in.command ().name () == "get-variable-type-name")
             && a_in.output ().has_out_of_band_record ()) {
             list<Output::OutOfBandRecord>::const_iterator it;
             for (it = a_in.output ().out_of_band_records ().begin ();
@@ -2530,7 +3390,11 @@ struct OnVariableTypeHandler : OutputHandler {
                     && (!it->stream_record ().debugger_console ().compare
                         (0, 6, "ptype ")
                         || !it->stream_record () .debugger_log ().compare
-                        (0, 6, "ptype "))) {
+                        (0, 6, "ptype ")
+                        || !it->stream_record ().debugger_console ().compare
+                        (0, 7, "whatis ")
+                        || !it->stream_record () .debugger_log ().compare
+                        (0, 7, "whatis "))) {
                     LOG_DD ("handler selected");
                     return true;
                 }
@@ -2544,15 +3408,29 @@ struct OnVariableTypeHandler : OutputHandler {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
         THROW_IF_FAIL (m_engine);
+        if (a_in.output ().has_result_record ()
+            && (a_in.output ().result_record ().kind ()
+                == Output::ResultRecord::ERROR)) {
+            if (a_in.command ().name () == "get-variable-type")
+                m_engine->on_type_description_failed
+                                        (a_in.command ().tag3 ());
+            return;
+        }
+
         UString type;
         list<Output::OutOfBandRecord>::const_iterator it;
         it = a_in.output ().out_of_band_records ().begin ();
         ++it;
-        if (!it->has_stream_record ()
+        if (it == a_in.output ().out_of_band_records ().end ()
+            || !it->has_stream_record ()
             || it->stream_record ().debugger_console ().compare
                                                (0, 7, "type = "))
         {
-            if (!it->has_stream_record ()) {
+            if (a_in.command ().name () == "get-variable-type")
+                m_engine->on_type_description_failed
+                                        (a_in.command ().tag3 ());
+            if (it == a_in.output ().out_of_band_records ().end ()
+                || !it->has_stream_record ()) {
                 LOG_ERROR ("no more stream record !");
                 return;
             }
@@ -2595,9 +3473,25 @@ struct OnVariableTypeHandler : OutputHandler {
                 var->type (type);
                 m_engine->variable_type_set_signal ().emit
                                         (var, a_in.command ().cookie ());
+                if (!a_in.command ().tag3 ().empty ())
+                    m_engine->cache_type_description
+                                        (a_in.command ().tag2 (),
+                                         a_in.command ().tag3 (),
+                                         type);
+            } else if (a_in.command ().name () == "get-variable-type-name") {
+                // Now that the name of the type is known, its
+                // description might be in the cache.
+                IDebugger::VariableSafePtr var;
+                var = a_in.command ().variable ();
+                THROW_IF_FAIL (var);
+                m_engine->describe_variable_type (var, type,
+                                                  a_in.command ().cookie ());
+                return;
             } else {
                 THROW ("should not be reached");
             }
+        } else if (a_in.command ().name () == "get-variable-type") {
+            m_engine->on_type_description_failed (a_in.command ().tag3 ());
         }
         m_engine->set_state (IDebugger::READY);
     }
@@ -2840,9 +3734,15 @@ struct OnErrorHandler : OutputHandler {
 
     bool can_handle (CommandAndOutput &a_in)
     {
+        // Errors of batched expression evaluations and thread frame
+        // listings are reported to the caller of
+        // IDebugger::evaluate_expressions and
+        // IDebugger::list_threads_frames instead.
         if (a_in.output ().has_result_record ()
             && (a_in.output ().result_record ().kind ()
-                == Output::ResultRecord::ERROR)) {
+                == Output::ResultRecord::ERROR)
+            && a_in.command ().name () != "evaluate-expressions"
+            && a_in.command ().name () != "list-thread-frames") {
             LOG_DD ("handler selected");
             return true;
         }
@@ -2953,6 +3853,10 @@ struct OnCreateVariableHandler : public OutputHandler
         // in the tag0 member of the command.
         var->name (a_in.command ().tag0 ());
 
+        // This must be done before the slot gets a chance to unfold
+        // the variable.
+        m_engine->apply_type_visualizer_policy (var);
+
         // Call the slot associated to IDebugger::create_variable (), if
         // any.
         if (a_in.command ().has_slot ()) {
@@ -3060,6 +3964,7 @@ struct OnUnfoldVariableHandler : public OutputHandler {
              it != children_vars.end ();
              ++it) {
             parent_var->append (*it);
+            m_engine->apply_type_visualizer_policy (*it);
         }
 
         // Call the slot associated to IDebugger::unfold_variable (), if
@@ -3308,6 +4213,7 @@ GDBEngine::load_program (const UString &a_prog,
     LOG_FUNCTION_SCOPE_NORMAL_DD;
 
     THROW_IF_FAIL (!a_prog.empty ());
+    invalidate_type_cache ();
     vector<UString> argv (a_argv);
 
     bool is_gdb_running = m_priv->is_gdb_running();
@@ -3337,6 +4243,8 @@ GDBEngine::load_program (const UString &a_prog,
 
         m_priv->uses_launch_tty = a_uses_launch_tty;
 
+        m_priv->set_non_stop_mode_if_wanted ();
+
         queue_command (Command ("load-program",
                                 "set breakpoint pending on"));
 
@@ -3414,6 +4322,8 @@ GDBEngine::attach_to_target (unsigned int a_pid,
                                            "" /* no inferior*/,
                                            gdb_opts));
 
+        m_priv->set_non_stop_mode_if_wanted ();
+
         Command command;
         command.value ("set breakpoint pending auto");
         queue_command (command);
@@ -3625,6 +4535,8 @@ GDBEngine::init_output_handlers ()
                 (OutputHandlerSafePtr (new OnStreamRecordHandler (this)));
     m_priv->output_handler_list.add
                 (OutputHandlerSafePtr (new OnDetachHandler (this)));
+    m_priv->output_handler_list.add
+                (OutputHandlerSafePtr (new OnThreadRunningHandler (this)));
     m_priv->output_handler_list.add
                 (OutputHandlerSafePtr (new OnStoppedHandler (this)));
     m_priv->output_handler_list.add
@@ -3639,10 +4551,18 @@ GDBEngine::init_output_handlers ()
                 (OutputHandlerSafePtr (new OnFramesListedHandler (this)));
     m_priv->output_handler_list.add
             (OutputHandlerSafePtr (new OnFramesParamsListedHandler (this)));
+    m_priv->output_handler_list.add
+            (OutputHandlerSafePtr (new OnStackDepthHandler (this)));
     m_priv->output_handler_list.add
             (OutputHandlerSafePtr (new OnInfoProcHandler (this)));
     m_priv->output_handler_list.add
         (OutputHandlerSafePtr (new OnLocalVariablesListedHandler (this)));
+    m_priv->output_handler_list.add
+        (OutputHandlerSafePtr (new OnFrameVariablesListedHandler (this)));
+    m_priv->output_handler_list.add
+        (OutputHandlerSafePtr (new OnObjfilesChangedHandler (this)));
+    m_priv->output_handler_list.add
+        (OutputHandlerSafePtr (new OnExpressionsEvaluatedHandler (this)));
     m_priv->output_handler_list.add
         (OutputHandlerSafePtr (new OnGlobalVariablesListedHandler (this)));
     m_priv->output_handler_list.add
@@ -3659,6 +4579,12 @@ GDBEngine::init_output_handlers ()
             (OutputHandlerSafePtr (new OnThreadListHandler (this)));
     m_priv->output_handler_list.add
             (OutputHandlerSafePtr (new OnThreadSelectedHandler (this)));
+    m_priv->output_handler_list.add
+            (OutputHandlerSafePtr (new OnThreadInfoHandler (this)));
+    m_priv->output_handler_list.add
+            (OutputHandlerSafePtr (new OnThreadFramesListedHandler (this)));
+    m_priv->output_handler_list.add
+            (OutputHandlerSafePtr (new OnThreadCreatedOrExitedHandler (this)));
     m_priv->output_handler_list.add
             (OutputHandlerSafePtr (new OnFileListHandler (this)));
     m_priv->output_handler_list.add
@@ -3758,6 +4684,12 @@ GDBEngine::breakpoint_deleted_signal () const
     return m_priv->breakpoint_deleted_signal;
 }
 
+sigc::signal<void, const IDebugger::Breakpoint&, const string&, const UString&>&
+GDBEngine::breakpoint_modified_signal () const
+{
+    return m_priv->breakpoint_modified_signal;
+}
+
 sigc::signal<void, const map<string, IDebugger::Breakpoint>&, const UString&>&
 GDBEngine::breakpoints_list_signal () const
 {
@@ -3805,6 +4737,33 @@ GDBEngine::thread_selected_signal () const
     return m_priv->thread_selected_signal;
 }
 
+sigc::signal<void,
+             const vector<IDebugger::ThreadInfo>&,
+             int,
+             const UString&>&
+GDBEngine::threads_info_listed_signal () const
+{
+    return m_priv->threads_info_listed_signal;
+}
+
+sigc::signal<void, int>&
+GDBEngine::thread_created_signal () const
+{
+    return m_priv->thread_created_signal;
+}
+
+sigc::signal<void, int>&
+GDBEngine::thread_exited_signal () const
+{
+    return m_priv->thread_exited_signal;
+}
+
+sigc::signal<void, int, bool>&
+GDBEngine::thread_state_changed_signal () const
+{
+    return m_priv->thread_state_changed_signal;
+}
+
 sigc::signal<void, const vector<IDebugger::Frame>&, const UString&>&
 GDBEngine::frames_listed_signal () const
 {
@@ -4438,10 +5397,89 @@ GDBEngine::do_continue (const UString &a_cookie)
     queue_command (command);
 }
 
+/// Resume a given thread, and only that one.  This makes sense in
+/// non-stop mode only.
+///
+/// \param a_thread_id the id of the thread to resume.
+void
+GDBEngine::continue_thread (int a_thread_id, const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    THROW_IF_FAIL (m_priv->non_stop_mode);
+    Command command ("do-continue",
+                     "-exec-continue --thread "
+                     + UString::from_int (a_thread_id),
+                     a_cookie);
+    queue_command (command);
+}
+
+/// Interrupt a given thread, and only that one.  This makes sense
+/// in non-stop mode only.
+///
+/// \param a_thread_id the id of the thread to interrupt.
+void
+GDBEngine::interrupt_thread (int a_thread_id, const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    THROW_IF_FAIL (m_priv->non_stop_mode);
+    Command command ("interrupt-thread",
+                     "-exec-interrupt --thread "
+                     + UString::from_int (a_thread_id),
+                     a_cookie);
+    queue_command (command);
+}
+
+/// Return true if GDB is in non-stop mode, i.e, if the threads of
+/// the inferior can stop and resume independently of each other.
+bool
+GDBEngine::is_non_stop_mode () const
+{
+    return m_priv->non_stop_mode;
+}
+
+/// Return true if a given thread of the inferior is running.
+bool
+GDBEngine::is_thread_running (int a_thread_id) const
+{
+    return m_priv->is_thread_running (a_thread_id);
+}
+
+/// Record that a thread resumed or stopped, and emit
+/// IDebugger::thread_state_changed_signal.
+///
+/// \param a_thread_id the id of the thread, or -1 for all the
+/// threads.
+///
+/// \param a_is_running true if the thread resumed, false if it
+/// stopped.
+void
+GDBEngine::set_thread_state (int a_thread_id, bool a_is_running)
+{
+    if (a_is_running)
+        m_priv->inferior_is_running = true;
+    else if (!m_priv->non_stop_mode || a_thread_id < 0)
+        m_priv->inferior_is_running = false;
+
+    if (m_priv->non_stop_mode) {
+        if (a_thread_id < 0) {
+            if (a_is_running)
+                m_priv->stopped_threads.clear ();
+        } else if (a_is_running) {
+            m_priv->stopped_threads.erase (a_thread_id);
+        } else {
+            m_priv->stopped_threads.insert (a_thread_id);
+        }
+    }
+    m_priv->thread_state_changed_signal.emit (a_thread_id, a_is_running);
+}
+
 void
 GDBEngine::run (const UString &a_cookie)
 {
     LOG_FUNCTION_SCOPE_NORMAL_DD;
+    invalidate_type_cache ();
     Command command ("run",
                      "-exec-run",
                      a_cookie);
@@ -4467,6 +5505,7 @@ GDBEngine::re_run (const DefaultSlot &a_slot)
         LOG_DD ("Requested to stop GDB");
     }
 
+    invalidate_type_cache ();
     Command command ("re-run", "-exec-run");
     command.set_slot (a_slot);
     queue_command (command);
@@ -4557,6 +5596,35 @@ GDBEngine::stop_target ()
         return false;
     }
 
+    // The inferior is being interrupted, or is stopped already, to
+    // sample its stacks.  Just don't resume it afterwards.
+    if (m_priv->sampling_phase != Priv::SAMPLING_NONE
+        && m_priv->sampling_resumes) {
+        m_priv->sampling_stop_requested = true;
+        return true;
+    }
+
+    return interrupt_inferior ();
+}
+
+/// Interrupt the running inferior.
+///
+/// \return true if the interruption was requested.
+bool
+GDBEngine::interrupt_inferior ()
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    if (!m_priv->gdb_pid)
+        return false;
+
+    // In non-stop mode, GDB keeps reading commands while the
+    // inferior runs, so there is no need to interrupt GDB itself.
+    if (m_priv->non_stop_mode) {
+        queue_command (Command ("interrupt-thread", "-exec-interrupt --all"));
+        return true;
+    }
+
     //return  (kill (m_priv->target_pid, SIGINT) == 0);
     return  (kill (m_priv->gdb_pid, SIGINT) == 0);
 }
@@ -4707,6 +5775,25 @@ GDBEngine::set_breakpoint (const Loc &a_loc,
                            gint a_ignore_count,
                            const BreakpointsSlot &a_slot,
                            const UString &a_cookie)
+{
+    set_breakpoint (a_loc, a_condition, a_ignore_count,
+                    /*a_thread_id=*/0, a_slot, a_cookie);
+}
+
+/// Set a breakpoint at a location, that stops only a given thread.
+///
+/// \param a_thread_id the id of the only thread the breakpoint
+/// stops, or 0 if it has to stop any thread.  Note that GDB refuses
+/// to set a breakpoint for a thread that doesn't exist (yet).
+///
+/// The other parameters are those of the overload above.
+void
+GDBEngine::set_breakpoint (const Loc &a_loc,
+                           const UString &a_condition,
+                           gint a_ignore_count,
+                           int a_thread_id,
+                           const BreakpointsSlot &a_slot,
+                           const UString &a_cookie)
 {
     LOG_FUNCTION_SCOPE_NORMAL_DD;
 
@@ -4716,19 +5803,10 @@ GDBEngine::set_breakpoint (const Loc &a_loc,
 
     location_to_string (a_loc, loc_str);
 
-    UString break_cmd = "-break-insert -f ";
-    if (!a_condition.empty ()) {
-        LOG_DD ("setting breakpoint with condition: " << a_condition);
-        break_cmd += " -c \"" + a_condition + "\"";
-    } else {
-        LOG_DD ("setting breakpoint without condition");
-    }
-
+    UString break_cmd = break_insert_command (loc_str, a_condition,
+                                              a_ignore_count, a_thread_id,
+                                              true);
     bool count_point = (a_ignore_count < 0);
-    if (!count_point)
-        break_cmd += " -i " + UString::from_int (a_ignore_count);
-
-    break_cmd += " " + loc_str;
     string cmd_name = count_point ? "set-countpoint" : "set-breakpoint";
 
     Command command (cmd_name, break_cmd, a_cookie);
@@ -4742,28 +5820,31 @@ GDBEngine::set_breakpoint (const UString &a_path,
                            const UString &a_condition,
                            gint a_ignore_count,
                            const UString &a_cookie)
+{
+    set_breakpoint (a_path, a_line_num, a_condition, a_ignore_count,
+                    /*a_thread_id=*/0, a_cookie);
+}
+
+/// Set a breakpoint at a source line, that stops only the thread
+/// a_thread_id, or any thread if a_thread_id is 0.
+void
+GDBEngine::set_breakpoint (const UString &a_path,
+                           gint a_line_num,
+                           const UString &a_condition,
+                           gint a_ignore_count,
+                           int a_thread_id,
+                           const UString &a_cookie)
 {
     LOG_FUNCTION_SCOPE_NORMAL_DD;
 
     THROW_IF_FAIL (!a_path.empty ());
 
-    UString break_cmd ("-break-insert -f ");
-    if (!a_condition.empty ()) {
-        LOG_DD ("setting breakpoint with condition: " << a_condition);
-        break_cmd += " -c \"" + a_condition + "\"";
-    } else {
-        LOG_DD ("setting breakpoint without condition");
-    }
-
+    UString loc_str = "\"" + a_path + ":"
+                      + UString::from_int (a_line_num) + "\"";
+    UString break_cmd = break_insert_command (loc_str, a_condition,
+                                              a_ignore_count, a_thread_id,
+                                              true);
     bool count_point = (a_ignore_count < 0);
-    if (!count_point)
-      break_cmd += " -i " + UString::from_int (a_ignore_count);
-
-    if (!a_path.empty ()) {
-        break_cmd += " \"" + a_path + ":";
-    }
-    break_cmd += UString::from_int (a_line_num);
-    break_cmd += "\"";
     string cmd_name = count_point ? "set-countpoint" : "set-breakpoint";
     queue_command (Command (cmd_name,
 			    break_cmd, a_cookie));
@@ -4780,22 +5861,67 @@ GDBEngine::set_breakpoint (const Address &a_address,
 
     THROW_IF_FAIL (!a_address.empty ());
 
-    UString break_cmd ("-break-insert -f ");
-    if (!a_condition.empty ()) {
-        LOG_DD ("setting breakpoint with condition: " << a_condition);
-        break_cmd += " -c \"" + a_condition + "\"";
-    } else {
-        LOG_DD ("setting breakpoint without condition");
-    }
+    UString break_cmd =
+        break_insert_command ("*" + (const string&) a_address, a_condition,
+                              a_ignore_count, /*a_thread_id=*/0, true);
     bool count_point = a_ignore_count < 0;
-    if (!count_point)
-      break_cmd += " -i " + UString::from_int (a_ignore_count);
-    break_cmd += " *" + (const string&) a_address;
 
     string cmd_name = count_point ? "set-countpoint" : "set-breakpoint";
     queue_command (Command (cmd_name, break_cmd, a_cookie));
 }
 
+/// Set several breakpoints at once.
+///
+/// The commands that insert the breakpoints are pipelined, so GDB
+/// doesn't have to report a breakpoint as set before the next one is
+/// sent.  Disabled breakpoints are inserted disabled right away.
+/// Each breakpoint that gets set is reported by
+/// IDebugger::breakpoints_set_signal, like with set_breakpoint.
+///
+/// \param a_breaks the breakpoints to set.  Breakpoints that have
+/// neither a file name, a function, an address nor an expression
+/// are ignored.
+///
+/// \param a_cookie the cookie passed to
+/// IDebugger::breakpoints_set_signal.
+void
+GDBEngine::set_breakpoints (const vector<IDebugger::Breakpoint> &a_breaks,
+                            const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    bool has_watchpoints = false;
+    vector<IDebugger::Breakpoint>::const_iterator it;
+    for (it = a_breaks.begin (); it != a_breaks.end (); ++it) {
+        UString cmd_name, break_cmd;
+        if (it->type () == Breakpoint::WATCHPOINT_TYPE) {
+            if (it->expression ().empty ())
+                continue;
+            break_cmd = "-break-watch";
+            if (it->is_write_watchpoint () && it->is_read_watchpoint ())
+                break_cmd += " -a";
+            else if (it->is_read_watchpoint ())
+                break_cmd += " -r";
+            break_cmd += " " + it->expression ();
+            cmd_name = "set-watchpoint";
+            has_watchpoints = true;
+        } else if (!build_break_insert_command (*it, cmd_name, break_cmd)) {
+            continue;
+        }
+
+        Command command (cmd_name, break_cmd, a_cookie);
+        // Inserting a breakpoint changes neither the state of the
+        // inferior nor the selected thread or frame.
+        command.may_be_pipelined (true);
+        queue_command (command);
+    }
+
+    // The result of -break-watch is not cached, so list the
+    // breakpoints once all of them are set.
+    if (has_watchpoints)
+        list_breakpoints (a_cookie);
+}
+
 /// Enable a given breakpoint
 ///
 /// \param a_break_num the ID of the breakpoint to enable.
@@ -4818,10 +5944,11 @@ GDBEngine::enable_breakpoint (const string &a_break_num,
     LOG_FUNCTION_SCOPE_NORMAL_DD;
 
     Command command ("enable-breakpoint",
-                     "-break-enable " + a_break_num);
+                     "-break-enable " + a_break_num,
+                     a_cookie);
+    command.tag0 (a_break_num);
     command.set_slot (a_slot);
     queue_command (command);
-    list_breakpoints (a_cookie);
 }
 
 /// Enable a given breakpoint
@@ -4846,10 +5973,47 @@ GDBEngine::disable_breakpoint (const string &a_break_num,
 {
     LOG_FUNCTION_SCOPE_NORMAL_DD;
 
-    queue_command (Command ("disable-breakpoint",
-                            "-break-disable " + a_break_num,
-                            a_cookie));
-    list_breakpoints (a_cookie);
+    Command command ("disable-breakpoint",
+                     "-break-disable " + a_break_num,
+                     a_cookie);
+    command.tag0 (a_break_num);
+    queue_command (command);
+}
+
+/// Enable several breakpoints.  GDB is sent as few -break-enable
+/// commands as possible, and the cache is updated once per command.
+///
+/// \param a_break_nums the IDs of the breakpoints to enable.
+///
+/// \param a_cookie the cookie passed to
+/// IDebugger::breakpoint_modified_signal.
+void
+GDBEngine::enable_breakpoints (const vector<string> &a_break_nums,
+                               const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    m_priv->queue_breakpoints_command ("enable-breakpoint",
+                                       "-break-enable",
+                                       a_break_nums, a_cookie);
+}
+
+/// Disable several breakpoints.  GDB is sent as few -break-disable
+/// commands as possible, and the cache is updated once per command.
+///
+/// \param a_break_nums the IDs of the breakpoints to disable.
+///
+/// \param a_cookie the cookie passed to
+/// IDebugger::breakpoint_modified_signal.
+void
+GDBEngine::disable_breakpoints (const vector<string> &a_break_nums,
+                                const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    m_priv->queue_breakpoints_command ("disable-breakpoint",
+                                       "-break-disable",
+                                       a_break_nums, a_cookie);
 }
 
 void
@@ -4865,8 +6029,12 @@ GDBEngine::set_breakpoint_ignore_count (const string &a_break_num,
                      "-break-after " + a_break_num
                      + " " + UString::from_int (a_ignore_count),
                      a_cookie);
+    command.tag0 (a_break_num);
+    command.tag2 (a_ignore_count);
+    // This is sent for each breakpoint when the inferior is
+    // re-started, so don't wait for each of them to complete.
+    command.may_be_pipelined (true);
     queue_command (command);
-    list_breakpoints (a_cookie);
 
     typedef map<string, IDebugger::Breakpoint> BPMap;
     BPMap &bp_cache =
@@ -4889,8 +6057,73 @@ GDBEngine::set_breakpoint_condition (const string &a_break_num,
     Command command ("set-breakpoint-condition",
                      "-break-condition " + a_break_num
                      + " " + a_condition, a_cookie);
+    command.tag0 (a_break_num);
+    command.tag1 (a_condition);
+    queue_command (command);
+}
+
+/// Restrict a breakpoint to a given thread, or let it stop any
+/// thread again.
+///
+/// GDB/MI has no command to change the thread of an existing
+/// breakpoint, so the breakpoint is deleted and inserted again at
+/// the same location, with the same condition, ignore count and
+/// enabled state.  The breakpoint thus gets a new number, and
+/// IDebugger::breakpoint_deleted_signal then
+/// IDebugger::breakpoints_set_signal are emitted.  Its hit count
+/// starts over.
+///
+/// \param a_break_num the ID of the breakpoint.
+///
+/// \param a_thread_id the id of the only thread the breakpoint has
+/// to stop, or 0 if it has to stop any thread.
+///
+/// \param a_cookie a string passed to
+/// IDebugger::breakpoints_set_signal.
+void
+GDBEngine::set_breakpoint_thread (const string &a_break_num,
+                                  int a_thread_id,
+                                  const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    RETURN_IF_FAIL (!a_break_num.empty () && a_thread_id >= 0);
+
+    Breakpoint bp;
+    if (!get_breakpoint_from_cache (a_break_num, bp)) {
+        LOG_ERROR ("unknown breakpoint: " << a_break_num);
+        return;
+    }
+    // GDB can't delete sub-breakpoints, so work on the parent.
+    if (bp.is_sub_breakpoint ()
+        && !get_breakpoint_from_cache (bp.parent_id (), bp)) {
+        LOG_ERROR ("unknown breakpoint: " << bp.parent_id ());
+        return;
+    }
+    if (bp.type () == Breakpoint::WATCHPOINT_TYPE) {
+        LOG_ERROR ("watchpoints can't be restricted to a thread");
+        return;
+    }
+    if (bp.thread_id () == a_thread_id)
+        return;
+
+    // The new breakpoint goes on ignoring the hits the old one had
+    // left to ignore.
+    Breakpoint new_bp = bp;
+    new_bp.thread_id (a_thread_id);
+    new_bp.initial_ignore_count (bp.ignore_count ());
+    UString cmd_name, break_cmd;
+    if (!build_break_insert_command (new_bp, cmd_name, break_cmd)) {
+        LOG_ERROR ("breakpoint " << a_break_num << " has no location");
+        return;
+    }
+
+    // Delete the old breakpoint only once the new one is set, so
+    // that it is kept if GDB rejects the new one, e.g. because the
+    // thread is gone.
+    Command command (cmd_name, break_cmd, a_cookie);
+    command.tag3 (bp.id ());
     queue_command (command);
-    list_breakpoints (a_cookie);
 }
 
 void
@@ -4937,6 +6170,55 @@ GDBEngine::is_countpoint (const Breakpoint &a_breakpoint) const
     return (a_breakpoint.type () == Breakpoint::COUNTPOINT_TYPE);
 }
 
+/// Generate the command that sets a breakpoint just like a given
+/// one: at the same location, with the same condition, enabled or
+/// disabled, for the same thread, and ignoring its initial ignore
+/// count.
+///
+/// \param a_breakpoint the breakpoint to set.  It's either a
+/// standard breakpoint or a countpoint.
+///
+/// \param a_cmd_name out parameter.  Set to the name of the command.
+///
+/// \param a_cmd out parameter.  Set to the command.
+///
+/// \return false if a_breakpoint can't be set by -break-insert, e.g.
+/// if it's a watchpoint or has no location.
+bool
+GDBEngine::build_break_insert_command (const Breakpoint &a_breakpoint,
+                                       UString &a_cmd_name,
+                                       UString &a_cmd) const
+{
+    if (a_breakpoint.type () != Breakpoint::STANDARD_BREAKPOINT_TYPE
+        && a_breakpoint.type () != Breakpoint::COUNTPOINT_TYPE)
+        return false;
+
+    UString loc_str;
+    UString file_name = a_breakpoint.file_full_name ().empty ()
+        ? a_breakpoint.file_name ()
+        : a_breakpoint.file_full_name ();
+    if (!file_name.empty () && a_breakpoint.line ())
+        loc_str = "\"" + file_name + ":"
+            + UString::from_int (a_breakpoint.line ()) + "\"";
+    else if (!a_breakpoint.function ().empty ())
+        loc_str = "\"" + a_breakpoint.function () + "\"";
+    else if (!a_breakpoint.address ().empty ())
+        loc_str = "*" + a_breakpoint.address ().to_string ();
+    else
+        return false;
+
+    bool count_point = is_countpoint (a_breakpoint);
+    a_cmd = break_insert_command (loc_str,
+                                  a_breakpoint.condition (),
+                                  count_point
+                                  ? -1
+                                  : a_breakpoint.initial_ignore_count (),
+                                  a_breakpoint.thread_id (),
+                                  a_breakpoint.enabled ());
+    a_cmd_name = count_point ? "set-countpoint" : "set-breakpoint";
+    return true;
+}
+
 void
 GDBEngine::delete_breakpoint (const UString &a_path,
                               gint a_line_num,
@@ -5027,16 +6309,9 @@ GDBEngine::set_breakpoint (const UString &a_func_name,
 {
     LOG_FUNCTION_SCOPE_NORMAL_DD;
 
-    UString break_cmd;
-    break_cmd += "-break-insert -f ";
-    if (!a_condition.empty ()) {
-        LOG_DD ("setting breakpoint with condition: " << a_condition);
-        break_cmd += " -c \"" + a_condition + "\"";
-    } else {
-        LOG_DD ("setting breakpoint without condition");
-    }
-    break_cmd += " -i " + UString::from_int (a_ignore_count);
-    break_cmd +=  " " + a_func_name;
+    UString break_cmd = break_insert_command (a_func_name, a_condition,
+                                              a_ignore_count,
+                                              /*a_thread_id=*/0, true);
 
     Command command ("set-breakpoint", break_cmd, a_cookie);
     command.set_slot (a_slot);
@@ -5176,6 +6451,67 @@ GDBEngine::append_breakpoints_to_cache
         append_breakpoint_to_cache (iter->second);
 }
 
+/// Forget all the type descriptions cached so far.  This is to be
+/// called whenever the objfiles of the inferior might have changed,
+/// as a type name might then designate a different type.
+void
+GDBEngine::invalidate_type_cache ()
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+    ++m_priv->objfiles_generation;
+    m_priv->type_cache.clear ();
+}
+
+/// Record the description of a type, as returned by "ptype", and
+/// hand it to the get_variable_type requests that were waiting for
+/// it.
+/// \param a_objfiles_generation the objfiles generation at the time
+/// the description was requested.  If the type cache got invalidated
+/// since then, the description is not recorded.
+/// \param a_type_name the name of the type.
+/// \param a_description the description of the type.
+void
+GDBEngine::cache_type_description (int a_objfiles_generation,
+                                   const UString &a_type_name,
+                                   const UString &a_description)
+{
+    if (a_type_name.empty ())
+        return;
+    if (a_objfiles_generation == m_priv->objfiles_generation)
+        m_priv->type_cache[a_type_name] = a_description;
+
+    map<UString, list<pair<VariableSafePtr, UString> > >::iterator it =
+        m_priv->type_waiters.find (a_type_name);
+    if (it == m_priv->type_waiters.end ())
+        return;
+    list<pair<VariableSafePtr, UString> > waiters;
+    waiters.swap (it->second);
+    m_priv->type_waiters.erase (it);
+    list<pair<VariableSafePtr, UString> >::const_iterator w;
+    for (w = waiters.begin (); w != waiters.end (); ++w) {
+        w->first->type (a_description);
+        variable_type_set_signal ().emit (w->first, w->second);
+    }
+}
+
+/// Called when the "ptype" of a type failed.  The requests that were
+/// waiting for its description each ask for it on their own.
+/// \param a_type_name the name of the type.
+void
+GDBEngine::on_type_description_failed (const UString &a_type_name)
+{
+    map<UString, list<pair<VariableSafePtr, UString> > >::iterator it =
+        m_priv->type_waiters.find (a_type_name);
+    if (it == m_priv->type_waiters.end ())
+        return;
+    list<pair<VariableSafePtr, UString> > waiters;
+    waiters.swap (it->second);
+    m_priv->type_waiters.erase (it);
+    list<pair<VariableSafePtr, UString> >::const_iterator w;
+    for (w = waiters.begin (); w != waiters.end (); ++w)
+        describe_variable_type (w->first, "", w->second);
+}
+
 
 void
 GDBEngine::set_catch (const UString &a_event,
@@ -5201,6 +6537,293 @@ GDBEngine::list_threads (const UString &a_cookie)
     queue_command (Command ("list-threads", "-thread-list-ids", a_cookie));
 }
 
+/// List the threads of the inferior along with their target id,
+/// name, state and current frame, in one go.  The result is
+/// reported by IDebugger::threads_info_listed_signal.
+void
+GDBEngine::list_threads_info (const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    queue_command (Command ("list-threads-info", "-thread-info", a_cookie));
+}
+
+/// List the innermost frames of a set of threads.  The commands for
+/// all the threads are sent to GDB at once, and neither the current
+/// thread nor the current frame is changed.
+///
+/// \param a_thread_ids the ids of the threads to list the frames of.
+///
+/// \param a_max_depth the maximum number of frames to list per
+/// thread.  If negative, all the frames are listed.
+///
+/// \param a_slot the slot called once the frames of all the threads
+/// have been listed.  A thread which frames could not be listed,
+/// e.g because it exited in the meantime, gets an empty list of
+/// frames.
+void
+GDBEngine::list_threads_frames (const list<int> &a_thread_ids,
+                                int a_max_depth,
+                                const ThreadsFramesSlot &a_slot)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    int batch_id = ++m_priv->last_thread_frames_batch_id;
+    Priv::ThreadFramesBatch &batch = m_priv->thread_frames_batches[batch_id];
+    batch.nb_pending = 0;
+    batch.slot = a_slot;
+
+    UString window;
+    if (a_max_depth > 0)
+        window = " 0 " + UString::from_int (a_max_depth - 1);
+
+    list<int>::const_iterator it;
+    for (it = a_thread_ids.begin (); it != a_thread_ids.end (); ++it) {
+        if (batch.frames.count (*it))
+            continue;
+        batch.frames[*it];
+        ++batch.nb_pending;
+        Command command ("list-thread-frames",
+                         "-stack-list-frames --thread "
+                         + UString::from_int (*it) + window);
+        command.tag0 (UString::from_int (batch_id));
+        command.tag2 (*it);
+        command.may_be_pipelined (true);
+        queue_command (command);
+    }
+
+    if (batch.nb_pending == 0) {
+        map<int, vector<IDebugger::Frame> > frames;
+        frames.swap (batch.frames);
+        m_priv->thread_frames_batches.erase (batch_id);
+        a_slot (frames);
+    }
+}
+
+/// Record the frames of one thread of a batch started by
+/// list_threads_frames.  Once the frames of all the threads of the
+/// batch are there, the slot of the batch is called.
+///
+/// \param a_batch_id the identifier of the batch.
+///
+/// \param a_thread_id the id of the thread.
+///
+/// \param a_frames the frames of the thread.
+void
+GDBEngine::record_thread_frames (int a_batch_id,
+                                 int a_thread_id,
+                                 const vector<IDebugger::Frame> &a_frames)
+{
+    map<int, Priv::ThreadFramesBatch>::iterator it =
+        m_priv->thread_frames_batches.find (a_batch_id);
+    if (it == m_priv->thread_frames_batches.end ())
+        return;
+    Priv::ThreadFramesBatch &batch = it->second;
+
+    batch.frames[a_thread_id] = a_frames;
+
+    THROW_IF_FAIL (batch.nb_pending > 0);
+    if (--batch.nb_pending)
+        return;
+
+    map<int, vector<IDebugger::Frame> > frames;
+    frames.swap (batch.frames);
+    ThreadsFramesSlot slot = batch.slot;
+    m_priv->thread_frames_batches.erase (it);
+    slot (frames);
+}
+
+/// Take a sample of the stacks of all the threads of the inferior.
+///
+/// If the inferior is running, it is interrupted, its threads and
+/// their innermost frames are listed, and it is resumed right away.
+/// That stop is not reported by IDebugger::stopped_signal, and the
+/// state of the debugger stays IDebugger::RUNNING in the meantime.
+/// If stop_target is called in the meantime, the inferior is left
+/// stopped and that stop is reported.  If the inferior is stopped,
+/// its stacks are just listed.
+///
+/// \param a_max_depth the maximum number of frames to list per
+/// thread.
+///
+/// \param a_slot the slot called with the frames of each thread.  It
+/// is called with no frame at all if the inferior stopped for
+/// another reason (e.g, a breakpoint) before it could be
+/// interrupted.
+void
+GDBEngine::sample_threads_stacks (int a_max_depth,
+                                  const ThreadsFramesSlot &a_slot)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    THROW_IF_FAIL (m_priv->sampling_phase == Priv::SAMPLING_NONE);
+
+    m_priv->sampling_max_depth = a_max_depth;
+    m_priv->sampling_slot = a_slot;
+    m_priv->sampling_resumes = m_priv->inferior_is_running;
+    m_priv->sampling_stop_requested = false;
+    m_priv->sampling_stopped_threads.clear ();
+    if (m_priv->sampling_resumes) {
+        m_priv->sampling_phase = Priv::SAMPLING_INTERRUPTING;
+        m_priv->sampling_interrupt_pending = interrupt_inferior ();
+        if (!m_priv->sampling_interrupt_pending)
+            cancel_stack_sampling ();
+    } else {
+        list_sampled_threads ();
+    }
+}
+
+/// Return true if a sample of the stacks of the threads is being
+/// taken.  See sample_threads_stacks.
+bool
+GDBEngine::is_sampling_stacks () const
+{
+    return m_priv->sampling_phase != Priv::SAMPLING_NONE;
+}
+
+/// Called for each stop of the inferior while it is being sampled by
+/// sample_threads_stacks.
+///
+/// Only the stop caused by the interrupt sent by the sampling is
+/// consumed; in non-stop mode, that is one stop per interrupted
+/// thread.  Any other stop, or a stop the user asked for in the
+/// meantime through stop_target, gives up the sampling.
+///
+/// \param a_record the out of band record reporting the stop.
+///
+/// \return true if the stop was consumed and must not be reported.
+bool
+GDBEngine::consume_sampling_stop (const Output::OutOfBandRecord &a_record)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    if (m_priv->sampling_phase == Priv::SAMPLING_NONE)
+        return false;
+
+    // GDB reports the interruption as SIGINT, or as the signal "0"
+    // in non-stop mode.
+    bool is_interrupt =
+        a_record.stop_reason () == IDebugger::SIGNAL_RECEIVED
+        && (a_record.signal_type () == "SIGINT"
+            || a_record.signal_type () == "0");
+
+    if (is_interrupt && m_priv->sampling_interrupt_pending) {
+        m_priv->sampling_interrupt_pending = false;
+        if (m_priv->sampling_stop_requested) {
+            // This stop is the one the user asked for.
+            cancel_stack_sampling ();
+            return false;
+        }
+        m_priv->sampling_stop_record = a_record;
+        if (m_priv->non_stop_mode)
+            m_priv->sampling_stopped_threads.insert (a_record.thread_id ());
+        list_sampled_threads ();
+        return true;
+    }
+
+    if (is_interrupt
+        && m_priv->non_stop_mode
+        && a_record.signal_type () == "0"
+        && m_priv->sampling_stopped_threads.insert
+                                        (a_record.thread_id ()).second)
+        return true;
+
+    // The inferior stopped for real before it could be
+    // interrupted, or got a SIGINT of its own.  Give up sampling
+    // and report the stop.
+    cancel_stack_sampling ();
+    return false;
+}
+
+/// Give up the sample being taken by sample_threads_stacks, and
+/// call its slot with no frame.
+void
+GDBEngine::cancel_stack_sampling ()
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    if (m_priv->sampling_phase == Priv::SAMPLING_NONE)
+        return;
+    m_priv->sampling_phase = Priv::SAMPLING_NONE;
+    m_priv->sampling_interrupt_pending = false;
+    m_priv->sampling_stop_requested = false;
+    m_priv->sampling_stopped_threads.clear ();
+    ThreadsFramesSlot slot = m_priv->sampling_slot;
+    m_priv->sampling_slot = ThreadsFramesSlot ();
+    slot (map<int, vector<IDebugger::Frame> > ());
+}
+
+void
+GDBEngine::list_sampled_threads ()
+{
+    m_priv->sampling_phase = Priv::SAMPLING_LISTING;
+    sigc::slot<void, const vector<IDebugger::ThreadInfo>&> slot =
+        sigc::mem_fun (*this, &GDBEngine::on_sampled_threads_listed);
+    Command command ("sample-threads-info", "-thread-info");
+    command.set_slot (slot);
+    command.may_be_pipelined (true);
+    queue_command (command);
+}
+
+void
+GDBEngine::on_sampled_threads_listed
+                        (const vector<IDebugger::ThreadInfo> &a_threads)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    if (m_priv->sampling_phase != Priv::SAMPLING_LISTING)
+        return;
+
+    list<int> thread_ids;
+    vector<IDebugger::ThreadInfo>::const_iterator it;
+    for (it = a_threads.begin (); it != a_threads.end (); ++it)
+        if (!it->is_running ())
+            thread_ids.push_back (it->id ());
+    list_threads_frames
+        (thread_ids, m_priv->sampling_max_depth,
+         sigc::mem_fun (*this, &GDBEngine::on_sampled_threads_frames_listed));
+}
+
+void
+GDBEngine::on_sampled_threads_frames_listed
+                        (const map<int, vector<IDebugger::Frame> > &a_frames)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    if (m_priv->sampling_phase != Priv::SAMPLING_LISTING)
+        return;
+
+    m_priv->sampling_phase = Priv::SAMPLING_NONE;
+    ThreadsFramesSlot slot = m_priv->sampling_slot;
+    m_priv->sampling_slot = ThreadsFramesSlot ();
+    bool stop_requested = m_priv->sampling_stop_requested;
+    m_priv->sampling_stop_requested = false;
+    m_priv->sampling_stopped_threads.clear ();
+    if (m_priv->sampling_resumes && !stop_requested) {
+        queue_command (Command ("resume-after-sample",
+                                m_priv->non_stop_mode
+                                ? "-exec-continue --all"
+                                : "-exec-continue"));
+    } else if (!m_priv->sampling_resumes) {
+        set_state (IDebugger::READY);
+    }
+    slot (a_frames);
+
+    if (m_priv->sampling_resumes && stop_requested) {
+        // The user asked to stop the inferior while it was being
+        // sampled: leave it stopped and report the stop that was
+        // consumed by the sampling.
+        Output output;
+        output.parsing_succeeded (true);
+        output.has_out_of_band_record (true);
+        output.out_of_band_records ().push_back
+                                        (m_priv->sampling_stop_record);
+        CommandAndOutput cao;
+        cao.output (output);
+        m_priv->output_handler_list.submit_command_and_output (cao);
+    }
+}
+
 void
 GDBEngine::select_thread (unsigned int a_thread_id,
                           const UString &a_cookie)
@@ -5268,6 +6891,33 @@ GDBEngine::delete_breakpoint (const string &a_break_num,
                             a_cookie));
 }
 
+/// Delete several breakpoints.  GDB is sent as few -break-delete
+/// commands as possible.
+///
+/// \param a_break_nums the IDs of the breakpoints to delete.  As
+/// with delete_breakpoint, the ID of a sub-breakpoint designates its
+/// parent breakpoint.
+///
+/// \param a_cookie the cookie of the commands.
+void
+GDBEngine::delete_breakpoints (const vector<string> &a_break_nums,
+                               const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    vector<string> ids;
+    std::set<string> seen;
+    vector<string>::const_iterator it;
+    for (it = a_break_nums.begin (); it != a_break_nums.end (); ++it) {
+        string id = it->substr (0, it->find ('.'));
+        if (!id.empty () && seen.insert (id).second)
+            ids.push_back (id);
+    }
+    m_priv->queue_breakpoints_command ("delete-breakpoint",
+                                       "-break-delete",
+                                       ids, a_cookie);
+}
+
 /// Lists the frames which numbers are in a given range.
 ///
 /// Upon completion of the GDB side of this command, the signal
@@ -5387,13 +7037,57 @@ GDBEngine::list_frames_arguments (int a_low_frame,
                                   const FrameArgsSlot &a_slot,
                                   const UString &a_cookie)
 {
-    UString cmd_str;
+    list_frames_arguments (a_low_frame, a_high_frame, PRINT_ALL_VALUES,
+                           a_slot, a_cookie);
+}
 
-    if (a_low_frame < 0 || a_high_frame < 0) {
-        cmd_str = "-stack-list-arguments 1";
-    } else {
-        cmd_str = UString ("-stack-list-arguments 1 ")
-            + UString::from_int (a_low_frame)
+/// List the arguments of the frames which numbers are in a given
+/// range, reporting only as much of their values as asked.
+///
+/// Formatting the full value of big aggregates passed by value, or
+/// of pretty-printed containers, is what makes listing the arguments
+/// of many frames slow; PRINT_SIMPLE_VALUES only reports the type of
+/// such arguments.
+///
+/// \param a_low_frame the lower bound of the range of frames which
+/// arguments to list.
+///
+/// \param a_high_frame the uper bound of the range of frames which
+/// arguments to list.
+///
+/// \param a_print_values how much of the values to report.
+///
+/// \param a_slot a callback slot called upon completion of the
+/// GDB-side command emitted by this function.  If that command
+/// fails, it is called with an empty map.
+///
+/// \param a_cookie a string to be passed to the
+/// GDBEngine::frames_arguments_listed_signal signal.
+void
+GDBEngine::list_frames_arguments (int a_low_frame,
+                                  int a_high_frame,
+                                  PrintValues a_print_values,
+                                  const FrameArgsSlot &a_slot,
+                                  const UString &a_cookie)
+{
+    // Older GDBs only know the numeric form of the print-values
+    // argument: 0 is --no-values, 1 --all-values and 2
+    // --simple-values.
+    UString cmd_str = "-stack-list-arguments ";
+
+    switch (a_print_values) {
+        case PRINT_NO_VALUES:
+            cmd_str += "0";
+            break;
+        case PRINT_ALL_VALUES:
+            cmd_str += "1";
+            break;
+        case PRINT_SIMPLE_VALUES:
+            cmd_str += "2";
+            break;
+    }
+    if (a_low_frame >= 0 && a_high_frame >= 0) {
+        cmd_str += " " + UString::from_int (a_low_frame)
             + " "
             + UString::from_int (a_high_frame);
     }
@@ -5402,6 +7096,33 @@ GDBEngine::list_frames_arguments (int a_low_frame,
     queue_command (command);
 }
 
+/// Query the number of frames of the call stack of the current
+/// thread, using -stack-info-depth.
+///
+/// \param a_slot the slot called with the depth of the stack upon
+/// completion of the GDB-side command.
+///
+/// \param a_max_depth if positive, GDB stops counting the frames
+/// after that many frames, which is quicker on very deep stacks.  The
+/// depth reported is then at most a_max_depth.
+///
+/// \param a_cookie the cookie of the command.
+void
+GDBEngine::query_stack_depth (const StackDepthSlot &a_slot,
+                              int a_max_depth,
+                              const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    UString cmd_str = "-stack-info-depth";
+    if (a_max_depth > 0)
+        cmd_str += " " + UString::from_int (a_max_depth);
+
+    Command command ("query-stack-depth", cmd_str, a_cookie);
+    command.set_slot (a_slot);
+    queue_command (command);
+}
+
 void
 GDBEngine::list_local_variables (const ConstVariableListSlot &a_slot,
                                  const UString &a_cookie)
@@ -5421,6 +7142,26 @@ GDBEngine::list_local_variables (const UString &a_cookie)
     list_local_variables (&null_const_variable_list_slot, a_cookie);
 }
 
+/// List the local variables and the arguments of the current frame
+/// in a single round-trip, using -stack-list-variables.  Only the
+/// values of scalar variables are reported; the value of aggregates,
+/// arrays and unions is left empty.  No variable object is created
+/// on the GDB side for the returned variables.
+/// \param a_slot the slot called with the list of locals and the
+/// list of arguments of the current frame.
+/// \param a_cookie the cookie of the command.
+void
+GDBEngine::list_frame_variables (const FrameVariablesSlot &a_slot,
+                                 const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+    Command command ("list-frame-variables",
+                     "-stack-list-variables --simple-values",
+                     a_cookie);
+    command.set_slot (a_slot);
+    queue_command (command);
+}
+
 void
 GDBEngine::list_global_variables (const UString &a_cookie)
 {
@@ -5444,6 +7185,128 @@ GDBEngine::evaluate_expression (const UString &a_expr,
     queue_command (command);
 }
 
+/// Evaluate a list of expressions in the context of the current
+/// frame.  All the expressions are sent to GDB at once, rather than
+/// one round-trip after the other, so evaluating many expressions
+/// costs about as much as evaluating a few.
+///
+/// \param a_exprs the expressions to evaluate.
+///
+/// \param a_slot the slot called once all the expressions have been
+/// evaluated.  It gets the results in the order of a_exprs.  An
+/// expression GDB could not evaluate yields a result which
+/// is_error () returns true; it is not reported through
+/// IDebugger::error_signal.
+void
+GDBEngine::evaluate_expressions (const std::list<UString> &a_exprs,
+                                 const ExpressionResultsSlot &a_slot)
+{
+    evaluate_expressions (a_exprs, 0, -1, a_slot);
+}
+
+/// Evaluate a list of expressions in the context of a given frame of
+/// a given thread, without selecting that thread or that frame.
+///
+/// \param a_exprs the expressions to evaluate.
+///
+/// \param a_thread_id the thread to evaluate the expressions in, or
+/// 0 for the current thread.
+///
+/// \param a_frame_level the level of the frame to evaluate the
+/// expressions in, in a_thread_id.  It's ignored if a_thread_id is 0.
+///
+/// \param a_slot the slot called once all the expressions have been
+/// evaluated, as with the overload above.
+void
+GDBEngine::evaluate_expressions (const std::list<UString> &a_exprs,
+                                 unsigned a_thread_id,
+                                 int a_frame_level,
+                                 const ExpressionResultsSlot &a_slot)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    UString context;
+    if (a_thread_id)
+        context = "--thread " + UString::from_int (a_thread_id)
+                  + " --frame " + UString::from_int (std::max (a_frame_level,
+                                                               0))
+                  + " ";
+
+    int batch_id = ++m_priv->last_expression_batch_id;
+    Priv::ExpressionBatch &batch = m_priv->expression_batches[batch_id];
+    batch.results.resize (a_exprs.size ());
+    batch.nb_pending = a_exprs.size ();
+    batch.slot = a_slot;
+
+    int index = 0;
+    std::list<UString>::const_iterator it;
+    for (it = a_exprs.begin (); it != a_exprs.end (); ++it, ++index) {
+        batch.results[index].expression (*it);
+        if (it->empty ()) {
+            batch.results[index].error ("empty expression");
+            --batch.nb_pending;
+            continue;
+        }
+        Command command ("evaluate-expressions",
+                         "-data-evaluate-expression " + context + *it);
+        command.tag0 (UString::from_int (batch_id));
+        command.tag2 (index);
+        command.may_be_pipelined (true);
+        queue_command (command);
+    }
+
+    if (batch.nb_pending == 0) {
+        vector<ExpressionResult> results;
+        results.swap (batch.results);
+        m_priv->expression_batches.erase (batch_id);
+        a_slot (results);
+    }
+}
+
+/// Record the result of the evaluation of one expression of a
+/// batch started by evaluate_expressions.  Once all the expressions
+/// of the batch are evaluated, the slot of the batch is called.
+///
+/// \param a_batch_id the identifier of the batch.
+///
+/// \param a_index the index of the expression in the batch.
+///
+/// \param a_value the value of the expression.
+///
+/// \param a_error the error message of GDB, if a_is_error is true.
+///
+/// \param a_is_error true if the expression could not be evaluated.
+void
+GDBEngine::record_expression_result (int a_batch_id,
+                                     int a_index,
+                                     const UString &a_value,
+                                     const UString &a_error,
+                                     bool a_is_error)
+{
+    map<int, Priv::ExpressionBatch>::iterator it =
+        m_priv->expression_batches.find (a_batch_id);
+    if (it == m_priv->expression_batches.end ())
+        return;
+    Priv::ExpressionBatch &batch = it->second;
+    THROW_IF_FAIL (a_index >= 0
+                   && (unsigned) a_index < batch.results.size ());
+
+    if (a_is_error)
+        batch.results[a_index].error (a_error);
+    else
+        batch.results[a_index].value (a_value);
+
+    THROW_IF_FAIL (batch.nb_pending > 0);
+    if (--batch.nb_pending)
+        return;
+
+    vector<ExpressionResult> results;
+    results.swap (batch.results);
+    ExpressionResultsSlot slot = batch.slot;
+    m_priv->expression_batches.erase (it);
+    slot (results);
+}
+
 void
 GDBEngine::call_function (const UString &a_expr,
                           const UString &a_cookie)
@@ -5491,6 +7354,7 @@ GDBEngine::get_variable_value (const VariableSafePtr &a_var,
                      "-data-evaluate-expression " + qname,
                      a_cookie);
     command.variable (a_var);
+    command.may_be_pipelined (true);
 
     queue_command (command);
 }
@@ -5539,6 +7403,71 @@ GDBEngine::get_variable_type (const VariableSafePtr &a_var,
     THROW_IF_FAIL (a_var);
     THROW_IF_FAIL (a_var->name () != "");
 
+    // Variable objects carry the name of their type, as reported by
+    // -var-create or -var-list-children.  Note that once the
+    // variable got its type description, its type is no longer a
+    // mere type name, hence the check for a one-liner.
+    UString type_name = a_var->type ();
+    type_name.chomp ();
+    if (type_name.find ('\n') != UString::npos
+        || type_name.find ('{') != UString::npos)
+        type_name.clear ();
+    if (!type_name.empty ()) {
+        describe_variable_type (a_var, type_name, a_cookie);
+        return;
+    }
+
+    // Otherwise, ask for the name of the type first.  That is cheap,
+    // and the description of that type might be in the cache.
+    UString qname;
+    a_var->build_qname (qname);
+    Command command ("get-variable-type-name",
+                     "whatis " + qname,
+                     a_cookie);
+    command.variable (a_var);
+    command.may_be_pipelined (true);
+
+    queue_command (command);
+}
+
+/// Set the type of a variable to the description of the type named
+/// a_type_name, from the type cache if possible, and emit
+/// IDebugger::variable_type_set_signal.  If that description is
+/// already being fetched for another variable, wait for it instead
+/// of fetching it again.
+///
+/// \param a_var the variable.
+///
+/// \param a_type_name the name of the type of a_var, or an empty
+/// string if not known.
+///
+/// \param a_cookie the cookie passed to the signal.
+void
+GDBEngine::describe_variable_type (const VariableSafePtr &a_var,
+                                   const UString &a_type_name,
+                                   const UString &a_cookie)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    if (!a_type_name.empty ()) {
+        map<UString, UString>::const_iterator it =
+            m_priv->type_cache.find (a_type_name);
+        if (it != m_priv->type_cache.end ()) {
+            LOG_DD ("type cache hit for " << a_type_name);
+            a_var->type (it->second);
+            m_priv->queue_cached_type_reply (a_var, a_cookie);
+            return;
+        }
+        map<UString, list<pair<VariableSafePtr, UString> > >::iterator w =
+            m_priv->type_waiters.find (a_type_name);
+        if (w != m_priv->type_waiters.end ()) {
+            LOG_DD ("waiting for the description of " << a_type_name);
+            w->second.push_back (make_pair (a_var, a_cookie));
+            return;
+        }
+        m_priv->type_waiters[a_type_name];
+    }
+
     UString qname;
     a_var->build_qname (qname);
     LOG_DD ("variable qname: " << qname);
@@ -5546,6 +7475,9 @@ GDBEngine::get_variable_type (const VariableSafePtr &a_var,
                      "ptype " + qname,
                      a_cookie);
     command.variable (a_var);
+    command.tag2 (m_priv->objfiles_generation);
+    command.tag3 (a_type_name);
+    command.may_be_pipelined (true);
 
     queue_command (command);
 }
@@ -6413,14 +8345,25 @@ GDBEngine::unfold_variable (VariableSafePtr a_var,
     }
     THROW_IF_FAIL (!a_var->internal_name ().empty ());
 
-    Command command ("unfold-variable",
-                     "-var-list-children "
-                     " --all-values "
-                     + a_var->internal_name (),
-                     a_cookie);
+    UString cmd_str = "-var-list-children --all-values "
+                      + a_var->internal_name ();
+    VisualizerPolicy policy = VISUALIZER_POLICY_FULL;
+    unsigned max_nb_children = 0;
+    if (a_var->is_dynamic ()
+        && get_type_visualizer_policy (a_var->type (), policy,
+                                       max_nb_children)
+        && policy == VISUALIZER_POLICY_LIMIT_CHILDREN) {
+        // Only ask the pretty printer for the first children.
+        cmd_str += UString (" 0 ") + UString::from_int (max_nb_children);
+    }
+
+    Command command ("unfold-variable", cmd_str, a_cookie);
     command.variable (a_var);
     command.set_slot (a_slot);
     command.should_emit_signal (a_should_emit_signal);
+    // Unfolding several variables in a row (e.g, when walking a
+    // variable tree) should not cost one round trip per variable.
+    command.may_be_pipelined (true);
     queue_command (command);
 }
 
@@ -6662,6 +8605,116 @@ GDBEngine::set_variable_visualizer (const VariableSafePtr a_var,
     queue_command (command);
 }
 
+/// Set the policy to apply to the pretty printing of variables which
+/// type matches a given pattern.  The policy is applied to the
+/// variables created from then on.  It takes precedence over the
+/// policies of the configuration, even after these change.
+///
+/// \param a_type_pattern a glob pattern matched against the type of
+/// variables, e.g. "std::map<*".
+///
+/// \param a_policy the policy to apply.
+///
+/// \param a_max_nb_children if a_policy is
+/// VISUALIZER_POLICY_LIMIT_CHILDREN, the maximum number of children
+/// to fetch when unfolding a variable.
+void
+GDBEngine::set_type_visualizer_policy (const UString &a_type_pattern,
+                                       VisualizerPolicy a_policy,
+                                       unsigned a_max_nb_children)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    THROW_IF_FAIL (!a_type_pattern.empty ());
+
+    vector<Priv::TypeVisualizerPolicy>::iterator it;
+    for (it = m_priv->type_visualizer_policies.begin ();
+         it != m_priv->type_visualizer_policies.end ();
+         ++it) {
+        if (it->type_pattern == a_type_pattern)
+            break;
+    }
+    if (it == m_priv->type_visualizer_policies.end ()) {
+        Priv::TypeVisualizerPolicy entry;
+        entry.type_pattern = a_type_pattern;
+        m_priv->type_visualizer_policies.push_back (entry);
+        it = m_priv->type_visualizer_policies.end () - 1;
+    }
+    it->policy = a_policy;
+    it->max_nb_children = a_max_nb_children;
+}
+
+/// Get the policy that applies to the pretty printing of variables
+/// of a given type.
+///
+/// \param a_type the type to consider.
+///
+/// \param a_policy out parameter.  The policy that applies to a_type.
+/// Set iff the function returns true.
+///
+/// \param a_max_nb_children out parameter.  The maximum number of
+/// children to fetch, if a_policy is VISUALIZER_POLICY_LIMIT_CHILDREN.
+///
+/// \return true if a policy was set for a_type, false otherwise.
+bool
+GDBEngine::get_type_visualizer_policy (const UString &a_type,
+                                       VisualizerPolicy &a_policy,
+                                       unsigned &a_max_nb_children) const
+{
+    if ((m_priv->type_visualizer_policies.empty ()
+         && m_priv->conf_type_visualizer_policies.empty ())
+        || a_type.empty ())
+        return false;
+
+    return (Priv::find_type_visualizer_policy
+                        (m_priv->type_visualizer_policies, a_type,
+                         a_policy, a_max_nb_children)
+            || Priv::find_type_visualizer_policy
+                        (m_priv->conf_type_visualizer_policies, a_type,
+                         a_policy, a_max_nb_children));
+}
+
+/// Forget the per type visualizer policies set with
+/// set_type_visualizer_policy.  Those of the configuration still
+/// apply.
+void
+GDBEngine::clear_type_visualizer_policies ()
+{
+    m_priv->type_visualizer_policies.clear ();
+}
+
+/// If the type of a freshly created variable object is to be shown
+/// raw, detach the pretty printer from it right away, before the
+/// printer gets a chance to run on its children.
+///
+/// \param a_var the variable to consider.
+void
+GDBEngine::apply_type_visualizer_policy (const VariableSafePtr a_var)
+{
+    THROW_IF_FAIL (a_var);
+
+    if (!m_priv->enable_pretty_printing
+        || !a_var->is_dynamic ()
+        || a_var->internal_name ().empty ())
+        return;
+
+    VisualizerPolicy policy = VISUALIZER_POLICY_FULL;
+    unsigned max_nb_children = 0;
+    if (!get_type_visualizer_policy (a_var->type (), policy,
+                                     max_nb_children)
+        || policy != VISUALIZER_POLICY_RAW)
+        return;
+
+    LOG_DD ("showing variable " << a_var->internal_name () << " raw");
+    set_variable_visualizer (a_var, GDB_NULL_PRETTY_PRINTING_VISUALIZER,
+                             &null_const_variable_slot);
+    a_var->is_dynamic (false);
+    // The raw structure of a variable that has a pretty printer is
+    // an aggregate.  Make sure the variable can be unfolded.
+    if (a_var->members ().empty () && !a_var->expects_children ())
+        a_var->num_expected_children (1);
+}
+
 //****************************
 //</GDBEngine methods>
 //****************************
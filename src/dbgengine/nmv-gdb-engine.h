@@ -87,6 +87,9 @@ public:
     sigc::signal<void, const IDebugger::Breakpoint&, const string&, const UString&>&
                                         breakpoint_deleted_signal () const;
 
+    sigc::signal<void, const IDebugger::Breakpoint&, const string&, const UString&>&
+                                        breakpoint_modified_signal () const;
+
     sigc::signal<void, const IDebugger::Breakpoint&, int>&
                                         breakpoint_disabled_signal () const;
 
@@ -114,6 +117,17 @@ public:
                  const Frame* const,
                  const UString&>& thread_selected_signal () const ;
 
+    sigc::signal<void,
+                 const vector<IDebugger::ThreadInfo>&,
+                 int,
+                 const UString&>& threads_info_listed_signal () const;
+
+    sigc::signal<void, int>& thread_created_signal () const;
+
+    sigc::signal<void, int>& thread_exited_signal () const;
+
+    sigc::signal<void, int, bool>& thread_state_changed_signal () const;
+
     sigc::signal<void,
                  const vector<IDebugger::Frame>&,
                  const UString&>& frames_listed_signal () const;
@@ -270,6 +284,8 @@ public:
     void run_loop_iterations (int a_nb_iters);
     void set_state (IDebugger::State a_state);
     bool stop_target () ;
+
+    bool interrupt_inferior ();
     void exit_engine ();
     void execute_command (const Command &a_command);
     bool queue_command (const Command &a_command);
@@ -331,8 +347,26 @@ public:
 
     void append_breakpoints_to_cache (map<string, IDebugger::Breakpoint>&);
 
+    void invalidate_type_cache ();
+
+    void cache_type_description (int a_objfiles_generation,
+                                 const UString &a_type_name,
+                                 const UString &a_description);
+
+    void on_type_description_failed (const UString &a_type_name);
+
     void do_continue (const UString &a_cookie);
 
+    void continue_thread (int a_thread_id, const UString &a_cookie);
+
+    void interrupt_thread (int a_thread_id, const UString &a_cookie);
+
+    bool is_non_stop_mode () const;
+
+    bool is_thread_running (int a_thread_id) const;
+
+    void set_thread_state (int a_thread_id, bool a_is_running);
+
     void run (const UString &a_cookie);
 
     void re_run (const DefaultSlot &);
@@ -386,10 +420,24 @@ public:
 			 const BreakpointsSlot &a_slot,
 			 const UString &a_cookie);
 
+    void set_breakpoint (const Loc &a_loc,
+                         const UString &a_condition,
+                         gint a_ignore_count,
+                         int a_thread_id,
+                         const BreakpointsSlot &a_slot,
+                         const UString &a_cookie);
+
+    void set_breakpoint (const UString &a_path,
+                         gint a_line_num,
+                         const UString &a_condition,
+                         gint a_ignore_count,
+                         const UString &a_cookie);
+
     void set_breakpoint (const UString &a_path,
                          gint a_line_num,
                          const UString &a_condition,
                          gint a_ignore_count,
+                         int a_thread_id,
                          const UString &a_cookie);
 
     void set_breakpoint (const UString &a_func_name,
@@ -408,6 +456,9 @@ public:
                          gint a_ignore_count,
                          const UString &a_cookie);
 
+    void set_breakpoints (const vector<Breakpoint> &a_breaks,
+                          const UString &a_cookie = "");
+
     void enable_breakpoint (const string& a_break_num,
 			    const BreakpointsSlot &a_slot,
 			    const UString &a_cookie = "");
@@ -418,6 +469,12 @@ public:
     void disable_breakpoint (const string& a_break_num,
                              const UString &a_cookie="");
 
+    void enable_breakpoints (const vector<string> &a_break_nums,
+                             const UString &a_cookie="");
+
+    void disable_breakpoints (const vector<string> &a_break_nums,
+                              const UString &a_cookie="");
+
     void set_breakpoint_ignore_count (const string& a_break_num,
                                       gint a_ignore_count,
                                       const UString &a_cookie = "");
@@ -426,6 +483,10 @@ public:
                                    const UString &a_condition,
                                    const UString &a_cookie = "");
 
+    void set_breakpoint_thread (const string &a_break_num,
+                                int a_thread_id,
+                                const UString &a_cookie = "");
+
     void enable_countpoint (const string& a_break_num,
 			    bool a_flag,
 			    const UString &a_cookie = "");
@@ -434,6 +495,10 @@ public:
 
     bool is_countpoint (const Breakpoint &a_breakpoint) const;
 
+    bool build_break_insert_command (const Breakpoint &a_breakpoint,
+                                     UString &a_cmd_name,
+                                     UString &a_cmd) const;
+
     void delete_breakpoint (const UString &a_path,
                             gint a_line_num,
                             const UString &a_cookie);
@@ -461,6 +526,33 @@ public:
 
     void list_threads (const UString &a_cookie);
 
+    void list_threads_info (const UString &a_cookie);
+
+    void list_threads_frames (const list<int> &a_thread_ids,
+                              int a_max_depth,
+                              const ThreadsFramesSlot &a_slot);
+
+    void record_thread_frames (int a_batch_id,
+                               int a_thread_id,
+                               const vector<IDebugger::Frame> &a_frames);
+
+    void sample_threads_stacks (int a_max_depth,
+                                const ThreadsFramesSlot &a_slot);
+
+    bool is_sampling_stacks () const;
+
+    bool consume_sampling_stop (const Output::OutOfBandRecord &a_record);
+
+    void cancel_stack_sampling ();
+
+    void list_sampled_threads ();
+
+    void on_sampled_threads_listed
+                        (const vector<IDebugger::ThreadInfo> &a_threads);
+
+    void on_sampled_threads_frames_listed
+                        (const map<int, vector<IDebugger::Frame> > &a_frames);
+
     void select_thread (unsigned int a_thread_id,
                         const UString &a_cookie);
 
@@ -469,6 +561,9 @@ public:
     void delete_breakpoint (const string &a_break_num,
                             const UString &a_cookie);
 
+    void delete_breakpoints (const vector<string> &a_break_nums,
+                             const UString &a_cookie);
+
     void select_frame (int a_frame_id,
                        const UString &a_cookie);
 
@@ -490,13 +585,40 @@ public:
 				const FrameArgsSlot &a_slot,
 				const UString &a_cookie);
 
+    void list_frames_arguments (int a_low_frame,
+                                int a_high_frame,
+                                PrintValues a_print_values,
+                                const FrameArgsSlot &a_slot,
+                                const UString &a_cookie);
+
+    void query_stack_depth (const StackDepthSlot &a_slot,
+                            int a_max_depth,
+                            const UString &a_cookie);
+
     void list_local_variables (const ConstVariableListSlot &a_slot,
 			       const UString &a_cookie);
 
     void list_local_variables (const UString &a_cookie);
 
+    void list_frame_variables (const FrameVariablesSlot &a_slot,
+                               const UString &a_cookie);
+
     void list_global_variables ( const UString &a_cookie );
 
+    void evaluate_expressions (const std::list<UString> &a_exprs,
+                               const ExpressionResultsSlot &a_slot);
+
+    void evaluate_expressions (const std::list<UString> &a_exprs,
+                               unsigned a_thread_id,
+                               int a_frame_level,
+                               const ExpressionResultsSlot &a_slot);
+
+    void record_expression_result (int a_batch_id,
+                                   int a_index,
+                                   const UString &a_value,
+                                   const UString &a_error,
+                                   bool a_is_error);
+
     void evaluate_expression (const UString &a_expr,
                               const UString &a_cookie);
 
@@ -518,6 +640,10 @@ public:
     void get_variable_type (const VariableSafePtr &a_var,
                             const UString &a_cookie);
 
+    void describe_variable_type (const VariableSafePtr &a_var,
+                                 const UString &a_type_name,
+                                 const UString &a_cookie);
+
     bool dereference_variable (const VariableSafePtr &a_var,
                                const UString &a_cookie);
 
@@ -532,6 +658,18 @@ public:
 				    const UString&,
 				    const ConstVariableSlot &a_slot);
 
+    void set_type_visualizer_policy (const UString &a_type_pattern,
+                                     VisualizerPolicy a_policy,
+                                     unsigned a_max_nb_children);
+
+    bool get_type_visualizer_policy (const UString &a_type,
+                                     VisualizerPolicy &a_policy,
+                                     unsigned &a_max_nb_children) const;
+
+    void clear_type_visualizer_policies ();
+
+    void apply_type_visualizer_policy (const VariableSafePtr a_var);
+
     void list_files (const UString &a_cookie);
 
     bool extract_proc_info (Output &a_output,
@@ -134,7 +134,11 @@ static const char* PREFIX_ERROR = "^error";
 static const char* PREFIX_BKPT = "bkpt={";
 static const char* PREFIX_BREAKPOINT_TABLE = "BreakpointTable={";
 static const char* PREFIX_BREAKPOINT_MODIFIED_ASYNC_OUTPUT = "=breakpoint-modified,";
+static const char* PREFIX_BREAKPOINT_CREATED_ASYNC_OUTPUT = "=breakpoint-created,";
+static const char* PREFIX_BREAKPOINT_DELETED_ASYNC_OUTPUT = "=breakpoint-deleted,";
 static const char* PREFIX_THREAD_IDS = "thread-ids={";
+static const char* PREFIX_THREADS = "threads=[";
+static const char* PREFIX_CURRENT_THREAD_ID = "current-thread-id=\"";
 static const char* PREFIX_NEW_THREAD_ID = "new-thread-id=\"";
 static const char* PREFIX_FILES = "files=[";
 static const char* PREFIX_STACK = "stack=[";
@@ -142,6 +146,7 @@ static const char* PREFIX_FRAME = "frame={";
 static const char* PREFIX_DEPTH = "depth=\"";
 static const char* PREFIX_STACK_ARGS = "stack-args=[";
 static const char* PREFIX_LOCALS = "locals=[";
+static const char* PREFIX_VARIABLES = "variables=[";
 static const char* PREFIX_VALUE = "value=\"";
 static const char* PREFIX_REGISTER_NAMES = "register-names=";
 static const char* PREFIX_CHANGED_REGISTERS = "changed-registers=";
@@ -150,6 +155,10 @@ static const char* PREFIX_MEMORY_VALUES = "addr=";
 static const char* PREFIX_RUNNING_ASYNC_OUTPUT = "*running,";
 static const char* PREFIX_STOPPED_ASYNC_OUTPUT = "*stopped,";
 static const char* PREFIX_THREAD_SELECTED_ASYNC_OUTPUT = "=thread-selected,";
+static const char* PREFIX_THREAD_CREATED_ASYNC_OUTPUT = "=thread-created,";
+static const char* PREFIX_THREAD_EXITED_ASYNC_OUTPUT = "=thread-exited,";
+static const char* PREFIX_LIBRARY_LOADED_ASYNC_OUTPUT = "=library-loaded,";
+static const char* PREFIX_LIBRARY_UNLOADED_ASYNC_OUTPUT = "=library-unloaded,";
 static const char* PREFIX_NAME = "name=\"";
 static const char* PREFIX_VARIABLE_DELETED = "ndeleted=\"";
 static const char* NDELETED = "ndeleted";
@@ -165,6 +174,84 @@ const char* PREFIX_VARIABLE_FORMAT = "format=";
 static bool grok_var_changed_list_components (GDBMIValueSafePtr a_value,
                                               list<VarChangePtr> &a_var_changes);
 
+/// Build a list of variables out of a list of tuples of the form
+/// {name="foo",type="int",value="1"}, as returned by
+/// -stack-list-locals and -stack-list-variables.
+/// \param a_tuples the list of tuples to grok.
+/// \param a_vars the resulting variables.
+/// \param a_args if non nil, variables which tuple carries the
+/// member arg="1" are appended to this list instead of a_vars.
+/// \return true upon successful completion, false otherwise.
+static bool
+grok_variable_tuples (const list<GDBMIValueSafePtr> &a_tuples,
+                      list<IDebugger::VariableSafePtr> &a_vars,
+                      list<IDebugger::VariableSafePtr> *a_args)
+{
+    std::list<GDBMIValueSafePtr>::const_iterator value_iter;
+    std::list<GDBMIResultSafePtr> tuple_content;
+    std::list<GDBMIResultSafePtr>::const_iterator tuple_iter;
+    for (value_iter = a_tuples.begin ();
+         value_iter != a_tuples.end ();
+         ++value_iter) {
+        if (!(*value_iter)) {continue;}
+        if ((*value_iter)->content_type () != GDBMIValue::TUPLE_TYPE) {
+            LOG_ERROR_D ("list of tuple should contain only tuples",
+                         GDBMI_PARSING_DOMAIN);
+            continue;
+        }
+        GDBMITupleSafePtr gdbmi_tuple = (*value_iter)->get_tuple_content ();
+        RETURN_VAL_IF_FAIL (gdbmi_tuple, false);
+        RETURN_VAL_IF_FAIL (!gdbmi_tuple->content ().empty (), false);
+
+        tuple_content.clear ();
+        tuple_content = gdbmi_tuple->content ();
+        RETURN_VAL_IF_FAIL (!tuple_content.empty (), false);
+        IDebugger::VariableSafePtr variable (new IDebugger::Variable);
+        bool is_arg = false;
+        for (tuple_iter = tuple_content.begin ();
+             tuple_iter != tuple_content.end ();
+             ++tuple_iter) {
+            if (!(*tuple_iter)) {
+                LOG_ERROR_D ("got and empty tuple member",
+                             GDBMI_PARSING_DOMAIN);
+                continue;
+            }
+
+            if (!(*tuple_iter)->value ()
+                ||(*tuple_iter)->value ()->content_type ()
+                    != GDBMIValue::STRING_TYPE) {
+                LOG_ERROR_D ("Got a tuple member which value is not a string",
+                             GDBMI_PARSING_DOMAIN);
+                continue;
+            }
+
+            UString variable_str = (*tuple_iter)->variable ();
+            UString value_str =
+                        (*tuple_iter)->value ()->get_string_content ();
+            value_str.chomp ();
+            if (variable_str == "name") {
+                variable->name (value_str);
+            } else if (variable_str == "type") {
+                variable->type (value_str);
+            } else if (variable_str == "value") {
+                variable->value (value_str);
+            } else if (variable_str == "arg" && a_args) {
+                is_arg = (value_str == "1");
+            } else {
+                LOG_ERROR_D ("got an unknown tuple member with name: '"
+                             << variable_str << "'",
+                             GDBMI_PARSING_DOMAIN);
+                continue;
+            }
+        }
+        if (is_arg)
+            a_args->push_back (variable);
+        else
+            a_vars.push_back (variable);
+    }
+    return true;
+}
+
 static bool
 is_string_start (gunichar a_c)
 {
@@ -1467,6 +1554,80 @@ GDBMIParser::parse_thread_selected_async_output (UString::size_type a_from,
     return true;
 }
 
+bool
+GDBMIParser::parse_thread_created_or_exited_async_output
+                                        (UString::size_type a_from,
+                                         UString::size_type &a_to,
+                                         bool &a_created,
+                                         int &a_thread_id)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_D (GDBMI_PARSING_DOMAIN);
+
+    UString::size_type cur = a_from;
+    if (m_priv->index_passed_end (cur)) {return false;}
+
+    bool created = false;
+    if (!RAW_INPUT.compare (cur,
+                            strlen (PREFIX_THREAD_CREATED_ASYNC_OUTPUT),
+                            PREFIX_THREAD_CREATED_ASYNC_OUTPUT)) {
+        created = true;
+        cur += strlen (PREFIX_THREAD_CREATED_ASYNC_OUTPUT);
+    } else if (!RAW_INPUT.compare (cur,
+                                   strlen (PREFIX_THREAD_EXITED_ASYNC_OUTPUT),
+                                   PREFIX_THREAD_EXITED_ASYNC_OUTPUT)) {
+        cur += strlen (PREFIX_THREAD_EXITED_ASYNC_OUTPUT);
+    } else {
+        LOG_PARSING_ERROR_MSG (cur, "was expecting : '=thread-created,' "
+                               "or '=thread-exited,'");
+        return false;
+    }
+
+    // The attributes look like id="2",group-id="i1".  Older GDBs
+    // don't quote the values though, as in id=2, so
+    // parse_attributes can't be used here.
+    int thread_id = 0;
+    while (!m_priv->index_passed_end (cur) && RAW_CHAR_AT (cur) != '\n') {
+        UString::size_type name_start = cur;
+        while (!m_priv->index_passed_end (cur)
+               && RAW_CHAR_AT (cur) != '='
+               && RAW_CHAR_AT (cur) != '\n') {
+            ++cur;
+        }
+        if (m_priv->index_passed_end (cur) || RAW_CHAR_AT (cur) != '=')
+            break;
+        string name = RAW_INPUT.substr (name_start, cur - name_start);
+        ++cur;
+        bool quoted = (!m_priv->index_passed_end (cur)
+                       && RAW_CHAR_AT (cur) == '"');
+        if (quoted)
+            ++cur;
+        UString::size_type value_start = cur;
+        while (!m_priv->index_passed_end (cur)
+               && RAW_CHAR_AT (cur) != (quoted ? '"' : ',')
+               && RAW_CHAR_AT (cur) != '\n') {
+            ++cur;
+        }
+        string value = RAW_INPUT.substr (value_start, cur - value_start);
+        if (quoted && !m_priv->index_passed_end (cur)
+            && RAW_CHAR_AT (cur) == '"')
+            ++cur;
+        if (name == "id")
+            thread_id = atoi (value.c_str ());
+        if (!m_priv->index_passed_end (cur) && RAW_CHAR_AT (cur) == ',')
+            ++cur;
+    }
+
+    if (thread_id <= 0) {
+        LOG_PARSING_ERROR_MSG (cur, "was expecting a non null thread id");
+        return false;
+    }
+
+    a_created = created;
+    a_thread_id = thread_id;
+    a_to = cur;
+    return true;
+}
+
 bool
 GDBMIParser::parse_attribute (UString::size_type a_from,
                               UString::size_type &a_to,
@@ -1539,6 +1700,45 @@ GDBMIParser::parse_attributes (UString::size_type a_from,
     return true;
 }
 
+/// Set the members of a frame from the content of the tuple of
+/// a GDB/MI frame, e.g:
+/// {level="0",addr="0x080485fa",func="func1",file="fooprog.cc",
+/// fullname="/foo/fooprog.cc",line="6"}
+static void
+set_frame_from_gdbmi_tuple (const GDBMITupleSafePtr &a_tuple,
+                            IDebugger::Frame &a_frame)
+{
+    list<GDBMIResultSafePtr>::const_iterator res_it;
+    UString name, value;
+    for (res_it = a_tuple->content ().begin ();
+         res_it != a_tuple->content ().end ();
+         ++res_it) {
+        if (!(*res_it)) {continue;}
+        if (!(*res_it)->value ()
+            || (*res_it)->value ()->content_type ()
+                != GDBMIValue::STRING_TYPE) {
+            continue;
+        }
+        name = (*res_it)->variable ();
+        value = (*res_it)->value ()->get_string_content ();
+        if (name == "level") {
+            a_frame.level (atoi (value.c_str ()));
+        } else if (name == "addr") {
+            a_frame.address (Address (value.raw ()));
+        } else if (name == "func") {
+            a_frame.function_name (value.raw ());
+        } else if (name == "file") {
+            a_frame.file_name (value);
+        } else if (name == "fullname") {
+            a_frame.file_full_name (value);
+        } else if (name == "line") {
+            a_frame.line (atoi (value.c_str ()));
+        } else if (name == "from") {
+            a_frame.library (value.raw ());
+        }
+    }
+}
+
 bool
 GDBMIParser::parse_frame (UString::size_type a_from,
                           UString::size_type &a_to,
@@ -1578,35 +1778,8 @@ GDBMIParser::parse_frame (UString::size_type a_from,
         LOG_PARSING_ERROR (cur);
         return false;
     }
-    list<GDBMIResultSafePtr>::const_iterator res_it;
-    GDBMIResultSafePtr tmp_res;
     IDebugger::Frame frame;
-    UString name, value;
-    for (res_it = result_value_tuple->content ().begin ();
-         res_it != result_value_tuple->content ().end ();
-         ++res_it) {
-        if (!(*res_it)) {continue;}
-        tmp_res = *res_it;
-        if (!tmp_res->value ()
-            ||tmp_res->value ()->content_type () != GDBMIValue::STRING_TYPE) {
-            continue;
-        }
-        name = tmp_res->variable ();
-        value = tmp_res->value ()->get_string_content ();
-        if (name == "level") {
-            frame.level (atoi (value.c_str ()));
-        } else if (name == "addr") {
-            frame.address () = value.raw ();
-        } else if (name == "func") {
-            frame.function_name (value.raw ());
-        } else if (name == "file") {
-            frame.file_name (value);
-        } else if (name == "fullname") {
-            frame.file_full_name (value);
-        } else if (name == "line") {
-            frame.line (atoi (value.c_str ()));
-        }
-    }
+    set_frame_from_gdbmi_tuple (result_value_tuple, frame);
     a_frame = frame;
     a_to = cur;
     return true;
@@ -1807,6 +1980,30 @@ GDBMIParser::parse_out_of_band_record (UString::size_type a_from,
         goto end;
     }
 
+    if (!RAW_INPUT.compare (cur,
+                            strlen (PREFIX_THREAD_CREATED_ASYNC_OUTPUT),
+                            PREFIX_THREAD_CREATED_ASYNC_OUTPUT)
+        || !RAW_INPUT.compare (cur,
+                               strlen (PREFIX_THREAD_EXITED_ASYNC_OUTPUT),
+                               PREFIX_THREAD_EXITED_ASYNC_OUTPUT)) {
+        int thread_id = 0;
+        bool created = false;
+        if (!parse_thread_created_or_exited_async_output (cur, cur,
+                                                          created,
+                                                          thread_id)) {
+            LOG_PARSING_ERROR_MSG (cur,
+                                   "could not parse the expected "
+                                   "thread created or exited async output");
+            return false;
+        }
+        record.thread_id (thread_id);
+        if (created)
+            record.thread_created (true);
+        else
+            record.thread_exited (true);
+        goto end;
+    }
+
     if (!RAW_INPUT.compare (cur,
                             strlen (PREFIX_BREAKPOINT_MODIFIED_ASYNC_OUTPUT),
                             PREFIX_BREAKPOINT_MODIFIED_ASYNC_OUTPUT)) {
@@ -1821,14 +2018,53 @@ GDBMIParser::parse_out_of_band_record (UString::size_type a_from,
         goto end;
     }
 
+    if (!RAW_INPUT.compare (cur,
+                            strlen (PREFIX_BREAKPOINT_CREATED_ASYNC_OUTPUT),
+                            PREFIX_BREAKPOINT_CREATED_ASYNC_OUTPUT)) {
+        IDebugger::Breakpoint bp;
+        if (!parse_breakpoint_created_async_output (cur, cur, bp)) {
+            LOG_PARSING_ERROR_MSG (cur,
+                                   "could not parse the expected "
+                                   "breakpoint created async output");
+            return false;
+        }
+        record.created_breakpoint (bp);
+        goto end;
+    }
+
+    if (!RAW_INPUT.compare (cur,
+                            strlen (PREFIX_BREAKPOINT_DELETED_ASYNC_OUTPUT),
+                            PREFIX_BREAKPOINT_DELETED_ASYNC_OUTPUT)) {
+        string id;
+        if (!parse_breakpoint_deleted_async_output (cur, cur, id)) {
+            LOG_PARSING_ERROR_MSG (cur,
+                                   "could not parse the expected "
+                                   "breakpoint deleted async output");
+            return false;
+        }
+        record.deleted_breakpoint_id (id);
+        goto end;
+    }
+
+    if (!RAW_INPUT.compare (cur,
+                            strlen (PREFIX_LIBRARY_LOADED_ASYNC_OUTPUT),
+                            PREFIX_LIBRARY_LOADED_ASYNC_OUTPUT)
+        || !RAW_INPUT.compare (cur,
+                               strlen (PREFIX_LIBRARY_UNLOADED_ASYNC_OUTPUT),
+                               PREFIX_LIBRARY_UNLOADED_ASYNC_OUTPUT)) {
+        // We only need to know that the set of objfiles changed, so
+        // the details of the library are skipped.
+        record.objfiles_changed (true);
+        while (!m_priv->index_passed_end (cur)
+               && RAW_CHAR_AT (cur) != '\n') {++cur;}
+        goto end;
+    }
+
     if (RAW_CHAR_AT (cur) == '=' || RAW_CHAR_AT (cur) == '*') {
-       //this is an unknown async notification sent by gdb.
-       //For now, the only one
-       //I have seen like this is of the form:
-       //'=thread-created,id=1',
-       //and the notification ends with a '\n' character.
-       //Of course it is not documented
-       //Let's ignore this by now
+       //this is an unknown async notification sent by gdb, like
+       //'=thread-group-started,id="i1",pid="4242"'.
+       //The notification ends with a '\n' character.
+       //Let's ignore it.
        while (RAW_CHAR_AT (cur) != '\n') {++cur;}
        ++cur;//consume the '\n' character
     }
@@ -1891,6 +2127,29 @@ fetch_gdbmi_result:
                 if (parse_threads_list (cur, cur, thread_ids)) {
                     result_record.thread_list (thread_ids);
                 }
+            } else if (!RAW_INPUT.compare (cur, strlen (PREFIX_THREADS),
+                                           PREFIX_THREADS)) {
+                vector<IDebugger::ThreadInfo> threads;
+                if (parse_thread_info (cur, cur, threads)) {
+                    result_record.thread_infos (threads);
+                } else {
+                    LOG_PARSING_ERROR (cur);
+                }
+            } else if (!RAW_INPUT.compare (cur,
+                                           strlen (PREFIX_CURRENT_THREAD_ID),
+                                           PREFIX_CURRENT_THREAD_ID)) {
+                GDBMIResultSafePtr result;
+                if (parse_gdbmi_result (cur, cur, result)
+                    && result
+                    && result->value ()
+                    && result->value ()->content_type ()
+                        == GDBMIValue::STRING_TYPE) {
+                    result_record.current_thread_id
+                        (atoi (result->value ()->get_string_content ()
+                               .c_str ()));
+                } else {
+                    LOG_PARSING_ERROR (cur);
+                }
             } else if (!RAW_INPUT.compare (cur,
                                            strlen (PREFIX_NEW_THREAD_ID),
                                            PREFIX_NEW_THREAD_ID)) {
@@ -1913,22 +2172,16 @@ fetch_gdbmi_result:
                        GDBMI_PARSING_DOMAIN);
             } else if (!RAW_INPUT.compare (cur, strlen (PREFIX_STACK),
                                            PREFIX_STACK)) {
-                vector<IDebugger::Frame> call_stack;
-                if (!parse_call_stack (cur, cur, call_stack)) {
+                std::shared_ptr<vector<IDebugger::Frame> > call_stack
+                    (new vector<IDebugger::Frame>);
+                if (!parse_call_stack (cur, cur, *call_stack)) {
                     LOG_PARSING_ERROR (cur);
                     return false;
                 }
                 result_record.call_stack (call_stack);
                 LOG_D ("parsed a call stack of depth: "
-                       << (int) call_stack.size (),
+                       << (int) call_stack->size (),
                        GDBMI_PARSING_DOMAIN);
-                vector<IDebugger::Frame>::iterator frame_iter;
-                for (frame_iter = call_stack.begin ();
-                     frame_iter != call_stack.end ();
-                     ++frame_iter) {
-                    LOG_D ("function-name: " << frame_iter->function_name (),
-                           GDBMI_PARSING_DOMAIN);
-                }
             } else if (!RAW_INPUT.compare (cur, strlen (PREFIX_FRAME),
                                            PREFIX_FRAME)) {
                 IDebugger::Frame frame;
@@ -1943,6 +2196,13 @@ fetch_gdbmi_result:
                 GDBMIResultSafePtr result;
                 parse_gdbmi_result (cur, cur, result);
                 THROW_IF_FAIL (result);
+                if (result->value ()
+                    && result->value ()->content_type ()
+                        == GDBMIValue::STRING_TYPE) {
+                    result_record.stack_depth
+                        (atoi (result->value ()->get_string_content ()
+                               .c_str ()));
+                }
                 LOG_D ("parsed result", GDBMI_PARSING_DOMAIN);
             } else if (!RAW_INPUT.compare (cur, strlen (PREFIX_STACK_ARGS),
                                            PREFIX_STACK_ARGS)) {
@@ -1962,6 +2222,15 @@ fetch_gdbmi_result:
                     LOG_D ("parsed local vars", GDBMI_PARSING_DOMAIN);
                     result_record.local_variables (vars);
                 }
+            } else if (!RAW_INPUT.compare (cur, strlen (PREFIX_VARIABLES),
+                                           PREFIX_VARIABLES)) {
+                list<IDebugger::VariableSafePtr> locals, args;
+                if (!parse_frame_variable_list (cur, cur, locals, args)) {
+                    LOG_PARSING_ERROR (cur);
+                } else {
+                    LOG_D ("parsed frame vars", GDBMI_PARSING_DOMAIN);
+                    result_record.frame_variables (locals, args);
+                }
             } else if (!RAW_INPUT.compare (cur, strlen (PREFIX_VALUE),
                                            PREFIX_VALUE)) {
                 // FIXME: this case will parse any response from
@@ -2368,6 +2637,9 @@ GDBMIParser::parse_breakpoint_with_one_loc (Glib::ustring::size_type a_from,
         ignore_count_present = true;
         a_bkpt.ignore_count (atoi (iter->second.c_str ()));
     }
+    if ((iter = attrs.find ("thread")) != null_iter) {
+        a_bkpt.thread_id (atoi (iter->second.c_str ()));
+    }
 
     string type = attrs["type"];
     if (type.find ("breakpoint") != type.npos)
@@ -2543,6 +2815,63 @@ GDBMIParser::parse_breakpoint_modified_async_output (UString::size_type a_from,
     return parse_breakpoint (cur, a_to, a_b);
 }
 
+bool
+GDBMIParser::parse_breakpoint_created_async_output (UString::size_type a_from,
+                                                    UString::size_type &a_to,
+                                                    IDebugger::Breakpoint &a_b)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    UString::size_type cur = a_from;
+
+    int prefix_len = strlen (PREFIX_BREAKPOINT_CREATED_ASYNC_OUTPUT);
+    if (RAW_INPUT.compare (cur, prefix_len,
+                           PREFIX_BREAKPOINT_CREATED_ASYNC_OUTPUT)) {
+        LOG_PARSING_ERROR (cur);
+        return false;
+    }
+
+    cur += prefix_len;
+    PARSING_ERROR_IF_END (cur);
+
+    return parse_breakpoint (cur, a_to, a_b);
+}
+
+bool
+GDBMIParser::parse_breakpoint_deleted_async_output (UString::size_type a_from,
+                                                    UString::size_type &a_to,
+                                                    string &a_id)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    UString::size_type cur = a_from;
+
+    int prefix_len = strlen (PREFIX_BREAKPOINT_DELETED_ASYNC_OUTPUT);
+    if (RAW_INPUT.compare (cur, prefix_len,
+                           PREFIX_BREAKPOINT_DELETED_ASYNC_OUTPUT)) {
+        LOG_PARSING_ERROR (cur);
+        return false;
+    }
+
+    cur += prefix_len;
+    PARSING_ERROR_IF_END (cur);
+
+    map<UString, UString> attrs;
+    if (!parse_attributes (cur, cur, attrs)) {
+        LOG_PARSING_ERROR (cur);
+        return false;
+    }
+    map<UString, UString>::const_iterator it = attrs.find ("id");
+    if (it == attrs.end () || it->second.empty ()) {
+        LOG_PARSING_ERROR_MSG (cur, "was expecting a breakpoint id");
+        return false;
+    }
+
+    a_id = it->second.raw ();
+    a_to = cur;
+    return true;
+}
+
 bool
 GDBMIParser::parse_threads_list (UString::size_type a_from,
                                  UString::size_type &a_to,
@@ -2658,6 +2987,114 @@ GDBMIParser::parse_threads_list (UString::size_type a_from,
     return true;
 }
 
+bool
+GDBMIParser::parse_thread_info (UString::size_type a_from,
+                                UString::size_type &a_to,
+                                vector<IDebugger::ThreadInfo> &a_threads)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_D (GDBMI_PARSING_DOMAIN);
+    UString::size_type cur = a_from;
+
+    if (RAW_INPUT.compare (cur, strlen (PREFIX_THREADS), PREFIX_THREADS)) {
+        LOG_PARSING_ERROR (cur);
+        return false;
+    }
+
+    GDBMIResultSafePtr result;
+    if (!parse_gdbmi_result (cur, cur, result)
+        || !result
+        || result->variable () != "threads"
+        || !result->value ()) {
+        LOG_PARSING_ERROR (cur);
+        return false;
+    }
+
+    vector<IDebugger::ThreadInfo> threads;
+    if (result->value ()->content_type () != GDBMIValue::LIST_TYPE
+        || !result->value ()->get_list_content ()
+        || result->value ()->get_list_content ()->empty ()) {
+        // No thread.
+        a_threads.swap (threads);
+        a_to = cur;
+        return true;
+    }
+
+    GDBMIListSafePtr thread_list = result->value ()->get_list_content ();
+    if (thread_list->content_type () != GDBMIList::VALUE_TYPE) {
+        LOG_PARSING_ERROR (cur);
+        return false;
+    }
+    list<GDBMIValueSafePtr> thread_values;
+    thread_list->get_value_content (thread_values);
+
+    list<GDBMIValueSafePtr>::const_iterator thread_it;
+    list<GDBMIResultSafePtr>::const_iterator attr_it;
+    for (thread_it = thread_values.begin ();
+         thread_it != thread_values.end ();
+         ++thread_it) {
+        if (!*thread_it
+            || (*thread_it)->content_type () != GDBMIValue::TUPLE_TYPE
+            || !(*thread_it)->get_tuple_content ()) {
+            LOG_PARSING_ERROR (cur);
+            return false;
+        }
+        // Each thread looks like:
+        // {id="2",target-id="Thread 0xb7e14b90 (LWP 21257)",
+        // name="worker",frame={level="0",addr="0xffffe410",
+        // func="__kernel_vsyscall",args=[]},state="stopped",core="1"}
+        IDebugger::ThreadInfo thread;
+        GDBMITupleSafePtr tuple = (*thread_it)->get_tuple_content ();
+        for (attr_it = tuple->content ().begin ();
+             attr_it != tuple->content ().end ();
+             ++attr_it) {
+            if (!*attr_it || !(*attr_it)->value ())
+                continue;
+            const UString &name = (*attr_it)->variable ();
+            GDBMIValueSafePtr value = (*attr_it)->value ();
+            if (name == "frame") {
+                if (value->content_type () == GDBMIValue::TUPLE_TYPE
+                    && value->get_tuple_content ()) {
+                    IDebugger::Frame frame;
+                    set_frame_from_gdbmi_tuple (value->get_tuple_content (),
+                                                frame);
+                    thread.frame (frame);
+                }
+                continue;
+            }
+            if (value->content_type () != GDBMIValue::STRING_TYPE)
+                continue;
+            const UString &str = value->get_string_content ();
+            if (name == "id") {
+                thread.id (atoi (str.c_str ()));
+            } else if (name == "target-id") {
+                thread.target_id (str.raw ());
+                // E.g "Thread 0xb7e14b90 (LWP 21257)", or
+                // "process 21257" when there is only one thread.
+                string::size_type pos = str.raw ().find ("LWP ");
+                if (pos != string::npos)
+                    thread.lwp (atoi (str.c_str () + pos + 4));
+                else if (str.raw ().compare (0, 8, "process ") == 0)
+                    thread.lwp (atoi (str.c_str () + 8));
+            } else if (name == "name") {
+                thread.name (str.raw ());
+            } else if (name == "state") {
+                thread.is_running (str == "running");
+            } else if (name == "core") {
+                thread.core (atoi (str.c_str ()));
+            }
+        }
+        if (thread.id () <= 0) {
+            LOG_ERROR ("got a thread with no id");
+            return false;
+        }
+        threads.push_back (thread);
+    }
+
+    a_threads.swap (threads);
+    a_to = cur;
+    return true;
+}
+
 bool
 GDBMIParser::parse_new_thread_id (UString::size_type a_from,
                                   UString::size_type &a_to,
@@ -2838,6 +3275,7 @@ GDBMIParser::parse_call_stack (const UString::size_type a_from,
 
     GDBMITupleSafePtr frame_tuple;
     vector<IDebugger::Frame> stack;
+    stack.reserve (result_list.size ());
     list<GDBMIResultSafePtr>::const_iterator iter, frame_part_iter;
     UString value;
     for (iter = result_list.begin (); iter != result_list.end (); ++iter) {
@@ -2855,7 +3293,7 @@ GDBMIParser::parse_call_stack (const UString::size_type a_from,
             THROW_IF_FAIL ((*frame_part_iter)->value ());
             value = (*frame_part_iter)->value ()->get_string_content ();
             if ((*frame_part_iter)->variable () == "addr") {
-                frame.address () = value.raw ();
+                frame.address (Address (value.raw ()));
             } else if ((*frame_part_iter)->variable () == "func") {
                 frame.function_name (value.raw ());
             } else if ((*frame_part_iter)->variable () == "file") {
@@ -2874,7 +3312,7 @@ GDBMIParser::parse_call_stack (const UString::size_type a_from,
         stack.push_back (frame);
         frame.clear ();
     }
-    a_stack = stack;
+    a_stack.swap (stack);
     a_to = cur;
     return true;
 }
@@ -2924,68 +3362,70 @@ GDBMIParser::parse_local_var_list (UString::size_type a_from,
     RETURN_VAL_IF_FAIL (!gdbmi_value_list.empty (), false);
 
     std::list<IDebugger::VariableSafePtr> variables;
-    std::list<GDBMIValueSafePtr>::const_iterator value_iter;
-    std::list<GDBMIResultSafePtr> tuple_content;
-    std::list<GDBMIResultSafePtr>::const_iterator tuple_iter;
-    for (value_iter = gdbmi_value_list.begin ();
-         value_iter != gdbmi_value_list.end ();
-         ++value_iter) {
-        if (!(*value_iter)) {continue;}
-        if ((*value_iter)->content_type () != GDBMIValue::TUPLE_TYPE) {
-            LOG_ERROR_D ("list of tuple should contain only tuples",
-                         GDBMI_PARSING_DOMAIN);
-            continue;
-        }
-        GDBMITupleSafePtr gdbmi_tuple = (*value_iter)->get_tuple_content ();
-        RETURN_VAL_IF_FAIL (gdbmi_tuple, false);
-        RETURN_VAL_IF_FAIL (!gdbmi_tuple->content ().empty (), false);
+    if (!grok_variable_tuples (gdbmi_value_list, variables, 0))
+        return false;
+    LOG_D ("got '" << (int)variables.size () << "' variables",
+           GDBMI_PARSING_DOMAIN);
 
-        tuple_content.clear ();
-        tuple_content = gdbmi_tuple->content ();
-        RETURN_VAL_IF_FAIL (!tuple_content.empty (), false);
-        IDebugger::VariableSafePtr variable (new IDebugger::Variable);
-        for (tuple_iter = tuple_content.begin ();
-             tuple_iter != tuple_content.end ();
-             ++tuple_iter) {
-            if (!(*tuple_iter)) {
-                LOG_ERROR_D ("got and empty tuple member",
-                             GDBMI_PARSING_DOMAIN);
-                continue;
-            }
+    a_vars = variables;
+    a_to = cur;
+    return true;
+}
 
-            if (!(*tuple_iter)->value ()
-                ||(*tuple_iter)->value ()->content_type ()
-                    != GDBMIValue::STRING_TYPE) {
-                LOG_ERROR_D ("Got a tuple member which value is not a string",
-                             GDBMI_PARSING_DOMAIN);
-                continue;
-            }
+bool
+GDBMIParser::parse_frame_variable_list
+                            (UString::size_type a_from,
+                             UString::size_type &a_to,
+                             list<IDebugger::VariableSafePtr> &a_locals,
+                             list<IDebugger::VariableSafePtr> &a_args)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_D (GDBMI_PARSING_DOMAIN);
+    UString::size_type cur = a_from;
+    CHECK_END (cur);
 
-            UString variable_str = (*tuple_iter)->variable ();
-            UString value_str =
-                        (*tuple_iter)->value ()->get_string_content ();
-            value_str.chomp ();
-            if (variable_str == "name") {
-                variable->name (value_str);
-            } else if (variable_str == "type") {
-                variable->type (value_str);
-            } else if (variable_str == "value") {
-                variable->value (value_str);
-            } else {
-                LOG_ERROR_D ("got an unknown tuple member with name: '"
-                             << variable_str << "'",
-                             GDBMI_PARSING_DOMAIN);
-                continue;
-            }
+    if (RAW_INPUT.compare (cur, strlen (PREFIX_VARIABLES),
+                           PREFIX_VARIABLES)) {
+        LOG_PARSING_ERROR (cur);
+        return false;
+    }
 
-        }
-        variables.push_back (variable);
+    GDBMIResultSafePtr gdbmi_result;
+    if (!parse_gdbmi_result (cur, cur, gdbmi_result)) {
+        LOG_PARSING_ERROR (cur);
+        return false;
     }
+    THROW_IF_FAIL (gdbmi_result
+                   && gdbmi_result->variable () == "variables");
 
-    LOG_D ("got '" << (int)variables.size () << "' variables",
+    if (!gdbmi_result->value ()
+        || gdbmi_result->value ()->content_type ()
+            != GDBMIValue::LIST_TYPE) {
+        LOG_PARSING_ERROR (cur);
+        return false;
+    }
+
+    a_locals.clear ();
+    a_args.clear ();
+    GDBMIListSafePtr gdbmi_list =
+        gdbmi_result->value ()->get_list_content ();
+    if (!gdbmi_list
+        || gdbmi_list->content_type () == GDBMIList::UNDEFINED_TYPE) {
+        a_to = cur;
+        return true;
+    }
+    RETURN_VAL_IF_FAIL (gdbmi_list->content_type () == GDBMIList::VALUE_TYPE,
+                        false);
+
+    std::list<GDBMIValueSafePtr> gdbmi_value_list;
+    gdbmi_list->get_value_content (gdbmi_value_list);
+    RETURN_VAL_IF_FAIL (!gdbmi_value_list.empty (), false);
+
+    if (!grok_variable_tuples (gdbmi_value_list, a_locals, &a_args))
+        return false;
+    LOG_D ("got '" << (int) a_locals.size () << "' locals and '"
+           << (int) a_args.size () << "' arguments",
            GDBMI_PARSING_DOMAIN);
 
-    a_vars = variables;
     a_to = cur;
     return true;
 }
@@ -3129,6 +3569,13 @@ GDBMIParser::parse_stack_arguments (UString::size_type a_from,
                                 THROW_IF_FAIL ((*arg_iter)->value ());
                                 parameter->name
                                 ((*arg_iter)->value()->get_string_content ());
+                            } else if ((*arg_iter)->variable () == "type") {
+                                // Reported by --simple-values, for
+                                // the aggregates which value is left
+                                // out.
+                                THROW_IF_FAIL ((*arg_iter)->value ());
+                                parameter->type
+                                ((*arg_iter)->value()->get_string_content ());
                             } else if ((*arg_iter)->variable () == "value") {
                                 THROW_IF_FAIL ((*arg_iter)->value ());
                                 parameter->value
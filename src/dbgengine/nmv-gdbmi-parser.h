@@ -469,6 +469,20 @@ public:
                                              UString::size_type &a_to,
                                              int &a_thread_id);
 
+    /// parse GDBMI async output that says that a thread got
+    /// created or exited in the inferior.
+    /// the string looks like:
+    /// =thread-created,id="<thread-id>",group-id="<group-id>"
+    /// or:
+    /// =thread-exited,id="<thread-id>",group-id="<group-id>"
+    /// \param a_created out parameter. Set to true if the thread got
+    /// created, false if it exited.
+    bool parse_thread_created_or_exited_async_output
+                                            (UString::size_type a_from,
+                                             UString::size_type &a_to,
+                                             bool &a_created,
+                                             int &a_thread_id);
+
     bool parse_attribute (UString::size_type a_from,
                           UString::size_type &a_to,
                           UString &a_name,
@@ -540,12 +554,35 @@ public:
                                                  UString::size_type &a_to,
                                                  IDebugger::Breakpoint &a_b);
 
+    /// Parse a GDB/MI async output that says that a breakpoint was
+    /// created by something else than a GDB/MI command, e.g
+    /// =breakpoint-created,bkpt={number="3",...}.
+    bool parse_breakpoint_created_async_output (UString::size_type a_from,
+                                                UString::size_type &a_to,
+                                                IDebugger::Breakpoint &a_b);
+
+    /// Parse a GDB/MI async output that says that a breakpoint was
+    /// deleted by something else than a GDB/MI command, e.g
+    /// =breakpoint-deleted,id="3".
+    bool parse_breakpoint_deleted_async_output (UString::size_type a_from,
+                                                UString::size_type &a_to,
+                                                string &a_id);
+
     /// parses the result of the gdbmi command
     /// "-thread-list-ids".
     bool parse_threads_list (UString::size_type a_from,
                              UString::size_type &a_to,
                              std::list<int> &a_thread_ids);
 
+    /// parses the list of threads of the result of the gdbmi
+    /// command "-thread-info", that looks like:
+    /// threads=[{id="1",target-id="Thread 0xb7e156b0 (LWP 21254)",
+    /// frame={level="0",addr="0x0804891f",func="foo",args=[],
+    /// file="foo.c",fullname="/tmp/foo.c",line="10"},state="stopped"}]
+    bool parse_thread_info (UString::size_type a_from,
+                            UString::size_type &a_to,
+                            vector<IDebugger::ThreadInfo> &a_threads);
+
     /// parses the result of the gdbmi command
     /// "-thread-select"
     /// \param a_input the input string to parse
@@ -588,6 +625,14 @@ public:
                                UString::size_type &a_to,
                                list<IDebugger::VariableSafePtr> &a_vars);
 
+    /// parse the locals and the arguments of a frame as returned by
+    /// the GDBMI command -stack-list-variables --simple-values
+    bool parse_frame_variable_list
+                        (UString::size_type a_from,
+                         UString::size_type &a_to,
+                         list<IDebugger::VariableSafePtr> &a_locals,
+                         list<IDebugger::VariableSafePtr> &a_args);
+
     bool parse_member_variable (const UString::size_type a_from,
                                 UString::size_type &a_to,
                                 IDebugger::VariableSafePtr &a_var,
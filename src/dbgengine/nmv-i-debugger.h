@@ -27,10 +27,12 @@
 #define __NMV_I_DEBUGGER_H__
 
 #include <stdint.h>
+#include <cstdio>
 #include <vector>
 #include <string>
 #include <map>
 #include <list>
+#include <memory>
 #include "common/nmv-api-macros.h"
 #include "common/nmv-ustring.h"
 #include "common/nmv-dynamic-module.h"
@@ -39,6 +41,8 @@
 #include "common/nmv-asm-instr.h"
 #include "common/nmv-loc.h"
 #include "common/nmv-str-utils.h"
+#include "common/nmv-string-pool.h"
+#include "common/nmv-exception.h"
 #include "nmv-i-conf-mgr.h"
 
 using nemiver::common::SafePtr;
@@ -55,6 +59,7 @@ using nemiver::common::MixedAsmInstr;
 using nemiver::common::Asm;
 using nemiver::common::DisassembleInfo;
 using nemiver::common::Loc;
+using nemiver::common::StringPool;
 using std::vector;
 using std::string;
 using std::map;
@@ -131,6 +136,9 @@ public:
         int m_parent_breakpoint_number;
         // Whether the breakpoint is pending.
         bool m_is_pending;
+        // The id of the only thread the breakpoint stops, or 0 if
+        // it stops any thread.
+        int m_thread_id;
 
     public:
         Breakpoint () {clear ();}
@@ -246,6 +254,13 @@ public:
         bool is_pending () const {return m_is_pending;}
         void is_pending (bool a) {m_is_pending = a;}
 
+        /// The id of the only thread this breakpoint stops, or 0 if
+        /// the breakpoint stops any thread.
+        int thread_id () const {return m_thread_id;}
+        void thread_id (int a) {m_thread_id = a;}
+
+        bool is_thread_specific () const {return m_thread_id > 0;}
+
         /// Test whether this breakpoint has multiple location.
         ///
         /// Each location is then represented by a sub-breakpoint,
@@ -294,6 +309,7 @@ public:
             m_sub_breakpoints.clear ();
             m_parent_breakpoint_number = 0;
             m_is_pending = false;
+            m_thread_id = 0;
         }
     };//end class Breakpoint
 
@@ -368,36 +384,76 @@ public:
     typedef SafePtr<Variable, ObjectRef, ObjectUnref> VariableSafePtr;
     typedef list<VariableSafePtr> VariableList;
 
+    /// \brief The name/value pairs of the arguments of a set of
+    /// frames, stored back to back.  A Frame refers to its slice of
+    /// such a vector, which is shared by all the frames of a listing.
+    typedef vector<std::pair<string, string> > FrameArgVector;
+    typedef std::shared_ptr<const FrameArgVector> FrameArgVectorSafePtr;
+
     /// \brief a function frame as seen by the debugger.
+    ///
+    /// A deep call stack can hold tens of thousands of frames, so this
+    /// is kept small and cheap to copy: the program counter is stored
+    /// as a number, the function, file and library names are ids into
+    /// StringPool::default_pool, and the arguments live in a vector
+    /// shared by all the frames of a listing.
     class Frame {
-        Address m_address;
-        string m_function_name;
-        map<string, string> m_args;
+        size_t m_pc;
+        // Number of hexadecimal digits the address was written with,
+        // so that address () gives back the very string GDB
+        // reported.  Zero means the frame has no address.
+        unsigned char m_pc_width;
+        // Whether the address was prefixed with "0x".
+        bool m_pc_prefixed;
         int m_level;
+        int m_line;
+        StringPool::Id m_function_name;
         //present if the target has debugging info
-        UString m_file_name;
+        StringPool::Id m_file_name;
         //present if the target has sufficient debugging info
-        UString m_file_full_name;
-        int m_line;
+        StringPool::Id m_file_full_name;
         //present if the target doesn't have debugging info
-        string m_library;
+        StringPool::Id m_library;
+        FrameArgVectorSafePtr m_args;
+        unsigned m_first_arg;
+        unsigned m_nb_args;
+
+        static const UString& pooled (StringPool::Id a_id)
+        {
+            return StringPool::default_pool ().get (a_id);
+        }
+
+        static StringPool::Id intern (const string &a_str)
+        {
+            return StringPool::default_pool ().intern (a_str);
+        }
+
     public:
 
         Frame () :
-        m_level (0),
-            m_line (0)
-            {
-            }
+            m_pc (0),
+            m_pc_width (0),
+            m_pc_prefixed (false),
+            m_level (0),
+            m_line (0),
+            m_function_name (0),
+            m_file_name (0),
+            m_file_full_name (0),
+            m_library (0),
+            m_first_arg (0),
+            m_nb_args (0)
+        {
+        }
 
         /// \operators
         /// @{
 
         bool operator== (const Frame &a) const
         {
-            return (level () == a.level ()
-                    && function_name () == a.function_name ()
-                    && file_name () == a.file_name ()
-                    && library () == a.library ());
+            return (m_level == a.m_level
+                    && m_function_name == a.m_function_name
+                    && m_file_name == a.m_file_name
+                    && m_library == a.m_library);
         }
 
         bool operator!= (const Frame &a) const {return !(operator== (a));}
@@ -406,60 +462,179 @@ public:
         /// \name accessors
 
         /// @{
-        const Address& address () const {return m_address;}
-        Address& address () {return m_address;}
-        void address (const Address &a_in) {m_address = a_in;}
-        bool has_empty_address () const
+        Address address () const
+        {
+            if (!m_pc_width)
+                return Address ();
+            char str[64];
+            snprintf (str, sizeof (str),
+                      m_pc_prefixed ? "0x%0*zx" : "%0*zx",
+                      (int) m_pc_width, m_pc);
+            return Address (str);
+        }
+        void address (const Address &a_in)
+        {
+            const string &str = a_in.to_string ();
+            m_pc = a_in;
+            m_pc_prefixed = str.size () > 2 && str[0] == '0' && str[1] == 'x';
+            m_pc_width = a_in.size ();
+        }
+        bool has_empty_address () const {return !m_pc_width;}
+
+        /// \return the program counter of the frame as a number.
+        size_t pc () const {return m_pc;}
+
+        const string& function_name () const
+        {
+            return pooled (m_function_name).raw ();
+        }
+        void function_name (const string &a_in)
         {
-            return m_address.to_string ().empty ();
+            m_function_name = intern (a_in);
         }
+        StringPool::Id function_name_id () const {return m_function_name;}
 
-        const string& function_name () const {return m_function_name;}
-        void function_name (const string &a_in) {m_function_name = a_in;}
+        /// \return the number of arguments of the frame.
+        unsigned nb_args () const {return m_nb_args;}
 
-        const map<string, string>& args () const {return m_args;}
-        map<string, string>& args () {return m_args;}
+        const string& arg_name (unsigned a_index) const
+        {
+            THROW_IF_FAIL (m_args && a_index < m_nb_args);
+            return (*m_args)[m_first_arg + a_index].first;
+        }
+
+        const string& arg_value (unsigned a_index) const
+        {
+            THROW_IF_FAIL (m_args && a_index < m_nb_args);
+            return (*m_args)[m_first_arg + a_index].second;
+        }
+
+        /// Make the arguments of the frame be the a_nb elements of
+        /// a_args starting at a_first.
+        void args (const FrameArgVectorSafePtr &a_args,
+                   unsigned a_first,
+                   unsigned a_nb)
+        {
+            THROW_IF_FAIL (!a_nb
+                           || (a_args && a_first + a_nb <= a_args->size ()));
+            m_args = a_args;
+            m_first_arg = a_first;
+            m_nb_args = a_nb;
+        }
 
         int level () const {return m_level;}
         void level (int a_level) {m_level = a_level;}
 
-        const UString& file_name () const {return m_file_name;}
-        void file_name (const UString &a_in) {m_file_name = a_in;}
+        const UString& file_name () const {return pooled (m_file_name);}
+        void file_name (const UString &a_in) {m_file_name = intern (a_in.raw ());}
+        StringPool::Id file_name_id () const {return m_file_name;}
 
-        const UString& file_full_name () const {return m_file_full_name;}
-        void file_full_name (const UString &a_in) {m_file_full_name = a_in;}
+        const UString& file_full_name () const
+        {
+            return pooled (m_file_full_name);
+        }
+        void file_full_name (const UString &a_in)
+        {
+            m_file_full_name = intern (a_in.raw ());
+        }
+        StringPool::Id file_full_name_id () const {return m_file_full_name;}
 
         int line () const {return m_line;}
         void line (int a_in) {m_line = a_in;}
 
-        const string& library () const {return m_library;}
-        void library (const string &a_library) {m_library = a_library;}
+        const string& library () const {return pooled (m_library).raw ();}
+        void library (const string &a_library)
+        {
+            m_library = intern (a_library);
+        }
 
         /// @}
 
         /// \brief clears the current instance
         void clear ()
         {
-            m_address = "";
-            m_function_name = "";
-            m_args.clear ();
-            m_level = 0;
-            m_file_name = "";
-            m_file_full_name = "";
-            m_line = 0;
-            m_library.clear ();
-            m_args.clear ();
+            *this = Frame ();
         }
     };//end class Frame
 
+    /// \brief A thread of the inferior, as reported by -thread-info.
+    class ThreadInfo {
+        int m_id;
+        string m_target_id;
+        int m_lwp;
+        string m_name;
+        bool m_is_running;
+        int m_core;
+        bool m_has_frame;
+        Frame m_frame;
+
+    public:
+        ThreadInfo () :
+            m_id (0),
+            m_lwp (0),
+            m_is_running (false),
+            m_core (-1),
+            m_has_frame (false)
+        {
+        }
+
+        /// \name accessors
+        /// @{
+
+        /// The id of the thread, as used by the debugger commands.
+        int id () const {return m_id;}
+        void id (int a_in) {m_id = a_in;}
+
+        /// The id of the thread for the target system, e.g
+        /// "Thread 0xb7e14b90 (LWP 21257)".
+        const string& target_id () const {return m_target_id;}
+        void target_id (const string &a_in) {m_target_id = a_in;}
+
+        /// The id of the thread for the kernel, e.g 21257 for the
+        /// target id above, or 0 if the target id doesn't tell it.
+        int lwp () const {return m_lwp;}
+        void lwp (int a_in) {m_lwp = a_in;}
+
+        /// The name of the thread, if the target gave it one.
+        const string& name () const {return m_name;}
+        void name (const string &a_in) {m_name = a_in;}
+
+        bool is_running () const {return m_is_running;}
+        void is_running (bool a_in) {m_is_running = a_in;}
+
+        /// The processor core the thread was last seen on, or -1.
+        int core () const {return m_core;}
+        void core (int a_in) {m_core = a_in;}
+
+        /// The frame the thread is stopped in.  Meaningful only if
+        /// has_frame () is true, which is never the case while the
+        /// thread is running.
+        bool has_frame () const {return m_has_frame;}
+        const Frame& frame () const {return m_frame;}
+        void frame (const Frame &a_in)
+        {
+            m_frame = a_in;
+            m_has_frame = true;
+        }
+
+        /// @}
+    };//end class ThreadInfo
+
     typedef sigc::slot<void> DefaultSlot;
     typedef sigc::slot<void, const vector<IDebugger::Frame>&>
         FrameVectorSlot;
+    /// The frames of a set of threads, keyed by thread id.
+    typedef sigc::slot<void, const map<int, vector<IDebugger::Frame> >&>
+        ThreadsFramesSlot;
     typedef sigc::slot<void, const map<int, IDebugger::VariableList>& >
         FrameArgsSlot;
+    typedef sigc::slot<void, int> StackDepthSlot;
 
     typedef sigc::slot<void, const VariableSafePtr> ConstVariableSlot;
     typedef sigc::slot<void, const VariableList&> ConstVariableListSlot;
+    typedef sigc::slot<void,
+                       const VariableList& /*locals*/,
+                       const VariableList& /*arguments*/> FrameVariablesSlot;
     typedef sigc::slot<void, const UString&> ConstUStringSlot;
 
     class Variable : public Object {
@@ -1088,6 +1263,68 @@ public:
         return false;
     }
 
+    /// How much of the values of variables a listing command
+    /// reports.  See IDebugger::list_frames_arguments.
+    enum PrintValues {
+        /// Only the names of the variables.
+        PRINT_NO_VALUES = 0,
+        /// The names and the full values of the variables.
+        PRINT_ALL_VALUES,
+        /// The names of the variables, the values of the scalar ones
+        /// and the types of the aggregates, arrays and unions.
+        PRINT_SIMPLE_VALUES
+    };
+
+    /// How the pretty printing system is applied to the variables of
+    /// a given type.  See IDebugger::set_type_visualizer_policy.
+    enum VisualizerPolicy {
+        /// Use the pretty printer of the type, if any.
+        VISUALIZER_POLICY_FULL = 0,
+        /// Show the raw structure of the variables, without running
+        /// any pretty printer.
+        VISUALIZER_POLICY_RAW,
+        /// Use the pretty printer of the type, but only fetch a
+        /// bounded number of children.
+        VISUALIZER_POLICY_LIMIT_CHILDREN
+    };
+
+    /// The outcome of the evaluation of one expression by
+    /// IDebugger::evaluate_expressions.
+    class ExpressionResult {
+        UString m_expression;
+        UString m_value;
+        UString m_error;
+        bool m_is_error;
+
+    public:
+        ExpressionResult () :
+            m_is_error (false)
+        {}
+
+        /// The expression that was evaluated.
+        const UString& expression () const {return m_expression;}
+        void expression (const UString &a_in) {m_expression = a_in;}
+
+        /// The value of the expression.  Meaningful only if
+        /// is_error () is false.
+        const UString& value () const {return m_value;}
+        void value (const UString &a_in) {m_value = a_in;}
+
+        /// The error message of the debugger, if the expression could
+        /// not be evaluated.
+        const UString& error () const {return m_error;}
+        void error (const UString &a_in)
+        {
+            m_error = a_in;
+            m_is_error = true;
+        }
+
+        bool is_error () const {return m_is_error;}
+    };//end class ExpressionResult
+
+    typedef sigc::slot<void, const vector<ExpressionResult>&>
+                                                    ExpressionResultsSlot;
+
     typedef sigc::slot<void,
                        const std::map<string, IDebugger::Breakpoint>&>
         BreakpointsSlot;
@@ -1131,6 +1368,17 @@ public:
                         const UString & /*cookie*/>&
                                      breakpoint_deleted_signal () const=0;
 
+    /// Emitted when a breakpoint that is already set changes, e.g
+    /// when it is enabled, disabled or hit, or when its condition
+    /// or ignore count changes.  Listeners are expected to update
+    /// that breakpoint only, rather than to list the breakpoints
+    /// again.
+    virtual sigc::signal<void,
+                        const IDebugger::Breakpoint&,
+                        const string& /*breakpoint number*/,
+                        const UString & /*cookie*/>&
+                                     breakpoint_modified_signal () const=0;
+
     /// returns a list of breakpoints set. It is not all the breakpoints
     /// set. Some of the breakpoints in the list can have been
     /// already returned in a previous call. This is done so because
@@ -1172,6 +1420,30 @@ public:
                          const UString& /*cookie*/> &
                                              thread_selected_signal () const=0;
 
+    /// Emitted when the threads of the inferior have been listed
+    /// by IDebugger::list_threads_info.
+    virtual sigc::signal<void,
+                         const vector<IDebugger::ThreadInfo>&/*threads*/,
+                         int /*current thread id*/,
+                         const UString& /*cookie*/>&
+                                    threads_info_listed_signal () const=0;
+
+    /// Emitted when a thread is created in the inferior.
+    virtual sigc::signal<void, int/*thread id*/>&
+                                    thread_created_signal () const=0;
+
+    /// Emitted when a thread of the inferior exits.
+    virtual sigc::signal<void, int/*thread id*/>&
+                                    thread_exited_signal () const=0;
+
+    /// Emitted when a thread resumes or stops.  A thread id of -1
+    /// means all the threads.  Outside of non-stop mode, all the
+    /// threads resume and stop together.
+    virtual sigc::signal<void,
+                         int/*thread id*/,
+                         bool/*is running*/>&
+                                    thread_state_changed_signal () const=0;
+
     virtual sigc::signal<void,
                         const vector<IDebugger::Frame>&,
                         const UString&>& frames_listed_signal () const=0;
@@ -1402,6 +1674,16 @@ public:
 
     virtual void do_continue (const UString &a_cookie="") = 0;
 
+    virtual void continue_thread (int a_thread_id,
+                                  const UString &a_cookie="") = 0;
+
+    virtual void interrupt_thread (int a_thread_id,
+                                   const UString &a_cookie="") = 0;
+
+    virtual bool is_non_stop_mode () const = 0;
+
+    virtual bool is_thread_running (int a_thread_id) const = 0;
+
     virtual void run (const UString &a_cookie="") = 0;
 
     virtual void re_run (const DefaultSlot &) = 0;
@@ -1437,12 +1719,26 @@ public:
                                  const BreakpointsSlot &a_slot,
                                  const UString &a_cookie = "") = 0;
 
+    virtual void set_breakpoint (const common::Loc &a_loc,
+                                 const UString &a_condition,
+                                 gint a_ignore_count,
+                                 int a_thread_id,
+                                 const BreakpointsSlot &a_slot,
+                                 const UString &a_cookie = "") = 0;
+
     virtual void set_breakpoint (const UString &a_path,
                                  gint a_line_num,
                                  const UString &a_condition= "",
                                  gint a_ignore_count = 0,
                                  const UString &a_cookie = "") = 0;
 
+    virtual void set_breakpoint (const UString &a_path,
+                                 gint a_line_num,
+                                 const UString &a_condition,
+                                 gint a_ignore_count,
+                                 int a_thread_id,
+                                 const UString &a_cookie) = 0;
+
     virtual void set_breakpoint (const UString &a_func_name,
                                  const UString &a_condition = "",
                                  gint a_ignore_count = 0,
@@ -1459,6 +1755,14 @@ public:
                                  gint a_ignore_count = 0,
                                  const UString &a_cookie = "") = 0;
 
+    /// Set several breakpoints at once, e.g. the breakpoints of a
+    /// session.  The breakpoints are set with their condition, their
+    /// initial ignore count, their thread and their enabled state,
+    /// without waiting for each of them to be set before setting the
+    /// next one.
+    virtual void set_breakpoints (const vector<Breakpoint> &a_breaks,
+                                  const UString &a_cookie = "") = 0;
+
     virtual void enable_breakpoint (const string& a_break_num,
                                     const BreakpointsSlot &a_slot,
                                     const UString &a_cookie="") = 0;
@@ -1469,6 +1773,14 @@ public:
     virtual void disable_breakpoint (const string& a_break_num,
                                      const UString &a_cookie="") = 0;
 
+    /// Enable several breakpoints with as few commands as possible.
+    virtual void enable_breakpoints (const vector<string> &a_break_nums,
+                                     const UString &a_cookie="") = 0;
+
+    /// Disable several breakpoints with as few commands as possible.
+    virtual void disable_breakpoints (const vector<string> &a_break_nums,
+                                      const UString &a_cookie="") = 0;
+
     virtual void set_breakpoint_ignore_count
                                         (const string& a_break_num,
                                          gint a_ignore_count,
@@ -1478,6 +1790,10 @@ public:
                                            const UString &a_condition,
                                            const UString &a_cookie = "") = 0;
 
+    virtual void set_breakpoint_thread (const string &a_break_num,
+                                        int a_thread_id,
+                                        const UString &a_cookie = "") = 0;
+
     virtual void enable_countpoint (const string& a_break_num,
                                     bool a_flag,
                                     const UString &a_cookie ="") = 0;
@@ -1515,8 +1831,21 @@ public:
     virtual void delete_breakpoint (const string &a_break_num,
                                     const UString &a_cookie="") = 0;
 
+    /// Delete several breakpoints with as few commands as possible.
+    virtual void delete_breakpoints (const vector<string> &a_break_nums,
+                                     const UString &a_cookie="") = 0;
+
     virtual void list_threads (const UString &a_cookie="") = 0;
 
+    virtual void list_threads_info (const UString &a_cookie="") = 0;
+
+    virtual void list_threads_frames (const list<int> &a_thread_ids,
+                                      int a_max_depth,
+                                      const ThreadsFramesSlot &a_slot) = 0;
+
+    virtual void sample_threads_stacks (int a_max_depth,
+                                        const ThreadsFramesSlot &a_slot) = 0;
+
     virtual void select_thread (unsigned int a_thread_id,
                                 const UString &a_cookie="") = 0;
 
@@ -1543,16 +1872,37 @@ public:
                                         const FrameArgsSlot &a_slot,
                                         const UString &a_cookie) = 0;
 
+    virtual void list_frames_arguments (int a_low_frame,
+                                        int a_high_frame,
+                                        PrintValues a_print_values,
+                                        const FrameArgsSlot &a_slot,
+                                        const UString &a_cookie="") = 0;
+
+    virtual void query_stack_depth (const StackDepthSlot &a_slot,
+                                    int a_max_depth = -1,
+                                    const UString &a_cookie="") = 0;
+
     virtual void list_local_variables (const ConstVariableListSlot &a_slot,
                                        const UString &a_cookie="") = 0;
 
     virtual void list_local_variables (const UString &a_cookie="") = 0;
 
+    virtual void list_frame_variables (const FrameVariablesSlot &a_slot,
+                                       const UString &a_cookie="") = 0;
+
     virtual void list_global_variables (const UString &a_cookie="") = 0;
 
     virtual void evaluate_expression (const UString &a_expr,
                                       const UString &a_cookie="") = 0;
 
+    virtual void evaluate_expressions (const std::list<UString> &a_exprs,
+                                       const ExpressionResultsSlot &a_slot) = 0;
+
+    virtual void evaluate_expressions (const std::list<UString> &a_exprs,
+                                       unsigned a_thread_id,
+                                       int a_frame_level,
+                                       const ExpressionResultsSlot &a_slot) = 0;
+
     virtual void call_function (const UString &a_call_expression,
                                 const UString &a_cookie="") = 0;
 
@@ -1577,6 +1927,18 @@ public:
     virtual void revisualize_variable (const VariableSafePtr a_var,
                                        const ConstVariableSlot &a_slot) = 0;
 
+    virtual void set_type_visualizer_policy
+                                (const UString &a_type_pattern,
+                                 VisualizerPolicy a_policy,
+                                 unsigned a_max_nb_children = 0) = 0;
+
+    virtual bool get_type_visualizer_policy
+                                (const UString &a_type,
+                                 VisualizerPolicy &a_policy,
+                                 unsigned &a_max_nb_children) const = 0;
+
+    virtual void clear_type_visualizer_policies () = 0;
+
     virtual void list_files (const UString &a_cookie="") = 0;
 
     virtual void list_register_names (const UString &a_cookie="") = 0;
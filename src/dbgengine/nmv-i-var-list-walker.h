@@ -57,6 +57,12 @@ public:
     virtual sigc::signal<void, const IVarWalkerSafePtr>&
                                         variable_visited_signal () const=0;
     virtual sigc::signal<void>& variable_list_visited_signal () const=0;
+
+    /// emitted each time a variable of the list has been walked.
+    /// The first argument is the number of variables walked so far,
+    /// the second one is the number of variables to walk.
+    virtual sigc::signal<void, unsigned, unsigned>&
+                            variable_list_walk_progress_signal () const=0;
     ///@}
 
     virtual void initialize (IDebugger *a_debugger)=0;
@@ -72,6 +78,12 @@ public:
 
     virtual void do_walk_variables ()=0;
 
+    /// Bound the walk of each variable of the list.
+    /// See IVarWalker::set_maximum_member_depth and
+    /// IVarWalker::set_maximum_member_breadth.
+    virtual void set_maximum_member_depth (unsigned a_max_depth)=0;
+    virtual void set_maximum_member_breadth (unsigned a_max_breadth)=0;
+
 };//end class IVarListWalker
 
 NEMIVER_END_NAMESPACE (nemiver)
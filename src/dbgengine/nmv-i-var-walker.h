@@ -68,6 +68,15 @@ public:
     virtual sigc::signal<void,
                          const IDebugger::VariableSafePtr>
                                         visited_variable_signal () const = 0;
+
+    /// emitted as the walk progresses.  The first argument is the
+    /// number of member nodes visited so far, the second one is the
+    /// number of member nodes the walker is still waiting the
+    /// debugger for.
+    virtual sigc::signal<void,
+                         unsigned /*nb visited nodes*/,
+                         unsigned /*nb pending nodes*/>
+                                        walk_progress_signal () const = 0;
     ///@}
 
     /// connect the walker to a variable and to a debugger
@@ -92,6 +101,12 @@ public:
     /// this can prevent inifite recursions.
     virtual void set_maximum_member_depth (unsigned a_max_depth) = 0;
     virtual unsigned get_maximum_member_depth () const = 0;
+
+    /// accessor of the maximum number of members of a given variable
+    /// node to explore.  Members past that number are not visited.
+    /// This keeps walks of huge arrays or containers bounded.
+    virtual void set_maximum_member_breadth (unsigned a_max_breadth) = 0;
+    virtual unsigned get_maximum_member_breadth () const = 0;
 }; // end IVarWalker
 
 NEMIVER_END_NAMESPACE (nemiver)
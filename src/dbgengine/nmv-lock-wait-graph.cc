@@ -0,0 +1,589 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <algorithm>
+#include <cstdlib>
+#include "common/nmv-exception.h"
+#include "nmv-lock-wait-graph.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// The maximum number of frames that can separate the innermost
+/// frame of a blocked thread from the primitive it called.  These
+/// are the system call wrappers of the C library.
+static const size_t MAX_SYSCALL_WRAPPER_FRAMES = 3;
+
+/// The number of frames fetched per thread.  The primitives are
+/// close to the top of the stack.
+static const int LOCK_WAIT_MAX_DEPTH = 16;
+
+static const char *COOKIE_LOCK_WAIT_THREADS = "cookie-lock-wait-threads";
+
+static bool
+contains (const string &a_str, const char *a_sub)
+{
+    return a_str.find (a_sub) != string::npos;
+}
+
+/// Tell which synchronization primitive a function is, if any.
+///
+/// The name is matched loosely, so that the internal aliases of the
+/// C library, e.g "__GI___pthread_mutex_lock" or
+/// "pthread_cond_wait@@GLIBC_2.3.2", are recognized as well.
+LockWaitGraph::LockKind
+LockWaitGraph::classify_function (const string &a_function_name)
+{
+    string name = a_function_name.substr (0, a_function_name.find ('@'));
+
+    if (contains (name, "mutex_lock")
+        || contains (name, "mutex_timedlock")
+        || contains (name, "mutex_clocklock"))
+        return LOCK_MUTEX;
+    if (contains (name, "rwlock_")
+        && (contains (name, "rdlock") || contains (name, "wrlock")))
+        return LOCK_RWLOCK;
+    if (contains (name, "cond_wait")
+        || contains (name, "cond_timedwait")
+        || contains (name, "cond_clockwait"))
+        return LOCK_CONDITION;
+    if (contains (name, "sem_wait")
+        || contains (name, "sem_timedwait")
+        || contains (name, "sem_clockwait"))
+        return LOCK_SEMAPHORE;
+    if (contains (name, "barrier_wait"))
+        return LOCK_BARRIER;
+    if (contains (name, "pthread_") && contains (name, "join"))
+        return LOCK_JOIN;
+    if (contains (name, "futex") || contains (name, "lll_lock_wait"))
+        return LOCK_FUTEX;
+    return LOCK_NONE;
+}
+
+/// Find the synchronization primitive a thread is blocked in.
+///
+/// \param a_frames the stack of the thread, innermost frame first.
+///
+/// \param a_kind out parameter.  The kind of the primitive.
+///
+/// \param a_frame_level out parameter.  The level of the frame of the
+/// primitive.  When primitives call one another, e.g
+/// pthread_mutex_lock calling __lll_lock_wait, this is the outermost
+/// one, the one the program called.
+///
+/// \return true if the thread is blocked in a primitive.
+bool
+LockWaitGraph::find_wait (const vector<IDebugger::Frame> &a_frames,
+                          LockKind &a_kind,
+                          int &a_frame_level)
+{
+    size_t i = 0;
+    while (i < a_frames.size ()
+           && i < MAX_SYSCALL_WRAPPER_FRAMES
+           && classify_function (a_frames[i].function_name ()) == LOCK_NONE)
+        ++i;
+    if (i == a_frames.size ()
+        || classify_function (a_frames[i].function_name ()) == LOCK_NONE)
+        return false;
+    while (i + 1 < a_frames.size ()
+           && (classify_function (a_frames[i + 1].function_name ())
+               != LOCK_NONE))
+        ++i;
+    a_kind = classify_function (a_frames[i].function_name ());
+    a_frame_level = a_frames[i].level ();
+    return true;
+}
+
+/// Return the name of the parameter through which the primitives of
+/// a given kind take the object to wait on, as in the C library
+/// sources.  It's available only if the debug info of the C library
+/// is installed.
+const char*
+LockWaitGraph::object_parameter_name (LockKind a_kind)
+{
+    switch (a_kind) {
+        case LOCK_MUTEX: return "mutex";
+        case LOCK_RWLOCK: return "rwlock";
+        case LOCK_CONDITION: return "cond";
+        case LOCK_SEMAPHORE: return "sem";
+        case LOCK_BARRIER: return "barrier";
+        case LOCK_JOIN: return "threadid";
+        case LOCK_FUTEX: return "futex";
+        case LOCK_NONE: break;
+    }
+    return 0;
+}
+
+/// Declare a thread of the inferior, be it blocked or not.
+///
+/// \param a_lwp the kernel id of the thread, which is what the owner
+/// field of a mutex holds.
+void
+LockWaitGraph::add_thread (int a_thread_id, int a_lwp)
+{
+    m_thread_lwps[a_thread_id] = a_lwp;
+}
+
+void
+LockWaitGraph::add_wait (const Wait &a_wait)
+{
+    m_waits.push_back (a_wait);
+}
+
+/// Record the kernel id of the thread owning the object at
+/// a_address, as read from the object.
+void
+LockWaitGraph::set_owner_lwp (size_t a_address, int a_lwp)
+{
+    m_owner_lwps[a_address] = a_lwp;
+}
+
+static bool
+lock_has_more_waiters (const LockWaitGraph::Lock &a_l,
+                       const LockWaitGraph::Lock &a_r)
+{
+    if (a_l.waiters.size () != a_r.waiters.size ())
+        return a_l.waiters.size () > a_r.waiters.size ();
+    if (a_l.in_cycle != a_r.in_cycle)
+        return a_l.in_cycle;
+    if (a_l.address != a_r.address)
+        return a_l.address < a_r.address;
+    return a_l.waiters.front () < a_r.waiters.front ();
+}
+
+/// Build the locks and the wait-for graph from the threads, waits
+/// and owners added so far, and find its cycles.  The locks are then
+/// ranked by decreasing number of waiters.
+void
+LockWaitGraph::analyze ()
+{
+    std::map<int, int> lwp_threads;
+    for (std::map<int, int>::const_iterator it = m_thread_lwps.begin ();
+         it != m_thread_lwps.end ();
+         ++it)
+        if (it->second)
+            lwp_threads[it->second] = it->first;
+
+    // Gather the waits per object.
+    m_locks.clear ();
+    m_waited_threads.clear ();
+    m_threads_in_cycles.clear ();
+    std::map<size_t, size_t> lock_indexes;
+    for (std::vector<Wait>::const_iterator it = m_waits.begin ();
+         it != m_waits.end ();
+         ++it) {
+        size_t index = m_locks.size ();
+        if (it->address) {
+            std::map<size_t, size_t>::const_iterator i =
+                lock_indexes.find (it->address);
+            if (i != lock_indexes.end ())
+                index = i->second;
+            else
+                lock_indexes[it->address] = index;
+        }
+        if (index == m_locks.size ()) {
+            m_locks.push_back (Lock ());
+            m_locks.back ().address = it->address;
+            m_locks.back ().kind = it->kind;
+            std::map<size_t, int>::const_iterator owner =
+                m_owner_lwps.find (it->address);
+            if (it->address && owner != m_owner_lwps.end ()) {
+                std::map<int, int>::const_iterator t =
+                    lwp_threads.find (owner->second);
+                if (t != lwp_threads.end ())
+                    m_locks.back ().owner_thread_id = t->second;
+            }
+        }
+        Lock &lock = m_locks[index];
+        lock.waiters.push_back (it->thread_id);
+        if (lock.owner_thread_id)
+            m_waited_threads[it->thread_id] = lock.owner_thread_id;
+    }
+
+    // Each thread waits on one object at most, which has one owner at
+    // most, so walking the edges from any thread either ends or
+    // loops.  A thread waiting on a mutex it owns already is a cycle
+    // of its own.
+    enum {UNVISITED = 0, IN_PATH, VISITED};
+    std::map<int, int> states;
+    for (std::map<int, int>::const_iterator it = m_waited_threads.begin ();
+         it != m_waited_threads.end ();
+         ++it) {
+        if (states[it->first] != UNVISITED)
+            continue;
+        std::vector<int> path;
+        int thread_id = it->first;
+        while (true) {
+            states[thread_id] = IN_PATH;
+            path.push_back (thread_id);
+            std::map<int, int>::const_iterator next =
+                m_waited_threads.find (thread_id);
+            if (next == m_waited_threads.end ())
+                break;
+            int state = states[next->second];
+            if (state == IN_PATH) {
+                std::vector<int>::iterator start =
+                    std::find (path.begin (), path.end (), next->second);
+                m_threads_in_cycles.insert (start, path.end ());
+                break;
+            }
+            if (state == VISITED)
+                break;
+            thread_id = next->second;
+        }
+        for (std::vector<int>::const_iterator i = path.begin ();
+             i != path.end ();
+             ++i)
+            states[*i] = VISITED;
+    }
+
+    // A waiter in a cycle waits on the next thread of the cycle.
+    for (std::vector<Lock>::iterator it = m_locks.begin ();
+         it != m_locks.end ();
+         ++it) {
+        std::sort (it->waiters.begin (), it->waiters.end ());
+        for (std::vector<int>::const_iterator w = it->waiters.begin ();
+             w != it->waiters.end ();
+             ++w) {
+            if (it->owner_thread_id && is_in_cycle (*w)) {
+                it->in_cycle = true;
+                break;
+            }
+        }
+    }
+    std::sort (m_locks.begin (), m_locks.end (), lock_has_more_waiters);
+}
+
+/// The threads blocked in a primitive, in the order they were added.
+const std::vector<LockWaitGraph::Wait>&
+LockWaitGraph::waits () const
+{
+    return m_waits;
+}
+
+/// The objects the threads wait on, with the most waited on first.
+/// Valid after analyze () only.
+const std::vector<LockWaitGraph::Lock>&
+LockWaitGraph::locks () const
+{
+    return m_locks;
+}
+
+/// Return the thread a_thread_id waits for, i.e the owner of the
+/// lock it is blocked on, or 0 if it's unknown or a_thread_id isn't
+/// blocked.  Valid after analyze () only.
+int
+LockWaitGraph::waited_thread (int a_thread_id) const
+{
+    std::map<int, int>::const_iterator it =
+        m_waited_threads.find (a_thread_id);
+    if (it == m_waited_threads.end ())
+        return 0;
+    return it->second;
+}
+
+/// Return true if a_thread_id is deadlocked, i.e part of a cycle of
+/// the wait-for graph.  Valid after analyze () only.
+bool
+LockWaitGraph::is_in_cycle (int a_thread_id) const
+{
+    return m_threads_in_cycles.count (a_thread_id);
+}
+
+size_t
+LockWaitGraph::nb_threads_in_cycles () const
+{
+    return m_threads_in_cycles.size ();
+}
+
+void
+LockWaitGraph::clear ()
+{
+    m_thread_lwps.clear ();
+    m_waits.clear ();
+    m_owner_lwps.clear ();
+    m_locks.clear ();
+    m_waited_threads.clear ();
+    m_threads_in_cycles.clear ();
+}
+
+/// Parse the value of an expression evaluated as an unsigned long.
+static size_t
+parse_address (const IDebugger::ExpressionResult &a_result)
+{
+    if (a_result.is_error ())
+        return 0;
+    return strtoul (a_result.value ().c_str (), 0, 0);
+}
+
+struct LockWaitCollector::Priv {
+    IDebuggerSafePtr debugger;
+    GraphSlot slot;
+    LockWaitGraph graph;
+    // The waits which objects are being looked up.
+    vector<LockWaitGraph::Wait> waits;
+    // The addresses of the objects of waits, as passed to the
+    // primitives and as found in the futex system calls.
+    vector<size_t> argument_addresses;
+    vector<size_t> futex_addresses;
+    int nb_pending;
+    bool is_listing_threads;
+    // Incremented at each collection, so that the answers to a
+    // cancelled one are dropped.
+    unsigned generation;
+
+    Priv (IDebuggerSafePtr &a_debugger) :
+        debugger (a_debugger),
+        nb_pending (0),
+        is_listing_threads (false),
+        generation (0)
+    {
+        THROW_IF_FAIL (debugger);
+        debugger->threads_info_listed_signal ().connect
+            (sigc::mem_fun (*this,
+                            &Priv::on_debugger_threads_info_listed_signal));
+    }
+
+    void collect (const GraphSlot &a_slot)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        cancel ();
+        slot = a_slot;
+        is_listing_threads = true;
+        debugger->list_threads_info (COOKIE_LOCK_WAIT_THREADS);
+    }
+
+    void cancel ()
+    {
+        ++generation;
+        is_listing_threads = false;
+        nb_pending = 0;
+        graph.clear ();
+        waits.clear ();
+        argument_addresses.clear ();
+        futex_addresses.clear ();
+    }
+
+    void done ()
+    {
+        graph.analyze ();
+        slot (graph);
+    }
+
+    void on_debugger_threads_info_listed_signal
+                        (const vector<IDebugger::ThreadInfo> &a_threads,
+                         int /*a_current_thread_id*/,
+                         const UString &a_cookie)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (a_cookie != COOKIE_LOCK_WAIT_THREADS || !is_listing_threads)
+            return;
+        is_listing_threads = false;
+
+        list<int> thread_ids;
+        for (vector<IDebugger::ThreadInfo>::const_iterator it =
+                 a_threads.begin ();
+             it != a_threads.end ();
+             ++it) {
+            graph.add_thread (it->id (), it->lwp ());
+            // A running thread isn't blocked, as far as we can tell.
+            if (!it->is_running ())
+                thread_ids.push_back (it->id ());
+        }
+        if (thread_ids.empty ()) {
+            done ();
+            return;
+        }
+        debugger->list_threads_frames
+            (thread_ids, LOCK_WAIT_MAX_DEPTH,
+             sigc::bind (sigc::mem_fun (*this,
+                                        &Priv::on_threads_frames_listed),
+                         generation));
+
+        NEMIVER_CATCH
+    }
+
+    void on_threads_frames_listed (const map<int,
+                                             vector<IDebugger::Frame> > &a_stacks,
+                                   unsigned a_generation)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (a_generation != generation)
+            return;
+
+        for (map<int, vector<IDebugger::Frame> >::const_iterator it =
+                 a_stacks.begin ();
+             it != a_stacks.end ();
+             ++it) {
+            LockWaitGraph::Wait wait;
+            if (!LockWaitGraph::find_wait (it->second,
+                                           wait.kind,
+                                           wait.frame_level))
+                continue;
+            wait.thread_id = it->first;
+            size_t caller = wait.frame_level + 1;
+            wait.caller = caller < it->second.size ()
+                ? it->second[caller]
+                : it->second[wait.frame_level];
+            waits.push_back (wait);
+        }
+        if (waits.empty ()) {
+            done ();
+            return;
+        }
+
+        // Look up the object of each wait twice: through the
+        // parameter of the primitive, which needs the debug info of
+        // the C library, and through the first argument of the futex
+        // system call the thread is blocked in.  The latter is still
+        // in $rdi on x86-64 and is the address of the object for
+        // mutexes.
+        argument_addresses.assign (waits.size (), 0);
+        futex_addresses.assign (waits.size (), 0);
+        nb_pending = 2 * waits.size ();
+        for (size_t i = 0; i < waits.size (); ++i) {
+            std::list<UString> exprs;
+            exprs.push_back
+                (UString ("(unsigned long) ")
+                 + LockWaitGraph::object_parameter_name (waits[i].kind));
+            debugger->evaluate_expressions
+                (exprs, waits[i].thread_id, waits[i].frame_level,
+                 sigc::bind (sigc::mem_fun (*this,
+                                            &Priv::on_address_evaluated),
+                             a_generation, &argument_addresses[i]));
+            exprs.clear ();
+            exprs.push_back ("(unsigned long) $rdi");
+            debugger->evaluate_expressions
+                (exprs, waits[i].thread_id, 0,
+                 sigc::bind (sigc::mem_fun (*this,
+                                            &Priv::on_address_evaluated),
+                             a_generation, &futex_addresses[i]));
+        }
+
+        NEMIVER_CATCH
+    }
+
+    void on_address_evaluated
+                (const vector<IDebugger::ExpressionResult> &a_results,
+                 unsigned a_generation,
+                 size_t *a_address)
+    {
+        NEMIVER_TRY
+
+        if (a_generation != generation)
+            return;
+        THROW_IF_FAIL (a_address && !a_results.empty ());
+        *a_address = parse_address (a_results.front ());
+        if (--nb_pending)
+            return;
+
+        // Read the owner of each mutex, once per mutex.
+        std::list<UString> exprs;
+        vector<size_t> mutexes;
+        for (size_t i = 0; i < waits.size (); ++i) {
+            waits[i].address = argument_addresses[i]
+                ? argument_addresses[i]
+                : futex_addresses[i];
+            graph.add_wait (waits[i]);
+            if (waits[i].kind != LockWaitGraph::LOCK_MUTEX
+                || !waits[i].address
+                || std::find (mutexes.begin (), mutexes.end (),
+                              waits[i].address) != mutexes.end ())
+                continue;
+            mutexes.push_back (waits[i].address);
+            // That's __data.__owner, the third int of
+            // pthread_mutex_t on all the glibc ABIs.
+            UString expr;
+            expr.printf ("((int *) %#lx)[2]",
+                         (unsigned long) waits[i].address);
+            exprs.push_back (expr);
+        }
+        if (exprs.empty ()) {
+            done ();
+            return;
+        }
+        debugger->evaluate_expressions
+            (exprs,
+             sigc::bind (sigc::mem_fun (*this, &Priv::on_owners_evaluated),
+                         a_generation, mutexes));
+
+        NEMIVER_CATCH
+    }
+
+    void on_owners_evaluated
+                (const vector<IDebugger::ExpressionResult> &a_results,
+                 unsigned a_generation,
+                 const vector<size_t> &a_mutexes)
+    {
+        NEMIVER_TRY
+
+        if (a_generation != generation)
+            return;
+        for (size_t i = 0; i < a_results.size () && i < a_mutexes.size (); ++i)
+            if (!a_results[i].is_error ())
+                graph.set_owner_lwp (a_mutexes[i],
+                                     atoi (a_results[i].value ().c_str ()));
+        done ();
+
+        NEMIVER_CATCH
+    }
+};//end struct LockWaitCollector::Priv
+
+LockWaitCollector::LockWaitCollector (IDebuggerSafePtr &a_debugger)
+{
+    m_priv.reset (new Priv (a_debugger));
+}
+
+LockWaitCollector::~LockWaitCollector ()
+{
+}
+
+/// Start building the wait-for graph of the inferior, which must be
+/// stopped.  A collection still in progress is cancelled.
+///
+/// \param a_slot the slot called with the graph, analyzed already.
+void
+LockWaitCollector::collect (const GraphSlot &a_slot)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->collect (a_slot);
+}
+
+/// Drop the collection in progress, if any.  Its slot won't be
+/// called.
+void
+LockWaitCollector::cancel ()
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->cancel ();
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,167 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_LOCK_WAIT_GRAPH_H__
+#define __NMV_LOCK_WAIT_GRAPH_H__
+
+#include <map>
+#include <set>
+#include <vector>
+#include "common/nmv-object.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "nmv-i-debugger.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// Who waits on whom among the threads of a stopped inferior.
+///
+/// A thread is deemed blocked when the innermost frames of its stack
+/// are those of a synchronization primitive of the C library, e.g
+/// pthread_mutex_lock or pthread_cond_wait, or of the futex calls
+/// these are built on.  The thread then waits on the object it passed
+/// to the primitive.  When the object is a mutex, its owner is read
+/// from the __owner field of glibc's pthread_mutex_t; this yields an
+/// edge from the waiter to the owner in the wait-for graph.  A cycle
+/// in that graph is a deadlock.
+class NEMIVER_API LockWaitGraph {
+public:
+    enum LockKind {
+        LOCK_NONE = 0,
+        LOCK_MUTEX,
+        LOCK_RWLOCK,
+        LOCK_CONDITION,
+        LOCK_SEMAPHORE,
+        LOCK_BARRIER,
+        LOCK_JOIN,
+        /// A bare futex, e.g a low level lock internal to the C
+        /// library.
+        LOCK_FUTEX
+    };
+
+    /// A thread blocked in a synchronization primitive.
+    struct Wait {
+        int thread_id;
+        LockKind kind;
+        /// The level of the frame of the primitive in the stack of
+        /// the thread.
+        int frame_level;
+        /// The frame that called the primitive.  This is where the
+        /// thread is blocked from the point of view of the user.
+        IDebugger::Frame caller;
+        /// The address of the object waited on, or 0 if it's unknown.
+        size_t address;
+
+        Wait () :
+            thread_id (0),
+            kind (LOCK_NONE),
+            frame_level (0),
+            address (0)
+        {
+        }
+    };//end struct Wait
+
+    /// An object some threads wait on.
+    struct Lock {
+        /// The address of the object, or 0 if it's unknown.  Waits
+        /// on unknown objects each get their own Lock.
+        size_t address;
+        LockKind kind;
+        /// The thread holding the lock, or 0 if it's unknown.
+        int owner_thread_id;
+        /// The threads waiting on the lock, in increasing order.
+        std::vector<int> waiters;
+        /// True if the lock is part of a cycle of the wait-for graph.
+        bool in_cycle;
+
+        Lock () :
+            address (0),
+            kind (LOCK_NONE),
+            owner_thread_id (0),
+            in_cycle (false)
+        {
+        }
+    };//end struct Lock
+
+private:
+    std::map<int, int> m_thread_lwps;
+    std::vector<Wait> m_waits;
+    std::map<size_t, int> m_owner_lwps;
+    std::vector<Lock> m_locks;
+    std::map<int, int> m_waited_threads;
+    std::set<int> m_threads_in_cycles;
+
+public:
+    static LockKind classify_function (const string &a_function_name);
+
+    static bool find_wait (const vector<IDebugger::Frame> &a_frames,
+                           LockKind &a_kind,
+                           int &a_frame_level);
+
+    static const char* object_parameter_name (LockKind a_kind);
+
+    void add_thread (int a_thread_id, int a_lwp);
+
+    void add_wait (const Wait &a_wait);
+
+    void set_owner_lwp (size_t a_address, int a_lwp);
+
+    void analyze ();
+
+    const std::vector<Wait>& waits () const;
+
+    const std::vector<Lock>& locks () const;
+
+    int waited_thread (int a_thread_id) const;
+
+    bool is_in_cycle (int a_thread_id) const;
+
+    size_t nb_threads_in_cycles () const;
+
+    void clear ();
+};//end class LockWaitGraph
+
+/// Fetches from a stopped inferior what a LockWaitGraph is made of:
+/// the threads, their stacks, the objects the blocked threads wait
+/// on and the owners of these objects.  Each of these steps is one
+/// batch of pipelined commands, whatever the number of threads.
+class NEMIVER_API LockWaitCollector : public nemiver::common::Object {
+    //non copyable
+    LockWaitCollector (const LockWaitCollector&);
+    LockWaitCollector& operator= (const LockWaitCollector&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+public:
+    typedef sigc::slot<void, const LockWaitGraph&> GraphSlot;
+
+    LockWaitCollector (IDebuggerSafePtr &a_debugger);
+    virtual ~LockWaitCollector ();
+    void collect (const GraphSlot &a_slot);
+    void cancel ();
+};//end class LockWaitCollector
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_LOCK_WAIT_GRAPH_H__
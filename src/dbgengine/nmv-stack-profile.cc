@@ -0,0 +1,187 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <algorithm>
+#include <set>
+#include "nmv-stack-profile.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// Return the child of a_node labelled a_function, adding it if
+/// needed.
+static StackProfile::Node&
+get_or_add_child (StackProfile::Node &a_node, StringPool::Id a_function)
+{
+    std::vector<StackProfile::Node>::iterator it;
+    for (it = a_node.children.begin (); it != a_node.children.end (); ++it)
+        if (it->function == a_function)
+            return *it;
+    a_node.children.push_back (StackProfile::Node ());
+    a_node.children.back ().function = a_function;
+    return a_node.children.back ();
+}
+
+static bool
+node_is_hotter (const StackProfile::Node &a_l, const StackProfile::Node &a_r)
+{
+    return a_l.nb_samples > a_r.nb_samples;
+}
+
+static void
+sort_call_tree (StackProfile::Node &a_node)
+{
+    std::stable_sort (a_node.children.begin (), a_node.children.end (),
+                      node_is_hotter);
+    std::vector<StackProfile::Node>::iterator it;
+    for (it = a_node.children.begin (); it != a_node.children.end (); ++it)
+        sort_call_tree (*it);
+}
+
+StackProfile::StackProfile () :
+    m_nb_samples (0)
+{
+}
+
+/// Return the label of a frame in the call tree: the name of its
+/// function or, when there is none, its address.
+StringPool::Id
+StackProfile::frame_function_id (const IDebugger::Frame &a_frame)
+{
+    if (a_frame.function_name_id ())
+        return a_frame.function_name_id ();
+
+    // Frame::address returns a copy: keep the string, not a
+    // reference into it.
+    const std::string address = a_frame.address ().to_string ();
+    if (address.empty ())
+        return 0;
+    std::map<std::string, StringPool::Id>::const_iterator it =
+        m_address_ids.find (address);
+    if (it != m_address_ids.end ())
+        return it->second | ADDRESS_ID_FLAG;
+    StringPool::Id id = m_addresses.size ();
+    m_addresses.push_back (address);
+    m_address_ids[address] = id;
+    return id | ADDRESS_ID_FLAG;
+}
+
+/// Add one sample, i.e, the stacks of the threads of the inferior
+/// taken at the same point in time.
+///
+/// \param a_stacks the frames of each thread, innermost first, as
+/// reported by IDebugger::list_threads_frames.
+void
+StackProfile::add_sample (const map<int, vector<IDebugger::Frame> > &a_stacks)
+{
+    map<int, vector<IDebugger::Frame> >::const_iterator it;
+    for (it = a_stacks.begin (); it != a_stacks.end (); ++it)
+        add_stack (it->first, it->second);
+    ++m_nb_samples;
+}
+
+/// Add the stack of one thread.  Empty stacks are ignored.
+///
+/// \param a_frames the frames of the thread, innermost first.
+void
+StackProfile::add_stack (int a_thread_id,
+                         const vector<IDebugger::Frame> &a_frames)
+{
+    if (a_frames.empty ())
+        return;
+    m_stacks.push_back (Stack ());
+    Stack &stack = m_stacks.back ();
+    stack.thread_id = a_thread_id;
+    stack.functions.reserve (a_frames.size ());
+    vector<IDebugger::Frame>::const_reverse_iterator it;
+    for (it = a_frames.rbegin (); it != a_frames.rend (); ++it)
+        stack.functions.push_back (frame_function_id (*it));
+}
+
+/// Return the number of samples added by add_sample.
+unsigned
+StackProfile::nb_samples () const
+{
+    return m_nb_samples;
+}
+
+/// Return the number of thread stacks recorded so far.
+size_t
+StackProfile::nb_stacks () const
+{
+    return m_stacks.size ();
+}
+
+/// Get the ids of the threads that have at least one recorded stack,
+/// in increasing order.
+void
+StackProfile::thread_ids (std::vector<int> &a_ids) const
+{
+    std::set<int> ids;
+    std::vector<Stack>::const_iterator it;
+    for (it = m_stacks.begin (); it != m_stacks.end (); ++it)
+        ids.insert (it->thread_id);
+    a_ids.assign (ids.begin (), ids.end ());
+}
+
+/// Aggregate the recorded stacks into a call tree.  The children of
+/// each node are sorted by decreasing number of samples.
+///
+/// \param a_root the root of the resulting tree.  Its nb_samples is
+/// the number of stacks that were aggregated.
+///
+/// \param a_thread_id if positive, only the stacks of that thread
+/// are aggregated.
+void
+StackProfile::build_call_tree (Node &a_root, int a_thread_id) const
+{
+    a_root = Node ();
+    std::vector<Stack>::const_iterator it;
+    for (it = m_stacks.begin (); it != m_stacks.end (); ++it) {
+        if (a_thread_id > 0 && it->thread_id != a_thread_id)
+            continue;
+        Node *node = &a_root;
+        ++node->nb_samples;
+        std::vector<StringPool::Id>::const_iterator f;
+        for (f = it->functions.begin (); f != it->functions.end (); ++f) {
+            node = &get_or_add_child (*node, *f);
+            if ((*f & ADDRESS_ID_FLAG) && node->address.empty ())
+                node->address = m_addresses[*f & ~ADDRESS_ID_FLAG];
+            ++node->nb_samples;
+        }
+        ++node->nb_self_samples;
+    }
+    sort_call_tree (a_root);
+}
+
+void
+StackProfile::clear ()
+{
+    m_stacks.clear ();
+    m_nb_samples = 0;
+    m_addresses.clear ();
+    m_address_ids.clear ();
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
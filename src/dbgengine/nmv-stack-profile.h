@@ -0,0 +1,116 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_STACK_PROFILE_H__
+#define __NMV_STACK_PROFILE_H__
+
+#include <vector>
+#include <map>
+#include "nmv-i-debugger.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// The stacks of the threads of the inferior, sampled at regular
+/// intervals, and aggregated into a call tree.
+///
+/// Each stack is kept as the sequence of the names of its functions,
+/// outermost first, interned in the default StringPool.  Frames that
+/// have no function name are designated by their address instead,
+/// in a table owned by the profile, so that clearing the profile
+/// frees them.  The call tree is built on demand, for all the
+/// threads or for a given one.
+class NEMIVER_API StackProfile {
+public:
+    /// A node of the call tree: a function, reached through the
+    /// path of functions of its ancestors.
+    struct Node {
+        /// The name of the function, as an id of the default
+        /// StringPool.  It's 0 for the root of the tree.  For a frame
+        /// that has no function name, it's an id of the addresses of
+        /// the profile, that has StackProfile::ADDRESS_ID_FLAG set.
+        StringPool::Id function;
+        /// The address of the frame, if it has no function name.
+        UString address;
+        /// The number of stacks that went through this node.
+        unsigned nb_samples;
+        /// The number of stacks that ended at this node.
+        unsigned nb_self_samples;
+        std::vector<Node> children;
+
+        Node () :
+            function (0),
+            nb_samples (0),
+            nb_self_samples (0)
+        {
+        }
+
+        const UString& function_name () const
+        {
+            if (!address.empty ())
+                return address;
+            return StringPool::default_pool ().get (function);
+        }
+    };//end struct Node
+
+private:
+    struct Stack {
+        int thread_id;
+        std::vector<StringPool::Id> functions;
+    };
+
+    std::vector<Stack> m_stacks;
+    unsigned m_nb_samples;
+    // The addresses of the frames that have no function name, and
+    // their ids, without ADDRESS_ID_FLAG.
+    std::vector<UString> m_addresses;
+    std::map<std::string, StringPool::Id> m_address_ids;
+
+    StringPool::Id frame_function_id (const IDebugger::Frame &a_frame);
+
+public:
+    /// The bit set in the ids of the frames that are designated by
+    /// their address.
+    static const StringPool::Id ADDRESS_ID_FLAG = 1u << 31;
+
+    StackProfile ();
+
+    void add_sample (const map<int, vector<IDebugger::Frame> > &a_stacks);
+
+    void add_stack (int a_thread_id,
+                    const vector<IDebugger::Frame> &a_frames);
+
+    unsigned nb_samples () const;
+
+    size_t nb_stacks () const;
+
+    void thread_ids (std::vector<int> &a_ids) const;
+
+    void build_call_tree (Node &a_root, int a_thread_id = -1) const;
+
+    void clear ();
+};//end class StackProfile
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_STACK_PROFILE_H__
@@ -39,6 +39,8 @@ struct SafePtrCmp {
 class VarListWalker : public IVarListWalker {
      mutable sigc::signal<void, const IVarWalkerSafePtr> m_variable_visited_signal;
      mutable sigc::signal<void> m_variable_list_visited_signal;
+     mutable sigc::signal<void, unsigned, unsigned>
+                                m_variable_list_walk_progress_signal;
      list<IDebugger::VariableSafePtr> m_variables;
      list<IVarWalkerSafePtr> m_var_walkers;
      typedef std::map<IVarWalkerSafePtr, bool, SafePtrCmp>  WalkersMap;
@@ -46,6 +48,11 @@ class VarListWalker : public IVarListWalker {
      WalkersQueue m_considered_walkers;
      WalkersMap m_walkers_map;
      IDebugger *m_debugger;
+     unsigned m_nb_walked_variables;
+     unsigned m_nb_variables_to_walk;
+     // Zero means the default bounds of the walkers are used.
+     unsigned m_max_depth;
+     unsigned m_max_breadth;
 
      IVarWalkerSafePtr create_variable_walker
                                  (const IDebugger::VariableSafePtr &a_var);
@@ -57,7 +64,11 @@ public:
 
      VarListWalker (DynamicModule *a_dynmod) :
          IVarListWalker (a_dynmod),
-         m_debugger (0)
+         m_debugger (0),
+         m_nb_walked_variables (0),
+         m_nb_variables_to_walk (0),
+         m_max_depth (0),
+         m_max_breadth (0)
     {
     }
     //******************
@@ -66,6 +77,8 @@ public:
     sigc::signal<void, const IVarWalkerSafePtr>&
                                     variable_visited_signal () const;
     sigc::signal<void>& variable_list_visited_signal () const;
+    sigc::signal<void, unsigned, unsigned>&
+                            variable_list_walk_progress_signal () const;
     //******************
     //</event getters>
     //******************
@@ -81,6 +94,10 @@ public:
 
     void do_walk_variables ();
 
+    void set_maximum_member_depth (unsigned a_max_depth);
+
+    void set_maximum_member_breadth (unsigned a_max_breadth);
+
 };//end class VarListWalker
 
 void
@@ -93,12 +110,24 @@ VarListWalker::on_visited_variable_signal
     variable_visited_signal ().emit (a_walker);
     THROW_IF_FAIL (m_walkers_map.find (a_walker) != m_walkers_map.end ());
     m_walkers_map.erase (a_walker);
+    ++m_nb_walked_variables;
+    variable_list_walk_progress_signal ().emit (m_nb_walked_variables,
+                                                m_nb_variables_to_walk);
     if (m_walkers_map.empty ()) {
         variable_list_visited_signal ().emit ();
     }
     NEMIVER_CATCH_NOX
 }
 
+/// Create the walker of a variable of the list.
+///
+/// This is a VarWalker, not a VarobjWalker: the variables of the
+/// list, e.g the global variables, are known by their name only and
+/// have no variable object.  A VarWalker gets the whole value of the
+/// variable at once, then asks for the types of all its members,
+/// which requests are pipelined.  So it doesn't walk the tree level
+/// by level the way VarobjWalker does, but it doesn't wait for each
+/// member in turn either.
 IVarWalkerSafePtr
 VarListWalker::create_variable_walker (const IDebugger::VariableSafePtr &a_var)
 {
@@ -114,6 +143,10 @@ VarListWalker::create_variable_walker (const IDebugger::VariableSafePtr &a_var)
     result = module_manager->load_iface<IVarWalker> ("varwalker",
                                                      "IVarWalker");
     THROW_IF_FAIL (result);
+    if (m_max_depth)
+        result->set_maximum_member_depth (m_max_depth);
+    if (m_max_breadth)
+        result->set_maximum_member_breadth (m_max_breadth);
     result->connect (m_debugger, a_var);
     return result;
 }
@@ -130,6 +163,12 @@ VarListWalker::variable_list_visited_signal () const
     return m_variable_list_visited_signal;
 }
 
+sigc::signal<void, unsigned, unsigned>&
+VarListWalker::variable_list_walk_progress_signal () const
+{
+    return m_variable_list_walk_progress_signal;
+}
+
 void
 VarListWalker::initialize (IDebugger *a_debugger)
 {
@@ -185,6 +224,8 @@ VarListWalker::do_walk_variable (const UString &a_var_qname)
         if (qname == a_var_qname) {
             LOG_DD ("found variable of qname " << qname << " to walk");
             m_walkers_map[*it] = true;
+            m_nb_walked_variables = 0;
+            m_nb_variables_to_walk = 1;
             (*it)->do_walk_variable ();
             LOG_DD ("variable walking query sent");
             return true;
@@ -197,6 +238,8 @@ VarListWalker::do_walk_variable (const UString &a_var_qname)
 void
 VarListWalker::do_walk_variables ()
 {
+    m_nb_walked_variables = 0;
+    m_nb_variables_to_walk = m_var_walkers.size ();
     list<IVarWalkerSafePtr>::iterator it;
     for (it = m_var_walkers.begin (); it != m_var_walkers.end (); ++it) {
         m_walkers_map[*it] = true;
@@ -204,6 +247,24 @@ VarListWalker::do_walk_variables ()
     }
 }
 
+void
+VarListWalker::set_maximum_member_depth (unsigned a_max_depth)
+{
+    m_max_depth = a_max_depth;
+    list<IVarWalkerSafePtr>::iterator it;
+    for (it = m_var_walkers.begin (); it != m_var_walkers.end (); ++it)
+        (*it)->set_maximum_member_depth (a_max_depth);
+}
+
+void
+VarListWalker::set_maximum_member_breadth (unsigned a_max_breadth)
+{
+    m_max_breadth = a_max_breadth;
+    list<IVarWalkerSafePtr>::iterator it;
+    for (it = m_var_walkers.begin (); it != m_var_walkers.end (); ++it)
+        (*it)->set_maximum_member_breadth (a_max_breadth);
+}
+
 //the dynmod used to instanciate the VarListWalker service object
 //and return an interface on it.
 struct VarListWalkerDynMod : public DynamicModule {
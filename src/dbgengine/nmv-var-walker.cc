@@ -24,6 +24,7 @@
  */
 #include <list>
 #include <map>
+#include <limits>
 #include "nmv-i-var-walker.h"
 #include "nmv-gdb-engine.h"
 #include "common/nmv-sequence.h"
@@ -42,6 +43,8 @@ typedef SafePtr<nemiver::GDBEngine, ObjectRef, ObjectUnref> GDBEngineSafePtr;
 NEMIVER_BEGIN_NAMESPACE (nemiver)
 
 const UString VAR_WALKER_COOKIE="var-walker-cookie";
+static const unsigned MAX_DEPTH = 256;
+static const unsigned MAX_BREADTH = std::numeric_limits<unsigned>::max ();
 
 nemiver::common::Sequence&
 get_sequence ()
@@ -67,12 +70,17 @@ class VarWalker : public IVarWalker , public sigc::trackable {
                          const IDebugger::VariableSafePtr>
                                             m_visited_variable_signal;
 
+    mutable sigc::signal<void, unsigned, unsigned> m_walk_progress_signal;
+
     mutable GDBEngine *m_debugger;
     UString m_root_var_name;
     list<sigc::connection> m_connections;
     map<IDebugger::VariableSafePtr, bool, SafePtrCmp> m_vars_to_visit;
     UString m_cookie;
     IDebugger::VariableSafePtr m_root_var;
+    unsigned m_nb_visited_nodes;
+    unsigned m_max_depth;
+    unsigned m_max_breadth;
 
     void on_variable_value_signal (const UString &a_name,
                                    const IDebugger::VariableSafePtr a_var,
@@ -84,13 +92,17 @@ class VarWalker : public IVarWalker , public sigc::trackable {
     void on_variable_type_set_signal (const IDebugger::VariableSafePtr a_var,
                                       const UString &a_cookie);
 
-    void get_type_of_all_members (const IDebugger::VariableSafePtr a_from);
+    void get_type_of_all_members (const IDebugger::VariableSafePtr a_from,
+                                  unsigned a_max_depth);
 
 public:
 
     VarWalker (DynamicModule *a_dynmod) :
         IVarWalker (a_dynmod),
-        m_debugger (0)
+        m_debugger (0),
+        m_nb_visited_nodes (0),
+        m_max_depth (MAX_DEPTH),
+        m_max_breadth (MAX_BREADTH)
     {
     }
 
@@ -101,6 +113,7 @@ public:
                                         visited_variable_node_signal () const;
     sigc::signal<void, const IDebugger::VariableSafePtr>
                                         visited_variable_signal () const;
+    sigc::signal<void, unsigned, unsigned> walk_progress_signal () const;
     //********************
     //</event getters>
     //********************
@@ -119,6 +132,10 @@ public:
     void set_maximum_member_depth (unsigned a_max_depth);
 
     unsigned get_maximum_member_depth () const;
+
+    void set_maximum_member_breadth (unsigned a_max_breadth);
+
+    unsigned get_maximum_member_breadth () const;
 };//end class VarWalker
 
 void
@@ -134,7 +151,7 @@ VarWalker::on_variable_value_signal (const UString &a_name,
     NEMIVER_TRY
 
     //now query for the type
-    get_type_of_all_members (a_var);
+    get_type_of_all_members (a_var, m_max_depth);
     m_root_var = a_var;
     LOG_DD ("set m_root_var");
 
@@ -152,7 +169,7 @@ VarWalker::on_variable_value_set_signal (const IDebugger::VariableSafePtr a_var,
     NEMIVER_TRY
 
     //now query for the type
-    get_type_of_all_members (a_var);
+    get_type_of_all_members (a_var, m_max_depth);
 
     LOG_DD ("m_vars_to_visit.size () = " << (int)m_vars_to_visit.size ());
     UString var_str;
@@ -184,6 +201,8 @@ VarWalker::on_variable_type_set_signal (const IDebugger::VariableSafePtr a_var,
 
     visited_variable_node_signal ().emit (a_var);
     m_vars_to_visit.erase (a_var);
+    ++m_nb_visited_nodes;
+    walk_progress_signal ().emit (m_nb_visited_nodes, m_vars_to_visit.size ());
     if (m_vars_to_visit.size () == 0) {
         visited_variable_signal ().emit (m_root_var);
         LOG_DD ("visited var: " << m_root_var->name ()
@@ -202,10 +221,14 @@ VarWalker::on_variable_type_set_signal (const IDebugger::VariableSafePtr a_var,
 }
 
 void
-VarWalker::get_type_of_all_members (const IDebugger::VariableSafePtr a_from)
+VarWalker::get_type_of_all_members (const IDebugger::VariableSafePtr a_from,
+                                    unsigned a_max_depth)
 {
     RETURN_IF_FAIL (a_from);
 
+    if (a_max_depth == 0)
+        return;
+
     LOG_DD ("member: " << a_from->name ());
     if (a_from->parent ()) {
         LOG_DD ("parent: " << a_from->parent ()->name ());
@@ -233,10 +256,11 @@ VarWalker::get_type_of_all_members (const IDebugger::VariableSafePtr a_from)
         return;
     }
     list<IDebugger::VariableSafePtr>::const_iterator it;
+    unsigned nb_members = 0;
     for (it = a_from->members ().begin ();
-         it != a_from->members ().end ();
-         ++it) {
-        get_type_of_all_members (*it);
+         it != a_from->members ().end () && nb_members < m_max_breadth;
+         ++it, ++nb_members) {
+        get_type_of_all_members (*it, a_max_depth - 1);
     }
     LOG_DD ("m_vars_to_visit.size () = " << (int)m_vars_to_visit.size ());
 }
@@ -253,6 +277,12 @@ VarWalker::visited_variable_signal () const
     return m_visited_variable_signal;
 }
 
+sigc::signal<void, unsigned, unsigned>
+VarWalker::walk_progress_signal () const
+{
+    return m_walk_progress_signal;
+}
+
 void
 VarWalker::connect (IDebugger *a_debugger,
                     const UString &a_var_name)
@@ -308,6 +338,7 @@ VarWalker::do_walk_variable (const UString &a_cookie)
     } else {
         m_cookie = a_cookie;
     }
+    m_nb_visited_nodes = 0;
 
     if (m_root_var_name.raw () != "") {
         m_debugger->print_variable_value (m_root_var_name,
@@ -330,14 +361,27 @@ VarWalker::get_debugger () const
 }
 
 void
-VarWalker::set_maximum_member_depth (unsigned)
+VarWalker::set_maximum_member_depth (unsigned a_max_depth)
 {
+    m_max_depth = a_max_depth;
 }
 
 unsigned
 VarWalker::get_maximum_member_depth () const
 {
-    return 0;
+    return m_max_depth;
+}
+
+void
+VarWalker::set_maximum_member_breadth (unsigned a_max_breadth)
+{
+    m_max_breadth = a_max_breadth;
+}
+
+unsigned
+VarWalker::get_maximum_member_breadth () const
+{
+    return m_max_breadth;
 }
 
 //the dynmod used to instanciate the VarWalker service object
@@ -24,6 +24,7 @@
  */
 #include <list>
 #include <map>
+#include <limits>
 #include "nmv-i-var-walker.h"
 #include "nmv-gdb-engine.h"
 #include "common/nmv-sequence.h"
@@ -43,6 +44,7 @@ typedef SafePtr<nemiver::GDBEngine, ObjectRef, ObjectUnref> GDBEngineSafePtr;
 NEMIVER_BEGIN_NAMESPACE (nemiver)
 
 static const unsigned MAX_DEPTH = 256;
+static const unsigned MAX_BREADTH = std::numeric_limits<unsigned>::max ();
 
 class VarobjWalker : public IVarWalker, public sigc::trackable
 {
@@ -52,14 +54,22 @@ class VarobjWalker : public IVarWalker, public sigc::trackable
     mutable sigc::signal<void,
                          const IDebugger::VariableSafePtr>
                                         m_visited_variable_signal;
+    mutable sigc::signal<void, unsigned, unsigned> m_walk_progress_signal;
     IDebugger *m_debugger;
     IDebugger::VariableSafePtr m_variable;
     UString m_var_name;
     bool m_do_walk;
     // The count of on going variable unfolding
     int m_variable_unfolds;
+    // The variable nodes of the tree level being walked.  All the
+    // nodes of a level are unfolded at once, before walking the
+    // next level.
+    IDebugger::VariableList m_current_level;
+    // The number of variable nodes visited so far.
+    unsigned m_nb_visited_nodes;
 
     unsigned m_max_depth;
+    unsigned m_max_breadth;
 
     VarobjWalker (); // Don't call this constructor.
 
@@ -70,7 +80,9 @@ public:
         m_debugger (0),
         m_do_walk (false),
         m_variable_unfolds (0),
-        m_max_depth (MAX_DEPTH)
+        m_nb_visited_nodes (0),
+        m_max_depth (MAX_DEPTH),
+        m_max_breadth (MAX_BREADTH)
     {
     }
 
@@ -80,6 +92,7 @@ public:
     sigc::signal<void,
                  const IDebugger::VariableSafePtr>
                                     visited_variable_signal () const;
+    sigc::signal<void, unsigned, unsigned> walk_progress_signal () const;
 
     void connect (IDebugger *a_debugger,
                   const UString &a_var_name);
@@ -97,9 +110,17 @@ public:
 
     unsigned get_maximum_member_depth () const;
 
+    void set_maximum_member_breadth (unsigned a_max_breadth);
+
+    unsigned get_maximum_member_breadth () const;
+
     void do_walk_variable_real (const IDebugger::VariableSafePtr,
                                 unsigned a_max_depth);
 
+    void walk_current_level (unsigned a_max_depth);
+
+    void on_current_level_unfolded (unsigned a_max_depth);
+
     void on_variable_unfolded_signal (const IDebugger::VariableSafePtr a_var,
                                       unsigned max_depth);
 
@@ -120,6 +141,12 @@ VarobjWalker::visited_variable_signal () const
     return m_visited_variable_signal;
 }
 
+sigc::signal<void, unsigned, unsigned>
+VarobjWalker::walk_progress_signal () const
+{
+    return m_walk_progress_signal;
+}
+
 void
 VarobjWalker::connect (IDebugger *a_debugger,
                        const UString &a_var_name)
@@ -202,6 +229,27 @@ VarobjWalker::get_maximum_member_depth () const
     return m_max_depth;
 }
 
+void
+VarobjWalker::set_maximum_member_breadth (unsigned a_max_breadth)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    m_max_breadth = a_max_breadth;
+}
+
+unsigned
+VarobjWalker::get_maximum_member_breadth () const
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    return m_max_breadth;
+}
+
+/// Walk the variable tree rooted at a_var, one level at a time.
+///
+/// \param a_var the root of the variable tree to walk.
+///
+/// \param a_max_depth the maximum number of levels to walk.
 void
 VarobjWalker::do_walk_variable_real (const IDebugger::VariableSafePtr a_var,
                                      unsigned a_max_depth)
@@ -213,39 +261,87 @@ VarobjWalker::do_walk_variable_real (const IDebugger::VariableSafePtr a_var,
     LOG_DD ("internal var name: " << a_var->internal_name ()
             << "depth: " << (int) a_max_depth);
 
-    if (a_max_depth == 0)
+    m_variable_unfolds = 0;
+    m_nb_visited_nodes = 0;
+    m_current_level.clear ();
+    m_current_level.push_back (a_var);
+    walk_current_level (a_max_depth);
+}
+
+/// Unfold all the nodes of the current level that need it.  The
+/// unfolding requests are all issued at once so that the debugger
+/// engine can send them down the wire without waiting for each
+/// result in turn.  Once they are all unfolded,
+/// VarobjWalker::on_current_level_unfolded walks the next level.
+///
+/// \param a_max_depth the maximum number of levels to walk, starting
+/// from the current one.
+void
+VarobjWalker::walk_current_level (unsigned a_max_depth)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    if (a_max_depth == 0 || m_current_level.empty ()) {
+        LOG_DD ("walk finished. visited nodes: " << (int) m_nb_visited_nodes);
+        m_current_level.clear ();
+        THROW_IF_FAIL (m_variable);
+        visited_variable_signal ().emit (m_variable);
         return;
+    }
 
-    if (a_var->needs_unfolding ()
-        && m_debugger->get_language_trait ().is_variable_compound (a_var)) {
-        LOG_DD ("needs unfolding");
-        m_variable_unfolds++;
-        m_debugger->unfold_variable
-            (a_var,
-             sigc::bind (sigc::mem_fun (*this,
-                                   &VarobjWalker::on_variable_unfolded_signal),
-                         a_max_depth - 1));
-    } else if (!a_var->members ().empty ()) {
-        LOG_DD ("children need visiting");
-        visited_variable_node_signal ().emit (a_var);
-        IDebugger::VariableList::const_iterator it;
-        for (it = a_var->members ().begin ();
-             it != a_var->members ().end ();
-             ++ it) {
-            do_walk_variable_real (*it, a_max_depth - 1);
+    IDebugger::VariableList::const_iterator it;
+    for (it = m_current_level.begin (); it != m_current_level.end (); ++it) {
+        if ((*it)->needs_unfolding ()
+            && m_debugger->get_language_trait ().is_variable_compound (*it)) {
+            LOG_DD ("needs unfolding");
+            m_variable_unfolds++;
+            m_debugger->unfold_variable
+                (*it,
+                 sigc::bind (sigc::mem_fun
+                             (*this,
+                              &VarobjWalker::on_variable_unfolded_signal),
+                             a_max_depth));
+        }
+    }
+
+    if (m_variable_unfolds == 0)
+        on_current_level_unfolded (a_max_depth);
+    else
+        walk_progress_signal ().emit (m_nb_visited_nodes,
+                                      m_variable_unfolds);
+}
+
+/// Called when all the nodes of the current level got unfolded.
+/// Visit them and walk their members, which make up the next level.
+///
+/// \param a_max_depth the maximum number of levels to walk, starting
+/// from the current one.
+void
+VarobjWalker::on_current_level_unfolded (unsigned a_max_depth)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    IDebugger::VariableList next_level;
+    IDebugger::VariableList::const_iterator it, member_it;
+    for (it = m_current_level.begin (); it != m_current_level.end (); ++it) {
+        visited_variable_node_signal ().emit (*it);
+        ++m_nb_visited_nodes;
+        unsigned nb_members = 0;
+        for (member_it = (*it)->members ().begin ();
+             member_it != (*it)->members ().end ()
+                 && nb_members < m_max_breadth;
+             ++member_it, ++nb_members) {
+            next_level.push_back (*member_it);
         }
-    } else {
-        LOG_DD ("else finished ?. m_variable_unfolds: "
-                << (int) m_variable_unfolds);
-        visited_variable_node_signal ().emit (a_var);
-        if (m_variable_unfolds == 0)
-            visited_variable_signal ().emit (m_variable);
     }
+    walk_progress_signal ().emit (m_nb_visited_nodes, next_level.size ());
 
+    m_current_level.swap (next_level);
+    walk_current_level (a_max_depth - 1);
 }
 
 void
-VarobjWalker::on_variable_unfolded_signal (const IDebugger::VariableSafePtr a_var,
+VarobjWalker::on_variable_unfolded_signal (const IDebugger::VariableSafePtr,
                                            unsigned a_max_depth)
 {
     LOG_FUNCTION_SCOPE_NORMAL_DD;
@@ -253,12 +349,11 @@ VarobjWalker::on_variable_unfolded_signal (const IDebugger::VariableSafePtr a_va
     NEMIVER_TRY
 
     m_variable_unfolds--;
-    visited_variable_node_signal ().emit (a_var);
-    do_walk_variable_real (a_var, a_max_depth);
-    if (m_variable_unfolds == 0) {
-        THROW_IF_FAIL (m_variable);
-        visited_variable_signal ().emit (m_variable);
-    }
+    if (m_variable_unfolds == 0)
+        on_current_level_unfolded (a_max_depth);
+    else
+        walk_progress_signal ().emit (m_nb_visited_nodes,
+                                      m_variable_unfolds);
 
     NEMIVER_CATCH_NOX
 }
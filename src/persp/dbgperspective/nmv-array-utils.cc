@@ -0,0 +1,336 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <limits>
+#include <glib/gi18n.h>
+#include "common/nmv-str-utils.h"
+#include "nmv-array-utils.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+NEMIVER_BEGIN_NAMESPACE (array_utils)
+
+/// Deduce how to decode elements of a given scalar type.
+///
+/// \param a_type the name of the type of the element, as printed by
+/// the ptype command of GDB.
+///
+/// \return the kind of element, or ELEMENT_KIND_UNSUPPORTED if the
+/// type is not a scalar type we know how to decode.
+ElementKind
+element_type_to_kind (const UString &a_type)
+{
+    std::string type = a_type.raw ();
+    // Qualifiers do not change the layout of the element.
+    const char *qualifiers[] = {"const ", "volatile "};
+    for (unsigned i = 0; i < sizeof (qualifiers) / sizeof (*qualifiers); ++i) {
+        std::string::size_type pos;
+        while ((pos = type.find (qualifiers[i])) != std::string::npos)
+            type.erase (pos, strlen (qualifiers[i]));
+    }
+    str_utils::chomp (type);
+
+    if (type.empty ()
+        || type.find ('*') != std::string::npos
+        || type.find ('{') != std::string::npos
+        || type.find ('[') != std::string::npos
+        || type == "long double")
+        return ELEMENT_KIND_UNSUPPORTED;
+
+    if (type == "float" || type == "double")
+        return ELEMENT_KIND_FLOAT;
+
+    if (!type.compare (0, 9, "unsigned ")
+        || type == "unsigned"
+        || type == "bool"
+        || type == "_Bool"
+        || type == "wchar_t")
+        return ELEMENT_KIND_UNSIGNED;
+
+    if (type.find ("char") != std::string::npos
+        || type.find ("short") != std::string::npos
+        || type.find ("int") != std::string::npos
+        || type.find ("long") != std::string::npos)
+        return ELEMENT_KIND_SIGNED;
+
+    return ELEMENT_KIND_UNSUPPORTED;
+}
+
+/// Parse the first hexadecimal number found in the result of the
+/// evaluation of a pointer expression.  GDB prints things like
+/// "(double (*)[10]) 0x601040 <samples>".
+bool
+parse_address (const UString &a_value, size_t &a_address)
+{
+    std::string::size_type pos = a_value.raw ().find ("0x");
+    if (pos == std::string::npos)
+        return false;
+    std::istringstream is (a_value.raw ().substr (pos));
+    size_t addr = 0;
+    is >> std::hex >> addr;
+    if (is.fail ())
+        return false;
+    a_address = addr;
+    return true;
+}
+
+/// Given the type of an expression, deduce the type of its elements
+/// and the expressions to evaluate to get the address of its
+/// storage, the size of an element and the number of elements.
+///
+/// \param a_expression the expression designating the array.
+///
+/// \param a_type the type of a_expression.  It can be an array, a
+/// pointer or a libstdc++ std::vector.
+///
+/// \param a_layout out parameter.  Set iff the function returns true.
+///
+/// \param a_error out parameter.  The reason why the elements can't
+/// be shown.  Set iff the function returns false.
+///
+/// \return true upon successful completion.
+bool
+type_to_array_layout (const UString &a_expression,
+                      const UString &a_type,
+                      ArrayLayout &a_layout,
+                      UString &a_error)
+{
+    std::string type = a_type.raw ();
+    std::string::size_type pos;
+    ArrayLayout layout;
+
+    if ((pos = type.find ("std::vector<")) != std::string::npos
+        && pos <= strlen ("class ")) {
+        // A libstdc++ std::vector.  Its elements live in
+        // [_M_start, _M_finish).
+        pos += strlen ("std::vector<");
+        std::string::size_type end = type.find_first_of (",>", pos);
+        if (end == std::string::npos) {
+            a_error = _("Could not parse the type of the vector");
+            return false;
+        }
+        layout.elem_type = type.substr (pos, end - pos);
+        layout.elem_type.chomp ();
+        UString impl = "(" + a_expression + ")._M_impl.";
+        if (layout.elem_type == "bool") {
+            // std::vector<bool> packs its elements in the bits of an
+            // array of words.  _M_start and _M_finish are iterators
+            // made of a pointer to a word and of the index of a bit
+            // in that word.
+            UString start = impl + "_M_start.", finish = impl + "_M_finish.";
+            UString word_size = "sizeof (*" + start + "_M_p)";
+            layout.elem_kind = ELEMENT_KIND_BIT;
+            layout.address_expr = start + "_M_p";
+            layout.elem_size_expr = word_size;
+            layout.count_expr = "(" + finish + "_M_p - " + start + "_M_p)"
+                                " * 8 * " + word_size
+                                + " + " + finish + "_M_offset"
+                                + " - " + start + "_M_offset";
+            a_layout = layout;
+            return true;
+        }
+        layout.address_expr = impl + "_M_start";
+        layout.count_expr = impl + "_M_finish - " + impl + "_M_start";
+    } else if ((pos = type.find (" [")) != std::string::npos) {
+        // An array.  Multidimensional arrays are seen as one flat
+        // array of elements.
+        layout.elem_type = type.substr (0, pos);
+        layout.elem_type.chomp ();
+        layout.nb_declared_elems = 1;
+        std::string::size_type cur = pos + 1;
+        while (cur < type.size () && type[cur] == '[') {
+            std::string::size_type close = type.find (']', cur);
+            if (close == std::string::npos)
+                break;
+            layout.nb_declared_elems *=
+                atol (type.substr (cur + 1, close - cur - 1).c_str ());
+            cur = close + 1;
+        }
+        layout.address_expr = "&(" + a_expression + ")";
+    } else if (!type.empty () && type[type.size () - 1] == '*') {
+        // A pointer.  The number of elements must be provided by the
+        // user.
+        layout.elem_type = type.substr (0, type.size () - 1);
+        layout.elem_type.chomp ();
+        layout.address_expr = a_expression;
+    } else {
+        a_error = UString (_("Not an array: ")) + a_type;
+        return false;
+    }
+
+    layout.elem_kind = element_type_to_kind (layout.elem_type);
+    if (layout.elem_kind == ELEMENT_KIND_UNSUPPORTED) {
+        a_error = UString (_("Unsupported element type: ")) + layout.elem_type;
+        return false;
+    }
+    layout.elem_size_expr = "sizeof (" + layout.elem_type + ")";
+    a_layout = layout;
+    return true;
+}
+
+/// \return the number of bytes of the storage of a_nb_elems
+/// elements of size a_elem_size.  Bits are stored in whole words.
+size_t
+storage_size (ElementKind a_kind, size_t a_elem_size, size_t a_nb_elems)
+{
+    if (a_kind != ELEMENT_KIND_BIT)
+        return a_nb_elems * a_elem_size;
+    size_t bits_per_word = 8 * a_elem_size;
+    return (a_nb_elems + bits_per_word - 1) / bits_per_word * a_elem_size;
+}
+
+/// \return the number of elements of size a_elem_size that
+/// a_nb_bytes bytes of storage can hold.
+size_t
+max_nb_elems (ElementKind a_kind, size_t a_elem_size, size_t a_nb_bytes)
+{
+    if (!a_elem_size)
+        return 0;
+    if (a_kind != ELEMENT_KIND_BIT)
+        return a_nb_bytes / a_elem_size;
+    return a_nb_bytes / a_elem_size * a_elem_size * 8;
+}
+
+/// Decode an unsigned integer of a_size bytes, in the byte order of
+/// the host.
+static uint64_t
+read_unsigned (const uint8_t *a_p, size_t a_size)
+{
+    switch (a_size) {
+        case 1: {uint8_t v; memcpy (&v, a_p, 1); return v;}
+        case 2: {uint16_t v; memcpy (&v, a_p, 2); return v;}
+        case 4: {uint32_t v; memcpy (&v, a_p, 4); return v;}
+        case 8: {uint64_t v; memcpy (&v, a_p, 8); return v;}
+    }
+    return 0;
+}
+
+/// Decode element number a_index of a_data as a double, so that it
+/// can be used to compute the statistics and draw the sparkline.
+double
+element_as_double (ElementKind a_kind,
+                   size_t a_elem_size,
+                   const std::vector<uint8_t> &a_data,
+                   size_t a_index)
+{
+    if (a_kind == ELEMENT_KIND_BIT) {
+        size_t bits_per_word = 8 * a_elem_size;
+        uint64_t word =
+            read_unsigned (&a_data[a_index / bits_per_word * a_elem_size],
+                           a_elem_size);
+        return (word >> (a_index % bits_per_word)) & 1;
+    }
+
+    const uint8_t *p = &a_data[a_index * a_elem_size];
+    switch (a_kind) {
+        case ELEMENT_KIND_FLOAT:
+            if (a_elem_size == sizeof (float)) {
+                float f;
+                memcpy (&f, p, sizeof (f));
+                return f;
+            } else if (a_elem_size == sizeof (double)) {
+                double d;
+                memcpy (&d, p, sizeof (d));
+                return d;
+            }
+            break;
+        case ELEMENT_KIND_SIGNED:
+            switch (a_elem_size) {
+                case 1: {int8_t v; memcpy (&v, p, 1); return v;}
+                case 2: {int16_t v; memcpy (&v, p, 2); return v;}
+                case 4: {int32_t v; memcpy (&v, p, 4); return v;}
+                case 8: {int64_t v; memcpy (&v, p, 8); return v;}
+            }
+            break;
+        case ELEMENT_KIND_UNSIGNED:
+            return read_unsigned (p, a_elem_size);
+        default:
+            break;
+    }
+    return 0;
+}
+
+/// Format element number a_index of a_data for the table.
+/// Integers are formatted from their raw bytes so that no precision
+/// is lost.
+UString
+format_element (ElementKind a_kind,
+                size_t a_elem_size,
+                const std::vector<uint8_t> &a_data,
+                size_t a_index)
+{
+    const uint8_t *p = &a_data[0];
+    std::ostringstream os;
+    if (a_kind == ELEMENT_KIND_BIT) {
+        os << (element_as_double (a_kind, a_elem_size, a_data, a_index)
+               ? "true" : "false");
+    } else if (a_kind == ELEMENT_KIND_SIGNED && a_elem_size == 8) {
+        int64_t v;
+        memcpy (&v, p + a_index * a_elem_size, sizeof (v));
+        os << v;
+    } else if (a_kind == ELEMENT_KIND_UNSIGNED && a_elem_size == 8) {
+        os << read_unsigned (p + a_index * a_elem_size, a_elem_size);
+    } else if (a_kind == ELEMENT_KIND_FLOAT) {
+        os.precision (a_elem_size == sizeof (float)
+                      ? std::numeric_limits<float>::digits10
+                      : std::numeric_limits<double>::digits10);
+        os << element_as_double (a_kind, a_elem_size, a_data, a_index);
+    } else {
+        os << (int64_t) element_as_double (a_kind, a_elem_size,
+                                           a_data, a_index);
+    }
+    return os.str ();
+}
+
+/// Compute the minimum, maximum and mean of a set of values.  They
+/// are all zero if the set is empty.
+void
+compute_stats (const std::vector<double> &a_values,
+               double &a_min,
+               double &a_max,
+               double &a_mean)
+{
+    a_min = a_max = a_mean = 0;
+    if (a_values.empty ())
+        return;
+
+    double sum = 0;
+    a_min = std::numeric_limits<double>::max ();
+    a_max = -std::numeric_limits<double>::max ();
+    for (size_t i = 0; i < a_values.size (); ++i) {
+        double v = a_values[i];
+        if (v < a_min)
+            a_min = v;
+        if (v > a_max)
+            a_max = v;
+        sum += v;
+    }
+    a_mean = sum / a_values.size ();
+}
+
+NEMIVER_END_NAMESPACE (array_utils)
+NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,108 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_ARRAY_UTILS_H__
+#define __NMV_ARRAY_UTILS_H__
+
+#include <stdint.h>
+#include <vector>
+#include "common/nmv-ustring.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+NEMIVER_BEGIN_NAMESPACE (array_utils)
+
+using nemiver::common::UString;
+
+/// The way the bytes of an element of an array are to be
+/// interpreted.
+enum ElementKind {
+    ELEMENT_KIND_UNSUPPORTED = 0,
+    ELEMENT_KIND_SIGNED,
+    ELEMENT_KIND_UNSIGNED,
+    ELEMENT_KIND_FLOAT,
+    // The elements are the bits of an array of words, like in a
+    // std::vector<bool>.  The size of an element is then the size
+    // of a word.
+    ELEMENT_KIND_BIT
+};
+
+/// What to ask the debugger to read the storage of an array, given
+/// the type of the expression designating it.
+struct ArrayLayout {
+    // The type of the elements, as shown to the user.
+    UString elem_type;
+    ElementKind elem_kind;
+    // The expressions evaluating to the address of the storage and
+    // to the size of an element of it.
+    UString address_expr;
+    UString elem_size_expr;
+    // The expression evaluating to the number of elements, or empty
+    // if it's given by the type or must be provided by the user.
+    UString count_expr;
+    // The number of elements of an array type, zero otherwise.
+    size_t nb_declared_elems;
+
+    ArrayLayout () :
+        elem_kind (ELEMENT_KIND_UNSUPPORTED),
+        nb_declared_elems (0)
+    {
+    }
+};
+
+ElementKind element_type_to_kind (const UString &a_type);
+
+bool parse_address (const UString &a_value, size_t &a_address);
+
+bool type_to_array_layout (const UString &a_expression,
+                           const UString &a_type,
+                           ArrayLayout &a_layout,
+                           UString &a_error);
+
+size_t storage_size (ElementKind a_kind,
+                     size_t a_elem_size,
+                     size_t a_nb_elems);
+
+size_t max_nb_elems (ElementKind a_kind,
+                     size_t a_elem_size,
+                     size_t a_nb_bytes);
+
+double element_as_double (ElementKind a_kind,
+                          size_t a_elem_size,
+                          const std::vector<uint8_t> &a_data,
+                          size_t a_index);
+
+UString format_element (ElementKind a_kind,
+                        size_t a_elem_size,
+                        const std::vector<uint8_t> &a_data,
+                        size_t a_index);
+
+void compute_stats (const std::vector<double> &a_values,
+                    double &a_min,
+                    double &a_max,
+                    double &a_mean);
+
+NEMIVER_END_NAMESPACE (array_utils)
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_ARRAY_UTILS_H__
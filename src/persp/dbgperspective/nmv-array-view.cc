@@ -0,0 +1,602 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <cstdlib>
+#include <algorithm>
+#include <sstream>
+#include <limits>
+#include <glib/gi18n.h>
+#include <gtkmm/box.h>
+#include <gtkmm/button.h>
+#include <gtkmm/drawingarea.h>
+#include <gtkmm/entry.h>
+#include <gtkmm/label.h>
+#include <gtkmm/liststore.h>
+#include <gtkmm/scrolledwindow.h>
+#include <gtkmm/spinbutton.h>
+#include <gtkmm/treeview.h>
+#include "common/nmv-exception.h"
+#include "nmv-array-view.h"
+#include "nmv-array-utils.h"
+#include "nmv-ui-utils.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+using namespace array_utils;
+
+static const char *COOKIE_ARRAY_VIEW_TYPE = "cookie-array-view-type";
+static const char *COOKIE_ARRAY_VIEW_ADDRESS = "cookie-array-view-address";
+static const char *COOKIE_ARRAY_VIEW_ELEM_SIZE = "cookie-array-view-elem-size";
+static const char *COOKIE_ARRAY_VIEW_COUNT = "cookie-array-view-count";
+static const char *COOKIE_ARRAY_VIEW_READ = "cookie-array-view-read";
+
+/// Number of rows of the table.  The table is paged, not
+/// virtualized: only that many elements are formatted and put into
+/// the tree model at a given time, and scrolling it does not bring
+/// in more.  The page is chosen with the "From index" spin button or
+/// by clicking the sparkline.
+static const size_t ARRAY_VIEW_PAGE_SIZE = 256;
+
+/// Upper bound of the number of bytes read from the inferior for a
+/// given array.  Bigger arrays are truncated.
+static const size_t ARRAY_VIEW_MAX_NB_BYTES = 8 * 1024 * 1024;
+
+struct ArrayColumns : public Gtk::TreeModelColumnRecord {
+    Gtk::TreeModelColumn<unsigned long> index;
+    Gtk::TreeModelColumn<Glib::ustring> value;
+
+    ArrayColumns ()
+    {
+        add (index);
+        add (value);
+    }
+};//end ArrayColumns
+
+static ArrayColumns&
+get_columns ()
+{
+    static ArrayColumns s_cols;
+    return s_cols;
+}
+
+struct ArrayView::Priv {
+    IDebuggerSafePtr debugger;
+    SafePtr<Gtk::Box> vbox;
+    SafePtr<Gtk::Entry> expression_entry;
+    SafePtr<Gtk::SpinButton> nb_elems_spin;
+    SafePtr<Gtk::Button> show_button;
+    SafePtr<Gtk::Label> stats_label;
+    SafePtr<Gtk::DrawingArea> sparkline;
+    SafePtr<Gtk::SpinButton> from_index_spin;
+    SafePtr<Gtk::TreeView> tree_view;
+    Glib::RefPtr<Gtk::ListStore> list_store;
+
+    // The state of the array being inspected.
+    UString expression;
+    UString elem_type;
+    ElementKind elem_kind;
+    size_t elem_size;
+    size_t nb_elems;
+    size_t address;
+    int nb_pending_queries;
+    bool is_up2date;
+
+    // The raw bytes of the array and the elements they decode to.
+    std::vector<uint8_t> raw_data;
+    std::vector<double> values;
+    double min_value;
+    double max_value;
+    double mean_value;
+
+    // Per pixel column minimum and maximum of the values, used to
+    // draw the sparkline.  It's recomputed only when the width of
+    // the sparkline or the data change.
+    std::vector<std::pair<double, double> > sparkline_columns;
+
+    Priv (IDebuggerSafePtr &a_debugger) :
+        debugger (a_debugger),
+        elem_kind (ELEMENT_KIND_UNSUPPORTED),
+        elem_size (0),
+        nb_elems (0),
+        address (0),
+        nb_pending_queries (0),
+        is_up2date (true),
+        min_value (0),
+        max_value (0),
+        mean_value (0)
+    {
+        build_widget ();
+        connect_to_debugger_signals ();
+        connect_to_widget_signals ();
+    }
+
+    void build_widget ()
+    {
+        expression_entry.reset (new Gtk::Entry);
+        nb_elems_spin.reset (new Gtk::SpinButton);
+        nb_elems_spin->set_range (0, std::numeric_limits<int>::max ());
+        nb_elems_spin->set_increments (1, 100);
+        nb_elems_spin->set_tooltip_text
+            (_("Number of elements to show.  Zero means the whole "
+               "array; this must be set for pointers."));
+        show_button.reset (new Gtk::Button (_("Show")));
+
+        Gtk::Box *hbox =
+            Gtk::manage (new Gtk::Box (Gtk::ORIENTATION_HORIZONTAL));
+        hbox->set_spacing (6);
+        hbox->set_border_width (3);
+        hbox->pack_start (*Gtk::manage (new Gtk::Label (_("Expression:"))),
+                          Gtk::PACK_SHRINK);
+        hbox->pack_start (*expression_entry);
+        hbox->pack_start (*Gtk::manage (new Gtk::Label (_("Elements:"))),
+                          Gtk::PACK_SHRINK);
+        hbox->pack_start (*nb_elems_spin, Gtk::PACK_SHRINK);
+        hbox->pack_start (*show_button, Gtk::PACK_SHRINK);
+
+        stats_label.reset (new Gtk::Label);
+        stats_label->set_alignment (0, 0.5);
+        stats_label->set_selectable (true);
+
+        sparkline.reset (new Gtk::DrawingArea);
+        sparkline->set_size_request (-1, 48);
+        sparkline->add_events (Gdk::BUTTON_PRESS_MASK);
+        sparkline->set_tooltip_text
+            (_("Click to show the elements at that position"));
+
+        from_index_spin.reset (new Gtk::SpinButton);
+        from_index_spin->set_range (0, 0);
+        from_index_spin->set_increments (ARRAY_VIEW_PAGE_SIZE,
+                                         ARRAY_VIEW_PAGE_SIZE * 16);
+        Gtk::Box *page_box =
+            Gtk::manage (new Gtk::Box (Gtk::ORIENTATION_HORIZONTAL));
+        page_box->set_spacing (6);
+        page_box->set_border_width (3);
+        page_box->pack_start (*Gtk::manage (new Gtk::Label (_("From index:"))),
+                              Gtk::PACK_SHRINK);
+        page_box->pack_start (*from_index_spin, Gtk::PACK_SHRINK);
+
+        list_store = Gtk::ListStore::create (get_columns ());
+        tree_view.reset (new Gtk::TreeView (list_store));
+        tree_view->append_column (_("Index"), get_columns ().index);
+        tree_view->append_column (_("Value"), get_columns ().value);
+        Gtk::ScrolledWindow *scr = Gtk::manage (new Gtk::ScrolledWindow);
+        scr->set_policy (Gtk::POLICY_AUTOMATIC, Gtk::POLICY_AUTOMATIC);
+        scr->set_shadow_type (Gtk::SHADOW_IN);
+        scr->add (*tree_view);
+
+        vbox.reset (new Gtk::Box (Gtk::ORIENTATION_VERTICAL));
+        vbox->pack_start (*hbox, Gtk::PACK_SHRINK);
+        vbox->pack_start (*stats_label, Gtk::PACK_SHRINK);
+        vbox->pack_start (*sparkline, Gtk::PACK_SHRINK);
+        vbox->pack_start (*page_box, Gtk::PACK_SHRINK);
+        vbox->pack_start (*scr);
+        vbox->show_all ();
+    }
+
+    void connect_to_debugger_signals ()
+    {
+        THROW_IF_FAIL (debugger);
+        debugger->stopped_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_debugger_stopped_signal));
+        debugger->variable_type_set_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_variable_type_set_signal));
+        debugger->variable_value_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_variable_value_signal));
+        debugger->read_memory_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_read_memory_signal));
+    }
+
+    void connect_to_widget_signals ()
+    {
+        show_button->signal_clicked ().connect
+            (sigc::mem_fun (*this, &Priv::on_show_clicked_signal));
+        expression_entry->signal_activate ().connect
+            (sigc::mem_fun (*this, &Priv::on_show_clicked_signal));
+        from_index_spin->signal_value_changed ().connect
+            (sigc::mem_fun (*this, &Priv::on_from_index_changed_signal));
+        sparkline->signal_draw ().connect
+            (sigc::mem_fun (*this, &Priv::on_sparkline_draw_signal));
+        sparkline->signal_button_press_event ().connect
+            (sigc::mem_fun (*this, &Priv::on_sparkline_button_press_signal));
+        tree_view->signal_draw ().connect_notify
+            (sigc::mem_fun (*this, &Priv::on_draw_signal));
+    }
+
+    bool should_process_now ()
+    {
+        THROW_IF_FAIL (tree_view);
+        return tree_view->get_is_drawable ();
+    }
+
+    void clear ()
+    {
+        elem_type.clear ();
+        elem_kind = ELEMENT_KIND_UNSUPPORTED;
+        elem_size = 0;
+        nb_elems = 0;
+        address = 0;
+        nb_pending_queries = 0;
+        raw_data.clear ();
+        values.clear ();
+        sparkline_columns.clear ();
+        min_value = max_value = mean_value = 0;
+        list_store->clear ();
+        from_index_spin->set_range (0, 0);
+        stats_label->set_text ("");
+        sparkline->queue_draw ();
+    }
+
+    void inspect_array (const UString &a_expression)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        clear ();
+        expression = a_expression;
+        expression.chomp ();
+        if (expression.empty ())
+            return;
+
+        if (expression_entry->get_text () != expression)
+            expression_entry->set_text (expression);
+
+        // First, get the type of the expression.  The rest of the
+        // queries depend on it.
+        IDebugger::VariableSafePtr var (new IDebugger::Variable (expression));
+        debugger->get_variable_type (var, COOKIE_ARRAY_VIEW_TYPE);
+    }
+
+    void set_error (const UString &a_message)
+    {
+        nb_pending_queries = 0;
+        stats_label->set_text (a_message);
+    }
+
+    /// Given the type of the inspected expression, deduce the type of
+    /// its elements and the expressions to evaluate to get the
+    /// address of its storage, the size of an element and the number
+    /// of elements.
+    void on_variable_type_set_signal (const IDebugger::VariableSafePtr a_var,
+                                      const UString &a_cookie)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        if (a_cookie != COOKIE_ARRAY_VIEW_TYPE)
+            return;
+
+        NEMIVER_TRY
+
+        THROW_IF_FAIL (a_var);
+        if (a_var->name () != expression)
+            return;
+
+        ArrayLayout layout;
+        UString error;
+        if (!type_to_array_layout (expression, a_var->type (),
+                                   layout, error)) {
+            set_error (error);
+            return;
+        }
+        elem_type = layout.elem_type;
+        elem_kind = layout.elem_kind;
+
+        nb_elems = nb_elems_spin->get_value_as_int ();
+        if (!nb_elems)
+            nb_elems = layout.nb_declared_elems;
+        if (!nb_elems && layout.count_expr.empty ()) {
+            set_error (_("Please set the number of elements to show"));
+            return;
+        }
+
+        nb_pending_queries = 2;
+        debugger->print_variable_value (layout.address_expr,
+                                        COOKIE_ARRAY_VIEW_ADDRESS);
+        debugger->print_variable_value (layout.elem_size_expr,
+                                        COOKIE_ARRAY_VIEW_ELEM_SIZE);
+        if (!nb_elems) {
+            ++nb_pending_queries;
+            debugger->print_variable_value (layout.count_expr,
+                                            COOKIE_ARRAY_VIEW_COUNT);
+        }
+
+        NEMIVER_CATCH
+    }
+
+    void on_variable_value_signal (const UString &,
+                                   const IDebugger::VariableSafePtr a_var,
+                                   const UString &a_cookie)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        if (a_cookie != COOKIE_ARRAY_VIEW_ADDRESS
+            && a_cookie != COOKIE_ARRAY_VIEW_ELEM_SIZE
+            && a_cookie != COOKIE_ARRAY_VIEW_COUNT)
+            return;
+
+        NEMIVER_TRY
+
+        THROW_IF_FAIL (a_var);
+        if (nb_pending_queries <= 0)
+            return;
+
+        if (a_cookie == COOKIE_ARRAY_VIEW_ADDRESS) {
+            if (!parse_address (a_var->value (), address)) {
+                set_error (UString (_("Could not get the address of "))
+                           + expression);
+                return;
+            }
+        } else if (a_cookie == COOKIE_ARRAY_VIEW_ELEM_SIZE) {
+            elem_size = atol (a_var->value ().c_str ());
+        } else if (a_cookie == COOKIE_ARRAY_VIEW_COUNT) {
+            long count = atol (a_var->value ().c_str ());
+            nb_elems = count > 0 ? count : 0;
+        }
+
+        if (--nb_pending_queries)
+            return;
+
+        if (!address || !elem_size || !nb_elems) {
+            set_error (UString (_("Nothing to show for ")) + expression);
+            return;
+        }
+        if (elem_size > sizeof (double)) {
+            set_error (UString (_("Unsupported element type: "))
+                       + elem_type);
+            return;
+        }
+        if (storage_size (elem_kind, elem_size, nb_elems)
+            > ARRAY_VIEW_MAX_NB_BYTES) {
+            LOG_DD ("truncating array of " << (int) nb_elems << " elements");
+            nb_elems = max_nb_elems (elem_kind, elem_size,
+                                     ARRAY_VIEW_MAX_NB_BYTES);
+        }
+        // Now read the whole backing storage at once.
+        debugger->read_memory (address,
+                               storage_size (elem_kind, elem_size, nb_elems),
+                               COOKIE_ARRAY_VIEW_READ);
+
+        NEMIVER_CATCH
+    }
+
+    void on_read_memory_signal (size_t a_address,
+                                const std::vector<uint8_t> &a_bytes,
+                                const UString &a_cookie)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        if (a_cookie != COOKIE_ARRAY_VIEW_READ)
+            return;
+
+        NEMIVER_TRY
+
+        if (a_address != address)
+            return;
+
+        raw_data = a_bytes;
+        nb_elems = std::min (nb_elems, max_nb_elems (elem_kind, elem_size,
+                                                     raw_data.size ()));
+        decode_values ();
+        update_stats_label ();
+
+        from_index_spin->set_range
+            (0, nb_elems > ARRAY_VIEW_PAGE_SIZE
+                ? nb_elems - ARRAY_VIEW_PAGE_SIZE
+                : 0);
+        fill_page ();
+        sparkline_columns.clear ();
+        sparkline->queue_draw ();
+
+        NEMIVER_CATCH
+    }
+
+    void decode_values ()
+    {
+        values.resize (nb_elems);
+        for (size_t i = 0; i < nb_elems; ++i)
+            values[i] = element_as_double (elem_kind, elem_size,
+                                           raw_data, i);
+        compute_stats (values, min_value, max_value, mean_value);
+    }
+
+    void update_stats_label ()
+    {
+        std::ostringstream os;
+        os << nb_elems << " x " << elem_type
+           << "    min: " << min_value
+           << "    max: " << max_value
+           << "    mean: " << mean_value;
+        stats_label->set_text (os.str ());
+    }
+
+    /// Put the page of elements starting at the index selected by the
+    /// user into the table.
+    void fill_page ()
+    {
+        list_store->clear ();
+        size_t from = from_index_spin->get_value_as_int ();
+        size_t to = std::min (from + ARRAY_VIEW_PAGE_SIZE, nb_elems);
+        for (size_t i = from; i < to; ++i) {
+            Gtk::TreeModel::iterator it = list_store->append ();
+            (*it)[get_columns ().index] = i;
+            (*it)[get_columns ().value] =
+                format_element (elem_kind, elem_size, raw_data, i);
+        }
+    }
+
+    void compute_sparkline_columns (int a_width)
+    {
+        sparkline_columns.clear ();
+        if (a_width <= 0 || values.empty ())
+            return;
+        sparkline_columns.resize (a_width);
+        for (int x = 0; x < a_width; ++x) {
+            size_t from = (size_t) x * values.size () / a_width;
+            size_t to = (size_t) (x + 1) * values.size () / a_width;
+            if (to <= from)
+                to = from + 1;
+            double lo = values[from], hi = values[from];
+            for (size_t i = from + 1; i < to && i < values.size (); ++i) {
+                lo = std::min (lo, values[i]);
+                hi = std::max (hi, values[i]);
+            }
+            sparkline_columns[x] = std::make_pair (lo, hi);
+        }
+    }
+
+    bool on_sparkline_draw_signal (const Cairo::RefPtr<Cairo::Context> &a_cr)
+    {
+        NEMIVER_TRY
+
+        int width = sparkline->get_allocated_width ();
+        int height = sparkline->get_allocated_height ();
+        if (values.empty () || width <= 0 || height <= 2)
+            return true;
+
+        if ((int) sparkline_columns.size () != width)
+            compute_sparkline_columns (width);
+
+        double range = max_value - min_value;
+        Gdk::RGBA color =
+            sparkline->get_style_context ()->get_color (Gtk::STATE_FLAG_NORMAL);
+        a_cr->set_source_rgba (color.get_red (),
+                               color.get_green (),
+                               color.get_blue (),
+                               color.get_alpha ());
+        a_cr->set_line_width (1.0);
+        for (int x = 0; x < width; ++x) {
+            double lo = 0.5, hi = 0.5;
+            if (range > 0) {
+                lo = (sparkline_columns[x].first - min_value) / range;
+                hi = (sparkline_columns[x].second - min_value) / range;
+            }
+            a_cr->move_to (x + 0.5, 1 + (1 - lo) * (height - 2));
+            a_cr->line_to (x + 0.5, 1 + (1 - hi) * (height - 2) - 0.5);
+        }
+        a_cr->stroke ();
+
+        NEMIVER_CATCH
+        return true;
+    }
+
+    bool on_sparkline_button_press_signal (GdkEventButton *a_event)
+    {
+        NEMIVER_TRY
+
+        int width = sparkline->get_allocated_width ();
+        if (!a_event || width <= 0 || values.empty ())
+            return false;
+        size_t index = (size_t) (a_event->x * values.size () / width);
+        from_index_spin->set_value (index);
+
+        NEMIVER_CATCH
+        return true;
+    }
+
+    void on_from_index_changed_signal ()
+    {
+        NEMIVER_TRY
+        fill_page ();
+        NEMIVER_CATCH
+    }
+
+    void on_show_clicked_signal ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        NEMIVER_TRY
+        inspect_array (expression_entry->get_text ());
+        NEMIVER_CATCH
+    }
+
+    void on_debugger_stopped_signal (IDebugger::StopReason a_reason,
+                                     bool /*a_has_frame*/,
+                                     const IDebugger::Frame &/*a_frame*/,
+                                     int /*a_thread_id*/,
+                                     const string &/*a_bp_num*/,
+                                     const UString &/*a_cookie*/)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (IDebugger::is_exited (a_reason) || expression.empty ())
+            return;
+
+        if (should_process_now ())
+            inspect_array (expression);
+        else
+            is_up2date = false;
+
+        NEMIVER_CATCH
+    }
+
+    void on_draw_signal (const Cairo::RefPtr<Cairo::Context> &)
+    {
+        NEMIVER_TRY
+
+        if (!is_up2date) {
+            is_up2date = true;
+            inspect_array (expression);
+        }
+
+        NEMIVER_CATCH
+    }
+};//end struct ArrayView::Priv
+
+ArrayView::ArrayView (IDebuggerSafePtr &a_debugger)
+{
+    m_priv.reset (new Priv (a_debugger));
+}
+
+ArrayView::~ArrayView ()
+{
+}
+
+Gtk::Widget&
+ArrayView::widget () const
+{
+    THROW_IF_FAIL (m_priv && m_priv->vbox);
+    return *m_priv->vbox;
+}
+
+/// Show the elements of the array designated by an expression.
+///
+/// \param a_expression an expression of array, pointer or
+/// std::vector type, which elements are of scalar type.
+void
+ArrayView::inspect_array (const UString &a_expression)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->inspect_array (a_expression);
+}
+
+void
+ArrayView::clear ()
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->clear ();
+    m_priv->expression.clear ();
+    m_priv->expression_entry->set_text ("");
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,65 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_ARRAY_VIEW_H__
+#define __NMV_ARRAY_VIEW_H__
+
+#include <gtkmm/widget.h>
+#include "common/nmv-object.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "nmv-i-debugger.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// A view that displays arrays of scalar elements (e.g, double
+/// samples[500000], or the storage of a std::vector<float> or of a
+/// std::vector<bool>).
+///
+/// Rather than creating one variable object per element, the view
+/// asks the debugger for the type of the array, the address of its
+/// storage and the size of an element, reads the whole backing
+/// storage with a single memory read and decodes the elements
+/// locally, see array_utils.  The table is paged rather than
+/// virtualized: it holds one page of elements, which the user picks
+/// with a spin button or by clicking the sparkline.
+class NEMIVER_API ArrayView : public nemiver::common::Object {
+    //non copyable
+    ArrayView (const ArrayView&);
+    ArrayView& operator= (const ArrayView&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+public:
+
+    ArrayView (IDebuggerSafePtr &a_debugger);
+    virtual ~ArrayView ();
+    Gtk::Widget& widget () const;
+    void inspect_array (const UString &a_expression);
+    void clear ();
+};//end ArrayView
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_ARRAY_VIEW_H__
@@ -29,6 +29,7 @@
 #include <gtkmm/liststore.h>
 #include <gtkmm/treerowreference.h>
 #include "common/nmv-exception.h"
+#include "common/nmv-str-utils.h"
 #include "nmv-breakpoints-view.h"
 #include "nmv-ui-utils.h"
 #include "nmv-i-workbench.h"
@@ -50,6 +51,9 @@ struct BPColumns : public Gtk::TreeModelColumnRecord {
     Gtk::TreeModelColumn<int> hits;
     Gtk::TreeModelColumn<Glib::ustring> expression;
     Gtk::TreeModelColumn<int> ignore_count;
+    // The id of the thread the breakpoint is restricted to, or an
+    // empty string if it stops any thread.
+    Gtk::TreeModelColumn<Glib::ustring> thread;
     Gtk::TreeModelColumn<IDebugger::Breakpoint> breakpoint;
     Gtk::TreeModelColumn<bool> is_standard;
 
@@ -65,7 +69,8 @@ struct BPColumns : public Gtk::TreeModelColumnRecord {
         TYPE_INDEX,
         HITS_INDEX,
         EXPRESSION_INDEX,
-        IGNORE_COUNT_INDEX
+        IGNORE_COUNT_INDEX,
+        THREAD_INDEX
     };
 
     BPColumns ()
@@ -83,6 +88,7 @@ struct BPColumns : public Gtk::TreeModelColumnRecord {
         add (hits);
         add (expression);
         add (ignore_count);
+        add (thread);
         add (is_standard);
     }
 };//end Cols
@@ -98,6 +104,9 @@ struct BreakpointsView::Priv {
 public:
     SafePtr<Gtk::TreeView> tree_view;
     Glib::RefPtr<Gtk::ListStore> list_store;
+    // The rows of list_store, by breakpoint id.  The iterators of a
+    // Gtk::ListStore stay valid until their row is removed.
+    std::map<string, Gtk::TreeModel::iterator> rows;
     Gtk::Widget *breakpoints_menu;
     sigc::signal<void,
                  const IDebugger::Breakpoint&> go_to_breakpoint_signal;
@@ -123,6 +132,8 @@ public:
         // breakpoints has changed.
         debugger->breakpoint_deleted_signal ().connect (sigc::mem_fun
                 (*this, &Priv::on_debugger_breakpoint_deleted_signal));
+        debugger->breakpoint_modified_signal ().connect (sigc::mem_fun
+                (*this, &Priv::on_debugger_breakpoint_modified_signal));
         debugger->breakpoints_set_signal ().connect
             (sigc::mem_fun (*this, &Priv::on_debugger_breakpoints_set_signal));
         debugger->breakpoints_list_signal ().connect (sigc::mem_fun
@@ -158,9 +169,11 @@ public:
         tree_view->append_column (_("Hits"), get_bp_cols ().hits);
         tree_view->append_column (_("Expression"),
                                   get_bp_cols ().expression);
+        tree_view->append_column_editable (_("Ignore count"),
+                                           get_bp_cols ().ignore_count);
         nb_columns =
-            tree_view->append_column_editable (_("Ignore count"),
-                                               get_bp_cols ().ignore_count);
+            tree_view->append_column_editable (_("Thread"),
+                                               get_bp_cols ().thread);
 	
 	for (int i = 0; i < nb_columns; ++i) {
             Gtk::TreeViewColumn *col = tree_view->get_column (i);
@@ -202,6 +215,12 @@ public:
 	  (sigc::mem_fun
 	   (*this, &BreakpointsView::Priv::on_breakpoint_condition_edited));
 
+        r = dynamic_cast<Gtk::CellRendererText*>
+            (tree_view->get_column_cell_renderer (BPColumns::THREAD_INDEX));
+        r->signal_edited ().connect
+            (sigc::mem_fun
+             (*this, &BreakpointsView::Priv::on_breakpoint_thread_edited));
+
         // we must handle the button press event before the default button
         // handler since there are cases when we need to prevent the default
         // handler from running
@@ -323,18 +342,32 @@ public:
     Gtk::TreeModel::iterator
     find_breakpoint_in_model (const IDebugger::Breakpoint &a_breakpoint)
     {
-        THROW_IF_FAIL (list_store);
+        std::map<string, Gtk::TreeModel::iterator>::const_iterator row =
+            rows.find (a_breakpoint.id ());
+        if (row == rows.end ())
+            // Breakpoint not found in model, return an invalid iter
+            return Gtk::TreeModel::iterator();
+        return row->second;
+    }
 
-        Gtk::TreeModel::iterator iter;
-        for (iter = list_store->children ().begin ();
-             iter != list_store->children ().end ();
-             ++iter) {
-            if ((*iter)[get_bp_cols ().id] == a_breakpoint.id ()) {
-                return iter;
-            }
-        }
-        // Breakpoint not found in model, return an invalid iter
-        return Gtk::TreeModel::iterator();
+    /// Remove the row of a given breakpoint id, if any.
+    void
+    erase_row (const string &a_id)
+    {
+        std::map<string, Gtk::TreeModel::iterator>::iterator row =
+            rows.find (a_id);
+        if (row == rows.end ())
+            return;
+        list_store->erase (row->second);
+        rows.erase (row);
+    }
+
+    void
+    clear_rows ()
+    {
+        rows.clear ();
+        if (list_store)
+            list_store->clear ();
     }
 
     void
@@ -355,6 +388,10 @@ public:
         (*a_iter)[get_bp_cols ().expression] = a_breakpoint.expression ();
         (*a_iter)[get_bp_cols ().ignore_count] =
                                         a_breakpoint.ignore_count ();
+        (*a_iter)[get_bp_cols ().thread] =
+                                (a_breakpoint.is_thread_specific ())
+                                ? UString::from_int (a_breakpoint.thread_id ())
+                                : UString ();
         (*a_iter)[get_bp_cols ().is_standard] = false;
         (*a_iter)[get_bp_cols ().is_countpoint] =
             debugger->is_countpoint (a_breakpoint);
@@ -387,7 +424,12 @@ public:
                 append_breakpoint (*bi);
             }
         } else {
-            Gtk::TreeModel::iterator tree_iter = list_store->append ();
+            Gtk::TreeModel::iterator tree_iter =
+                find_breakpoint_in_model (a_bp);
+            if (!tree_iter) {
+                tree_iter = list_store->append ();
+                rows[a_bp.id ()] = tree_iter;
+            }
             update_breakpoint (tree_iter, a_bp);
         }
     }
@@ -434,7 +476,28 @@ public:
     void
     init_actions()
     {
+        Gtk::StockID nil_stock_id ("");
         static ui_utils::ActionEntry s_breakpoints_action_entries [] = {
+            {
+                "EnableBreakpointsMenuItemAction",
+                nil_stock_id,
+                _("_Enable"),
+                _("Enable the selected breakpoints"),
+                sigc::mem_fun (*this, &Priv::on_breakpoints_enable_action),
+                ui_utils::ActionEntry::DEFAULT,
+                "",
+                false
+            },
+            {
+                "DisableBreakpointsMenuItemAction",
+                nil_stock_id,
+                _("D_isable"),
+                _("Disable the selected breakpoints"),
+                sigc::mem_fun (*this, &Priv::on_breakpoints_disable_action),
+                ui_utils::ActionEntry::DEFAULT,
+                "",
+                false
+            },
             {
                 "DeleteBreakpointMenuItemAction",
                 Gtk::Stock::DELETE,
@@ -483,22 +546,8 @@ public:
     void
     erase_breakpoint (const string &a_bp_num)
     {
-
         LOG_DD ("asked to erase bp num:" << a_bp_num);
-
-        Gtk::TreeModel::iterator iter;
-        for (iter = list_store->children ().begin ();
-             iter != list_store->children ().end ();
-             ++iter) {
-            if ((*iter)[get_bp_cols ().id] == a_bp_num) {
-                break;
-            }
-        }
-
-        if (iter != list_store->children ().end ()) {
-            LOG_DD ("erased bp");
-            list_store->erase (iter);
-        }
+        erase_row (a_bp_num);
     }
 
     void 
@@ -549,24 +598,34 @@ public:
                                            const UString &/*a_cookie*/)
     {
         NEMIVER_TRY
-        list<Gtk::TreeModel::iterator> iters_to_erase;
-        for (Gtk::TreeModel::iterator iter = list_store->children ().begin ();
-             iter != list_store->children ().end ();
-             ++iter) {
-            IDebugger::Breakpoint bp = (*iter)[get_bp_cols ().breakpoint];
-            if (bp.parent_id () == a_break_number) {
-                iters_to_erase.push_back (iter);
-            }
-        }
-        list<Gtk::TreeModel::iterator>::iterator it;
-        for (it = iters_to_erase.begin ();
-             it != iters_to_erase.end ();
-             ++it) {
-            list_store->erase (*it);
+        // Erase the row of the breakpoint, or the rows of its
+        // sub-breakpoints, which ids are prefixed by "<number>.".
+        erase_row (a_break_number);
+        string prefix = a_break_number + ".";
+        std::map<string, Gtk::TreeModel::iterator>::iterator row =
+            rows.lower_bound (prefix);
+        while (row != rows.end ()
+               && !row->first.compare (0, prefix.size (), prefix)) {
+            list_store->erase (row->second);
+            rows.erase (row++);
         }
         NEMIVER_CATCH
     }
 
+    void
+    on_debugger_breakpoint_modified_signal
+                                (const IDebugger::Breakpoint &a_break,
+                                 const string &/*a_break_number*/,
+                                 const UString &/*a_cookie*/)
+    {
+        NEMIVER_TRY
+        // This doesn't look at the other rows, so updating a
+        // breakpoint costs the same however many breakpoints there
+        // are.
+        append_breakpoint (a_break);
+        NEMIVER_CATCH
+    }
+
     void
     on_debugger_breakpoints_set_signal
     (const std::map<string, IDebugger::Breakpoint> &a,
@@ -671,8 +730,9 @@ public:
         }
     }
 
+    /// Get the IDs of the selected breakpoints.
     void
-    on_breakpoint_delete_action ()
+    get_selected_breakpoint_ids (vector<string> &a_ids)
     {
         THROW_IF_FAIL (tree_view)
         THROW_IF_FAIL (list_store);
@@ -686,11 +746,42 @@ public:
             tree_iter = list_store->get_iter (*it);
             if (tree_iter) {
                 Glib::ustring bp_id = (*tree_iter)[get_bp_cols ().id];
-                debugger->delete_breakpoint (bp_id);
+                a_ids.push_back (bp_id);
             }
         }
     }
 
+    void
+    on_breakpoint_delete_action ()
+    {
+        vector<string> ids;
+        get_selected_breakpoint_ids (ids);
+        if (!ids.empty ())
+            debugger->delete_breakpoints (ids);
+    }
+
+    void
+    on_breakpoints_enable_action ()
+    {
+        NEMIVER_TRY
+        vector<string> ids;
+        get_selected_breakpoint_ids (ids);
+        if (!ids.empty ())
+            debugger->enable_breakpoints (ids);
+        NEMIVER_CATCH
+    }
+
+    void
+    on_breakpoints_disable_action ()
+    {
+        NEMIVER_TRY
+        vector<string> ids;
+        get_selected_breakpoint_ids (ids);
+        if (!ids.empty ())
+            debugger->disable_breakpoints (ids);
+        NEMIVER_CATCH
+    }
+
     void
     on_draw_signal (const Cairo::RefPtr<Cairo::Context> &)
     {
@@ -804,6 +895,41 @@ public:
         NEMIVER_CATCH
     }
 
+    /// Restrict the breakpoint to the thread which id was typed by
+    /// the user, or let it stop any thread if the cell was cleared.
+    void
+    on_breakpoint_thread_edited (const Glib::ustring &a_path,
+                                 const Glib::ustring &a_text)
+    {
+        NEMIVER_TRY
+
+        Gtk::TreeModel::iterator it = tree_view->get_model ()->get_iter (a_path);
+        if (!it)
+            return;
+
+        IDebugger::Breakpoint bp = (*it)[get_bp_cols ().breakpoint];
+        if (bp.type () == IDebugger::Breakpoint::WATCHPOINT_TYPE)
+            return;
+
+        // An empty cell means any thread.  Anything but a thread
+        // number is rejected, rather than read as 0.
+        UString text (a_text);
+        text.chomp ();
+        int thread_id = -1;
+        if (str_utils::string_is_decimal_number (text.raw ()))
+            thread_id = atoi (text.raw ().c_str ());
+        else
+            LOG_ERROR ("not a thread id: " << text);
+        if (thread_id >= 0 && thread_id != bp.thread_id ())
+            debugger->set_breakpoint_thread (bp.id (), thread_id);
+        else
+            // Show the thread of the breakpoint again, rather than
+            // what was typed.
+            update_breakpoint (it, bp);
+
+        NEMIVER_CATCH
+    }
+
 };//end class BreakpointsView::Priv
 
 BreakpointsView::BreakpointsView (IWorkbench& a_workbench,
@@ -839,9 +965,7 @@ void
 BreakpointsView::clear ()
 {
     THROW_IF_FAIL (m_priv);
-    if (m_priv->list_store) {
-        m_priv->list_store->clear ();
-    }
+    m_priv->clear_rows ();
 }
 
 void
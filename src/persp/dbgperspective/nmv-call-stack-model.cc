@@ -0,0 +1,841 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <map>
+#include <algorithm>
+#include <glib/gi18n.h>
+#include "common/nmv-exception.h"
+#include "nmv-call-stack-model.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+CallStackCols&
+get_call_stack_columns ()
+{
+    static CallStackCols s_cols;
+    return s_cols;
+}
+
+template <class T>
+static void
+set_value (Glib::ValueBase &a_value, const T &a_content)
+{
+    Glib::Value<T> value;
+    value.init (Glib::Value<T>::value_type ());
+    value.set (a_content);
+    a_value.init (value.gobj ());
+}
+
+struct CallStackModel::Priv {
+    struct Entry {
+        IDebugger::Frame frame;
+        // The formatted arguments, with the full values of the
+        // aggregates if has_full_args is true, or only their type.
+        UString args;
+        bool has_args;
+        bool has_full_args;
+
+        Entry () :
+            has_args (false),
+            has_full_args (false)
+        {
+        }
+    };
+
+    /// A run of consecutive frames of the same function, shown as a
+    /// single row.
+    struct Run {
+        int first;
+        int last;
+        int row;
+        // The number of levels hidden by the runs before this one.
+        int shift_before;
+    };
+
+    struct RunLevelLess {
+        bool operator() (int a_level, const Run &a_run) const
+        {
+            return a_level < a_run.first;
+        }
+    };
+
+    struct RunRowLess {
+        bool operator() (int a_row, const Run &a_run) const
+        {
+            return a_row < a_run.row;
+        }
+    };
+
+    typedef std::map<int, Entry> EntryMap;
+    typedef std::map<int, int> RunMap;
+
+    CallStackModel &model;
+    int depth;
+    int stamp;
+    EntryMap cache;
+    // Maps the first level of each run to its last level.
+    RunMap runs;
+    // The runs put aside while collapse_recursion is off.  The frames
+    // strictly inside them might have been evicted, so the runs
+    // couldn't be found again from the cached frames alone.
+    RunMap hidden_runs;
+    // The runs in order, with their row.  Rebuilt from runs when
+    // needed.
+    std::vector<Run> run_index;
+    bool run_index_is_dirty;
+    int nb_hidden_levels;
+    bool collapse_recursion;
+    unsigned max_cached_frames;
+
+    Priv (CallStackModel &a_model) :
+        model (a_model),
+        depth (0),
+        stamp (1),
+        run_index_is_dirty (false),
+        nb_hidden_levels (0),
+        collapse_recursion (true),
+        max_cached_frames (CallStackModel::DEFAULT_MAX_CACHED_FRAMES)
+    {
+    }
+
+    void
+    update_run_index ()
+    {
+        if (!run_index_is_dirty)
+            return;
+
+        run_index.clear ();
+        run_index.reserve (runs.size ());
+        int shift = 0;
+        for (RunMap::const_iterator it = runs.begin ();
+             it != runs.end ();
+             ++it) {
+            Run run;
+            run.first = it->first;
+            run.last = it->second;
+            run.row = it->first - shift;
+            run.shift_before = shift;
+            run_index.push_back (run);
+            shift += it->second - it->first;
+        }
+        nb_hidden_levels = shift;
+        run_index_is_dirty = false;
+    }
+
+    /// \return the last run which first level is at most a_level,
+    /// or nil if there is none.
+    const Run*
+    run_at_or_before_level (int a_level)
+    {
+        update_run_index ();
+        std::vector<Run>::const_iterator it =
+            std::upper_bound (run_index.begin (), run_index.end (),
+                              a_level, RunLevelLess ());
+        if (it == run_index.begin ())
+            return 0;
+        return &*--it;
+    }
+
+    /// \return the last run which row is at most a_row, or nil if
+    /// there is none.
+    const Run*
+    run_at_or_before_row (int a_row)
+    {
+        update_run_index ();
+        std::vector<Run>::const_iterator it =
+            std::upper_bound (run_index.begin (), run_index.end (),
+                              a_row, RunRowLess ());
+        if (it == run_index.begin ())
+            return 0;
+        return &*--it;
+    }
+
+    int
+    nb_rows ()
+    {
+        update_run_index ();
+        return depth - nb_hidden_levels;
+    }
+
+    int
+    row_of_level (int a_level)
+    {
+        const Run *run = run_at_or_before_level (a_level);
+        if (!run)
+            return a_level;
+        if (a_level <= run->last)
+            return run->row;
+        return a_level - run->shift_before - (run->last - run->first);
+    }
+
+    int
+    level_of_row (int a_row)
+    {
+        const Run *run = run_at_or_before_row (a_row);
+        if (!run)
+            return a_row;
+        if (a_row == run->row)
+            return run->first;
+        return a_row + run->shift_before + (run->last - run->first);
+    }
+
+    int
+    last_level_of_row (int a_row)
+    {
+        const Run *run = run_at_or_before_row (a_row);
+        if (run && a_row == run->row)
+            return run->last;
+        return level_of_row (a_row);
+    }
+
+    bool
+    same_function (int a_level1, int a_level2) const
+    {
+        EntryMap::const_iterator it1 = cache.find (a_level1),
+                                 it2 = cache.find (a_level2);
+        if (it1 == cache.end () || it2 == cache.end ())
+            return false;
+        const IDebugger::Frame &f1 = it1->second.frame,
+                               &f2 = it2->second.frame;
+        return (!f1.function_name ().empty ()
+                && f1.function_name () == f2.function_name ()
+                && f1.file_name () == f2.file_name ()
+                && f1.library () == f2.library ());
+    }
+
+    /// \return the run containing a_level, or runs.end ().
+    RunMap::iterator
+    find_run (int a_level)
+    {
+        RunMap::iterator it = runs.upper_bound (a_level);
+        if (it == runs.begin ())
+            return runs.end ();
+        --it;
+        if (it->second < a_level)
+            return runs.end ();
+        return it;
+    }
+
+    void
+    make_iter (int a_row, iterator &a_iter) const
+    {
+        a_iter.set_stamp (stamp);
+        a_iter.gobj ()->user_data = GINT_TO_POINTER (a_row);
+    }
+
+    int
+    row_of_iter (const iterator &a_iter) const
+    {
+        return GPOINTER_TO_INT (a_iter.gobj ()->user_data);
+    }
+
+    bool
+    is_valid (const iterator &a_iter)
+    {
+        if (a_iter.get_stamp () != stamp)
+            return false;
+        int row = row_of_iter (a_iter);
+        return row >= 0 && row < nb_rows ();
+    }
+
+    void
+    emit_row_changed (int a_row)
+    {
+        Gtk::TreeModel::Path path;
+        path.push_back (a_row);
+        iterator iter;
+        make_iter (a_row, iter);
+        model.row_changed (path, iter);
+    }
+
+    /// Join the row of a_level - 1 and the row of a_level into a
+    /// single run.  If a_emit is true, tell the views about the row
+    /// that goes away.
+    void
+    join_with_previous_level (int a_level, bool a_emit)
+    {
+        int first = a_level - 1, last = a_level;
+        RunMap::iterator prev = find_run (a_level - 1);
+        if (prev != runs.end ()) {
+            if (prev->second >= a_level)
+                // Already joined.
+                return;
+            first = prev->first;
+        }
+        RunMap::iterator next = runs.find (a_level);
+        if (next != runs.end ())
+            last = next->second;
+
+        int deleted_row = row_of_level (a_level);
+        int kept_row = row_of_level (first);
+
+        if (next != runs.end ())
+            runs.erase (next);
+        runs[first] = last;
+        run_index_is_dirty = true;
+
+        if (a_emit) {
+            Gtk::TreeModel::Path path;
+            path.push_back (deleted_row);
+            model.row_deleted (path);
+            emit_row_changed (kept_row);
+        }
+    }
+
+    /// Forget the frames that are not needed anymore.
+    ///
+    /// The frames strictly inside a run are never shown, and only
+    /// the last frame of a run is needed to extend it, so they go
+    /// first.  Then, while there are too many frames, the frames
+    /// the farthest from [a_low, a_high] go.
+    void
+    evict_frames (int a_low, int a_high)
+    {
+        for (RunMap::const_iterator it = runs.begin ();
+             it != runs.end ();
+             ++it) {
+            if (it->second - it->first < 2)
+                continue;
+            cache.erase (cache.upper_bound (it->first),
+                         cache.lower_bound (it->second));
+        }
+
+        int middle = a_low + (a_high - a_low) / 2;
+        while (cache.size () > max_cached_frames) {
+            int lowest = cache.begin ()->first,
+                highest = cache.rbegin ()->first;
+            if (middle - lowest > highest - middle)
+                cache.erase (cache.begin ());
+            else
+                cache.erase (--cache.end ());
+        }
+    }
+
+    void
+    set_frames (const std::vector<IDebugger::Frame> &a_frames)
+    {
+        if (a_frames.empty ())
+            return;
+
+        int low = a_frames.front ().level (),
+            high = a_frames.back ().level ();
+        std::vector<IDebugger::Frame>::const_iterator it;
+        for (it = a_frames.begin (); it != a_frames.end (); ++it) {
+            if (it->level () < 0 || it->level () >= depth)
+                continue;
+            cache[it->level ()].frame = *it;
+        }
+
+        if (collapse_recursion) {
+            for (int level = std::max (low, 1);
+                 level <= high + 1 && level < depth;
+                 ++level) {
+                if (same_function (level - 1, level))
+                    join_with_previous_level (level, true);
+            }
+        }
+
+        int prev_row = -1;
+        for (int level = low; level <= high && level < depth; ++level) {
+            int row = row_of_level (level);
+            if (row != prev_row)
+                emit_row_changed (row);
+            prev_row = row;
+        }
+
+        evict_frames (low, high);
+    }
+
+    void
+    set_frames_arguments (const std::map<int, IDebugger::VariableList> &a_args,
+                          bool a_full_values)
+    {
+        std::map<int, IDebugger::VariableList>::const_iterator it;
+        for (it = a_args.begin (); it != a_args.end (); ++it) {
+            EntryMap::iterator entry = cache.find (it->first);
+            if (entry == cache.end ())
+                continue;
+            // Don't let the simple values of a later listing hide
+            // the full ones.
+            if (!a_full_values && entry->second.has_full_args)
+                continue;
+            CallStackModel::format_args_string (it->second,
+                                                entry->second.args);
+            entry->second.has_args = true;
+            entry->second.has_full_args = a_full_values;
+            int row = row_of_level (it->first);
+            if (level_of_row (row) == it->first)
+                emit_row_changed (row);
+        }
+    }
+
+    void
+    rebuild_runs ()
+    {
+        run_index_is_dirty = true;
+        if (!collapse_recursion) {
+            hidden_runs.swap (runs);
+            runs.clear ();
+            return;
+        }
+        // Start from the runs known before collapsing was turned
+        // off, then join the frames fetched since then.
+        runs.swap (hidden_runs);
+        hidden_runs.clear ();
+        for (EntryMap::const_iterator it = cache.begin ();
+             it != cache.end ();
+             ++it) {
+            if (it->first > 0 && same_function (it->first - 1, it->first))
+                join_with_previous_level (it->first, false);
+        }
+    }
+};//end struct CallStackModel::Priv
+
+CallStackModel::CallStackModel () :
+    Glib::ObjectBase (typeid (CallStackModel)),
+    Glib::Object ()
+{
+    m_priv.reset (new Priv (*this));
+}
+
+CallStackModel::~CallStackModel ()
+{
+}
+
+Glib::RefPtr<CallStackModel>
+CallStackModel::create ()
+{
+    return Glib::RefPtr<CallStackModel> (new CallStackModel);
+}
+
+/// Forget all the frames and set the depth of the stack.
+///
+/// This doesn't tell the views about the rows that come and go, so
+/// the model should be unset from its views first.
+///
+/// \param a_depth the number of frames of the stack.
+void
+CallStackModel::reset (int a_depth)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->depth = std::max (a_depth, 0);
+    ++m_priv->stamp;
+    m_priv->cache.clear ();
+    m_priv->runs.clear ();
+    m_priv->hidden_runs.clear ();
+    m_priv->run_index_is_dirty = true;
+}
+
+/// \return the number of frames of the stack.
+int
+CallStackModel::depth () const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->depth;
+}
+
+/// \return the number of rows of the model.  That is the depth of
+/// the stack minus the frames hidden in recursion runs.
+int
+CallStackModel::nb_rows () const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->nb_rows ();
+}
+
+/// Hand frames to the model.  The rows of the frames are updated
+/// and, if collapse_recursion is set, joined with their neighbours
+/// that are frames of the same function.
+///
+/// \param a_frames the frames, in increasing level order.
+void
+CallStackModel::set_frames (const std::vector<IDebugger::Frame> &a_frames)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->set_frames (a_frames);
+}
+
+/// Hand the arguments of some frames to the model.  The arguments of
+/// the frames the model doesn't hold are ignored.
+///
+/// \param a_args the arguments, per frame level.
+///
+/// \param a_full_values true if a_args holds the full values of the
+/// arguments, rather than only the type of the aggregates.
+void
+CallStackModel::set_frames_arguments
+                    (const std::map<int, IDebugger::VariableList> &a_args,
+                     bool a_full_values)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->set_frames_arguments (a_args, a_full_values);
+}
+
+/// \return true if the model holds the frame at a_level.
+bool
+CallStackModel::has_frame (int a_level) const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->cache.find (a_level) != m_priv->cache.end ();
+}
+
+/// \param a_level the level of the frame to get.
+///
+/// \param a_frame out parameter.  Set to the frame at a_level.
+///
+/// \return true if the model holds the frame at a_level.
+bool
+CallStackModel::get_frame (int a_level, IDebugger::Frame &a_frame) const
+{
+    THROW_IF_FAIL (m_priv);
+    Priv::EntryMap::const_iterator it = m_priv->cache.find (a_level);
+    if (it == m_priv->cache.end ())
+        return false;
+    a_frame = it->second.frame;
+    return true;
+}
+
+/// \param a_level the level of the frame to consider.
+///
+/// \param a_args out parameter.  Set to the arguments of the frame at
+/// a_level, formatted as "(name = value, ...)".
+///
+/// \return true if the model holds the arguments of that frame.
+bool
+CallStackModel::get_frame_arguments (int a_level, UString &a_args) const
+{
+    THROW_IF_FAIL (m_priv);
+    Priv::EntryMap::const_iterator it = m_priv->cache.find (a_level);
+    if (it == m_priv->cache.end () || !it->second.has_args)
+        return false;
+    a_args = it->second.args;
+    return true;
+}
+
+/// \return true if the model holds the full values of the
+/// arguments of the frame at a_level.
+bool
+CallStackModel::has_full_frame_arguments (int a_level) const
+{
+    THROW_IF_FAIL (m_priv);
+    Priv::EntryMap::const_iterator it = m_priv->cache.find (a_level);
+    return it != m_priv->cache.end () && it->second.has_full_args;
+}
+
+/// \param a_levels out parameter.  Set to the levels of the frames
+/// the model holds, in increasing order.
+void
+CallStackModel::get_cached_levels (std::vector<int> &a_levels) const
+{
+    THROW_IF_FAIL (m_priv);
+    a_levels.clear ();
+    a_levels.reserve (m_priv->cache.size ());
+    for (Priv::EntryMap::const_iterator it = m_priv->cache.begin ();
+         it != m_priv->cache.end ();
+         ++it)
+        a_levels.push_back (it->first);
+}
+
+/// \return the level of the frame shown at a_row.  For the row of a
+/// recursion run, that is the level of its innermost frame.
+int
+CallStackModel::level_of_row (int a_row) const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->level_of_row (a_row);
+}
+
+/// \return the level of the last frame shown at a_row.  That is
+/// level_of_row (a_row), unless a_row is the row of a recursion run.
+int
+CallStackModel::last_level_of_row (int a_row) const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->last_level_of_row (a_row);
+}
+
+/// \return the row showing the frame at a_level.
+int
+CallStackModel::row_of_level (int a_level) const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->row_of_level (a_level);
+}
+
+/// Set whether consecutive frames of the same function are shown as
+/// a single row.
+///
+/// Like reset, this doesn't tell the views about the rows that come
+/// and go, so the model should be unset from its views first.
+void
+CallStackModel::collapse_recursion (bool a_flag)
+{
+    THROW_IF_FAIL (m_priv);
+    if (m_priv->collapse_recursion == a_flag)
+        return;
+    m_priv->collapse_recursion = a_flag;
+    ++m_priv->stamp;
+    m_priv->rebuild_runs ();
+}
+
+bool
+CallStackModel::collapse_recursion () const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->collapse_recursion;
+}
+
+/// Set the maximum number of frames held by the model.
+void
+CallStackModel::max_cached_frames (unsigned a_max)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->max_cached_frames = a_max;
+}
+
+unsigned
+CallStackModel::max_cached_frames () const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->max_cached_frames;
+}
+
+/// \return the value of a frame argument.  The members of an
+/// aggregate are shown between braces; an aggregate which value was
+/// left out is shown by its type.
+static UString
+format_arg_value (const IDebugger::Variable &a_arg)
+{
+    if (!a_arg.value ().empty ())
+        return a_arg.value ();
+    if (!a_arg.members ().empty ()) {
+        UString str = "{";
+        IDebugger::VariableList::const_iterator it;
+        for (it = a_arg.members ().begin ();
+             it != a_arg.members ().end ();
+             ++it) {
+            if (!*it)
+                continue;
+            if (str.size () > 1)
+                str += ", ";
+            str += (*it)->name () + " = " + format_arg_value (**it);
+        }
+        return str + "}";
+    }
+    if (!a_arg.type ().empty ())
+        return "(" + a_arg.type () + ") {...}";
+    return "";
+}
+
+/// Format the arguments of a frame as "(name = value, ...)".
+void
+CallStackModel::format_args_string (const IDebugger::VariableList &a_args,
+                                    UString &a_string)
+{
+    UString arg_string = "(";
+    bool is_first = true;
+    IDebugger::VariableList::const_iterator arg_it;
+    for (arg_it = a_args.begin (); arg_it != a_args.end (); ++arg_it) {
+        if (!*arg_it)
+            continue;
+        if (!is_first)
+            arg_string += ", ";
+        arg_string += (*arg_it)->name () + " = "
+                      + format_arg_value (**arg_it);
+        is_first = false;
+    }
+    arg_string += ")";
+    a_string = arg_string;
+}
+
+Gtk::TreeModelFlags
+CallStackModel::get_flags_vfunc () const
+{
+    return Gtk::TREE_MODEL_LIST_ONLY;
+}
+
+int
+CallStackModel::get_n_columns_vfunc () const
+{
+    return get_call_stack_columns ().size ();
+}
+
+GType
+CallStackModel::get_column_type_vfunc (int a_index) const
+{
+    THROW_IF_FAIL (a_index >= 0 && a_index < get_n_columns_vfunc ());
+    return get_call_stack_columns ().types ()[a_index];
+}
+
+void
+CallStackModel::get_value_vfunc (const iterator &a_iter,
+                                 int a_column,
+                                 Glib::ValueBase &a_value) const
+{
+    THROW_IF_FAIL (m_priv);
+
+    CallStackCols &cols = get_call_stack_columns ();
+    int row = m_priv->row_of_iter (a_iter);
+    int first = m_priv->level_of_row (row);
+    int last = m_priv->last_level_of_row (row);
+    int nb_frames = last - first + 1;
+
+    if (a_column == cols.frame_index.index ()) {
+        set_value (a_value, first);
+        return;
+    }
+    if (a_column == cols.nb_frames.index ()) {
+        set_value (a_value, nb_frames);
+        return;
+    }
+
+    UString str;
+    Priv::EntryMap::const_iterator it = m_priv->cache.find (first);
+    if (a_column == cols.frame_index_caption.index ()) {
+        str = UString::from_int (first);
+        if (nb_frames > 1)
+            str += "-" + UString::from_int (last);
+    } else if (it == m_priv->cache.end ()) {
+        // The frame is not fetched yet.
+        if (a_column == cols.function_name.index ())
+            str = "...";
+    } else {
+        const IDebugger::Frame &frame = it->second.frame;
+        if (a_column == cols.function_name.index ()) {
+            if (nb_frames > 1)
+                // Translators: this is the name of a function that
+                // calls itself recursively, followed by the number of
+                // its frames.
+                str.printf (_("%s \xc3\x97%d"),
+                            frame.function_name ().c_str (), nb_frames);
+            else
+                str = frame.function_name ();
+        } else if (a_column == cols.function_args.index ()) {
+            if (it->second.has_args)
+                str = it->second.args;
+        } else if (a_column == cols.location.index ()) {
+            if (!frame.file_name ().empty ())
+                str = frame.file_name () + ":"
+                      + UString::from_int (frame.line ());
+        } else if (a_column == cols.address.index ()) {
+            str = frame.address ().to_string ();
+        } else if (a_column == cols.binary.index ()) {
+            str = frame.library ();
+        }
+    }
+    set_value (a_value, Glib::ustring (str));
+}
+
+bool
+CallStackModel::iter_next_vfunc (const iterator &a_iter,
+                                 iterator &a_iter_next) const
+{
+    THROW_IF_FAIL (m_priv);
+    if (!m_priv->is_valid (a_iter))
+        return false;
+    int row = m_priv->row_of_iter (a_iter) + 1;
+    if (row >= m_priv->nb_rows ())
+        return false;
+    m_priv->make_iter (row, a_iter_next);
+    return true;
+}
+
+bool
+CallStackModel::iter_children_vfunc (const iterator &,
+                                     iterator &) const
+{
+    return false;
+}
+
+bool
+CallStackModel::iter_has_child_vfunc (const iterator &) const
+{
+    return false;
+}
+
+int
+CallStackModel::iter_n_children_vfunc (const iterator &) const
+{
+    return 0;
+}
+
+int
+CallStackModel::iter_n_root_children_vfunc () const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->nb_rows ();
+}
+
+bool
+CallStackModel::iter_nth_child_vfunc (const iterator &,
+                                      int,
+                                      iterator &) const
+{
+    return false;
+}
+
+bool
+CallStackModel::iter_nth_root_child_vfunc (int a_n, iterator &a_iter) const
+{
+    THROW_IF_FAIL (m_priv);
+    if (a_n < 0 || a_n >= m_priv->nb_rows ())
+        return false;
+    m_priv->make_iter (a_n, a_iter);
+    return true;
+}
+
+bool
+CallStackModel::iter_parent_vfunc (const iterator &,
+                                   iterator &) const
+{
+    return false;
+}
+
+Gtk::TreeModel::Path
+CallStackModel::get_path_vfunc (const iterator &a_iter) const
+{
+    THROW_IF_FAIL (m_priv);
+    Path path;
+    path.push_back (m_priv->row_of_iter (a_iter));
+    return path;
+}
+
+bool
+CallStackModel::get_iter_vfunc (const Path &a_path, iterator &a_iter) const
+{
+    THROW_IF_FAIL (m_priv);
+    if (a_path.size () != 1)
+        return false;
+    return iter_nth_root_child_vfunc (a_path[0], a_iter);
+}
+
+bool
+CallStackModel::iter_is_valid (const iterator &a_iter) const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->is_valid (a_iter);
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,155 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_CALL_STACK_MODEL_H__
+#define __NMV_CALL_STACK_MODEL_H__
+
+#include <vector>
+#include <gtkmm/treemodel.h>
+#include "common/nmv-safe-ptr-utils.h"
+#include "nmv-i-debugger.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+using nemiver::common::SafePtr;
+using nemiver::common::UString;
+
+/// The columns of CallStackModel.
+struct CallStackCols : public Gtk::TreeModelColumnRecord {
+    Gtk::TreeModelColumn<Glib::ustring> location;
+    Gtk::TreeModelColumn<Glib::ustring> address;
+    Gtk::TreeModelColumn<Glib::ustring> binary;
+    Gtk::TreeModelColumn<Glib::ustring> function_name;
+    Gtk::TreeModelColumn<Glib::ustring> function_args;
+    Gtk::TreeModelColumn<Glib::ustring> frame_index_caption;
+    Gtk::TreeModelColumn<int> frame_index;
+    Gtk::TreeModelColumn<int> nb_frames;
+
+    CallStackCols ()
+    {
+        add (location);
+        add (address);
+        add (binary);
+        add (function_name);
+        add (function_args);
+        add (frame_index_caption);
+        add (frame_index);
+        add (nb_frames);
+    }
+};//end CallStackCols
+
+CallStackCols& get_call_stack_columns ();
+
+/// A list model of the frames of a call stack, that doesn't need to
+/// hold all the frames to show all the rows.
+///
+/// The model is given the depth of the stack and has one row per
+/// frame.  It only holds the frames it was handed with set_frames,
+/// at most max_cached_frames of them; the rows of the other frames
+/// just show their level, until their frame is handed to the model.
+/// Frames far from the last ones handed are forgotten first.
+///
+/// The arguments of the frames are usually handed without the values
+/// of the aggregates, which are then shown by their type; once the
+/// full values of the arguments of a frame are handed, they are shown
+/// instead.
+///
+/// When collapse_recursion is set, consecutive frames of the same
+/// function are shown as a single "function ×N" row.  The rows
+/// are joined as the frames are handed to the model, so the number
+/// of rows can shrink as more frames are known.
+class NEMIVER_API CallStackModel : public Glib::Object,
+                                   public Gtk::TreeModel {
+    //non copyable
+    CallStackModel (const CallStackModel&);
+    CallStackModel& operator= (const CallStackModel&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+protected:
+    CallStackModel ();
+
+public:
+
+    static const unsigned DEFAULT_MAX_CACHED_FRAMES = 1024;
+
+    static Glib::RefPtr<CallStackModel> create ();
+    virtual ~CallStackModel ();
+
+    void reset (int a_depth);
+    int depth () const;
+    int nb_rows () const;
+
+    void set_frames (const std::vector<IDebugger::Frame> &a_frames);
+    void set_frames_arguments
+        (const std::map<int, IDebugger::VariableList> &a_args,
+         bool a_full_values = false);
+    bool has_frame (int a_level) const;
+    bool get_frame (int a_level, IDebugger::Frame &a_frame) const;
+    bool get_frame_arguments (int a_level, UString &a_args) const;
+    bool has_full_frame_arguments (int a_level) const;
+    void get_cached_levels (std::vector<int> &a_levels) const;
+
+    int level_of_row (int a_row) const;
+    int last_level_of_row (int a_row) const;
+    int row_of_level (int a_level) const;
+
+    void collapse_recursion (bool a_flag);
+    bool collapse_recursion () const;
+
+    void max_cached_frames (unsigned a_max);
+    unsigned max_cached_frames () const;
+
+    static void format_args_string (const IDebugger::VariableList &a_args,
+                                    UString &a_string);
+
+protected:
+    Gtk::TreeModelFlags get_flags_vfunc () const;
+    int get_n_columns_vfunc () const;
+    GType get_column_type_vfunc (int a_index) const;
+    void get_value_vfunc (const iterator &a_iter,
+                          int a_column,
+                          Glib::ValueBase &a_value) const;
+    bool iter_next_vfunc (const iterator &a_iter,
+                          iterator &a_iter_next) const;
+    bool iter_children_vfunc (const iterator &a_parent,
+                              iterator &a_iter) const;
+    bool iter_has_child_vfunc (const iterator &a_iter) const;
+    int iter_n_children_vfunc (const iterator &a_iter) const;
+    int iter_n_root_children_vfunc () const;
+    bool iter_nth_child_vfunc (const iterator &a_parent,
+                               int a_n,
+                               iterator &a_iter) const;
+    bool iter_nth_root_child_vfunc (int a_n, iterator &a_iter) const;
+    bool iter_parent_vfunc (const iterator &a_child,
+                            iterator &a_iter) const;
+    Path get_path_vfunc (const iterator &a_iter) const;
+    bool get_iter_vfunc (const Path &a_path, iterator &a_iter) const;
+    bool iter_is_valid (const iterator &a_iter) const;
+};//end CallStackModel
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_CALL_STACK_MODEL_H__
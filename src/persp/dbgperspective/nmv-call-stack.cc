@@ -25,11 +25,15 @@
 #include "config.h"
 #include <sstream>
 #include <algorithm>
+#include <set>
 #include <gtkmm/treeview.h>
-#include <gtkmm/liststore.h>
+#include <gtkmm/dialog.h>
+#include <gtkmm/label.h>
+#include <gtkmm/spinbutton.h>
 #include <glib/gi18n.h>
 #include "common/nmv-exception.h"
 #include "nmv-call-stack.h"
+#include "nmv-call-stack-model.h"
 #include "nmv-ui-utils.h"
 #include "nmv-i-workbench.h"
 #include "nmv-i-perspective.h"
@@ -58,62 +62,36 @@ struct GObjectMMUnref {
 
 typedef SafePtr<Glib::Object, GObjectMMRef, GObjectMMUnref> GObjectMMSafePtr;
 
-struct CallStackCols : public Gtk::TreeModelColumnRecord {
-    Gtk::TreeModelColumn<Glib::ustring> location;
-    Gtk::TreeModelColumn<Glib::ustring> address;
-    Gtk::TreeModelColumn<Glib::ustring> binary;
-    Gtk::TreeModelColumn<Glib::ustring> function_name;
-    Gtk::TreeModelColumn<Glib::ustring> function_args;
-    Gtk::TreeModelColumn<Glib::ustring> frame_index_caption;
-    Gtk::TreeModelColumn<int> frame_index;
-    Gtk::TreeModelColumn<bool> is_expansion_row;
-
-    /// Keep the enum in an order compatible with the how the diffent
-    /// columns are appended in CallStack::Priv::build_widget.
-    enum Index {
-        FRAME_INDEX = 0,
-        FUNCTION_NAME_INDEX,
-        FUNCTION_ARGUMENTS_INDEX,
-        LOCATION_INDEX,
-        ADDRESS_INDEX,
-        BINARY_INDEX
-    };
-
-    CallStackCols ()
-    {
-        add (location);
-        add (address);
-	add (binary);
-        add (function_name);
-        add (function_args);
-        add (frame_index_caption);
-        add (frame_index);
-        add (is_expansion_row);
-    }
-};//end cols
-
 static CallStackCols&
 columns ()
 {
-    static CallStackCols s_cols;
-    return s_cols;
+    return get_call_stack_columns ();
 }
 
-static const char* COOKIE_CALL_STACK_IN_FRAME_PAGING_TRANS =
-    "cookie-call-stack-in-frame-paging-trans";
-
-typedef vector<IDebugger::Frame> FrameArray;
-typedef map<int, list<IDebugger::VariableSafePtr> > FrameArgsMap;
-typedef map<int, IDebugger::Frame> LevelFrameMap;
-struct CallStack::Priv {
+/// The order in which the columns are appended in
+/// CallStack::Priv::build_widget.
+enum CallStackColumnIndex {
+    FRAME_INDEX = 0,
+    FUNCTION_NAME_INDEX,
+    FUNCTION_ARGUMENTS_INDEX,
+    LOCATION_INDEX,
+    ADDRESS_INDEX,
+    BINARY_INDEX
+};
+
+/// The maximum number of frames asked to the debugger at once.
+static const unsigned MAX_NB_FRAMES_PER_FETCH = 1024;
+
+/// How long the pointer must rest over a row, in milliseconds, before
+/// the full arguments of its frame are fetched for the tooltip.
+static const unsigned TOOLTIP_FETCH_DELAY_MS = 300;
+
+struct CallStack::Priv : public sigc::trackable {
     IDebuggerSafePtr debugger;
     IConfMgrSafePtr conf_mgr;
     IWorkbench& workbench;
     IPerspective& perspective;
-    FrameArray frames;
-    FrameArgsMap params;
-    LevelFrameMap level_frame_map;
-    Glib::RefPtr<Gtk::ListStore> store;
+    Glib::RefPtr<CallStackModel> model;
     SafePtr<Gtk::TreeView> widget;
     IDebugger::Frame cur_frame;
     sigc::signal<void, int, const IDebugger::Frame&> frame_selected_signal;
@@ -122,9 +100,21 @@ struct CallStack::Priv {
     Glib::RefPtr<Gtk::ActionGroup> call_stack_action_group;
     unsigned cur_frame_index;
     unsigned nb_frames_expansion_chunk;
-    int frame_low;
-    int frame_high;
-    bool waiting_for_stack_args;
+    // Bumped each time the stack is refreshed, so that the replies
+    // about the previous stack are ignored.
+    unsigned generation;
+    bool fetch_in_flight;
+    bool fetch_scheduled;
+    // The level of the frame to make current as soon as it is
+    // fetched, or -1.
+    int pending_level;
+    // The levels of the frames which full argument values are being
+    // fetched.
+    std::set<int> full_args_in_flight;
+    // The level of the frame which full arguments are to be fetched
+    // once the pointer rests over its row, or -1.
+    int tooltip_level;
+    sigc::connection tooltip_fetch_connection;
     bool in_set_cur_frame_trans;
     bool is_up2date;
 
@@ -135,12 +125,15 @@ struct CallStack::Priv {
         conf_mgr (0),
         workbench (a_workbench),
         perspective (a_perspective),
+        model (CallStackModel::create ()),
         callstack_menu (0),
         cur_frame_index (-1),
         nb_frames_expansion_chunk (25),
-        frame_low (0),
-        frame_high (nb_frames_expansion_chunk),
-        waiting_for_stack_args (false),
+        generation (0),
+        fetch_in_flight (false),
+        fetch_scheduled (false),
+        pending_level (-1),
+        tooltip_level (-1),
         in_set_cur_frame_trans (false),
         is_up2date (true)
     {
@@ -169,6 +162,7 @@ struct CallStack::Priv {
     void 
     init_actions ()
     {
+        Gtk::StockID nil_stock_id ("");
 
         static ui_utils::ActionEntry s_call_stack_action_entries [] = {
             {
@@ -182,6 +176,31 @@ struct CallStack::Priv {
                 ui_utils::ActionEntry::DEFAULT,
                 "",
                 false
+            },
+            {
+                "GoToFrameMenuItemAction",
+                Gtk::Stock::JUMP_TO,
+                _("_Go to Frame..."),
+                _("Select the frame at a given depth of the call stack"),
+                sigc::mem_fun
+                    (*this,
+                     &Priv::on_go_to_frame_action),
+                ui_utils::ActionEntry::DEFAULT,
+                "",
+                false
+            },
+            {
+                "CollapseRecursionMenuItemAction",
+                nil_stock_id,
+                _("Co_llapse Recursive Frames"),
+                _("Show consecutive frames of the same function "
+                  "as a single row"),
+                sigc::mem_fun
+                    (*this,
+                     &Priv::on_collapse_recursion_action),
+                ui_utils::ActionEntry::TOGGLE,
+                "",
+                false
             }
         };
 
@@ -198,6 +217,13 @@ struct CallStack::Priv {
              num_actions,
              call_stack_action_group);
 
+        Glib::RefPtr<Gtk::ToggleAction> collapse_action =
+            Glib::RefPtr<Gtk::ToggleAction>::cast_dynamic
+                (call_stack_action_group->get_action
+                                    ("CollapseRecursionMenuItemAction"));
+        THROW_IF_FAIL (collapse_action);
+        collapse_action->set_active (model->collapse_recursion ());
+
         workbench.get_ui_manager ()->insert_action_group
                                                 (call_stack_action_group);
     }
@@ -223,68 +249,356 @@ struct CallStack::Priv {
         return callstack_menu;
     }
 
-    /// Set the frame at a_index as the current frame.  This makes the
+    /// Set the frame at a_level as the current frame.  This makes the
     /// whole perspective to udpate accordingly.
     void
-    set_current_frame (unsigned a_index)
+    set_current_frame (int a_level, const IDebugger::Frame &a_frame)
     {
-        THROW_IF_FAIL (a_index < frames.size ());
-        cur_frame_index = a_index;
-        cur_frame = frames[cur_frame_index];
-        THROW_IF_FAIL (cur_frame.level () >= 0);
+        THROW_IF_FAIL (a_level >= 0);
+        cur_frame_index = a_level;
+        cur_frame = a_frame;
         in_set_cur_frame_trans = true;
 
         LOG_DD ("frame selected: '"<<  (int) cur_frame_index << "'");
         LOG_DD ("frame level: '" << (int) cur_frame.level () << "'");
 
         debugger->select_frame (cur_frame_index);
+        fetch_full_arguments (a_level);
     }
 
-    /// If the selected frame is the "expand to see more frames" raw,
-    /// ask the debugger engine for more frames.
-    /// Otherwise, just set the "current frame" variable.
-    void 
-    update_selected_frame (Gtk::TreeModel::iterator &a_row_iter)
+    /// The rows show the arguments of the frames without the value
+    /// of the aggregates.  Fetch the full values of the arguments of
+    /// the frame at a_level, unless they are already there.
+    void
+    fetch_full_arguments (int a_level)
+    {
+        if (!model->has_frame (a_level)
+            || model->has_full_frame_arguments (a_level)
+            || full_args_in_flight.count (a_level))
+            return;
+
+        full_args_in_flight.insert (a_level);
+        debugger->list_frames_arguments
+            (a_level, a_level, IDebugger::PRINT_ALL_VALUES,
+             sigc::bind (sigc::mem_fun (*this,
+                                        &Priv::on_full_frame_args_listed),
+                         a_level, generation));
+    }
+
+    void
+    on_full_frame_args_listed
+    (const map<int, IDebugger::VariableList> &a_frames_args,
+     int a_level,
+     unsigned a_generation)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
-        THROW_IF_FAIL (a_row_iter);
-
-        // if the selected row is the "expand number of stack lines" row, trigger
-        // a redraw of the call stack with more raws.
-        if ((*a_row_iter)[columns ().is_expansion_row]) {
-            frame_low = frame_high + 1;
-            frame_high += nb_frames_expansion_chunk;
-            debugger->list_frames (frame_low, frame_high,
-                                   sigc::mem_fun
-                                   (*this, &Priv::on_frames_listed_during_paging),
-                                   "");
+        NEMIVER_TRY
+        if (a_generation != generation)
+            return;
+        full_args_in_flight.erase (a_level);
+        if (a_frames_args.find (a_level) == a_frames_args.end ()) {
+            // The command failed; don't trigger a new query that
+            // would just fetch them again.
+            LOG_ERROR ("could not fetch the arguments of frame " << a_level);
             return;
         }
+        model->set_frames_arguments (a_frames_args,
+                                     /*a_full_values=*/true);
+        // The pointer may still be over that frame, waiting for its
+        // tooltip.
+        if (widget)
+            widget->trigger_tooltip_query ();
+        NEMIVER_CATCH
+    }
 
-        set_current_frame ((*a_row_iter)[columns ().frame_index]);
+    /// Fetch the full arguments of the frame at a_level once the
+    /// pointer has rested over its row for a while, so that moving
+    /// the pointer across the rows doesn't fetch all of them.
+    void
+    schedule_tooltip_fetch (int a_level)
+    {
+        if (a_level == tooltip_level && tooltip_fetch_connection.connected ())
+            return;
+        tooltip_fetch_connection.disconnect ();
+        tooltip_level = a_level;
+        tooltip_fetch_connection = Glib::signal_timeout ().connect
+            (sigc::mem_fun (*this, &Priv::on_tooltip_fetch_timeout),
+             TOOLTIP_FETCH_DELAY_MS);
     }
 
-    void 
-    finish_update_handling ()
+    void
+    cancel_tooltip_fetch ()
+    {
+        tooltip_fetch_connection.disconnect ();
+        tooltip_level = -1;
+    }
+
+    bool
+    on_tooltip_fetch_timeout ()
+    {
+        NEMIVER_TRY
+        int level = tooltip_level;
+        tooltip_level = -1;
+        if (level >= 0)
+            fetch_full_arguments (level);
+        NEMIVER_CATCH
+        return false;
+    }
+
+    bool
+    on_leave_notify_event_signal (GdkEventCrossing *)
+    {
+        NEMIVER_TRY
+        cancel_tooltip_fetch ();
+        NEMIVER_CATCH
+        return false;
+    }
+
+    /// Show the arguments of the frame under the pointer, with their
+    /// full values, in a tooltip.  The full values are fetched once
+    /// the pointer rests over the row of the frame.
+    bool
+    on_query_tooltip_signal (int a_x, int a_y,
+                             bool a_keyboard_tooltip,
+                             const Glib::RefPtr<Gtk::Tooltip> &a_tooltip)
+    {
+        NEMIVER_TRY
+
+        THROW_IF_FAIL (widget);
+        Gtk::TreeModel::Path path;
+        if (!widget->get_tooltip_context_path (a_x, a_y,
+                                               a_keyboard_tooltip, path)
+            || path.empty ())
+            return false;
+
+        int level = model->level_of_row (path[0]);
+        if (!model->has_full_frame_arguments (level)) {
+            schedule_tooltip_fetch (level);
+            return false;
+        }
+
+        IDebugger::Frame frame;
+        UString args;
+        if (!model->get_frame (level, frame)
+            || !model->get_frame_arguments (level, args))
+            return false;
+        a_tooltip->set_text (frame.function_name () + " " + args);
+        widget->set_tooltip_row (a_tooltip, path);
+        return true;
+
+        NEMIVER_CATCH
+        return false;
+    }
+
+    /// Make the frame at a_level the current frame.  If that frame
+    /// is not fetched yet, fetch it first.
+    void
+    make_level_current (int a_level)
+    {
+        IDebugger::Frame frame;
+        if (model->get_frame (a_level, frame)) {
+            pending_level = -1;
+            set_current_frame (a_level, frame);
+            return;
+        }
+        pending_level = a_level;
+        fetch_needed_frames ();
+    }
+
+    /// Select a row without making its frame the current one.
+    void
+    select_row_silently (int a_row)
+    {
+        THROW_IF_FAIL (widget);
+        if (a_row < 0 || a_row >= model->nb_rows ())
+            return;
+        Gtk::TreeModel::Path path;
+        path.push_back (a_row);
+        on_selection_changed_connection.block ();
+        widget->get_selection ()->select (path);
+        on_selection_changed_connection.unblock ();
+    }
+
+    /// Select the row of the frame at a_level, scroll to it and make
+    /// that frame the current one.  If the frame is in a collapsed
+    /// recursion run, the row of the run is selected.
+    void
+    jump_to_level (int a_level)
+    {
+        THROW_IF_FAIL (widget);
+        if (a_level < 0 || a_level >= model->depth ())
+            return;
+        int row = model->row_of_level (a_level);
+        Gtk::TreeModel::Path path;
+        path.push_back (row);
+        select_row_silently (row);
+        widget->scroll_to_row (path, 0.5);
+        make_level_current (a_level);
+    }
+
+    /// Unset the model from the view while it is reset, for the view
+    /// not to be told about each row that comes and goes.
+    void
+    reset_model (int a_depth)
+    {
+        if (widget) {
+            on_selection_changed_connection.block ();
+            widget->unset_model ();
+        }
+        model->reset (a_depth);
+        if (widget) {
+            widget->set_model (model);
+            on_selection_changed_connection.unblock ();
+        }
+    }
+
+    /// Ask the debugger for the depth of the stack.  The frames
+    /// are then fetched as their rows get shown.
+    void
+    refresh_stack (bool a_select_top_most)
     {
         THROW_IF_FAIL (debugger);
-        debugger->list_frames (frame_low, frame_high,
-			       sigc::bind (sigc::mem_fun (*this, &Priv::on_frames_listed),
-                                           /*a_select_top_most*/false),
-			       "");
+        ++generation;
+        fetch_in_flight = false;
+        pending_level = -1;
+        full_args_in_flight.clear ();
+        cancel_tooltip_fetch ();
+        debugger->query_stack_depth
+            (sigc::bind (sigc::mem_fun (*this, &Priv::on_stack_depth_queried),
+                         generation, a_select_top_most));
     }
 
-    void 
-    handle_update (const UString &a_cookie)
+    void
+    on_stack_depth_queried (int a_depth,
+                            unsigned a_generation,
+                            bool a_select_top_most)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (a_generation != generation)
+            return;
+
+        LOG_DD ("stack depth: " << a_depth);
+        reset_model (a_depth);
+        if (!a_depth)
+            return;
+        if (widget)
+            select_row_silently (0);
+        if (a_select_top_most)
+            make_level_current (0);
+        else
+            fetch_needed_frames ();
+
+        NEMIVER_CATCH
+    }
+
+    /// Get the levels of the frames shown in the visible rows that
+    /// are not fetched yet.
+    ///
+    /// \return false if there is no such frame.
+    bool
+    get_missing_visible_levels (int &a_low, int &a_high)
+    {
+        int nb_rows = model->nb_rows ();
+        int start_row = 0, end_row = 0;
+        Gtk::TreeModel::Path start, end;
+        if (widget
+            && widget->get_visible_range (start, end)
+            && !start.empty () && !end.empty ()) {
+            start_row = start[0];
+            end_row = end[0];
+        } else {
+            end_row = std::min (nb_rows, (int) nb_frames_expansion_chunk) - 1;
+        }
+
+        bool found = false;
+        for (int row = start_row; row <= end_row && row < nb_rows; ++row) {
+            int level = model->level_of_row (row);
+            if (model->has_frame (level))
+                continue;
+            if (!found)
+                a_low = level;
+            a_high = level;
+            found = true;
+        }
+        return found;
+    }
+
+    /// Fetch the frame that is to become the current one, if any,
+    /// or else the frames of the visible rows that are not fetched
+    /// yet.  Only one such request is in flight at a time.
+    void
+    fetch_needed_frames ()
     {
-        if (a_cookie != COOKIE_CALL_STACK_IN_FRAME_PAGING_TRANS) {
-            // Restore the frame window, in case the user changed it by
-            // requesting more call stack frames.
-            frame_low = 0;
-            frame_high = nb_frames_expansion_chunk;
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        if (fetch_in_flight || !model->depth ())
+            return;
+
+        int low = 0, high = 0;
+        if (pending_level >= 0 && !model->has_frame (pending_level)) {
+            low = high = pending_level;
+        } else if (!get_missing_visible_levels (low, high)) {
+            return;
         }
 
+        // Right after a recursion run, the run is likely to go on,
+        // so fetch as many frames as it has already, to collapse
+        // deep recursions in a few requests.
+        unsigned window = nb_frames_expansion_chunk;
+        if (low > 0) {
+            int prev_row = model->row_of_level (low - 1);
+            unsigned run_length = model->last_level_of_row (prev_row)
+                                  - model->level_of_row (prev_row) + 1;
+            if (run_length > window)
+                window = run_length;
+        }
+        window = std::min (window, MAX_NB_FRAMES_PER_FETCH);
+        high = std::max (high, (int) (low + window - 1));
+        high = std::min (high, (int) (low + MAX_NB_FRAMES_PER_FETCH - 1));
+        high = std::min (high, model->depth () - 1);
+
+        fetch_in_flight = true;
+        debugger->list_frames (low, high,
+                               sigc::bind
+                                 (sigc::mem_fun (*this,
+                                                 &Priv::on_frames_listed),
+                                  low, generation),
+                               "");
+    }
+
+    void
+    schedule_fetch ()
+    {
+        if (fetch_scheduled)
+            return;
+        fetch_scheduled = true;
+        Glib::signal_idle ().connect
+            (sigc::mem_fun (*this, &Priv::on_idle_fetch));
+    }
+
+    bool
+    on_idle_fetch ()
+    {
+        NEMIVER_TRY
+        fetch_scheduled = false;
+        fetch_needed_frames ();
+        NEMIVER_CATCH
+        return false;
+    }
+
+    void
+    finish_update_handling ()
+    {
+        refresh_stack (/*a_select_top_most=*/false);
+    }
+
+    void 
+    handle_update ()
+    {
         if (should_process_now ()) {
             finish_update_handling ();
         } else {
@@ -298,7 +612,7 @@ struct CallStack::Priv {
                                 const IDebugger::Frame &/*a_frame*/,
                                 int /*a_thread_id*/,
                                 const string& /*a_bp_num*/,
-                                const UString &a_cookie)
+                                const UString &/*a_cookie*/)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
@@ -311,7 +625,7 @@ struct CallStack::Priv {
             return;
         }
 
-        handle_update (a_cookie);
+        handle_update ();
 
         NEMIVER_CATCH
     }
@@ -319,81 +633,90 @@ struct CallStack::Priv {
     void
     on_thread_selected_signal (int /*a_thread_id*/,
                                const IDebugger::Frame* const /*a_frame*/,
-                               const UString& a_cookie)
+                               const UString& /*a_cookie*/)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
-        handle_update (a_cookie);
+        NEMIVER_TRY
+        handle_update ();
+        NEMIVER_CATCH
     }
 
+    /// The frames [a_low, ...] requested by fetch_needed_frames are
+    /// there.  Hand them to the model, ask for the arguments of the
+    /// frames that are shown and go on fetching.
     void
-    on_frames_listed_during_paging (const vector<IDebugger::Frame> &a_stack)
+    on_frames_listed (const vector<IDebugger::Frame> &a_frames,
+                      int a_low,
+                      unsigned a_generation)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
         NEMIVER_TRY;
 
-        // We are in a mode where the user asked to see more stack
-        // frames.  This is named frame paging. In this case, just
-        // append the frames to the current ones. Again, the frames
-        // will be appended without arguments. We'll request the
-        // arguments right after this.
-        FrameArgsMap frames_args;
-        append_frames_to_tree_view (a_stack, frames_args);
-
-        // Okay so now, ask for frame arguments matching the frames we
-        // just received.
-        debugger->list_frames_arguments (a_stack[0].level (),
-                                         a_stack[a_stack.size () - 1].level (),
-                                         sigc::mem_fun
-                                         (*this, &Priv::on_frames_args_listed),
-                                         "");
-
-        NEMIVER_CATCH;
-    }
-
-    void
-    on_frames_listed (const vector<IDebugger::Frame> &a_stack,
-                      bool a_select_top_most = false)
-    {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
-
-        NEMIVER_TRY;
+        if (a_generation != generation)
+            return;
+        fetch_in_flight = false;
 
-        THROW_IF_FAIL (debugger);
-        waiting_for_stack_args = true;
-
-        FrameArgsMap frames_args;
-        // Set the frame list without frame arguments, then, request
-        // IDebugger for frame arguments.  When the arguments arrive,
-        // we will update the call stack with those.
-        set_frame_list (a_stack, frames_args);
-
-        // Okay so now, ask for frame arguments matching the frames we
-        // just received.
-        debugger->list_frames_arguments (a_stack[0].level (),
-                                         a_stack[a_stack.size () - 1].level (),
-                                         sigc::mem_fun
-                                         (*this, &Priv::on_frames_args_listed),
-                                         "");
+        if (a_frames.empty () || a_frames.front ().level () != a_low) {
+            // The stack is not as deep as we were told; don't ask
+            // for these frames again and again.
+            LOG_ERROR ("could not fetch frame " << a_low);
+            pending_level = -1;
+            return;
+        }
+        model->set_frames (a_frames);
+
+        // The frames inside a recursion run are not shown, so only
+        // ask for the arguments of the frames heading a row.  Only
+        // ask for the simple values: formatting big aggregates passed
+        // by value is slow.  The full values of the arguments of a
+        // frame are fetched when it is selected or hovered.
+        int first_head = -1, last_head = -1;
+        vector<IDebugger::Frame>::const_iterator it;
+        for (it = a_frames.begin (); it != a_frames.end (); ++it) {
+            int level = it->level ();
+            if (model->level_of_row (model->row_of_level (level)) != level)
+                continue;
+            if (first_head < 0)
+                first_head = level;
+            last_head = level;
+        }
+        if (first_head >= 0)
+            debugger->list_frames_arguments
+                (first_head, last_head, IDebugger::PRINT_SIMPLE_VALUES,
+                 sigc::bind (sigc::mem_fun (*this,
+                                            &Priv::on_frames_args_listed),
+                             generation),
+                 "");
+
+        if (pending_level >= 0) {
+            IDebugger::Frame frame;
+            if (model->get_frame (pending_level, frame)) {
+                int level = pending_level;
+                pending_level = -1;
+                set_current_frame (level, frame);
+            }
+        }
 
-        if (a_select_top_most)
-            set_current_frame (0);
+        fetch_needed_frames ();
 
         NEMIVER_CATCH;
     }
 
     void
     on_frames_args_listed
-    (const map<int, IDebugger::VariableList> &a_frames_args)
+    (const map<int, IDebugger::VariableList> &a_frames_args,
+     unsigned a_generation)
     {
         LOG_DD ("frames params listed");
 
-        if (waiting_for_stack_args) {
-            update_frames_arguments (a_frames_args);
-            waiting_for_stack_args = false;
-        } else {
-            LOG_D ("not in the frame setting transaction", NMV_DEFAULT_DOMAIN);
+        NEMIVER_TRY
+        if (a_generation != generation) {
+            LOG_D ("arguments of a previous stack", NMV_DEFAULT_DOMAIN);
+            return;
         }
+        model->set_frames_arguments (a_frames_args);
+        NEMIVER_CATCH
     }
 
     void
@@ -415,27 +738,29 @@ struct CallStack::Priv {
         NEMIVER_CATCH
     }
 
+    /// Make the frame of the selected row the current one.
     void
-    on_selection_changed_signal ()
+    update_selected_frame ()
     {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        THROW_IF_FAIL (widget);
 
-        NEMIVER_TRY;
+        if (!model->nb_rows ())
+            return;
 
-        // Don't try to select a row on an empty call stack.
-        if (store->children ().empty ())
+        vector<Gtk::TreePath> selected_rows =
+            widget->get_selection ()->get_selected_rows ();
+        if (selected_rows.empty () || selected_rows.front ().empty ())
             return;
+        make_level_current (model->level_of_row (selected_rows.front ()[0]));
+    }
 
-        Gtk::TreeView *tree_view = dynamic_cast<Gtk::TreeView*> (widget.get ());
-        THROW_IF_FAIL (tree_view);
-        Glib::RefPtr<Gtk::TreeSelection> selection = tree_view->get_selection ();
-        THROW_IF_FAIL (selection);
-        vector<Gtk::TreePath> selected_rows = selection->get_selected_rows ();
-        if (selected_rows.empty ()) {return;}
-
-        Gtk::TreeModel::iterator row_iter =
-                store->get_iter (selected_rows.front ());
-        update_selected_frame (row_iter);
+    void
+    on_selection_changed_signal ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY;
+        update_selected_frame ();
         NEMIVER_CATCH
     }
 
@@ -445,14 +770,7 @@ struct CallStack::Priv {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
         NEMIVER_TRY
-
-        Gtk::TreeView *tree_view = dynamic_cast<Gtk::TreeView*> (widget.get ());
-        THROW_IF_FAIL (tree_view);
-        Glib::RefPtr<Gtk::TreeSelection> selection = tree_view->get_selection ();
-        THROW_IF_FAIL (selection);
-        Gtk::TreeModel::iterator row_it = selection->get_selected ();
-        update_selected_frame (row_it);
-
+        update_selected_frame ();
         NEMIVER_CATCH
     }
 
@@ -465,6 +783,11 @@ struct CallStack::Priv {
         if (!is_up2date) {
             finish_update_handling ();
             is_up2date = true;
+        } else {
+            // The rows shown may have changed, e.g. because the view
+            // got scrolled.  Fetch their frames, but not while
+            // drawing.
+            schedule_fetch ();
         }
         NEMIVER_CATCH
     }
@@ -546,6 +869,7 @@ struct CallStack::Priv {
         }
     }
 
+    /// Copy the frames fetched so far to the clipboard.
     void
     on_call_stack_copy_to_clipboard_action ()
     {
@@ -553,36 +877,104 @@ struct CallStack::Priv {
 
         NEMIVER_TRY
 
-        int i = 0;
         std::ostringstream frame_stream;
-        vector<IDebugger::Frame>::const_iterator frame_iter;
-        map<int, list<IDebugger::VariableSafePtr> >::const_iterator
-                                                                params_iter;
+        vector<int> levels;
+        model->get_cached_levels (levels);
+        IDebugger::Frame frame;
         UString args_string;
         // convert list of stack frames to a string
         // FIXME: maybe Frame should
         // just implement operator<< ?
-        for (frame_iter = frames.begin (), params_iter = params.begin ();
-             frame_iter != frames.end ();
-             ++frame_iter, ++params_iter) {
-            frame_stream << "#" << UString::from_int (i++) << "  " <<
-                frame_iter->function_name ();
-
-            // if the params map exists, add the
+        for (vector<int>::const_iterator it = levels.begin ();
+             it != levels.end ();
+             ++it) {
+            model->get_frame (*it, frame);
+            frame_stream << "#" << UString::from_int (*it) << "  " <<
+                frame.function_name ();
+
+            // if the params are known, add the
             // function params to the stack trace
-            args_string = "()";
-            if (params_iter != params.end ())
-                format_args_string (params_iter->second, args_string);
+            if (!model->get_frame_arguments (*it, args_string))
+                args_string = "()";
             frame_stream << args_string.raw ();
 
-            frame_stream << " at " << frame_iter->file_name () << ":"
-                << UString::from_int(frame_iter->line ()) << std::endl;
+            frame_stream << " at " << frame.file_name () << ":"
+                << UString::from_int(frame.line ()) << std::endl;
         }
         Gtk::Clipboard::get ()->set_text (frame_stream.str ());
 
         NEMIVER_CATCH
     }
 
+    void
+    on_go_to_frame_action ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (!model->depth ())
+            return;
+
+        Gtk::Dialog dialog (_("Go to Frame"),
+                            workbench.get_root_window (),
+                            true);
+        Gtk::Box box (Gtk::ORIENTATION_HORIZONTAL, 6);
+        box.set_border_width (6);
+        Gtk::Label label (_("Frame _number:"), true);
+        Gtk::SpinButton spin_button;
+        spin_button.set_range (0, model->depth () - 1);
+        spin_button.set_increments (1, 10);
+        spin_button.set_value (cur_frame_index < (unsigned) model->depth ()
+                               ? cur_frame_index : 0);
+        spin_button.set_activates_default ();
+        label.set_mnemonic_widget (spin_button);
+        box.pack_start (label, Gtk::PACK_SHRINK);
+        box.pack_start (spin_button);
+        dialog.get_content_area ()->pack_start (box);
+        dialog.add_button (Gtk::Stock::CANCEL, Gtk::RESPONSE_CANCEL);
+        dialog.add_button (Gtk::Stock::JUMP_TO, Gtk::RESPONSE_OK);
+        dialog.set_default_response (Gtk::RESPONSE_OK);
+        dialog.show_all ();
+
+        if (dialog.run () != Gtk::RESPONSE_OK)
+            return;
+        jump_to_level (spin_button.get_value_as_int ());
+
+        NEMIVER_CATCH
+    }
+
+    void
+    on_collapse_recursion_action ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        Glib::RefPtr<Gtk::ToggleAction> action =
+            Glib::RefPtr<Gtk::ToggleAction>::cast_dynamic
+                (call_stack_action_group->get_action
+                                    ("CollapseRecursionMenuItemAction"));
+        THROW_IF_FAIL (action);
+        if (action->get_active () == model->collapse_recursion ())
+            return;
+
+        if (widget) {
+            on_selection_changed_connection.block ();
+            widget->unset_model ();
+        }
+        model->collapse_recursion (action->get_active ());
+        if (widget) {
+            widget->set_model (model);
+            on_selection_changed_connection.unblock ();
+            if (cur_frame_index < (unsigned) model->depth ())
+                select_row_silently (model->row_of_level (cur_frame_index));
+            schedule_fetch ();
+        }
+
+        NEMIVER_CATCH
+    }
+
     Gtk::Widget*
     get_widget ()
     {
@@ -598,8 +990,7 @@ struct CallStack::Priv {
         if (widget) {
             return;
         }
-        store = Gtk::ListStore::create (columns ());
-        Gtk::TreeView *tree_view = new Gtk::TreeView (store);
+        Gtk::TreeView *tree_view = new Gtk::TreeView (model);
         THROW_IF_FAIL (tree_view);
         widget.reset (tree_view);
 	int nb_cols = 0;
@@ -609,18 +1000,24 @@ struct CallStack::Priv {
         tree_view->append_column (_("Location"), columns ().location);
         tree_view->append_column (_("Address"), columns ().address);
 	nb_cols = tree_view->append_column (_("Binary"), columns ().binary);
+        // All the rows have the same height, so use fixed size
+        // columns and let the view skip measuring each row; on a deep
+        // stack that would mean going through all the rows.
+        static const int s_column_widths[] = {80, 200, 250, 250, 120, 200};
         Gtk::TreeViewColumn *col = 0;
 	for (int i = 0; i < nb_cols; ++i) {
             col = tree_view->get_column (i);
             col->set_resizable ();
             col->set_clickable ();
+            col->set_sizing (Gtk::TREE_VIEW_COLUMN_FIXED);
+            col->set_fixed_width (s_column_widths[i]);
 	}
 
-        THROW_IF_FAIL (col = tree_view->get_column (CallStackCols::BINARY_INDEX));
+        THROW_IF_FAIL (col = tree_view->get_column (BINARY_INDEX));
         col->get_first_cell ()->set_sensitive ();
 
         tree_view->set_headers_visible (true);
-	tree_view->columns_autosize ();
+        tree_view->set_fixed_height_mode (true);
         tree_view->get_selection ()->set_mode (Gtk::SELECTION_SINGLE);
 
         on_selection_changed_connection =
@@ -636,242 +1033,37 @@ struct CallStack::Priv {
         tree_view->signal_draw ().connect_notify
             (sigc::mem_fun (this, &Priv::on_draw_signal));
 
-        tree_view->add_events (Gdk::EXPOSURE_MASK);
+        tree_view->add_events (Gdk::EXPOSURE_MASK | Gdk::LEAVE_NOTIFY_MASK);
 
         tree_view->signal_button_press_event ().connect_notify
             (sigc::mem_fun (*this,
                             &Priv::on_call_stack_button_press_signal));
-    }
-
-    void
-    store_frames_in_cache (const FrameArray &a_frames,
-                           const FrameArgsMap &a_frames_args)
-    {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
-
-        if (a_frames.empty ())
-            return;
-        append_frames_to_cache (a_frames, a_frames_args);
-    }
-
-    void
-    append_frames_to_cache (const FrameArray &a_frames,
-                            const FrameArgsMap &a_frames_args)
-    {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
-
-        THROW_IF_FAIL (!a_frames.empty ());
-
-        int dest_start_index = a_frames[0].level (),
-            dest_end_index = a_frames.size () + dest_start_index - 1;
-        unsigned level = 0;
-        FrameArray::const_iterator f;
-
-        frames.reserve (dest_end_index + 1);
-        for (f = a_frames.begin (); f != a_frames.end (); ++f) {
-            level = f->level ();
-            if (level >= frames.size ())
-                frames.push_back (*f);
-            else
-                frames[level] = *f;
-        }
-        append_frame_args_to_cache (a_frames_args);
-    }
-
-    void
-    append_frame_args_to_cache (const FrameArgsMap &a_frames_args)
-    {
-        FrameArgsMap::const_iterator fa;
-        for (fa = a_frames_args.begin ();
-             fa != a_frames_args.end ();
-             ++fa) {
-            params[fa->first] = fa->second;
-        }
-    }
-
-    void
-    format_args_string (const list<IDebugger::VariableSafePtr> &a_args,
-                        UString &a_string)
-    {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
-
-        UString arg_string = "(";
-        list<IDebugger::VariableSafePtr>::const_iterator arg_it = a_args.begin ();
-        if (arg_it != a_args.end () && *arg_it) {
-            arg_string += (*arg_it)->name () + " = " + (*arg_it)->value ();
-            ++arg_it;
-        }
-        for (; arg_it != a_args.end (); ++arg_it) {
-            if (!*arg_it)
-                continue;
-            arg_string += ", " + (*arg_it)->name ()
-                          + " = " + (*arg_it)->value ();
-        }
-        arg_string += ")";
-        a_string = arg_string;
-    }
-
-    void
-    append_frames_to_tree_view (const FrameArray &a_frames,
-                                const FrameArgsMap &a_args)
-    {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
-
-        // Erase the expansion row, if it exists.
-        if (store && !store->children ().empty ()) {
-            LOG_DD ("does expansion row exist ?");
-            Gtk::TreeRow last_row =
-                store->children ()[store->children ().size () - 1];
-            if (last_row[columns ().is_expansion_row]) {
-                LOG_DD ("erasing expansion node");
-                store->erase (last_row);
-            } else {
-                LOG_DD ("not an expansion node");
-            }
-        }
-        // really append the frames to the tree view now
-        Gtk::TreeModel::iterator store_iter;
-        unsigned nb_frames = a_frames.size ();
-        for (unsigned i = 0; i < nb_frames; ++i) {
-            level_frame_map[a_frames[i].level ()] = a_frames[i];
-            frames.push_back (a_frames[i]);
-            store_iter = store->append ();
-            (*store_iter)[columns ().is_expansion_row] = false;
-            (*store_iter)[columns ().function_name] =
-                a_frames[i].function_name ();
-            if (!a_frames[i].file_name ().empty ()) {
-                (*store_iter)[columns ().location] =
-                    a_frames[i].file_name () + ":"
-                    + UString::from_int (a_frames[i].line ());
-            }
-            (*store_iter)[columns ().address] =
-                a_frames[i].address ().to_string ();
-	    (*store_iter)[columns ().binary] = a_frames[i].library ();
-            (*store_iter)[columns ().frame_index] = a_frames[i].level ();
-            (*store_iter)[columns ().frame_index_caption] =
-                UString::from_int (a_frames[i].level ());
-            FrameArgsMap::const_iterator fa_it;
-            UString arg_string;
-            fa_it = a_args.find (a_frames[i].level ());
-            if (fa_it != a_args.end ()) {
-                format_args_string (fa_it->second, arg_string);
-                params[a_frames[i].level ()] = fa_it->second;
-            } else {
-                arg_string = "()";
-            }
-            (*store_iter)[columns ().function_args] = arg_string;
-        }
-        if (a_frames.size () >= nb_frames_expansion_chunk) {
-            store_iter = store->append ();
-            UString msg;
-            msg.printf (ngettext ("(Click here to see the next %d row of the "
-                                  "call stack)",
-                                  "(Click here to see the next %d rows of the "
-                                  "call stack)",
-                                  nb_frames_expansion_chunk),
-                        nb_frames_expansion_chunk);
-            (*store_iter)[columns ().frame_index_caption] = "...";
-            (*store_iter)[columns ().location] = msg;
-            (*store_iter)[columns ().is_expansion_row] = true;
-        }
-        store_frames_in_cache (a_frames, a_args);
-    }
 
-    void
-    set_frame_list (const FrameArray &a_frames,
-                    const FrameArgsMap &a_params,
-                    bool a_emit_signal=false)
-    {
-        THROW_IF_FAIL (get_widget ());
-
-        clear_frame_list ();
-
-        append_frames_to_tree_view (a_frames, a_params);
-
-        Gtk::TreeView *tree_view =
-            dynamic_cast<Gtk::TreeView*> (widget.get ());
-        THROW_IF_FAIL (tree_view);
-
-        if (!a_emit_signal) {
-            on_selection_changed_connection.block ();
-        }
-        tree_view->get_selection ()->select (Gtk::TreePath ("0"));
-        if (!a_emit_signal) {
-            on_selection_changed_connection.unblock ();
-        }
-    }
-
-    void
-    update_frames_arguments (FrameArgsMap a_args)
-    {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
-
-        UString args_string;
-        FrameArgsMap::const_iterator arg_it;
-        LevelFrameMap::iterator lf_it;
-        int level = 0;
-        bool is_expansion_row = false;
-
-        for (Gtk::TreeModel::iterator row = store->children ().begin ();
-             row != store->children ().end ();
-             ++row) {
-            is_expansion_row = (*row)[columns ().is_expansion_row];
-            if (is_expansion_row)
-                continue;
-            level = (*row)[columns ().frame_index];
-            LOG_DD ("considering frame level " << level << " ...");
-            if ((lf_it = level_frame_map.find (level))
-                == level_frame_map.end ()) {
-                LOG_ERROR ("Error: no frame found for level "
-                           << arg_it->first);
-                THROW ("Constraint error in CallStack widget");
-            }
-            if ((arg_it = a_args.find (level)) == a_args.end ()) {
-                LOG_DD ("sorry, no arguments for this frame");
-                continue;
-            }
-            format_args_string (arg_it->second, args_string);
-            (*row)[columns ().function_args] = args_string;
-            LOG_DD ("yesss, frame arguments are: " << args_string);
-        }
-        append_frame_args_to_cache (a_args);
+        tree_view->set_has_tooltip ();
+        tree_view->signal_query_tooltip ().connect
+            (sigc::mem_fun (*this, &Priv::on_query_tooltip_signal));
+        tree_view->signal_leave_notify_event ().connect
+            (sigc::mem_fun (*this, &Priv::on_leave_notify_event_signal));
     }
 
     /// Visually clear the frame list.
-    /// \param a_reset_frame_window if true, reset the frame window range
-    ///  to [0 - defaultmax]
     void
-    clear_frame_list (bool a_reset_frame_window = false)
+    clear_frame_list ()
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
-        if (a_reset_frame_window) {
-            frame_low = 0;
-            frame_high = nb_frames_expansion_chunk;
-        }
-
-        THROW_IF_FAIL (store);
-        // We really don't need to try to update the selected frame
-        // when we are just clearing the list store, so block the signal
-        // transmission to the callback slot while we clear the store.
-        on_selection_changed_connection.block ();
-        store->clear ();
-        on_selection_changed_connection.unblock ();
-        frames.clear ();
-        params.clear ();
-        level_frame_map.clear ();
-
+        ++generation;
+        fetch_in_flight = false;
+        pending_level = -1;
+        full_args_in_flight.clear ();
+        cancel_tooltip_fetch ();
+        reset_model (0);
     }
 
     void
     update_call_stack (bool a_select_top_most = false)
     {
-        THROW_IF_FAIL (debugger);
-        debugger->list_frames (0, frame_high,
-                               sigc::bind (sigc::mem_fun
-                                           (*this, &Priv::on_frames_listed),
-                                           a_select_top_most),
-                               "");
+        refresh_stack (a_select_top_most);
     }
 };//end struct CallStack::Priv
 
@@ -892,14 +1084,15 @@ bool
 CallStack::is_empty ()
 {
     THROW_IF_FAIL (m_priv);
-    return m_priv->frames.empty ();
+    return m_priv->model->depth () == 0;
 }
 
-const vector<IDebugger::Frame>&
-CallStack::frames () const
+/// \return the number of frames of the call stack.
+int
+CallStack::depth () const
 {
     THROW_IF_FAIL (m_priv);
-    return m_priv->frames;
+    return m_priv->model->depth ();
 }
 
 IDebugger::Frame&
@@ -939,7 +1132,21 @@ CallStack::clear ()
     LOG_FUNCTION_SCOPE_NORMAL_DD;
     THROW_IF_FAIL (m_priv);
 
-    m_priv->clear_frame_list (true /* reset frame window */ );
+    m_priv->clear_frame_list ();
+}
+
+/// Select the frame at a given depth of the call stack, scroll to it
+/// and make it the current frame.  The frame is fetched first if
+/// needed.
+///
+/// \param a_level the level of the frame, 0 being the innermost one.
+void
+CallStack::jump_to_frame (int a_level)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+    THROW_IF_FAIL (m_priv);
+
+    m_priv->jump_to_level (a_level);
 }
 
 sigc::signal<void, int, const IDebugger::Frame&>&
@@ -60,10 +60,11 @@ public:
             IPerspective& a_perspective);
     virtual ~CallStack ();
     bool is_empty ();
-    const vector<IDebugger::Frame>& frames () const;
+    int depth () const;
     IDebugger::Frame& current_frame () const;
     void update_stack (bool select_top_most = false);
     void clear ();
+    void jump_to_frame (int a_level);
     Gtk::Widget& widget () const;
     sigc::signal<void,
                  int,
@@ -0,0 +1,489 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <list>
+#include <map>
+#include <glibmm/main.h>
+#include "common/nmv-exception.h"
+#include "nmv-child-prefetcher.h"
+#include "nmv-variables-utils.h"
+
+namespace vutil = nemiver::variables_utils2;
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+struct ChildPrefetcher::Priv : public sigc::trackable {
+    IDebugger &debugger;
+    Gtk::TreeView &tree_view;
+    Glib::RefPtr<Gtk::TreeStore> tree_store;
+    unsigned child_budget;
+    // How many members can still be prefetched until the next stop.
+    unsigned budget_left;
+    // The rows whose variables are to be prefetched, oldest first.
+    std::list<Gtk::TreeRowReference> pending_rows;
+    // The rows explicitly asked to be unfolded by unfold_row, with
+    // the slots to call once done.  They go before the prefetches
+    // and regardless of the budget.
+    std::list<std::pair<Gtk::TreeRowReference,
+                        sigc::slot<void> > > requested_rows;
+    ChildPrefetcher::VarobjMaker varobj_maker;
+    // The variable being unfolded, if any.
+    IDebugger::VariableSafePtr var_in_flight;
+    // Whether var_in_flight comes from requested_rows, and the slot
+    // to call once it is unfolded.
+    bool in_flight_is_requested;
+    sigc::slot<void> in_flight_done;
+    // The row the user expanded while its variable was being
+    // unfolded, if any.  It is expanded once the members arrive.
+    SafePtr<Gtk::TreeRowReference> row_to_expand;
+    sigc::connection idle_connection;
+
+    Priv (IDebugger &a_debugger,
+          Gtk::TreeView &a_tree_view,
+          const Glib::RefPtr<Gtk::TreeStore> &a_tree_store,
+          unsigned a_child_budget) :
+        debugger (a_debugger),
+        tree_view (a_tree_view),
+        tree_store (a_tree_store),
+        child_budget (a_child_budget),
+        budget_left (a_child_budget),
+        in_flight_is_requested (false)
+    {
+        THROW_IF_FAIL (tree_store);
+        debugger.stopped_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_stopped_signal));
+        debugger.running_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_running_signal));
+    }
+
+    ~Priv ()
+    {
+        idle_connection.disconnect ();
+    }
+
+    /// Return true if the row a_it shows a variable whose members
+    /// have not been fetched yet and are worth prefetching.
+    bool
+    row_needs_prefetch (const Gtk::TreeModel::iterator &a_it) const
+    {
+        if (!a_it || !(*a_it)[vutil::get_variable_columns ().needs_unfolding])
+            return false;
+        IDebugger::VariableSafePtr var =
+            (*a_it)[vutil::get_variable_columns ().variable];
+        if (!var)
+            return false;
+        if (var->internal_name ().empty ())
+            // A plain variable, like a local listed without a backend
+            // object.  The backend object is created first, which
+            // costs one more request, so only do it for aggregates:
+            // their value is not listed.  Pointers are left alone.
+            return !varobj_maker.empty () && var->value ().empty ();
+        return var->needs_unfolding ();
+    }
+
+    void
+    schedule ()
+    {
+        if (idle_connection.connected ()
+            || var_in_flight
+            || (requested_rows.empty ()
+                && (pending_rows.empty () || budget_left == 0)))
+            return;
+        idle_connection = Glib::signal_idle ().connect
+            (sigc::mem_fun (*this, &Priv::on_idle),
+             Glib::PRIORITY_LOW);
+    }
+
+    void
+    cancel ()
+    {
+        pending_rows.clear ();
+        requested_rows.clear ();
+        idle_connection.disconnect ();
+    }
+
+    /// Mark the row at a_it as having no members to fetch: remove
+    /// the dummy child row that made it expandable.
+    void
+    mark_row_as_unfolded (const Gtk::TreeModel::iterator &a_it)
+    {
+        Gtk::TreeModel::Children rows = a_it->children ();
+        for (Gtk::TreeModel::iterator it = rows.begin (); it != rows.end ();)
+            it = tree_store->erase (it);
+        (*a_it)[vutil::get_variable_columns ().needs_unfolding] = false;
+    }
+
+    /// Call the slot of the explicitly requested unfolding that just
+    /// completed, if any.
+    void
+    finish_in_flight ()
+    {
+        var_in_flight.reset ();
+        if (in_flight_is_requested) {
+            in_flight_is_requested = false;
+            sigc::slot<void> done = in_flight_done;
+            in_flight_done = sigc::slot<void> ();
+            done ();
+        }
+    }
+
+    /// Start unfolding the oldest row of requested_rows that still
+    /// needs it.  The slots of the requests that need nothing are
+    /// called right away.
+    ///
+    /// \return true if an unfolding was started.
+    bool
+    unfold_requested_row ()
+    {
+        while (!requested_rows.empty ()) {
+            Gtk::TreeRowReference row_ref = requested_rows.front ().first;
+            sigc::slot<void> done = requested_rows.front ().second;
+            requested_rows.pop_front ();
+
+            Gtk::TreeModel::iterator it;
+            IDebugger::VariableSafePtr var;
+            if (row_ref.is_valid ())
+                it = tree_store->get_iter (row_ref.get_path ());
+            if (it
+                && (*it)[vutil::get_variable_columns ().needs_unfolding])
+                var = (*it)[vutil::get_variable_columns ().variable];
+            if (!var
+                || (var->internal_name ().empty () && !varobj_maker)) {
+                done ();
+                continue;
+            }
+
+            var_in_flight = var;
+            in_flight_is_requested = true;
+            in_flight_done = done;
+            if (var->internal_name ().empty ()) {
+                make_varobj (row_ref);
+            } else if (!var->needs_unfolding ()) {
+                mark_row_as_unfolded (it);
+                finish_in_flight ();
+                continue;
+            } else {
+                unfold (row_ref);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void
+    unfold (Gtk::TreeRowReference a_row_ref)
+    {
+        debugger.unfold_variable
+            (var_in_flight,
+             sigc::bind (sigc::mem_fun (*this, &Priv::on_variable_unfolded),
+                         a_row_ref));
+    }
+
+    /// Have the backend object of the plain variable var_in_flight,
+    /// shown at a_row_ref, created.
+    void
+    make_varobj (Gtk::TreeRowReference a_row_ref)
+    {
+        varobj_maker (a_row_ref.get_path (),
+                      sigc::bind (sigc::mem_fun (*this, &Priv::on_varobj_made),
+                                  a_row_ref));
+    }
+
+    void
+    on_varobj_made (const IDebugger::VariableSafePtr a_varobj,
+                    Gtk::TreeRowReference a_row_ref)
+    {
+        NEMIVER_TRY;
+
+        // The backend object counts as a member in the budget.
+        if (!in_flight_is_requested && budget_left > 0)
+            --budget_left;
+
+        if (!a_varobj) {
+            // The variable is not shown anymore, e.g because another
+            // frame was selected in the mean time.
+            row_to_expand.reset ();
+            finish_in_flight ();
+            schedule ();
+            return;
+        }
+
+        var_in_flight = a_varobj;
+        if (!a_varobj->needs_unfolding ()) {
+            // A plain variable that turned out to have no members.
+            if (a_row_ref.is_valid ()) {
+                Gtk::TreeModel::iterator it =
+                    tree_store->get_iter (a_row_ref.get_path ());
+                if (it)
+                    mark_row_as_unfolded (it);
+            }
+            finish_in_flight ();
+            schedule ();
+            return;
+        }
+        unfold (a_row_ref);
+
+        NEMIVER_CATCH;
+    }
+
+    /// Unfold the variable of the oldest pending row that still needs
+    /// it.  Only one variable is unfolded at a time, so the requests
+    /// of the user never wait behind a long train of prefetches.
+    bool
+    on_idle ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY;
+
+        if (unfold_requested_row ())
+            return false;
+
+        while (!pending_rows.empty () && budget_left > 0) {
+            Gtk::TreeRowReference row_ref = pending_rows.front ();
+            pending_rows.pop_front ();
+            if (!row_ref.is_valid ())
+                continue;
+            Gtk::TreeModel::iterator it =
+                tree_store->get_iter (row_ref.get_path ());
+            // A row the user expanded is being unfolded on their
+            // behalf already.
+            if (!row_needs_prefetch (it)
+                || tree_view.row_expanded (row_ref.get_path ()))
+                continue;
+            var_in_flight = (*it)[vutil::get_variable_columns ().variable];
+            LOG_DD ("prefetching members of " << var_in_flight->name ());
+            if (var_in_flight->internal_name ().empty ())
+                make_varobj (row_ref);
+            else
+                unfold (row_ref);
+            break;
+        }
+
+        NEMIVER_CATCH;
+
+        // The next prefetch is scheduled once this one is done.
+        return false;
+    }
+
+    void
+    on_variable_unfolded (const IDebugger::VariableSafePtr a_var,
+                          Gtk::TreeRowReference a_row_ref)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY;
+
+        var_in_flight.reset ();
+        if (!in_flight_is_requested) {
+            unsigned nb_members = a_var->members ().size ();
+            budget_left =
+                nb_members < budget_left ? budget_left - nb_members : 0;
+        }
+
+        // Even if the inferior resumed in the mean time, the members
+        // are shown if the row still holds the variable: otherwise
+        // they would be fetched twice.
+        if (a_row_ref.is_valid ()) {
+            Gtk::TreeModel::Path path = a_row_ref.get_path ();
+            Gtk::TreeModel::iterator it = tree_store->get_iter (path);
+            IDebugger::VariableSafePtr var;
+            if (it)
+                var = (*it)[vutil::get_variable_columns ().variable];
+            if (var == a_var
+                && (*it)[vutil::get_variable_columns ().needs_unfolding]) {
+                vutil::update_unfolded_variable (a_var, tree_view, it,
+                                                 false /* do not truncate type */);
+                if (row_to_expand
+                    && row_to_expand->is_valid ()
+                    && row_to_expand->get_path () == path) {
+                    tree_view.expand_row (path, false);
+                    prefetch_children_of (path);
+                }
+            }
+        }
+        row_to_expand.reset ();
+        finish_in_flight ();
+        schedule ();
+
+        NEMIVER_CATCH;
+    }
+
+    void
+    prefetch_children_of (const Gtk::TreeModel::Path &a_path)
+    {
+        Gtk::TreeModel::iterator it = tree_store->get_iter (a_path);
+        if (!it)
+            return;
+        Gtk::TreeModel::Children rows = it->children ();
+        for (Gtk::TreeModel::iterator row_it = rows.begin ();
+             row_it != rows.end ();
+             ++row_it) {
+            if (row_needs_prefetch (row_it))
+                pending_rows.push_back
+                    (Gtk::TreeRowReference (tree_store,
+                                            tree_store->get_path (row_it)));
+        }
+        schedule ();
+    }
+
+    void
+    on_stopped_signal (IDebugger::StopReason,
+                       bool,
+                       const IDebugger::Frame &,
+                       int,
+                       const string&,
+                       const UString&)
+    {
+        budget_left = child_budget;
+    }
+
+    void
+    on_running_signal ()
+    {
+        cancel ();
+    }
+};//end struct ChildPrefetcher::Priv
+
+/// \param a_debugger the debugger the members are fetched from.
+///
+/// \param a_tree_view the tree view showing the variables.
+///
+/// \param a_tree_store the model of a_tree_view.
+///
+/// \param a_child_budget the maximum number of members prefetched
+/// between two stops of the inferior.
+ChildPrefetcher::ChildPrefetcher
+                        (IDebugger &a_debugger,
+                         Gtk::TreeView &a_tree_view,
+                         const Glib::RefPtr<Gtk::TreeStore> &a_tree_store,
+                         unsigned a_child_budget)
+{
+    m_priv.reset (new Priv (a_debugger, a_tree_view,
+                            a_tree_store, a_child_budget));
+}
+
+ChildPrefetcher::~ChildPrefetcher ()
+{
+}
+
+/// Set the maximum number of members prefetched between two stops
+/// of the inferior.  Zero disables prefetching.
+void
+ChildPrefetcher::child_budget (unsigned a_budget)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->child_budget = a_budget;
+    if (m_priv->budget_left > a_budget)
+        m_priv->budget_left = a_budget;
+}
+
+unsigned
+ChildPrefetcher::child_budget () const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->child_budget;
+}
+
+/// Schedule the prefetch of the members of the variables shown by
+/// the children of the row at a_path.  This is to be called once the
+/// row has been expanded by the user and its own members are shown.
+void
+ChildPrefetcher::prefetch_children_of (const Gtk::TreeModel::Path &a_path)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->prefetch_children_of (a_path);
+}
+
+/// To be called when the user expands the row at a_path, before
+/// unfolding its variable.
+///
+/// \param a_var the variable shown at a_path.
+///
+/// \param a_path the row expanded by the user.
+///
+/// \return true if a_var is being prefetched.  In that case the
+/// row is expanded once its members arrive, and the caller must not
+/// unfold a_var itself.
+bool
+ChildPrefetcher::take_over_expansion (const IDebugger::VariableSafePtr a_var,
+                                      const Gtk::TreeModel::Path &a_path)
+{
+    THROW_IF_FAIL (m_priv);
+    if (!a_var || m_priv->var_in_flight != a_var)
+        return false;
+    m_priv->row_to_expand.reset
+        (new Gtk::TreeRowReference (m_priv->tree_store, a_path));
+    return true;
+}
+
+/// Set the slot used to create the backend object of plain
+/// variables.  Without it, unfold_row leaves the rows of plain
+/// variables alone and they are never prefetched.
+void
+ChildPrefetcher::set_varobj_maker (const VarobjMaker &a_maker)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->varobj_maker = a_maker;
+}
+
+/// Fetch the members of the variable shown at a_path, if they
+/// haven't been fetched yet, without expanding the row.  This goes
+/// before the pending prefetches and is not bounded by the budget.
+///
+/// \param a_path the row to consider.
+///
+/// \param a_done the slot to call once the members of the row are
+/// shown, or once it is known they won't be.
+void
+ChildPrefetcher::unfold_row (const Gtk::TreeModel::Path &a_path,
+                             const sigc::slot<void> &a_done)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->requested_rows.push_back
+        (std::make_pair (Gtk::TreeRowReference (m_priv->tree_store, a_path),
+                         a_done));
+    m_priv->schedule ();
+}
+
+/// Drop the pending requests made with unfold_row.  Their slots are
+/// not called.
+void
+ChildPrefetcher::cancel_row_unfolds ()
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->requested_rows.clear ();
+}
+
+/// Drop the pending prefetches and unfold_row requests.  This is done
+/// automatically when the inferior resumes.
+void
+ChildPrefetcher::cancel ()
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->cancel ();
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,102 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_CHILD_PREFETCHER_H__
+#define __NMV_CHILD_PREFETCHER_H__
+
+#include <gtkmm/treeview.h>
+#include <gtkmm/treestore.h>
+#include "common/nmv-object.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "nmv-i-debugger.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// Speculatively unfolds the variables shown one level below the
+/// rows of a tree of variables that the user has expanded.
+///
+/// Plain variables, that is variables without a backend object like
+/// the locals of the local variables inspector, are only prefetched
+/// if they are aggregates and a VarobjMaker is set: their backend
+/// object is created first.
+///
+/// The members of those variables are fetched from the debugger
+/// during idle time, one variable at a time, while the inferior is
+/// stopped.  So when the user expands one of them, its members are
+/// already there.  The number of members fetched between two stops
+/// is bounded by a budget, and pending prefetches are dropped as soon
+/// as the inferior resumes.
+///
+/// The tree is expected to use the columns of
+/// variables_utils2::get_variable_columns.
+class NEMIVER_API ChildPrefetcher : public nemiver::common::Object {
+    //non copyable
+    ChildPrefetcher (const ChildPrefetcher&);
+    ChildPrefetcher& operator= (const ChildPrefetcher&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+public:
+
+    /// The default maximum number of members prefetched between two
+    /// stops of the inferior.
+    static const unsigned DEFAULT_CHILD_BUDGET = 256;
+
+    /// A slot that creates the backend object of the plain variable
+    /// shown at a given row, puts it in place of the plain variable
+    /// and calls its second argument with it.  The second argument
+    /// is called with a null pointer if the plain variable is not
+    /// shown anymore once the backend object is created.
+    typedef sigc::slot<void,
+                       const Gtk::TreeModel::Path&,
+                       const IDebugger::ConstVariableSlot&> VarobjMaker;
+
+    ChildPrefetcher (IDebugger &a_debugger,
+                     Gtk::TreeView &a_tree_view,
+                     const Glib::RefPtr<Gtk::TreeStore> &a_tree_store,
+                     unsigned a_child_budget = DEFAULT_CHILD_BUDGET);
+    virtual ~ChildPrefetcher ();
+
+    void child_budget (unsigned a_budget);
+    unsigned child_budget () const;
+
+    void prefetch_children_of (const Gtk::TreeModel::Path &a_path);
+
+    bool take_over_expansion (const IDebugger::VariableSafePtr a_var,
+                              const Gtk::TreeModel::Path &a_path);
+
+    void set_varobj_maker (const VarobjMaker &a_maker);
+
+    void unfold_row (const Gtk::TreeModel::Path &a_path,
+                     const sigc::slot<void> &a_done);
+
+    void cancel_row_unfolds ();
+
+    void cancel ();
+};//end ChildPrefetcher
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_CHILD_PREFETCHER_H__
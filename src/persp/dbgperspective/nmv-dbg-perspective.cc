@@ -87,6 +87,10 @@
 #ifdef WITH_MEMORYVIEW
 #include "nmv-memory-view.h"
 #endif // WITH_MEMORYVIEW
+#include "nmv-array-view.h"
+#include "nmv-parallel-stacks-view.h"
+#include "nmv-profiler-view.h"
+#include "nmv-lock-wait-view.h"
 #include "nmv-watchpoint-dialog.h"
 #include "nmv-debugger-utils.h"
 #include "nmv-set-jump-to-dialog.h"
@@ -121,6 +125,10 @@ const char *BREAKPOINTS_VIEW_TITLE       = _("Breakpoints");
 const char *REGISTERS_VIEW_TITLE         = _("Registers");
 const char *MEMORY_VIEW_TITLE            = _("Memory");
 const char *EXPR_MONITOR_VIEW_TITLE      = _("Expression Monitor");
+const char *ARRAY_VIEW_TITLE             = _("Array");
+const char *PARALLEL_STACKS_VIEW_TITLE   = _("Parallel Stacks");
+const char *PROFILER_VIEW_TITLE          = _("Profiler");
+const char *LOCK_WAIT_VIEW_TITLE         = _("Lock Waits");
 
 const char *CAPTION_SESSION_NAME = "captionname";
 const char *SESSION_NAME = "sessionname";
@@ -137,6 +145,10 @@ const char *DISASSEMBLY_TITLE = "<Disassembly>";
 
 static const int NUM_INSTR_TO_DISASSEMBLE = 20;
 
+// The maximum number of variables kept around to show the value of
+// the expressions hovered in the source editor, during a given stop.
+static const unsigned MAX_NB_CACHED_HOVER_VARIABLES = 64;
+
 const char *DBG_PERSPECTIVE_DEFAULT_LAYOUT = "default-layout";
 
 const Gtk::StockID STOCK_SET_BREAKPOINT (SET_BREAKPOINT);
@@ -295,6 +307,7 @@ private:
     void on_breakpoint_go_to_source_action
                                 (const IDebugger::Breakpoint& a_breakpoint);
     void on_thread_list_thread_selected_signal (int a_tid);
+    void on_thread_list_break_in_thread_requested_signal (int a_tid);
 
     void on_switch_page_signal (Gtk::Widget *a_page, guint a_page_num);
 
@@ -336,6 +349,10 @@ private:
     void on_conf_key_changed_signal (const UString &a_key,
                                      const UString &a_namespace);
 
+    bool get_inline_values (std::map<UString, UString> &a_values);
+
+    void on_local_vars_values_changed_signal ();
+
     void on_debugger_connected_to_remote_target_signal ();
 
     void on_debugger_inferior_re_run_signal ();
@@ -363,6 +380,11 @@ private:
                                          const string&,
                                          const UString &a_cookie);
 
+    void on_debugger_breakpoint_modified_signal
+                                        (const IDebugger::Breakpoint&,
+                                         const string&,
+                                         const UString &a_cookie);
+
     void on_debugger_got_overloads_choice_signal
                     (const vector<IDebugger::OverloadsChoiceEntry> &entries,
                      const UString &a_cookie);
@@ -413,7 +435,8 @@ private:
                              const Address &address);
 
     void on_variable_created_for_tooltip_signal
-                                    (const IDebugger::VariableSafePtr);
+                                    (const IDebugger::VariableSafePtr,
+                                     const UString &a_cache_key);
     void on_popup_tip_hide ();
 
     bool on_file_content_changed (const UString &a_path);
@@ -428,6 +451,10 @@ private:
     void on_activate_memory_view ();
 #endif // WITH_MEMORYVIEW
     void on_activate_expr_monitor_view ();
+    void on_activate_array_view ();
+    void on_activate_parallel_stacks_view ();
+    void on_activate_profiler_view ();
+    void on_activate_lock_wait_view ();
     void on_activate_global_variables ();
     void on_default_config_read ();
 
@@ -477,6 +504,9 @@ private:
     void record_and_save_session (ISessMgr::Session &a_session);
     IProcMgr* get_process_manager ();
     void try_to_request_show_variable_value_at_position (int a_x, int a_y);
+    UString build_hover_cache_key (const UString &a_expr) const;
+    void clear_hover_cache ();
+    void cancel_hover_request ();
     void show_underline_tip_at_position (int a_x, int a_y,
                                          const UString &a_text);
     void show_underline_tip_at_position (int a_x, int a_y,
@@ -647,7 +677,10 @@ public:
                          bool a_is_count_point);
     void set_breakpoint (const Address &a_address,
                          bool a_is_count_point);
-    void set_breakpoint (const IDebugger::Breakpoint &a_breakpoint);
+    void set_breakpoint (const IDebugger::Breakpoint &a_breakpoint,
+                         bool a_defer_if_no_thread = true);
+    void set_breakpoints (const vector<IDebugger::Breakpoint> &a_breaks);
+    void set_pending_thread_breakpoints (int a_thread_id);
     void re_initialize_set_breakpoints ();
     void append_breakpoint (const IDebugger::Breakpoint &a_breakpoint);
     void append_breakpoints
@@ -754,6 +787,8 @@ public:
 
     Gtk::ScrolledWindow& get_local_vars_inspector_scrolled_win ();
 
+    Gtk::Box& get_local_vars_inspector_box ();
+
     Terminal& get_terminal ();
 
     Gtk::Box& get_terminal_box ();
@@ -768,6 +803,8 @@ public:
 
     Gtk::ScrolledWindow& get_expressions_monitor_scrolled_win ();
 
+    Gtk::Box& get_expressions_monitor_box ();
+
     RegistersView& get_registers_view ();
 
 #ifdef WITH_MEMORYVIEW
@@ -776,6 +813,14 @@ public:
 
     ExprMonitor& get_expr_monitor_view ();
 
+    ArrayView& get_array_view ();
+
+    ParallelStacksView& get_parallel_stacks_view ();
+
+    ProfilerView& get_profiler_view ();
+
+    LockWaitView& get_lock_wait_view ();
+
     ThreadList& get_thread_list ();
 
     bool set_where (const IDebugger::Frame &a_frame,
@@ -905,6 +950,7 @@ struct DBGPerspective::Priv {
     Path2MonitorMap path_2_monitor_map;
     SafePtr<LocalVarsInspector> variables_editor;
     SafePtr<Gtk::ScrolledWindow> variables_editor_scrolled_win;
+    SafePtr<Gtk::Box> variables_editor_box;
     SafePtr<Terminal> terminal;
     SafePtr<Gtk::Box> terminal_box;
     SafePtr<Gtk::ScrolledWindow> breakpoints_scrolled_win;
@@ -912,17 +958,25 @@ struct DBGPerspective::Priv {
     SafePtr<ThreadList> thread_list;
     SafePtr<Gtk::ScrolledWindow> registers_scrolled_win;
     SafePtr<Gtk::ScrolledWindow> expressions_monitor_scrolled_win;
+    SafePtr<Gtk::Box> expressions_monitor_box;
     SafePtr<RegistersView> registers_view;
 #ifdef WITH_MEMORYVIEW
     SafePtr<MemoryView> memory_view;
 #endif // WITH_MEMORYVIEW
     SafePtr<ExprMonitor> expr_monitor;
+    SafePtr<ArrayView> array_view;
+    SafePtr<ParallelStacksView> parallel_stacks_view;
+    SafePtr<ProfilerView> profiler_view;
+    SafePtr<LockWaitView> lock_wait_view;
 
     int current_page_num;
     IDebuggerSafePtr debugger;
     IDebugger::Frame current_frame;
     int current_thread_id;
     map<string, IDebugger::Breakpoint> breakpoints;
+    // Thread-specific breakpoints restored from a session, waiting
+    // for their thread to be created.
+    list<IDebugger::Breakpoint> pending_thread_breakpoints;
     ISessMgrSafePtr session_manager;
     ISessMgr::Session session;
     IProcMgrSafePtr process_manager;
@@ -932,6 +986,7 @@ struct DBGPerspective::Priv {
     bool confirm_before_reload_source;
     bool allow_auto_reload_source;
     bool enable_syntax_highlight;
+    bool show_inline_values;
     UString custom_font_name;
     UString system_font_name;
     bool use_launch_terminal;
@@ -959,6 +1014,14 @@ struct DBGPerspective::Priv {
     UString var_to_popup;
     int var_popup_tip_x;
     int var_popup_tip_y;
+    // The variables created to show the value of hovered
+    // expressions, keyed by expression and frame.  They are reused
+    // until the next stop.
+    map<UString, IDebugger::VariableSafePtr> hover_cache;
+    // The keys of the hover variables being created.
+    map<UString, bool> pending_hover_requests;
+    // The key of the hover variable to show once it's created.
+    UString hover_key_to_popup;
     //****************************************
     //</variable value popup tip related data>
     //****************************************
@@ -991,6 +1054,7 @@ struct DBGPerspective::Priv {
         confirm_before_reload_source (true),
         allow_auto_reload_source (true),
         enable_syntax_highlight (true),
+        show_inline_values (false),
         use_launch_terminal (false),
         num_instr_to_disassemble (NUM_INSTR_TO_DISASSEMBLE),
         asm_style_pure (true),
@@ -1808,6 +1872,40 @@ DBGPerspective::on_thread_list_thread_selected_signal (int a_tid)
     NEMIVER_CATCH;
 }
 
+/// Set a breakpoint that stops only the thread a_tid at the line of
+/// the cursor, or restrict the breakpoint already set there to that
+/// thread.
+void
+DBGPerspective::on_thread_list_break_in_thread_requested_signal (int a_tid)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    NEMIVER_TRY;
+
+    SourceEditor *source_editor = get_current_source_editor ();
+    if (!source_editor
+        || source_editor->get_buffer_type ()
+           != SourceEditor::BUFFER_TYPE_SOURCE)
+        return;
+    UString path;
+    source_editor->get_path (path);
+    if (path.empty ())
+        return;
+
+    gint current_line =
+        source_editor->source_view ().get_source_buffer ()->get_insert
+            ()->get_iter ().get_line () + 1;
+    const IDebugger::Breakpoint *bp = get_breakpoint (path, current_line);
+    if (bp)
+        debugger ()->set_breakpoint_thread (bp->id (), a_tid);
+    else
+        debugger ()->set_breakpoint (path, current_line,
+                                     /*condition=*/"", /*ignore_count=*/0,
+                                     a_tid, /*cookie=*/"");
+
+    NEMIVER_CATCH;
+}
+
 
 void
 DBGPerspective::on_switch_page_signal (Gtk::Widget *a_page,
@@ -1943,6 +2041,7 @@ DBGPerspective::on_motion_notify_event_signal (GdkEventMotion *a_event)
     m_priv->mouse_in_source_editor_x = x;
     m_priv->mouse_in_source_editor_y = y;
     if (m_priv->debugger->get_state () != IDebugger::NOT_STARTED) {
+        cancel_hover_request ();
         restart_mouse_immobile_timer ();
     }
 
@@ -2156,6 +2255,39 @@ DBGPerspective::on_shutdown_signal ()
     NEMIVER_CATCH
 }
 
+/// Provide the source editors with the values of the local
+/// variables to show inline.  The values are those the locals
+/// inspector already got, so no command is sent to the debugger.
+///
+/// \param a_values the values, keyed by variable name.
+///
+/// \return false if no up to date value is available.
+bool
+DBGPerspective::get_inline_values (std::map<UString, UString> &a_values)
+{
+    if (!m_priv->variables_editor
+        || !m_priv->debugger_engine_alive
+        || debugger ()->get_state () != IDebugger::READY)
+        return false;
+    return m_priv->variables_editor->get_variable_values (a_values);
+}
+
+/// Redraw the values shown inline by the current source editor when
+/// the locals inspector got new values.
+void
+DBGPerspective::on_local_vars_values_changed_signal ()
+{
+    NEMIVER_TRY
+
+    if (!m_priv->show_inline_values)
+        return;
+    SourceEditor *editor = get_current_source_editor (false);
+    if (editor)
+        editor->refresh_inline_values ();
+
+    NEMIVER_CATCH
+}
+
 /// Function called whenever a the value of a configuration key
 /// changes on the sytem.
 ///
@@ -2211,6 +2343,17 @@ DBGPerspective::on_conf_key_changed_signal (const UString &a_key,
                                                 (highlight);
             }
         }
+    } else if (a_key == CONF_KEY_SHOW_INLINE_VALUES) {
+        conf_mgr.get_key_value (a_key,
+                                m_priv->show_inline_values,
+                                a_namespace);
+        map<int, SourceEditor*>::iterator it;
+        for (it = m_priv->pagenum_2_source_editor_map.begin ();
+             it != m_priv->pagenum_2_source_editor_map.end ();
+             ++it) {
+            if (it->second)
+                it->second->show_inline_values (m_priv->show_inline_values);
+        }
     } else if (a_key == CONF_KEY_USE_SYSTEM_FONT) {
         conf_mgr.get_key_value (a_key, m_priv->use_system_font, a_namespace);
         UString font_name;
@@ -2416,35 +2559,11 @@ DBGPerspective::on_debugger_bp_automatically_set_on_main
 void
 DBGPerspective::on_debugger_breakpoints_list_signal
                             (const map<string, IDebugger::Breakpoint> &a_breaks,
-                             const UString &a_cookie)
+                             const UString &/*a_cookie*/)
 {
     LOG_FUNCTION_SCOPE_NORMAL_DD;
 
     NEMIVER_TRY
-    // if a breakpoint was stored in the session db as disabled,
-    // it must be set initially and then immediately disabled.
-    // When the breakpoint is set, it
-    // will send a 'cookie' along of the form
-    // "initiallly-disabled#filename.cc#123"
-    if (a_cookie.find ("initially-disabled") != UString::npos) {
-        UString::size_type start_of_file = a_cookie.find ('#') + 1;
-        UString::size_type start_of_line = a_cookie.rfind ('#') + 1;
-        UString file = a_cookie.substr (start_of_file,
-                                        (start_of_line - 1) - start_of_file);
-        int line = atoi
-                (a_cookie.substr (start_of_line,
-                                  a_cookie.size () - start_of_line).c_str ());
-        map<string, IDebugger::Breakpoint>::const_iterator break_iter;
-        for (break_iter = a_breaks.begin ();
-             break_iter != a_breaks.end ();
-             ++break_iter) {
-            if ((break_iter->second.file_full_name () == file
-                    || break_iter->second.file_name () == file)
-                 && break_iter->second.line () == line) {
-                debugger ()->disable_breakpoint (break_iter->second.id ());
-            }
-        }
-    }
     LOG_DD ("debugger engine set breakpoints");
     append_breakpoints (a_breaks);
     SourceEditor* editor = get_current_source_editor ();
@@ -2478,6 +2597,7 @@ DBGPerspective::on_debugger_stopped_signal (IDebugger::StopReason a_reason,
     update_src_dependant_bp_actions_sensitiveness ();
     m_priv->current_frame = a_frame;
     m_priv->current_thread_id = a_thread_id;
+    clear_hover_cache ();
 
     set_where (a_frame, /*do_scroll=*/true, /*try_hard=*/true);
 
@@ -2597,6 +2717,35 @@ DBGPerspective::on_debugger_breakpoint_deleted_signal
     NEMIVER_CATCH
 }
 
+/// Update the visual representation of a breakpoint that changed.
+/// If the breakpoint moved, e.g because it was pending and got
+/// resolved, its previous visual representation is removed first.
+void
+DBGPerspective::on_debugger_breakpoint_modified_signal
+                                        (const IDebugger::Breakpoint &a_break,
+                                         const string &a_break_number,
+                                         const UString &)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    NEMIVER_TRY
+
+    map<string, IDebugger::Breakpoint>::iterator i =
+        m_priv->breakpoints.find (a_break_number);
+    if (i != m_priv->breakpoints.end ()
+        && (i->second.line () != a_break.line ()
+            || !(i->second.address () == a_break.address ())
+            || i->second.is_pending () != a_break.is_pending ()))
+        delete_visual_breakpoint (i);
+
+    append_breakpoint (a_break);
+    SourceEditor* editor = get_current_source_editor ();
+    if (editor)
+        update_toggle_menu_text (*editor);
+
+    NEMIVER_CATCH
+}
+
 void
 DBGPerspective::on_debugger_got_overloads_choice_signal
                     (const vector<IDebugger::OverloadsChoiceEntry> &entries,
@@ -2767,14 +2916,26 @@ DBGPerspective::on_debugger_asm_signal4
     NEMIVER_CATCH
 }
 
+/// Callback invoked when the variable of an expression hovered in
+/// the source editor got created.  The variable is cached, and shown
+/// only if the mouse is still on the expression.
+///
+/// \param a_var the created variable.
+///
+/// \param a_cache_key the key of a_var in the hover cache.
 void
 DBGPerspective::on_variable_created_for_tooltip_signal
-                                (const IDebugger::VariableSafePtr a_var)
+                                (const IDebugger::VariableSafePtr a_var,
+                                 const UString &a_cache_key)
 {
     NEMIVER_TRY
 
+    if (m_priv->pending_hover_requests.erase (a_cache_key)
+        && m_priv->hover_cache.size () < MAX_NB_CACHED_HOVER_VARIABLES)
+        m_priv->hover_cache[a_cache_key] = a_var;
+
     if (m_priv->in_show_var_value_at_pos_transaction
-        && m_priv->var_to_popup == a_var->name ()) {
+        && m_priv->hover_key_to_popup == a_cache_key) {
         show_underline_tip_at_position (m_priv->var_popup_tip_x,
                                         m_priv->var_popup_tip_y,
                                         a_var);
@@ -2954,6 +3115,58 @@ DBGPerspective::on_activate_expr_monitor_view ()
     NEMIVER_CATCH;
 }
 
+void
+DBGPerspective::on_activate_array_view ()
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    NEMIVER_TRY;
+
+    THROW_IF_FAIL (m_priv);
+    m_priv->layout ().activate_view (ARRAY_VIEW_INDEX);
+
+    NEMIVER_CATCH;
+}
+
+void
+DBGPerspective::on_activate_parallel_stacks_view ()
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    NEMIVER_TRY;
+
+    THROW_IF_FAIL (m_priv);
+    m_priv->layout ().activate_view (PARALLEL_STACKS_VIEW_INDEX);
+
+    NEMIVER_CATCH;
+}
+
+void
+DBGPerspective::on_activate_profiler_view ()
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    NEMIVER_TRY;
+
+    THROW_IF_FAIL (m_priv);
+    m_priv->layout ().activate_view (PROFILER_VIEW_INDEX);
+
+    NEMIVER_CATCH;
+}
+
+void
+DBGPerspective::on_activate_lock_wait_view ()
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    NEMIVER_TRY;
+
+    THROW_IF_FAIL (m_priv);
+    m_priv->layout ().activate_view (LOCK_WAIT_VIEW_INDEX);
+
+    NEMIVER_CATCH;
+}
+
 void
 DBGPerspective::on_activate_global_variables ()
 {
@@ -3580,6 +3793,48 @@ DBGPerspective::init_actions ()
             "<alt>6",
             false
         },
+        {
+            "ActivateArrayViewMenuAction",
+            nil_stock_id,
+            ARRAY_VIEW_TITLE,
+            _("Switch to Array View"),
+            sigc::mem_fun (*this, &DBGPerspective::on_activate_array_view),
+            ActionEntry::DEFAULT,
+            "<alt>7",
+            false
+        },
+        {
+            "ActivateParallelStacksViewMenuAction",
+            nil_stock_id,
+            PARALLEL_STACKS_VIEW_TITLE,
+            _("Switch to Parallel Stacks View"),
+            sigc::mem_fun (*this,
+                           &DBGPerspective::on_activate_parallel_stacks_view),
+            ActionEntry::DEFAULT,
+            "<alt>8",
+            false
+        },
+        {
+            "ActivateProfilerViewMenuAction",
+            nil_stock_id,
+            PROFILER_VIEW_TITLE,
+            _("Switch to Profiler View"),
+            sigc::mem_fun (*this, &DBGPerspective::on_activate_profiler_view),
+            ActionEntry::DEFAULT,
+            "<alt>9",
+            false
+        },
+        {
+            "ActivateLockWaitViewMenuAction",
+            nil_stock_id,
+            LOCK_WAIT_VIEW_TITLE,
+            _("Switch to Lock Waits View"),
+            sigc::mem_fun (*this,
+                           &DBGPerspective::on_activate_lock_wait_view),
+            ActionEntry::DEFAULT,
+            "<alt>0",
+            false
+        },
         {
             "DebugMenuAction",
             nil_stock_id,
@@ -3822,7 +4077,7 @@ DBGPerspective::init_body ()
     get_call_stack_paned ().add2 (get_call_stack_scrolled_win ());
 
     get_context_paned ().pack1 (get_call_stack_paned ());
-    get_context_paned ().pack2 (get_local_vars_inspector_scrolled_win ());
+    get_context_paned ().pack2 (get_local_vars_inspector_box ());
 
     int context_pane_location = -1;
     NEMIVER_TRY
@@ -3885,6 +4140,11 @@ DBGPerspective::init_signals ()
     get_thread_list ().thread_selected_signal ().connect (sigc::mem_fun
         (*this, &DBGPerspective::on_thread_list_thread_selected_signal));
 
+    get_thread_list ().break_in_thread_requested_signal ().connect
+        (sigc::mem_fun
+         (*this,
+          &DBGPerspective::on_thread_list_break_in_thread_requested_signal));
+
     default_config_read_signal ().connect (sigc::mem_fun (this,
                 &DBGPerspective::on_default_config_read));
 
@@ -3916,6 +4176,9 @@ DBGPerspective::init_debugger_signals ()
     debugger ()->breakpoint_deleted_signal ().connect (sigc::mem_fun
             (*this, &DBGPerspective::on_debugger_breakpoint_deleted_signal));
 
+    debugger ()->breakpoint_modified_signal ().connect (sigc::mem_fun
+            (*this, &DBGPerspective::on_debugger_breakpoint_modified_signal));
+
     debugger ()->got_overloads_choice_signal ().connect (sigc::mem_fun
         (*this, &DBGPerspective::on_debugger_got_overloads_choice_signal));
 
@@ -3945,6 +4208,9 @@ DBGPerspective::init_debugger_signals ()
 
     debugger ()->got_target_info_signal ().connect (sigc::mem_fun
             (*this, &DBGPerspective::on_debugger_got_target_info_signal));
+
+    debugger ()->thread_created_signal ().connect (sigc::mem_fun
+            (*this, &DBGPerspective::set_pending_thread_breakpoints));
 }
 
 void
@@ -3959,6 +4225,10 @@ DBGPerspective::clear_status_notebook (bool a_restarting)
     get_memory_view ().clear ();
 #endif // WITH_MEMORYVIEW
     get_expr_monitor_view ().re_init_widget (a_restarting);
+    get_array_view ().clear ();
+    get_parallel_stacks_view ().clear ();
+    get_profiler_view ().clear ();
+    get_lock_wait_view ().clear ();
 }
 
 void
@@ -4857,6 +5127,8 @@ DBGPerspective::read_default_config ()
                             m_priv->enable_syntax_highlight);
     conf_mgr.get_key_value (CONF_KEY_SHOW_SOURCE_LINE_NUMBERS,
                             m_priv->show_line_numbers);
+    conf_mgr.get_key_value (CONF_KEY_SHOW_INLINE_VALUES,
+                            m_priv->show_inline_values);
     conf_mgr.get_key_value (CONF_KEY_CONFIRM_BEFORE_RELOAD_SOURCE,
                             m_priv->confirm_before_reload_source);
     conf_mgr.get_key_value (CONF_KEY_USE_SYSTEM_FONT,
@@ -4954,14 +5226,77 @@ DBGPerspective::try_to_request_show_variable_value_at_position (int a_x,
     int abs_x=0, abs_y=0;
     if (!source_view_to_root_window_coordinates (a_x, a_y, abs_x, abs_y))
         return;
+
+    // Reuse the variable created for the same expression in the same
+    // frame during this stop, if any.
+    UString key = build_hover_cache_key (var_name);
+    map<UString, IDebugger::VariableSafePtr>::const_iterator it =
+        m_priv->hover_cache.find (key);
+    if (it != m_priv->hover_cache.end ()) {
+        LOG_DD ("reusing the variable of '" << var_name << "'");
+        m_priv->in_show_var_value_at_pos_transaction = false;
+        show_underline_tip_at_position (abs_x, abs_y, it->second);
+        return;
+    }
+
     m_priv->in_show_var_value_at_pos_transaction = true;
     m_priv->var_popup_tip_x = abs_x;
     m_priv->var_popup_tip_y = abs_y;
     m_priv->var_to_popup = var_name;
+    m_priv->hover_key_to_popup = key;
+
+    // Don't create the variable twice if it's already being created;
+    // on_variable_created_for_tooltip_signal will show it.
+    if (m_priv->pending_hover_requests.find (key)
+        != m_priv->pending_hover_requests.end ())
+        return;
+    m_priv->pending_hover_requests[key] = true;
     debugger ()->create_variable
         (var_name,
-         sigc::mem_fun (*this,
-                        &DBGPerspective::on_variable_created_for_tooltip_signal));
+         sigc::bind
+         (sigc::mem_fun (*this,
+                         &DBGPerspective::on_variable_created_for_tooltip_signal),
+          key));
+}
+
+/// Build the key of an hovered expression in the hover cache.  The
+/// variable of an expression depends on the frame it is evaluated
+/// in, so the current frame is part of the key.
+///
+/// \param a_expr the hovered expression.
+UString
+DBGPerspective::build_hover_cache_key (const UString &a_expr) const
+{
+    THROW_IF_FAIL (m_priv);
+
+    UString key = a_expr;
+    key += "@" + UString::from_int (m_priv->current_thread_id)
+           + ":" + UString::from_int (m_priv->current_frame.level ())
+           + ":" + m_priv->current_frame.address ().to_string ();
+    return key;
+}
+
+/// Forget the variables created to show the value of hovered
+/// expressions.  Their values are obsolete once the inferior ran.
+void
+DBGPerspective::clear_hover_cache ()
+{
+    THROW_IF_FAIL (m_priv);
+
+    m_priv->hover_cache.clear ();
+    m_priv->pending_hover_requests.clear ();
+    cancel_hover_request ();
+}
+
+/// Make sure the result of the hover request in flight, if any, is
+/// not shown.  The variable it creates is still cached.
+void
+DBGPerspective::cancel_hover_request ()
+{
+    THROW_IF_FAIL (m_priv);
+
+    m_priv->in_show_var_value_at_pos_transaction = false;
+    m_priv->hover_key_to_popup = "";
 }
 
 /// Popup a tip at a given position, showing some text content.
@@ -5134,9 +5469,21 @@ DBGPerspective::add_views_to_layout ()
                                    MEMORY_VIEW_TITLE,
                                    MEMORY_VIEW_INDEX);
     #endif // WITH_MEMORYVIEW
-    m_priv->layout ().append_view (get_expressions_monitor_scrolled_win (),
+    m_priv->layout ().append_view (get_expressions_monitor_box (),
                                    EXPR_MONITOR_VIEW_TITLE,
                                    EXPR_MONITOR_VIEW_INDEX);
+    m_priv->layout ().append_view (get_array_view ().widget (),
+                                   ARRAY_VIEW_TITLE,
+                                   ARRAY_VIEW_INDEX);
+    m_priv->layout ().append_view (get_parallel_stacks_view ().widget (),
+                                   PARALLEL_STACKS_VIEW_TITLE,
+                                   PARALLEL_STACKS_VIEW_INDEX);
+    m_priv->layout ().append_view (get_profiler_view ().widget (),
+                                   PROFILER_VIEW_TITLE,
+                                   PROFILER_VIEW_INDEX);
+    m_priv->layout ().append_view (get_lock_wait_view ().widget (),
+                                   LOCK_WAIT_VIEW_TITLE,
+                                   LOCK_WAIT_VIEW_INDEX);
     m_priv->layout ().do_init ();
 
 }
@@ -5225,7 +5572,8 @@ DBGPerspective::record_and_save_session (ISessMgr::Session &a_session)
                                      break_iter->second.condition (),
                                      break_iter->second.initial_ignore_count (),
                                      debugger ()->is_countpoint
-                                     (break_iter->second));
+                                     (break_iter->second),
+                                     break_iter->second.thread_id ());
             a_session.breakpoints ().push_back (bp);
             parent_ids_added[parent_id] = true;
             LOG_DD ("Regular breakpoint scheduled to be stored");
@@ -5239,6 +5587,24 @@ DBGPerspective::record_and_save_session (ISessMgr::Session &a_session)
         }
     }
 
+    // Thread-specific breakpoints whose thread was never created
+    // are not known to the debugger, but they are part of the
+    // session all the same.
+    list<IDebugger::Breakpoint>::const_iterator pending_iter;
+    for (pending_iter = m_priv->pending_thread_breakpoints.begin ();
+         pending_iter != m_priv->pending_thread_breakpoints.end ();
+         ++pending_iter) {
+        ISessMgr::Breakpoint bp (pending_iter->file_name (),
+                                 pending_iter->file_full_name (),
+                                 pending_iter->line (),
+                                 pending_iter->enabled (),
+                                 pending_iter->condition (),
+                                 pending_iter->initial_ignore_count (),
+                                 debugger ()->is_countpoint (*pending_iter),
+                                 pending_iter->thread_id ());
+        a_session.breakpoints ().push_back (bp);
+    }
+
     THROW_IF_FAIL (session_manager_ptr ());
 
     a_session.search_paths ().clear ();
@@ -5400,6 +5766,9 @@ DBGPerspective::create_source_editor (Glib::RefPtr<Gsv::Buffer> &a_source_buf,
                                            false));
         source_editor->source_view ().set_show_line_numbers
                                                 (m_priv->show_line_numbers);
+        source_editor->set_inline_values_provider
+            (sigc::mem_fun (*this, &DBGPerspective::get_inline_values));
+        source_editor->show_inline_values (m_priv->show_inline_values);
         current_line = a_current_line;
     }
 
@@ -5910,6 +6279,7 @@ DBGPerspective::execute_session (ISessMgr::Session &a_session)
         breakpoint.enabled (it->enabled ());
         breakpoint.condition (it->condition ());
         breakpoint.initial_ignore_count (it->ignore_count ());
+        breakpoint.thread_id (it->thread_id ());
         if (it->is_countpoint ()) {
             breakpoint.type (IDebugger::Breakpoint::COUNTPOINT_TYPE);
             LOG_DD ("breakpoint "
@@ -6213,12 +6583,14 @@ DBGPerspective::execute_program
 
     // delete old breakpoints, if any.
     m_priv->breakpoints.clear();
-    map<string, IDebugger::Breakpoint>::const_iterator bp_it;
-    for (bp_it = saved_bps.begin ();
-         bp_it != saved_bps.end ();
-         ++bp_it) {
-        if (m_priv->debugger_engine_alive)
-            dbg_engine->delete_breakpoint (bp_it->first);
+    if (m_priv->debugger_engine_alive && !saved_bps.empty ()) {
+        vector<string> bp_ids;
+        map<string, IDebugger::Breakpoint>::const_iterator bp_it;
+        for (bp_it = saved_bps.begin ();
+             bp_it != saved_bps.end ();
+             ++bp_it)
+            bp_ids.push_back (bp_it->first);
+        dbg_engine->delete_breakpoints (bp_ids);
     }
 
     if (is_new_program) {
@@ -6251,6 +6623,9 @@ DBGPerspective::execute_program
     // set environment variables of the inferior
     dbg_engine->add_env_variables (a_env);
 
+    // The breakpoints are set again below.
+    m_priv->pending_thread_breakpoints.clear ();
+
     // If this is a new program we are debugging,
     // set a breakpoint in 'main' by default.
     if (a_breaks.empty ()) {
@@ -6259,6 +6634,7 @@ DBGPerspective::execute_program
             LOG_DD ("here");
             map<string, IDebugger::Breakpoint>::const_iterator it;
             map<string, bool> bps_set;
+            vector<IDebugger::Breakpoint> bps_to_set;
             UString parent_id;
             for (it = saved_bps.begin ();
                  it != saved_bps.end ();
@@ -6273,17 +6649,18 @@ DBGPerspective::execute_program
                         parent_id = i->parent_id ();
                         if (bps_set.find (parent_id) != bps_set.end ())
                             continue;
-                        set_breakpoint (*i);
+                        bps_to_set.push_back (*i);
                         bps_set[parent_id] = true;
                     }
                 } else {
                     parent_id = it->second.parent_id();
                     if (bps_set.find (parent_id) != bps_set.end ())
                         continue;
-                    set_breakpoint (it->second);
+                    bps_to_set.push_back (it->second);
                     bps_set[parent_id] = true;
                 }
             }
+            set_breakpoints (bps_to_set);
             if (!saved_bps.empty())
                 // We are restarting the same program, and we hope that
                 // some that at least one breakpoint is actually going to
@@ -6304,14 +6681,16 @@ DBGPerspective::execute_program
         LOG_DD ("here");
         vector<IDebugger::Breakpoint>::const_iterator it;
         map<string, bool> bps_set;
+        vector<IDebugger::Breakpoint> bps_to_set;
         UString parent_id;
         for (it = a_breaks.begin (); it != a_breaks.end (); ++it) {
             parent_id = it->parent_id ();
             if (bps_set.find (parent_id) != bps_set.end ())
                 continue;
-            set_breakpoint (*it);
+            bps_to_set.push_back (*it);
             bps_set[parent_id] = true;
         }
+        set_breakpoints (bps_to_set);
         // Here we are starting (or restarting) the program and we
         // hope at least one breakpoint is going to be set; so lets
         // schedule the continuation of the execution of the inferior.
@@ -6935,41 +7314,39 @@ DBGPerspective::set_breakpoint (const Address &a_address,
                                  a_is_count_point ? -1 : 0);
 }
 
+/// Set a breakpoint described by a_breakpoint, e.g. one restored
+/// from a session.
+///
+/// \param a_defer_if_no_thread if true and the breakpoint stops only
+/// a thread that is not in the thread list, wait for that thread to
+/// be created before setting the breakpoint.
 void
-DBGPerspective::set_breakpoint (const IDebugger::Breakpoint &a_breakpoint)
+DBGPerspective::set_breakpoint (const IDebugger::Breakpoint &a_breakpoint,
+                                bool a_defer_if_no_thread)
 {
-    UString file_name = a_breakpoint.file_full_name ().empty ()
-        ? a_breakpoint.file_name ()
-        : a_breakpoint.file_full_name ();
-
-    // If the breakpoint was marked as 'disabled' in the session DB,
-    // we have to set it and immediately disable it.  We need to pass
-    // along some additional information in the 'cookie' to determine
-    // which breakpoint needs to be disabling after it is set.
-    UString cookie = a_breakpoint.enabled ()
-        ? ""
-        : "initially-disabled#" + file_name
-        + "#" + UString::from_int (a_breakpoint.line ());
-
-    // Now set the breakpoint proper.
     if (a_breakpoint.type () == IDebugger::Breakpoint::STANDARD_BREAKPOINT_TYPE
         || a_breakpoint.type () == IDebugger::Breakpoint::COUNTPOINT_TYPE) {
-        int ignore_count =
-            debugger ()->is_countpoint (a_breakpoint)
-            ? -1
-            : a_breakpoint.initial_ignore_count ();
-
-        if (!file_name.empty ())
-            debugger ()->set_breakpoint (file_name,
-                                         a_breakpoint.line (),
-                                         a_breakpoint.condition (),
-                                         ignore_count, cookie);
-        else if (!a_breakpoint.address ().empty ())
-            debugger ()->set_breakpoint (a_breakpoint.address (),
-                                         a_breakpoint.condition (),
-                                         ignore_count, cookie);
-        // else we don't set this breakpoint as it has neither an
-        // address or a file name associated.
+        if (a_breakpoint.is_thread_specific () && a_defer_if_no_thread) {
+            // GDB refuses to set a breakpoint for a thread that
+            // doesn't exist, which is the case when the breakpoint
+            // comes from a session and the inferior is not running
+            // yet.  The breakpoint is then set when its thread gets
+            // created.
+            const list<int> &threads = get_thread_list ().thread_ids ();
+            if (std::find (threads.begin (), threads.end (),
+                           a_breakpoint.thread_id ()) == threads.end ()) {
+                LOG_DD ("deferring breakpoint on thread "
+                        << a_breakpoint.thread_id ());
+                m_priv->pending_thread_breakpoints.push_back (a_breakpoint);
+                return;
+            }
+        }
+
+        // This sets the breakpoint with its condition, its thread
+        // and its ignore count, and disabled right away if it was
+        // disabled.  A breakpoint that has no location is not set.
+        debugger ()->set_breakpoints
+            (vector<IDebugger::Breakpoint> (1, a_breakpoint));
     } else if (a_breakpoint.type ()
                == IDebugger::Breakpoint::WATCHPOINT_TYPE) {
         debugger ()->set_watchpoint (a_breakpoint.expression (),
@@ -6978,6 +7355,60 @@ DBGPerspective::set_breakpoint (const IDebugger::Breakpoint &a_breakpoint)
     }
 }
 
+/// Set several breakpoints at once, e.g. the breakpoints of a
+/// session.  Unlike set_breakpoint, this doesn't wait for each
+/// breakpoint to be set before setting the next one.
+///
+/// The thread-specific breakpoints which thread doesn't exist yet
+/// are set when their thread gets created.
+void
+DBGPerspective::set_breakpoints (const vector<IDebugger::Breakpoint> &a_breaks)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    const list<int> &threads = get_thread_list ().thread_ids ();
+    vector<IDebugger::Breakpoint> breaks;
+    vector<IDebugger::Breakpoint>::const_iterator it;
+    for (it = a_breaks.begin (); it != a_breaks.end (); ++it) {
+        if (it->is_thread_specific ()
+            && std::find (threads.begin (), threads.end (),
+                          it->thread_id ()) == threads.end ()) {
+            LOG_DD ("deferring breakpoint on thread " << it->thread_id ());
+            m_priv->pending_thread_breakpoints.push_back (*it);
+            continue;
+        }
+        breaks.push_back (*it);
+    }
+    if (!breaks.empty ())
+        debugger ()->set_breakpoints (breaks);
+}
+
+/// Set the thread-specific breakpoints that were waiting for the
+/// thread a_thread_id to be created.
+void
+DBGPerspective::set_pending_thread_breakpoints (int a_thread_id)
+{
+    LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+    NEMIVER_TRY;
+
+    list<IDebugger::Breakpoint> &pending =
+        m_priv->pending_thread_breakpoints;
+    list<IDebugger::Breakpoint>::iterator it = pending.begin ();
+    while (it != pending.end ()) {
+        if (it->thread_id () != a_thread_id) {
+            ++it;
+            continue;
+        }
+        IDebugger::Breakpoint bp = *it;
+        it = pending.erase (it);
+        // The thread is not in the thread list yet.
+        set_breakpoint (bp, /*a_defer_if_no_thread=*/false);
+    }
+
+    NEMIVER_CATCH;
+}
+
 /// Re-set ignore count on breakpoints that are already set.
 void
 DBGPerspective::re_initialize_set_breakpoints ()
@@ -8345,6 +8776,10 @@ DBGPerspective::get_local_vars_inspector ()
             (new LocalVarsInspector (debugger (),
                                      *m_priv->workbench,
                                      *this));
+        m_priv->variables_editor->values_changed_signal ().connect
+            (sigc::mem_fun
+                 (*this,
+                  &DBGPerspective::on_local_vars_values_changed_signal));
     }
     THROW_IF_FAIL (m_priv->variables_editor);
     return *m_priv->variables_editor;
@@ -8363,6 +8798,25 @@ DBGPerspective::get_local_vars_inspector_scrolled_win ()
     return *m_priv->variables_editor_scrolled_win;
 }
 
+/// \return the box holding the search bar of the local variables
+/// inspector, on top of its scrolled window.
+Gtk::Box&
+DBGPerspective::get_local_vars_inspector_box ()
+{
+    THROW_IF_FAIL (m_priv);
+    if (!m_priv->variables_editor_box) {
+        m_priv->variables_editor_box.reset
+            (new Gtk::Box (Gtk::ORIENTATION_VERTICAL));
+        THROW_IF_FAIL (m_priv->variables_editor_box);
+        m_priv->variables_editor_box->pack_start
+            (get_local_vars_inspector ().search_bar (), Gtk::PACK_SHRINK);
+        m_priv->variables_editor_box->pack_start
+            (get_local_vars_inspector_scrolled_win ());
+    }
+    THROW_IF_FAIL (m_priv->variables_editor_box);
+    return *m_priv->variables_editor_box;
+}
+
 
 Terminal&
 DBGPerspective::get_terminal ()
@@ -8472,6 +8926,25 @@ DBGPerspective::get_expressions_monitor_scrolled_win ()
     return *m_priv->expressions_monitor_scrolled_win;
 }
 
+/// \return the box holding the search bar of the expression
+/// monitor, on top of its scrolled window.
+Gtk::Box&
+DBGPerspective::get_expressions_monitor_box ()
+{
+    THROW_IF_FAIL (m_priv);
+    if (!m_priv->expressions_monitor_box) {
+        m_priv->expressions_monitor_box.reset
+            (new Gtk::Box (Gtk::ORIENTATION_VERTICAL));
+        THROW_IF_FAIL (m_priv->expressions_monitor_box);
+        m_priv->expressions_monitor_box->pack_start
+            (get_expr_monitor_view ().search_bar (), Gtk::PACK_SHRINK);
+        m_priv->expressions_monitor_box->pack_start
+            (get_expressions_monitor_scrolled_win ());
+    }
+    THROW_IF_FAIL (m_priv->expressions_monitor_box);
+    return *m_priv->expressions_monitor_box;
+}
+
 RegistersView&
 DBGPerspective::get_registers_view ()
 {
@@ -8509,6 +8982,55 @@ DBGPerspective::get_expr_monitor_view ()
     return *m_priv->expr_monitor;
 }
 
+/// Return the view showing arrays of scalars.
+ArrayView&
+DBGPerspective::get_array_view ()
+{
+    THROW_IF_FAIL (m_priv);
+
+    if (!m_priv->array_view)
+        m_priv->array_view.reset (new ArrayView (debugger ()));
+    THROW_IF_FAIL (m_priv->array_view);
+    return *m_priv->array_view;
+}
+
+/// Return the view grouping the call stacks of all the threads.
+ParallelStacksView&
+DBGPerspective::get_parallel_stacks_view ()
+{
+    THROW_IF_FAIL (m_priv);
+
+    if (!m_priv->parallel_stacks_view)
+        m_priv->parallel_stacks_view.reset
+            (new ParallelStacksView (debugger ()));
+    THROW_IF_FAIL (m_priv->parallel_stacks_view);
+    return *m_priv->parallel_stacks_view;
+}
+
+/// Return the sampling profiler view.
+ProfilerView&
+DBGPerspective::get_profiler_view ()
+{
+    THROW_IF_FAIL (m_priv);
+
+    if (!m_priv->profiler_view)
+        m_priv->profiler_view.reset (new ProfilerView (debugger ()));
+    THROW_IF_FAIL (m_priv->profiler_view);
+    return *m_priv->profiler_view;
+}
+
+/// Return the view of the threads blocked on locks.
+LockWaitView&
+DBGPerspective::get_lock_wait_view ()
+{
+    THROW_IF_FAIL (m_priv);
+
+    if (!m_priv->lock_wait_view)
+        m_priv->lock_wait_view.reset (new LockWaitView (debugger ()));
+    THROW_IF_FAIL (m_priv->lock_wait_view);
+    return *m_priv->lock_wait_view;
+}
+
 struct ScrollTextViewToEndClosure {
     Gtk::TextView* text_view;
 
@@ -39,6 +39,10 @@ extern const char *TARGET_TERMINAL_VIEW_TITLE;
 extern const char *BREAKPOINTS_VIEW_TITLE;
 extern const char *REGISTERS_VIEW_TITLE;
 extern const char *MEMORY_VIEW_TITLE;
+extern const char *ARRAY_VIEW_TITLE;
+extern const char *PARALLEL_STACKS_VIEW_TITLE;
+extern const char *PROFILER_VIEW_TITLE;
+extern const char *LOCK_WAIT_VIEW_TITLE;
 
 enum ViewsIndex
 {
@@ -49,7 +53,11 @@ enum ViewsIndex
 #ifdef WITH_MEMORYVIEW
     MEMORY_VIEW_INDEX,
 #endif // WITH_MEMORYVIEW
-    EXPR_MONITOR_VIEW_INDEX
+    EXPR_MONITOR_VIEW_INDEX,
+    ARRAY_VIEW_INDEX,
+    PARALLEL_STACKS_VIEW_INDEX,
+    PROFILER_VIEW_INDEX,
+    LOCK_WAIT_VIEW_INDEX
 };
 
 class SourceEditor;
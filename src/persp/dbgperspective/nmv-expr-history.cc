@@ -0,0 +1,331 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <map>
+#include <iomanip>
+#include "common/nmv-exception.h"
+#include "common/nmv-string-pool.h"
+#include "nmv-expr-history.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+using nemiver::common::StringPool;
+
+// Below that many values, the pool is never compacted.
+static const unsigned MIN_NB_VALUES_TO_COMPACT = 1024;
+
+struct ExprHistory::Priv {
+    struct Entry {
+        unsigned stop_number;
+        gint64 timestamp;
+        int thread_id;
+        StringPool::Id value;
+    };
+
+    // The ring buffer of the samples of one expression.  Once full,
+    // the oldest sample is at index 'oldest'.
+    struct Ring {
+        std::vector<Entry> entries;
+        unsigned oldest;
+
+        Ring () :
+            oldest (0)
+        {
+        }
+    };
+
+    typedef std::map<UString, Ring> Rings;
+
+    unsigned max_nb_samples;
+    // The values of the samples.  A StringPool never drops a value,
+    // so once it holds a lot more values than there are samples, it
+    // is replaced by a pool holding only the values still in use.
+    SafePtr<StringPool> values;
+    unsigned nb_entries;
+    Rings rings;
+
+    Priv (unsigned a_max_nb_samples) :
+        max_nb_samples (a_max_nb_samples),
+        values (new StringPool),
+        nb_entries (0)
+    {
+        THROW_IF_FAIL (max_nb_samples);
+    }
+
+    void maybe_compact_values ()
+    {
+        if (values->size () < MIN_NB_VALUES_TO_COMPACT
+            || values->size () < 2 * nb_entries)
+            return;
+
+        SafePtr<StringPool> compacted (new StringPool);
+        Rings::iterator ring_it;
+        for (ring_it = rings.begin (); ring_it != rings.end (); ++ring_it) {
+            std::vector<Entry>::iterator it;
+            for (it = ring_it->second.entries.begin ();
+                 it != ring_it->second.entries.end ();
+                 ++it)
+                it->value = compacted->intern (values->get (it->value).raw ());
+        }
+        values = compacted;
+    }
+
+    /// Binary search of the entry recorded at a given stop.  The
+    /// entries of a ring are sorted by stop number, starting at
+    /// index 'oldest'.
+    static const Entry* find_entry (const Ring &a_ring,
+                                    unsigned a_stop_number)
+    {
+        unsigned nb = a_ring.entries.size ();
+        unsigned lo = 0, hi = nb;
+        while (lo < hi) {
+            unsigned mid = lo + (hi - lo) / 2;
+            const Entry &e = a_ring.entries[(a_ring.oldest + mid) % nb];
+            if (e.stop_number < a_stop_number)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == nb)
+            return 0;
+        const Entry &e = a_ring.entries[(a_ring.oldest + lo) % nb];
+        return e.stop_number == a_stop_number ? &e : 0;
+    }
+};//end struct ExprHistory::Priv
+
+/// \param a_max_nb_samples the maximum number of samples to keep for
+/// each expression.
+ExprHistory::ExprHistory (unsigned a_max_nb_samples)
+{
+    m_priv.reset (new Priv (a_max_nb_samples));
+}
+
+ExprHistory::~ExprHistory ()
+{
+}
+
+/// \return the maximum number of samples kept for each expression.
+unsigned
+ExprHistory::max_nb_samples () const
+{
+    return m_priv->max_nb_samples;
+}
+
+/// Record the value of an expression at a given stop.  If the
+/// history of that expression is full, its oldest sample is dropped.
+/// If a value was already recorded at that stop, it is replaced.
+///
+/// \param a_expr the expression to consider.
+///
+/// \param a_stop_number the number of the stop.
+///
+/// \param a_timestamp the time of the stop, in microseconds since the
+/// Epoch.
+///
+/// \param a_thread_id the thread the inferior stopped in.
+///
+/// \param a_value the value of a_expr at that stop.
+void
+ExprHistory::add_sample (const UString &a_expr,
+                         unsigned a_stop_number,
+                         gint64 a_timestamp,
+                         int a_thread_id,
+                         const UString &a_value)
+{
+    Priv::Ring &ring = m_priv->rings[a_expr];
+
+    Priv::Entry entry;
+    entry.stop_number = a_stop_number;
+    entry.timestamp = a_timestamp;
+    entry.thread_id = a_thread_id;
+    entry.value = m_priv->values->intern (a_value.raw ());
+
+    unsigned nb = ring.entries.size ();
+    if (nb) {
+        Priv::Entry &newest = ring.entries[(ring.oldest + nb - 1) % nb];
+        if (newest.stop_number == a_stop_number) {
+            newest = entry;
+            return;
+        }
+    }
+
+    if (nb < m_priv->max_nb_samples) {
+        ring.entries.push_back (entry);
+        ++m_priv->nb_entries;
+    } else {
+        ring.entries[ring.oldest] = entry;
+        ring.oldest = (ring.oldest + 1) % nb;
+    }
+    m_priv->maybe_compact_values ();
+}
+
+/// Get the samples recorded for an expression, oldest first.
+///
+/// \param a_expr the expression to consider.
+///
+/// \param a_samples out parameter.  The resulting samples.
+void
+ExprHistory::get_samples (const UString &a_expr,
+                          std::vector<Sample> &a_samples) const
+{
+    a_samples.clear ();
+    Priv::Rings::const_iterator it = m_priv->rings.find (a_expr);
+    if (it == m_priv->rings.end ())
+        return;
+
+    const Priv::Ring &ring = it->second;
+    unsigned nb_entries = ring.entries.size ();
+    a_samples.reserve (nb_entries);
+    for (unsigned i = 0; i < nb_entries; ++i) {
+        const Priv::Entry &entry =
+            ring.entries[(ring.oldest + i) % nb_entries];
+        Sample sample;
+        sample.stop_number = entry.stop_number;
+        sample.timestamp = entry.timestamp;
+        sample.thread_id = entry.thread_id;
+        sample.value = &m_priv->values->get (entry.value);
+        a_samples.push_back (sample);
+    }
+}
+
+/// Get the value an expression had at a given stop.
+///
+/// \param a_expr the expression to consider.
+///
+/// \param a_stop_number the number of the stop.
+///
+/// \param a_sample out parameter.  The sample recorded at that stop.
+///
+/// \return true if a sample of a_expr was recorded at that stop and
+/// is still in the history, false otherwise.
+bool
+ExprHistory::get_sample_at_stop (const UString &a_expr,
+                                 unsigned a_stop_number,
+                                 Sample &a_sample) const
+{
+    Priv::Rings::const_iterator it = m_priv->rings.find (a_expr);
+    if (it == m_priv->rings.end ())
+        return false;
+    const Priv::Entry *entry = Priv::find_entry (it->second, a_stop_number);
+    if (!entry)
+        return false;
+    a_sample.stop_number = entry->stop_number;
+    a_sample.timestamp = entry->timestamp;
+    a_sample.thread_id = entry->thread_id;
+    a_sample.value = &m_priv->values->get (entry->value);
+    return true;
+}
+
+/// \return true iff at least one sample was recorded for a given
+/// expression.
+bool
+ExprHistory::has_samples (const UString &a_expr) const
+{
+    Priv::Rings::const_iterator it = m_priv->rings.find (a_expr);
+    return it != m_priv->rings.end () && !it->second.entries.empty ();
+}
+
+/// Drop the samples recorded for an expression.
+void
+ExprHistory::forget_expression (const UString &a_expr)
+{
+    Priv::Rings::iterator it = m_priv->rings.find (a_expr);
+    if (it == m_priv->rings.end ())
+        return;
+    m_priv->nb_entries -= it->second.entries.size ();
+    m_priv->rings.erase (it);
+    if (m_priv->rings.empty ())
+        clear ();
+}
+
+/// Drop all the samples of all the expressions.
+void
+ExprHistory::clear ()
+{
+    m_priv->rings.clear ();
+    m_priv->nb_entries = 0;
+    m_priv->values.reset (new StringPool);
+}
+
+/// \return the number of distinct non empty values held by the
+/// history.  Values that are no longer used by any sample might be
+/// counted until the history gets compacted.
+unsigned
+ExprHistory::nb_distinct_values () const
+{
+    // Don't count the empty string the pool always holds.
+    return m_priv->values->size () - 1;
+}
+
+static void
+write_csv_field (const UString &a_field, std::ostream &a_out)
+{
+    if (a_field.raw ().find_first_of (",\"\n\r") == std::string::npos) {
+        a_out << a_field.raw ();
+        return;
+    }
+    a_out << '"';
+    for (std::string::const_iterator it = a_field.raw ().begin ();
+         it != a_field.raw ().end ();
+         ++it) {
+        if (*it == '"')
+            a_out << '"';
+        a_out << *it;
+    }
+    a_out << '"';
+}
+
+/// Write the samples of a set of expressions in the CSV format.  The
+/// first line names the columns; then there is one line per sample.
+///
+/// \param a_exprs the expressions to consider.
+///
+/// \param a_out the stream to write to.
+void
+ExprHistory::write_csv (const std::list<UString> &a_exprs,
+                        std::ostream &a_out) const
+{
+    a_out << "expression,stop,time,thread,value\n";
+
+    std::vector<Sample> samples;
+    std::list<UString>::const_iterator expr_it;
+    for (expr_it = a_exprs.begin (); expr_it != a_exprs.end (); ++expr_it) {
+        get_samples (*expr_it, samples);
+        std::vector<Sample>::const_iterator it;
+        for (it = samples.begin (); it != samples.end (); ++it) {
+            write_csv_field (*expr_it, a_out);
+            a_out << ',' << it->stop_number
+                  << ',' << it->timestamp / G_USEC_PER_SEC
+                  << '.' << std::setw (6) << std::setfill ('0')
+                  << it->timestamp % G_USEC_PER_SEC << std::setfill (' ')
+                  << ',' << it->thread_id
+                  << ',';
+            write_csv_field (*it->value, a_out);
+            a_out << '\n';
+        }
+    }
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
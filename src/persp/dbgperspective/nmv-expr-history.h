@@ -0,0 +1,107 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_EXPR_HISTORY_H__
+#define __NMV_EXPR_HISTORY_H__
+
+#include <ostream>
+#include <vector>
+#include <list>
+#include <glib.h>
+#include "common/nmv-object.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "common/nmv-ustring.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+using nemiver::common::UString;
+
+/// The values taken by a set of monitored expressions, across the
+/// successive stops of the inferior.
+///
+/// Each expression has a ring buffer of bounded size, so the oldest
+/// samples are dropped once it is full.  The values are interned in a
+/// common::StringPool shared by all the expressions: a counter that
+/// keeps the same value across many stops, or several expressions
+/// holding the same value, only cost one string.
+class NEMIVER_API ExprHistory : public nemiver::common::Object {
+    //non copyable
+    ExprHistory (const ExprHistory&);
+    ExprHistory& operator= (const ExprHistory&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+public:
+
+    /// The default maximum number of samples kept per expression.
+    static const unsigned DEFAULT_MAX_NB_SAMPLES = 4096;
+
+    /// A value taken by an expression at a given stop.
+    struct Sample {
+        /// The number of the stop the value was recorded at.
+        unsigned stop_number;
+        /// When the value was recorded, in microseconds since the
+        /// Epoch.
+        gint64 timestamp;
+        /// The thread the inferior stopped in.
+        int thread_id;
+        /// The value.  It is owned by the history, so it must not
+        /// be used after the next change of the history.
+        const UString *value;
+    };
+
+    ExprHistory (unsigned a_max_nb_samples = DEFAULT_MAX_NB_SAMPLES);
+    virtual ~ExprHistory ();
+
+    unsigned max_nb_samples () const;
+
+    void add_sample (const UString &a_expr,
+                     unsigned a_stop_number,
+                     gint64 a_timestamp,
+                     int a_thread_id,
+                     const UString &a_value);
+
+    void get_samples (const UString &a_expr,
+                      std::vector<Sample> &a_samples) const;
+
+    bool get_sample_at_stop (const UString &a_expr,
+                             unsigned a_stop_number,
+                             Sample &a_sample) const;
+
+    bool has_samples (const UString &a_expr) const;
+
+    void forget_expression (const UString &a_expr);
+
+    void clear ();
+
+    unsigned nb_distinct_values () const;
+
+    void write_csv (const std::list<UString> &a_exprs,
+                    std::ostream &a_out) const;
+};//end ExprHistory
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_EXPR_HISTORY_H__
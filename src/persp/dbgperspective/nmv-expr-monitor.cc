@@ -23,11 +23,26 @@
  *See COPYRIGHT file copyright information.
  */
 #include "nmv-expr-monitor.h"
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <fstream>
 #include <glib/gi18n.h>
 #include <gtkmm/treestore.h>
 #include <gtkmm/treerowreference.h>
+#include <gtkmm/liststore.h>
+#include <gtkmm/dialog.h>
+#include <gtkmm/drawingarea.h>
+#include <gtkmm/label.h>
+#include <gtkmm/scrolledwindow.h>
+#include <gtkmm/filechooserdialog.h>
+#include <gtkmm/radiobutton.h>
+#include <gtkmm/spinbutton.h>
 #include "common/nmv-exception.h"
+#include "nmv-expr-history.h"
 #include "nmv-vars-treeview.h"
+#include "nmv-child-prefetcher.h"
+#include "nmv-vars-search-bar.h"
 #include "nmv-variables-utils.h"
 #include "nmv-debugger-utils.h"
 #include "nmv-i-workbench.h"
@@ -41,13 +56,118 @@ using namespace dutils;
 
 NEMIVER_BEGIN_NAMESPACE (nemiver)
 
+struct ExprHistoryColumns : public Gtk::TreeModelColumnRecord {
+    Gtk::TreeModelColumn<unsigned> stop_number;
+    Gtk::TreeModelColumn<Glib::ustring> time;
+    Gtk::TreeModelColumn<int> thread_id;
+    Gtk::TreeModelColumn<Glib::ustring> value;
+
+    ExprHistoryColumns ()
+    {
+        add (stop_number);
+        add (time);
+        add (thread_id);
+        add (value);
+    }
+};//end ExprHistoryColumns
+
+static ExprHistoryColumns&
+get_history_columns ()
+{
+    static ExprHistoryColumns s_cols;
+    return s_cols;
+}
+
+/// Format the time of a history sample, e.g "14:02:11.042".
+static UString
+format_sample_time (gint64 a_timestamp)
+{
+    time_t secs = a_timestamp / G_USEC_PER_SEC;
+    struct tm tm;
+    char buf[32] = {0};
+    if (!localtime_r (&secs, &tm)
+        || !strftime (buf, sizeof (buf), "%H:%M:%S", &tm))
+        return UString::from_int (secs);
+    UString result;
+    result.printf ("%s.%03d", buf,
+                   (int) ((a_timestamp % G_USEC_PER_SEC) / 1000));
+    return result;
+}
+
+/// Draw the numerical values of a history, as a line.
+static bool
+draw_history_sparkline (const Cairo::RefPtr<Cairo::Context> &a_cr,
+                        Gtk::DrawingArea *a_area,
+                        const std::vector<double> *a_values)
+{
+    NEMIVER_TRY
+
+    int width = a_area->get_allocated_width ();
+    int height = a_area->get_allocated_height ();
+    if (a_values->size () < 2 || width <= 0 || height <= 2)
+        return true;
+
+    double min_value = (*a_values)[0], max_value = (*a_values)[0];
+    for (size_t i = 1; i < a_values->size (); ++i) {
+        min_value = std::min (min_value, (*a_values)[i]);
+        max_value = std::max (max_value, (*a_values)[i]);
+    }
+    double range = max_value - min_value;
+
+    Gdk::RGBA color =
+        a_area->get_style_context ()->get_color (Gtk::STATE_FLAG_NORMAL);
+    a_cr->set_source_rgba (color.get_red (),
+                           color.get_green (),
+                           color.get_blue (),
+                           color.get_alpha ());
+    a_cr->set_line_width (1.0);
+    for (size_t i = 0; i < a_values->size (); ++i) {
+        double x = (double) i * (width - 1) / (a_values->size () - 1) + 0.5;
+        double y = range > 0
+            ? ((*a_values)[i] - min_value) / range
+            : 0.5;
+        y = 1 + (1 - y) * (height - 2);
+        if (i == 0)
+            a_cr->move_to (x, y);
+        else
+            a_cr->line_to (x, y);
+    }
+    a_cr->stroke ();
+
+    NEMIVER_CATCH
+    return true;
+}
+
 struct ExprMonitor::Priv
 {
+    /// How and when a monitored expression is re-evaluated.
+    struct RefreshState {
+        RefreshPolicy policy;
+        unsigned period;
+        // The function and thread of the stop at which the expression
+        // was last re-evaluated.
+        UString last_function;
+        int last_thread_id;
+        // True if the expression was not re-evaluated at the last
+        // stop, because of its policy.
+        bool is_stale;
+
+        RefreshState () :
+            policy (REFRESH_AT_EACH_STOP),
+            period (1),
+            last_thread_id (-1),
+            is_stale (false)
+        {
+        }
+    };
+
     Glib::RefPtr<Gtk::UIManager> ui_manager;
     IDebugger &debugger;
     IPerspective &perspective;
     SafePtr<VarsTreeView> tree_view;
     Glib::RefPtr<Gtk::TreeStore> tree_store;
+    SafePtr<ChildPrefetcher> child_prefetcher;
+    SafePtr<VarsSearchBar> search_bar;
     SafePtr<Gtk::TreeRowReference> in_scope_exprs_row_ref;
     SafePtr<Gtk::TreeRowReference> out_of_scope_exprs_row_ref;
     Gtk::TreeModel::iterator cur_selected_row;
@@ -57,6 +177,21 @@ struct ExprMonitor::Priv
     // Variables that went out of scope because the inferior got
     // restarted.
     IDebugger::VariableList killed_expressions;
+    // The values taken by the monitored expressions at each stop.
+    ExprHistory history;
+    // The number of stops seen so far, and the time and thread of the
+    // last one.
+    unsigned nb_stops;
+    gint64 saved_stop_time;
+    int saved_thread_id;
+    // The refresh policies of the monitored expressions, keyed by the
+    // name of the expressions, so that they survive the re-creation
+    // of the expressions when the inferior is re-started.
+    map<UString, RefreshState> refresh_states;
+    // Pending re-evaluation of the stale expressions that got
+    // scrolled or expanded into view.
+    sigc::connection stale_refresh_connection;
+    sigc::connection vadjustment_connection;
     map<IDebugger::VariableSafePtr, bool> in_scope_exprs;
     map<IDebugger::VariableSafePtr, bool> revived_exprs;
     vector<Gtk::TreeModel::Path> selected_paths;
@@ -74,6 +209,9 @@ struct ExprMonitor::Priv
         : debugger (a_debugger),
           perspective (a_perspective),
           contextual_menu (0),
+          nb_stops (0),
+          saved_stop_time (0),
+          saved_thread_id (-1),
           saved_reason (IDebugger::UNDEFINED_REASON),
           saved_has_frame (false),
           initialized (false),
@@ -84,6 +222,11 @@ struct ExprMonitor::Priv
         // the outside.
     }
 
+    ~Priv ()
+    {
+        stale_refresh_connection.disconnect ();
+    }
+
     /// Return the widget to visualize the variables managed by the
     /// monitor.  This function lazily builds the widget and
     /// initializes the monitor.
@@ -99,6 +242,16 @@ struct ExprMonitor::Priv
         return *tree_view;
     }
 
+    /// \return the box to search the monitored expressions.
+    Gtk::Widget&
+    get_search_bar ()
+    {
+        if (!initialized)
+            init_widget ();
+        THROW_IF_FAIL (initialized && search_bar);
+        return *search_bar;
+    }
+
     void
     init_widget ()
     {
@@ -119,6 +272,12 @@ struct ExprMonitor::Priv
 
         tree_store = tree_view->get_tree_store ();
         THROW_IF_FAIL (tree_store);
+        child_prefetcher.reset (new ChildPrefetcher (debugger,
+                                                     *tree_view,
+                                                     tree_store));
+        search_bar.reset (new VarsSearchBar (*tree_view, tree_store,
+                                             &debugger,
+                                             child_prefetcher.get ()));
 
         // *************************************************************
         // Create a row for expressions that are in-scope and a row for
@@ -156,6 +315,8 @@ struct ExprMonitor::Priv
             kill_monitored_expressions ();
         } else {
             killed_expressions.clear ();
+            history.clear ();
+            refresh_states.clear ();
         }
         monitored_expressions.clear ();
         clear_in_scope_exprs_rows ();
@@ -211,6 +372,13 @@ struct ExprMonitor::Priv
         tree_view->signal_draw ().connect_notify
             (sigc::mem_fun (this, &Priv::on_draw_signal));
 
+        // Stale rows can only come into view when the tree is
+        // scrolled or expanded.  The scrolled window the tree gets
+        // packed in gives it a new adjustment.
+        connect_to_vadjustment ();
+        tree_view->property_vadjustment ().signal_changed ().connect
+            (sigc::mem_fun (*this, &Priv::connect_to_vadjustment));
+
         // Schedule the button press signal handler to be run before
         // the default handler.
         tree_view->signal_button_press_event ().connect_notify
@@ -230,6 +398,7 @@ struct ExprMonitor::Priv
     void
     init_actions ()
     {
+        Gtk::StockID nil_stock_id ("");
         ui_utils::ActionEntry s_expr_monitor_action_entries [] = {
             {
                 "RemoveExpressionsMenuItemAction",
@@ -241,6 +410,48 @@ struct ExprMonitor::Priv
                 "",
                 false
             },
+            {
+                "RefreshExpressionsMenuItemAction",
+                Gtk::Stock::REFRESH,
+                _("Refresh"),
+                _("Re-evaluate the selected expressions now"),
+                sigc::mem_fun (*this, &Priv::on_refresh_expressions_action),
+                ui_utils::ActionEntry::DEFAULT,
+                "",
+                false
+            },
+            {
+                "SetRefreshPolicyMenuItemAction",
+                nil_stock_id,
+                _("Refresh Policy..."),
+                _("Choose when the selected expressions are re-evaluated"),
+                sigc::mem_fun (*this, &Priv::on_set_refresh_policy_action),
+                ui_utils::ActionEntry::DEFAULT,
+                "",
+                false
+            },
+            {
+                "ShowExpressionHistoryMenuItemAction",
+                nil_stock_id,
+                _("Show History"),
+                _("Show the values the selected expression took "
+                  "at each stop"),
+                sigc::mem_fun (*this, &Priv::on_show_history_action),
+                ui_utils::ActionEntry::DEFAULT,
+                "",
+                false
+            },
+            {
+                "ExportExpressionsHistoryMenuItemAction",
+                nil_stock_id,
+                _("Export History as CSV..."),
+                _("Save the values the expressions took at each stop "
+                  "into a CSV file"),
+                sigc::mem_fun (*this, &Priv::on_export_history_action),
+                ui_utils::ActionEntry::DEFAULT,
+                "",
+                false
+            },
             {
                 "AddExpressionMenuItemAction",
                 Gtk::Stock::ADD,
@@ -780,6 +991,8 @@ struct ExprMonitor::Priv
         for (it = monitored_expressions.begin ();
              it != monitored_expressions.end ();
              ++it) {
+            if (!should_refresh_expr_at_stop (*it, /*a_is_visible=*/true))
+                continue;
             debugger.list_changed_variables (*it,
                                              sigc::bind
                                              (sigc::mem_fun
@@ -797,6 +1010,458 @@ struct ExprMonitor::Priv
         NEMIVER_CATCH;
     }
 
+    /// Return true iff the row of a given expression is (at least
+    /// partly) visible in the tree view.
+    bool
+    expr_row_is_visible (const IDebugger::VariableSafePtr a_expr)
+    {
+        Gtk::TreeModel::Path start, end;
+        if (!tree_view->get_visible_range (start, end))
+            return false;
+
+        Gtk::TreeModel::iterator parent_it, row_it;
+        if (a_expr->in_scope ())
+            get_in_scope_exprs_row_iterator (parent_it);
+        else
+            get_out_of_scope_exprs_row_iterator (parent_it);
+        if (!parent_it
+            || !vutils::find_a_variable (a_expr, parent_it, row_it))
+            return false;
+        Gtk::TreeModel::Path path = tree_store->get_path (row_it);
+        return start <= path && path <= end;
+    }
+
+    /// Tell if a monitored expression should be re-evaluated at the
+    /// current stop, according to its refresh policy.  If it should
+    /// not, the expression is marked as stale.
+    ///
+    /// \param a_expr the expression to consider.
+    ///
+    /// \param a_is_visible true if the widget is visible.
+    bool
+    should_refresh_expr_at_stop (const IDebugger::VariableSafePtr a_expr,
+                                 bool a_is_visible)
+    {
+        RefreshState &state = refresh_states[a_expr->name ()];
+
+        bool refresh = true;
+        switch (state.policy) {
+            case REFRESH_AT_EACH_STOP:
+                break;
+            case REFRESH_EVERY_NTH_STOP:
+                refresh = state.period <= 1 || nb_stops % state.period == 0;
+                break;
+            case REFRESH_WHEN_VISIBLE:
+                refresh = a_is_visible && expr_row_is_visible (a_expr);
+                break;
+            case REFRESH_MANUALLY:
+                refresh = false;
+                break;
+        }
+
+        // An expression that is out of scope cannot get back in
+        // scope while we are still stopping in the same function.
+        if (refresh
+            && !a_expr->in_scope ()
+            && !expression_is_killed (a_expr)
+            && state.last_function == saved_frame.function_name ()
+            && state.last_thread_id == saved_thread_id)
+            refresh = false;
+
+        if (refresh) {
+            state.last_function = saved_frame.function_name ();
+            state.last_thread_id = saved_thread_id;
+        }
+        state.is_stale = !refresh;
+        if (!refresh)
+            show_expr_as_stale (a_expr, true);
+        return refresh;
+    }
+
+    /// Grey out the row of a monitored expression which value is
+    /// stale, or show it normally again once it was re-evaluated.
+    ///
+    /// \param a_expr the expression to consider.
+    ///
+    /// \param a_is_stale true if the value of a_expr is stale.
+    void
+    show_expr_as_stale (const IDebugger::VariableSafePtr a_expr,
+                        bool a_is_stale)
+    {
+        Gtk::TreeModel::iterator parent_it, row_it;
+        if (a_expr->in_scope ())
+            get_in_scope_exprs_row_iterator (parent_it);
+        else
+            get_out_of_scope_exprs_row_iterator (parent_it);
+        if (!parent_it
+            || !vutils::find_a_variable (a_expr, parent_it, row_it))
+            return;
+
+        if (a_is_stale)
+            (*row_it)[vutils::get_variable_columns ().fg_color] =
+                tree_view->get_style_context ()->get_color
+                                            (Gtk::STATE_FLAG_INSENSITIVE);
+        else if (!(*row_it)[vutils::get_variable_columns ().is_highlighted])
+            (*row_it)[vutils::get_variable_columns ().fg_color] =
+                tree_view->get_style_context ()->get_color
+                                            (Gtk::STATE_FLAG_NORMAL);
+    }
+
+    void
+    connect_to_vadjustment ()
+    {
+        vadjustment_connection.disconnect ();
+        Glib::RefPtr<Gtk::Adjustment> vadjustment =
+            tree_view->get_vadjustment ();
+        if (vadjustment)
+            vadjustment_connection =
+                vadjustment->signal_value_changed ().connect
+                    (sigc::mem_fun (*this, &Priv::schedule_stale_refresh));
+    }
+
+    /// Re-evaluate the stale expressions that became visible, a bit
+    /// later, so that scrolling through the tree only does it once.
+    void
+    schedule_stale_refresh ()
+    {
+        if (stale_refresh_connection.connected ())
+            return;
+        stale_refresh_connection = Glib::signal_timeout ().connect
+            (sigc::mem_fun (*this, &Priv::on_stale_refresh_timeout), 150);
+    }
+
+    bool
+    on_stale_refresh_timeout ()
+    {
+        NEMIVER_TRY;
+        refresh_stale_visible_exprs ();
+        NEMIVER_CATCH;
+        return false;
+    }
+
+    /// Re-evaluate the stale expressions which refresh policy is
+    /// REFRESH_WHEN_VISIBLE and which row became visible.
+    void
+    refresh_stale_visible_exprs ()
+    {
+        if (!should_process_now ())
+            return;
+
+        IDebugger::VariableList::const_iterator it;
+        for (it = monitored_expressions.begin ();
+             it != monitored_expressions.end ();
+             ++it) {
+            map<UString, RefreshState>::iterator state =
+                refresh_states.find ((*it)->name ());
+            if (state == refresh_states.end ()
+                || !state->second.is_stale
+                || state->second.policy != REFRESH_WHEN_VISIBLE
+                || !expr_row_is_visible (*it))
+                continue;
+            refresh_expression (*it);
+        }
+    }
+
+    /// Re-evaluate a monitored expression now, whatever its refresh
+    /// policy.
+    ///
+    /// \param a_expr the expression to consider.
+    void
+    refresh_expression (const IDebugger::VariableSafePtr a_expr)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        THROW_IF_FAIL (a_expr);
+
+        RefreshState &state = refresh_states[a_expr->name ()];
+        state.is_stale = false;
+        state.last_function = saved_frame.function_name ();
+        state.last_thread_id = saved_thread_id;
+        debugger.list_changed_variables
+            (a_expr,
+             sigc::bind (sigc::mem_fun (*this, &Priv::on_vars_changed),
+                         a_expr));
+    }
+
+    /// Set the refresh policy of a monitored expression.
+    ///
+    /// \param a_expr the expression to consider.
+    ///
+    /// \param a_policy the new policy.
+    ///
+    /// \param a_period if a_policy is REFRESH_EVERY_NTH_STOP, the
+    /// number of stops between two re-evaluations.
+    void
+    set_refresh_policy (const IDebugger::VariableSafePtr a_expr,
+                        RefreshPolicy a_policy,
+                        unsigned a_period)
+    {
+        THROW_IF_FAIL (a_expr);
+
+        RefreshState &state = refresh_states[a_expr->name ()];
+        state.policy = a_policy;
+        state.period = a_period ? a_period : 1;
+    }
+
+    /// Get the refresh policy of a monitored expression.
+    ///
+    /// \param a_expr the expression to consider.
+    ///
+    /// \param a_period out parameter.  The number of stops between two
+    /// re-evaluations, if the policy is REFRESH_EVERY_NTH_STOP.
+    RefreshPolicy
+    get_refresh_policy (const IDebugger::VariableSafePtr a_expr,
+                        unsigned &a_period) const
+    {
+        THROW_IF_FAIL (a_expr);
+
+        map<UString, RefreshState>::const_iterator it =
+            refresh_states.find (a_expr->name ());
+        if (it == refresh_states.end ()) {
+            a_period = 1;
+            return REFRESH_AT_EACH_STOP;
+        }
+        a_period = it->second.period;
+        return it->second.policy;
+    }
+
+    /// Let the user choose the refresh policy of a set of expressions.
+    ///
+    /// \param a_exprs the expressions to consider.  The dialog is
+    /// initialized with the policy of the first one.
+    void
+    edit_refresh_policy (const IDebugger::VariableList &a_exprs)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        if (a_exprs.empty ())
+            return;
+
+        Gtk::Dialog dialog (_("Refresh Policy"),
+                            perspective.get_workbench ().get_root_window (),
+                            true);
+        dialog.add_button (Gtk::Stock::CANCEL, Gtk::RESPONSE_CANCEL);
+        dialog.add_button (Gtk::Stock::OK, Gtk::RESPONSE_OK);
+        dialog.set_default_response (Gtk::RESPONSE_OK);
+
+        Gtk::RadioButton::Group group;
+        Gtk::RadioButton each_stop_button
+            (group, _("Re-evaluate at each stop"));
+        Gtk::RadioButton nth_stop_button
+            (group, _("Re-evaluate every Nth stop, N being:"));
+        Gtk::RadioButton when_visible_button
+            (group, _("Re-evaluate only while visible"));
+        Gtk::RadioButton manually_button
+            (group, _("Re-evaluate only when asked to"));
+        Gtk::SpinButton period_spin;
+        period_spin.set_range (1, 1000000);
+        period_spin.set_increments (1, 10);
+
+        unsigned period = 1;
+        switch (get_refresh_policy (a_exprs.front (), period)) {
+            case REFRESH_AT_EACH_STOP:
+                each_stop_button.set_active (true);
+                break;
+            case REFRESH_EVERY_NTH_STOP:
+                nth_stop_button.set_active (true);
+                break;
+            case REFRESH_WHEN_VISIBLE:
+                when_visible_button.set_active (true);
+                break;
+            case REFRESH_MANUALLY:
+                manually_button.set_active (true);
+                break;
+        }
+        period_spin.set_value (period);
+
+        Gtk::Box nth_stop_box (Gtk::ORIENTATION_HORIZONTAL, 6);
+        nth_stop_box.pack_start (nth_stop_button, Gtk::PACK_SHRINK);
+        nth_stop_box.pack_start (period_spin, Gtk::PACK_SHRINK);
+
+        Gtk::Box *box = dialog.get_content_area ();
+        THROW_IF_FAIL (box);
+        box->set_spacing (6);
+        box->pack_start (each_stop_button, Gtk::PACK_SHRINK);
+        box->pack_start (nth_stop_box, Gtk::PACK_SHRINK);
+        box->pack_start (when_visible_button, Gtk::PACK_SHRINK);
+        box->pack_start (manually_button, Gtk::PACK_SHRINK);
+        dialog.show_all ();
+
+        if (dialog.run () != Gtk::RESPONSE_OK)
+            return;
+
+        RefreshPolicy policy = REFRESH_AT_EACH_STOP;
+        if (nth_stop_button.get_active ())
+            policy = REFRESH_EVERY_NTH_STOP;
+        else if (when_visible_button.get_active ())
+            policy = REFRESH_WHEN_VISIBLE;
+        else if (manually_button.get_active ())
+            policy = REFRESH_MANUALLY;
+
+        IDebugger::VariableList::const_iterator it;
+        for (it = a_exprs.begin (); it != a_exprs.end (); ++it)
+            set_refresh_policy (*it, policy, period_spin.get_value_as_int ());
+    }
+
+    /// Record the current value of a monitored expression into its
+    /// history.
+    ///
+    /// \param a_expr the expression to consider.
+    void
+    record_history_sample (const IDebugger::VariableSafePtr a_expr)
+    {
+        if (!a_expr
+            || !a_expr->in_scope ()
+            || expression_is_killed (a_expr))
+            return;
+        history.add_sample (a_expr->name (), nb_stops,
+                            saved_stop_time, saved_thread_id,
+                            a_expr->value ());
+    }
+
+    /// Get the root expressions of the rows currently selected.
+    void
+    get_selected_exprs (IDebugger::VariableList &a_exprs)
+    {
+        THROW_IF_FAIL (tree_view && tree_store);
+
+        std::vector<Gtk::TreeModel::Path> selected_rows =
+            tree_view->get_selection ()->get_selected_rows ();
+        std::vector<Gtk::TreeModel::Path>::const_iterator it;
+        for (it = selected_rows.begin (); it != selected_rows.end (); ++it) {
+            Gtk::TreeModel::iterator i = tree_store->get_iter (*it);
+            IDebugger::VariableSafePtr var =
+                (*i)[vutils::get_variable_columns ().variable];
+            if (!var)
+                continue;
+            var = var->root ();
+            if (std::find (a_exprs.begin (), a_exprs.end (), var)
+                == a_exprs.end ())
+                a_exprs.push_back (var);
+        }
+    }
+
+    /// Show a dialog displaying the history of the values of a given
+    /// expression: a line drawing the numerical values, and a table
+    /// of all the samples.
+    ///
+    /// \param a_expr the expression to consider.
+    void
+    show_history (const IDebugger::VariableSafePtr a_expr)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        THROW_IF_FAIL (a_expr);
+
+        std::vector<ExprHistory::Sample> samples;
+        history.get_samples (a_expr->name (), samples);
+
+        Glib::RefPtr<Gtk::ListStore> store =
+            Gtk::ListStore::create (get_history_columns ());
+        std::vector<double> values;
+        std::vector<ExprHistory::Sample>::const_iterator it;
+        for (it = samples.begin (); it != samples.end (); ++it) {
+            Gtk::TreeModel::iterator row = store->append ();
+            (*row)[get_history_columns ().stop_number] = it->stop_number;
+            (*row)[get_history_columns ().time] =
+                format_sample_time (it->timestamp);
+            (*row)[get_history_columns ().thread_id] = it->thread_id;
+            (*row)[get_history_columns ().value] = *it->value;
+
+            // Only the values that start with a number, e.g "42" or
+            // "65 'A'", make it to the graph.
+            const char *str = it->value->c_str ();
+            char *end = 0;
+            double value = strtod (str, &end);
+            if (end != str)
+                values.push_back (value);
+        }
+
+        UString title;
+        title.printf (_("History of %s"), a_expr->name ().c_str ());
+        Gtk::Dialog dialog (title,
+                            perspective.get_workbench ().get_root_window (),
+                            true);
+        dialog.add_button (Gtk::Stock::CLOSE, Gtk::RESPONSE_CLOSE);
+        dialog.set_default_size (480, 400);
+
+        UString summary;
+        summary.printf (_("%d samples (at most %d are kept)"),
+                        (int) samples.size (),
+                        (int) history.max_nb_samples ());
+        Gtk::Label summary_label (summary);
+        summary_label.set_alignment (0, 0.5);
+
+        Gtk::DrawingArea sparkline;
+        sparkline.set_size_request (-1, 48);
+        sparkline.signal_draw ().connect
+            (sigc::bind (sigc::ptr_fun (&draw_history_sparkline),
+                         &sparkline, &values));
+
+        Gtk::TreeView samples_view (store);
+        samples_view.append_column (_("Stop"),
+                                    get_history_columns ().stop_number);
+        samples_view.append_column (_("Time"), get_history_columns ().time);
+        samples_view.append_column (_("Thread"),
+                                    get_history_columns ().thread_id);
+        samples_view.append_column (_("Value"), get_history_columns ().value);
+        Gtk::ScrolledWindow scr;
+        scr.set_policy (Gtk::POLICY_AUTOMATIC, Gtk::POLICY_AUTOMATIC);
+        scr.set_shadow_type (Gtk::SHADOW_IN);
+        scr.add (samples_view);
+
+        Gtk::Box *box = dialog.get_content_area ();
+        THROW_IF_FAIL (box);
+        box->set_spacing (6);
+        box->pack_start (summary_label, Gtk::PACK_SHRINK);
+        if (values.size () > 1)
+            box->pack_start (sparkline, Gtk::PACK_SHRINK);
+        box->pack_start (scr);
+        dialog.show_all ();
+        dialog.run ();
+    }
+
+    /// Let the user choose a file and write the history of a set of
+    /// expressions into it, in the CSV format.
+    ///
+    /// \param a_exprs the expressions to consider.
+    void
+    export_history (const IDebugger::VariableList &a_exprs)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        Gtk::FileChooserDialog file_chooser
+            (perspective.get_workbench ().get_root_window (),
+             _("Export Expressions History"),
+             Gtk::FILE_CHOOSER_ACTION_SAVE);
+        file_chooser.add_button (Gtk::Stock::CANCEL, Gtk::RESPONSE_CANCEL);
+        file_chooser.add_button (Gtk::Stock::SAVE, Gtk::RESPONSE_OK);
+        file_chooser.set_do_overwrite_confirmation (true);
+        file_chooser.set_current_name ("expressions-history.csv");
+
+        if (file_chooser.run () != Gtk::RESPONSE_OK)
+            return;
+        std::string path = file_chooser.get_filename ();
+        if (path.empty ())
+            return;
+
+        std::list<UString> names;
+        IDebugger::VariableList::const_iterator it;
+        for (it = a_exprs.begin (); it != a_exprs.end (); ++it)
+            names.push_back ((*it)->name ());
+
+        std::ofstream out (path.c_str ());
+        if (out)
+            history.write_csv (names, out);
+        if (!out) {
+            UString msg;
+            msg.printf (_("Could not write the history into %s"),
+                        path.c_str ());
+            ui_utils::display_error
+                (perspective.get_workbench ().get_root_window (), msg);
+        }
+    }
+
     /// Return the UI manager associated with this variable monitor.
     /// this is for e.g, the contextual menu.
     Glib::RefPtr<Gtk::UIManager>
@@ -877,6 +1542,31 @@ struct ExprMonitor::Priv
 
         remove_expression_action->set_sensitive
             (expression_is_selected ());
+
+        const char *selection_actions[] = {
+            "/ExprMonitorPopup/RefreshExpressionsMenuItem",
+            "/ExprMonitorPopup/SetRefreshPolicyMenuItem"
+        };
+        for (unsigned i = 0;
+             i < sizeof (selection_actions) / sizeof (selection_actions[0]);
+             ++i) {
+            Glib::RefPtr<Gtk::Action> action =
+                get_ui_manager ()->get_action (selection_actions[i]);
+            THROW_IF_FAIL (action);
+            action->set_sensitive (expression_is_selected ());
+        }
+
+        Glib::RefPtr<Gtk::Action> show_history_action =
+            get_ui_manager ()->get_action
+            ("/ExprMonitorPopup/ShowExpressionHistoryMenuItem");
+        THROW_IF_FAIL (show_history_action);
+        show_history_action->set_sensitive (expression_is_selected ());
+
+        Glib::RefPtr<Gtk::Action> export_history_action =
+            get_ui_manager ()->get_action
+            ("/ExprMonitorPopup/ExportExpressionsHistoryMenuItem");
+        THROW_IF_FAIL (export_history_action);
+        export_history_action->set_sensitive (!monitored_expressions.empty ());
     }
 
     /// Pop up the contextual menu of the variable monitor.
@@ -900,7 +1590,7 @@ struct ExprMonitor::Priv
     on_stopped_signal (IDebugger::StopReason a_reason,
                        bool a_has_frame,
                        const IDebugger::Frame &a_frame,
-                       int /*a_thread_id*/,
+                       int a_thread_id,
                        const string& /*a_bp_num*/,
                        const UString &/*a_cookie*/)
     {
@@ -916,11 +1606,18 @@ struct ExprMonitor::Priv
         saved_reason = a_reason;
         saved_has_frame = a_has_frame;
 
+        ++nb_stops;
+        saved_stop_time = g_get_real_time ();
+        saved_thread_id = a_thread_id;
+
         if (should_process_now ()) {
             finish_handling_debugger_stopped_event (a_reason,
                                                     a_has_frame,
                                                     a_frame);
         } else {
+            // The expressions are updated, and their values recorded
+            // into the history as those of this stop, when the widget
+            // is drawn again.  The stops in between leave no sample.
             is_up2date = false;
         }
         NEMIVER_CATCH;
@@ -992,6 +1689,8 @@ struct ExprMonitor::Priv
 
         NEMIVER_TRY;
 
+        record_history_sample (a_var_root);
+
         // Is this variable in scope or not? Update the graphical
         // stuff according to that property.
         Gtk::TreeModel::iterator var_it, parent_it;
@@ -1011,6 +1710,7 @@ struct ExprMonitor::Priv
                                            /*a_is_new_frame=*/is_new_frame,
                                            /*a_update_members=*/false);
             }
+            show_expr_as_stale (a_var_root, false);
         }
 
         // Now, update changed_in_scope_exprs_at_prev_stop and
@@ -1041,13 +1741,19 @@ struct ExprMonitor::Priv
 
         NEMIVER_TRY;
 
+        // Rows of stale expressions might have come into view.
+        schedule_stale_refresh ();
+
         if (!(*a_it)[vutils::get_variable_columns ().needs_unfolding]) {
+            child_prefetcher->prefetch_children_of (a_path);
             return;
         }
         LOG_DD ("A variable needs unfolding");
 
         IDebugger::VariableSafePtr var =
             (*a_it)[vutils::get_variable_columns ().variable];
+        if (child_prefetcher->take_over_expansion (var, a_path))
+            return;
         debugger.unfold_variable
             (var,
              sigc::bind  (sigc::mem_fun (*this,
@@ -1079,6 +1785,7 @@ struct ExprMonitor::Priv
                                           var_it,
                                           false /* do not truncate type */);
         tree_view->expand_row (a_expr_node, false);
+        child_prefetcher->prefetch_children_of (a_expr_node);
         NEMIVER_CATCH;
     }
 
@@ -1145,12 +1852,85 @@ struct ExprMonitor::Priv
                  delete_list.begin ();
              it != delete_list.end ();
              ++it) {
+            history.forget_expression ((*it)->name ());
+            refresh_states.erase ((*it)->name ());
             remove_expression (*it);
         }
 
         NEMIVER_CATCH;
     }
 
+    /// Callback called whenever the user clicks on the menu item to
+    /// re-evaluate the selected expressions.
+    void
+    on_refresh_expressions_action ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY;
+
+        IDebugger::VariableList exprs;
+        get_selected_exprs (exprs);
+        IDebugger::VariableList::const_iterator it;
+        for (it = exprs.begin (); it != exprs.end (); ++it)
+            if (!expression_is_killed (*it))
+                refresh_expression (*it);
+
+        NEMIVER_CATCH;
+    }
+
+    /// Callback called whenever the user clicks on the menu item to
+    /// choose the refresh policy of the selected expressions.
+    void
+    on_set_refresh_policy_action ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY;
+
+        IDebugger::VariableList exprs;
+        get_selected_exprs (exprs);
+        edit_refresh_policy (exprs);
+
+        NEMIVER_CATCH;
+    }
+
+    /// Callback called whenever the user clicks on the menu item to
+    /// show the history of the selected expression.
+    void
+    on_show_history_action ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY;
+
+        IDebugger::VariableList exprs;
+        get_selected_exprs (exprs);
+        if (!exprs.empty ())
+            show_history (exprs.front ());
+
+        NEMIVER_CATCH;
+    }
+
+    /// Callback called whenever the user clicks on the menu item to
+    /// export the history of the expressions.  If some expressions
+    /// are selected, only their history is exported.
+    void
+    on_export_history_action ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY;
+
+        IDebugger::VariableList exprs;
+        get_selected_exprs (exprs);
+        if (exprs.empty ())
+            exprs = monitored_expressions;
+        export_history (exprs);
+
+        NEMIVER_CATCH;
+    }
+
     /// Callback function invoked whenever the user clicks on a menu
     /// item to monitor a new expression.
     void
@@ -1253,6 +2033,14 @@ ExprMonitor::widget ()
     return m_priv->get_widget ();
 }
 
+/// \return the box to search the monitored expressions.
+Gtk::Widget&
+ExprMonitor::search_bar ()
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->get_search_bar ();
+}
+
 /// Monitor a new variable.  IOW, add a new variable to the monitor.
 ///
 /// \param a_expr the new variable to monitor.
@@ -1306,4 +2094,46 @@ ExprMonitor::re_init_widget (bool a_remember_variables)
     m_priv->re_init_widget (a_remember_variables);
 }
 
+/// Set the policy that says when a monitored expression is
+/// re-evaluated.
+///
+/// \param a_expr the expression to consider.
+///
+/// \param a_policy the new policy.
+///
+/// \param a_period if a_policy is REFRESH_EVERY_NTH_STOP, the number
+/// of stops between two re-evaluations.
+void
+ExprMonitor::set_refresh_policy (const IDebugger::VariableSafePtr a_expr,
+                                 RefreshPolicy a_policy,
+                                 unsigned a_period)
+{
+    m_priv->set_refresh_policy (a_expr, a_policy, a_period);
+}
+
+/// Get the policy that says when a monitored expression is
+/// re-evaluated.
+///
+/// \param a_expr the expression to consider.
+///
+/// \param a_period out parameter.  If the policy is
+/// REFRESH_EVERY_NTH_STOP, the number of stops between two
+/// re-evaluations.
+ExprMonitor::RefreshPolicy
+ExprMonitor::get_refresh_policy (const IDebugger::VariableSafePtr a_expr,
+                                 unsigned &a_period) const
+{
+    return m_priv->get_refresh_policy (a_expr, a_period);
+}
+
+/// Re-evaluate a monitored expression now, whatever its refresh
+/// policy.
+///
+/// \param a_expr the expression to consider.
+void
+ExprMonitor::refresh_expression (const IDebugger::VariableSafePtr a_expr)
+{
+    m_priv->refresh_expression (a_expr);
+}
+
 NEMIVER_END_NAMESPACE (nemiver)
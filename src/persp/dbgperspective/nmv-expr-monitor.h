@@ -51,16 +51,40 @@ class NEMIVER_API ExprMonitor : public nemiver::common::Object {
     ExprMonitor ();
 
  public:
+    /// How often a monitored expression is re-evaluated.  Whatever
+    /// the policy, an expression that is out of scope is re-evaluated
+    /// only when the inferior stops in a different function or
+    /// thread than when it was last re-evaluated.
+    enum RefreshPolicy {
+        /// Re-evaluate the expression at each stop.  This is the
+        /// default.
+        REFRESH_AT_EACH_STOP = 0,
+        /// Re-evaluate the expression every Nth stop.
+        REFRESH_EVERY_NTH_STOP,
+        /// Re-evaluate the expression at each stop, but only while
+        /// its row is visible.
+        REFRESH_WHEN_VISIBLE,
+        /// Re-evaluate the expression only when asked to.
+        REFRESH_MANUALLY
+    };
+
     ExprMonitor (IDebugger &a_dbg,
                  IPerspective &a_perspective);
     virtual ~ExprMonitor ();
     Gtk::Widget& widget ();
+    Gtk::Widget& search_bar ();
     void add_expression (const IDebugger::VariableSafePtr a_expr);
     void add_expressions (const IDebugger::VariableList &a_exprs);
     bool expression_is_monitored (const IDebugger::Variable &a_expr) const;
     void remove_expression (const IDebugger::VariableSafePtr a_expr);
     void remove_expressions (const IDebugger::VariableList &a_exprs);
     void re_init_widget (bool a_remember_variables);
+    void set_refresh_policy (const IDebugger::VariableSafePtr a_expr,
+                             RefreshPolicy a_policy,
+                             unsigned a_period = 1);
+    RefreshPolicy get_refresh_policy (const IDebugger::VariableSafePtr a_expr,
+                                      unsigned &a_period) const;
+    void refresh_expression (const IDebugger::VariableSafePtr a_expr);
 };// end ExprMonitor
 
 NEMIVER_END_NAMESPACE (nemiver)
@@ -31,6 +31,7 @@
 #include "nmv-global-vars-inspector-dialog.h"
 #include "nmv-variables-utils.h"
 #include "nmv-vars-treeview.h"
+#include "nmv-vars-search-bar.h"
 #include "nmv-ui-utils.h"
 #include "nmv-i-workbench.h"
 #include "nmv-i-var-list-walker.h"
@@ -40,6 +41,12 @@ namespace vutil = nemiver::variables_utils2;
 
 NEMIVER_BEGIN_NAMESPACE (nemiver)
 
+// Programs can have a huge number of globals, some of them being
+// big aggregates. Bound how far each of them is walked so that
+// the dialog stays responsive.
+static const unsigned GLOBAL_VARS_MAX_MEMBER_DEPTH = 8;
+static const unsigned GLOBAL_VARS_MAX_MEMBER_BREADTH = 512;
+
 struct GlobalVarsInspectorDialog::Priv : public sigc::trackable {
 private:
     Priv ();
@@ -51,6 +58,7 @@ public:
 
     IWorkbench &workbench;
     VarsTreeView* tree_view;
+    Gtk::ProgressBar *progress_bar;
     Glib::RefPtr<Gtk::TreeStore> tree_store;
     Gtk::TreeModel::iterator cur_selected_row;
     SafePtr<Gtk::Menu> contextual_menu;
@@ -63,7 +71,8 @@ public:
         dialog (a_dialog),
         gtkbuilder (a_gtkbuilder),
         workbench (a_workbench),
-        tree_view (0)
+        tree_view (0),
+        progress_bar (0)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
@@ -89,8 +98,18 @@ public:
         scr->set_shadow_type (Gtk::SHADOW_IN);
         THROW_IF_FAIL (tree_view);
         scr->add (*tree_view);
+        // The global variables are all listed upfront, so only search
+        // the rows that are already there.
+        VarsSearchBar *search_bar =
+            Gtk::manage (new VarsSearchBar (*tree_view, tree_store));
+        box->pack_start (*search_bar, Gtk::PACK_SHRINK);
         box->pack_start (*scr);
+        progress_bar = Gtk::manage (new Gtk::ProgressBar);
+        THROW_IF_FAIL (progress_bar);
+        progress_bar->set_show_text (true);
+        box->pack_start (*progress_bar, Gtk::PACK_SHRINK);
         dialog.show_all ();
+        progress_bar->hide ();
     }
 
     void build_tree_view ()
@@ -124,10 +143,22 @@ public:
             (sigc::mem_fun
              (*this,
               &GlobalVarsInspectorDialog::Priv::on_global_variable_visited_signal));
+            global_variables_walker_list->variable_list_walk_progress_signal
+                                                                ().connect
+            (sigc::mem_fun
+             (*this,
+              &GlobalVarsInspectorDialog::Priv::on_global_variables_walk_progress_signal));
+            global_variables_walker_list->variable_list_visited_signal
+                                                                ().connect
+            (sigc::mem_fun
+             (*this,
+              &GlobalVarsInspectorDialog::Priv::on_global_variables_visited_signal));
         }
         return global_variables_walker_list;
     }
 
+    /// The global variables are walked by VarWalker rather than
+    /// VarobjWalker, see VarListWalker::create_variable_walker.
     IVarListWalkerSafePtr create_variable_walker_list ()
     {
         DynamicModule::Loader *loader =
@@ -141,6 +172,8 @@ public:
                                                         "IVarListWalker");
         THROW_IF_FAIL (result);
         result->initialize (debugger.get ());
+        result->set_maximum_member_depth (GLOBAL_VARS_MAX_MEMBER_DEPTH);
+        result->set_maximum_member_breadth (GLOBAL_VARS_MAX_MEMBER_BREADTH);
         return result;
     }
 
@@ -235,6 +268,14 @@ public:
 
         walker_list->remove_variables ();
         walker_list->append_variables (a_vars);
+        if (progress_bar && !a_vars.empty ()) {
+            UString msg;
+            msg.printf (_("Walking %d global variables"),
+                        (int) a_vars.size ());
+            progress_bar->set_fraction (0.0);
+            progress_bar->set_text (msg);
+            progress_bar->show ();
+        }
         walker_list->do_walk_variables ();
 
         NEMIVER_CATCH
@@ -257,6 +298,31 @@ public:
         NEMIVER_CATCH
     }
 
+    void on_global_variables_walk_progress_signal (unsigned a_nb_walked,
+                                                   unsigned a_nb_to_walk)
+    {
+        NEMIVER_TRY
+
+        if (!progress_bar || !a_nb_to_walk)
+            return;
+        UString msg;
+        msg.printf (_("%u of %u variables walked"), a_nb_walked, a_nb_to_walk);
+        progress_bar->set_fraction ((double) a_nb_walked / a_nb_to_walk);
+        progress_bar->set_text (msg);
+
+        NEMIVER_CATCH
+    }
+
+    void on_global_variables_visited_signal ()
+    {
+        NEMIVER_TRY
+
+        if (progress_bar)
+            progress_bar->hide ();
+
+        NEMIVER_CATCH
+    }
+
     void on_tree_view_selection_changed_signal ()
     {
     }
@@ -29,13 +29,23 @@
 #include <glib/gi18n.h>
 #include <gtkmm/treestore.h>
 #include <gtkmm/treerowreference.h>
+#include <gtkmm/liststore.h>
+#include <gtkmm/dialog.h>
+#include <gtkmm/label.h>
+#include <gtkmm/comboboxtext.h>
+#include <gtkmm/button.h>
+#include <gtkmm/box.h>
+#include <gtkmm/scrolledwindow.h>
 #include "common/nmv-exception.h"
 #include "nmv-local-vars-inspector.h"
+#include "nmv-locals-snapshots.h"
 #include "nmv-variables-utils.h"
 #include "nmv-ui-utils.h"
 #include "nmv-i-workbench.h"
 #include "nmv-i-var-walker.h"
 #include "nmv-vars-treeview.h"
+#include "nmv-child-prefetcher.h"
+#include "nmv-vars-search-bar.h"
 #include "nmv-debugger-utils.h"
 #include "nmv-conf-keys.h"
 
@@ -46,6 +56,30 @@ using Glib::RefPtr;
 
 NEMIVER_BEGIN_NAMESPACE (nemiver)
 
+struct SnapshotDiffColumns : public Gtk::TreeModelColumnRecord {
+    Gtk::TreeModelColumn<Glib::ustring> path;
+    Gtk::TreeModelColumn<Glib::ustring> change;
+    Gtk::TreeModelColumn<Glib::ustring> old_value;
+    Gtk::TreeModelColumn<Glib::ustring> new_value;
+    Gtk::TreeModelColumn<Glib::ustring> delta;
+
+    SnapshotDiffColumns ()
+    {
+        add (path);
+        add (change);
+        add (old_value);
+        add (new_value);
+        add (delta);
+    }
+};//end SnapshotDiffColumns
+
+static SnapshotDiffColumns&
+get_snapshot_diff_columns ()
+{
+    static SnapshotDiffColumns s_cols;
+    return s_cols;
+}
+
 struct LocalVarsInspector::Priv : public sigc::trackable {
 private:
     Priv ();
@@ -55,6 +89,8 @@ public:
     IPerspective &perspective;
     VarsTreeView *tree_view;
     Glib::RefPtr<Gtk::TreeStore> tree_store;
+    SafePtr<ChildPrefetcher> child_prefetcher;
+    SafePtr<VarsSearchBar> search_bar;
     Gtk::TreeModel::iterator cur_selected_row;
     SafePtr<Gtk::TreeRowReference> local_variables_row_ref;
     SafePtr<Gtk::TreeRowReference> function_arguments_row_ref;
@@ -78,6 +114,14 @@ public:
     IVarWalkerSafePtr varobj_walker;
     DynamicModuleManager *module_manager;
     Glib::RefPtr<Gtk::UIManager> ui_manager;
+    // The snapshots of the locals pinned by the user.
+    LocalsSnapshots snapshots;
+    // The number of snapshots pinned so far, to label them.  It
+    // doesn't go down when a snapshot is forgotten, so two snapshots
+    // never get the same number.
+    int nb_pinned_snapshots;
+    sigc::signal<void> values_changed_signal;
+    sigc::connection values_changed_connection;
 
     Priv (IDebuggerSafePtr &a_debugger,
           IWorkbench &a_workbench,
@@ -91,7 +135,8 @@ public:
         saved_has_frame (false),
         local_vars_inspector_menu (0),
         varobj_walker (0),
-        module_manager (0)
+        module_manager (0),
+        nb_pinned_snapshots (0)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
         THROW_IF_FAIL (a_debugger);
@@ -99,6 +144,14 @@ public:
         THROW_IF_FAIL (tree_view);
         tree_store = tree_view->get_tree_store ();
         THROW_IF_FAIL (tree_store);
+        child_prefetcher.reset (new ChildPrefetcher (*debugger,
+                                                     *tree_view,
+                                                     tree_store));
+        child_prefetcher->set_varobj_maker
+            (sigc::mem_fun (*this, &Priv::create_varobj_of_row));
+        search_bar.reset (new VarsSearchBar (*tree_view, tree_store,
+                                             debugger.get (),
+                                             child_prefetcher.get ()));
         re_init_tree_view ();
         connect_to_debugger_signals ();
         init_graphical_signals ();
@@ -245,11 +298,84 @@ public:
             dynamic_cast<Gtk::CellRendererText*> (r);
         t->signal_edited ().connect (sigc::mem_fun
                                      (*this, &Priv::on_cell_edited_signal));
+
+        tree_store->signal_row_changed ().connect
+            (sigc::mem_fun (*this, &Priv::on_tree_store_row_changed_signal));
+        tree_store->signal_row_deleted ().connect
+            (sigc::mem_fun (*this, &Priv::on_tree_store_row_deleted_signal));
+    }
+
+    /// Emit values_changed_signal once the tree is done changing,
+    /// rather than once per changed row.
+    void
+    schedule_values_changed_signal ()
+    {
+        if (values_changed_connection.connected ())
+            return;
+        values_changed_connection = Glib::signal_idle ().connect
+            (sigc::mem_fun (*this, &Priv::on_values_changed_idle));
+    }
+
+    bool
+    on_values_changed_idle ()
+    {
+        NEMIVER_TRY
+        values_changed_signal.emit ();
+        NEMIVER_CATCH
+        return false;
+    }
+
+    void
+    on_tree_store_row_changed_signal (const Gtk::TreeModel::Path &,
+                                      const Gtk::TreeModel::iterator &)
+    {
+        schedule_values_changed_signal ();
+    }
+
+    void
+    on_tree_store_row_deleted_signal (const Gtk::TreeModel::Path &)
+    {
+        schedule_values_changed_signal ();
+    }
+
+    /// Get the values of the local variables and function arguments
+    /// shown by the top level rows.
+    ///
+    /// \return false if the rows are not up to date, e.g because the
+    /// inspector was hidden when the inferior last stopped.
+    bool
+    get_variable_values (std::map<UString, UString> &a_values)
+    {
+        if (!is_up2date)
+            return false;
+        Gtk::TreeModel::iterator parents[2];
+        bool has_parent[2];
+        has_parent[0] = get_local_variables_row_iterator (parents[0]);
+        has_parent[1] = get_function_arguments_row_iterator (parents[1]);
+        for (int i = 0; i < 2; ++i) {
+            if (!has_parent[i])
+                continue;
+            Gtk::TreeModel::Children rows = parents[i]->children ();
+            for (Gtk::TreeModel::iterator it = rows.begin ();
+                 it != rows.end ();
+                 ++it) {
+                IDebugger::VariableSafePtr var =
+                    (*it)[vutil::get_variable_columns ().variable];
+                if (!var)
+                    continue;
+                UString name =
+                    (Glib::ustring) (*it)[vutil::get_variable_columns ().name];
+                a_values[name] =
+                    (Glib::ustring) (*it)[vutil::get_variable_columns ().value];
+            }
+        }
+        return true;
     }
 
     void
     init_actions ()
     {
+        Gtk::StockID nil_stock_id ("");
         ui_utils::ActionEntry s_local_vars_inspector_action_entries [] = {
             {
                 "CopyLocalVariablePathMenuItemAction",
@@ -288,6 +414,27 @@ public:
                 "",
                 false
             },
+            {
+                "PinLocalsSnapshotMenuItemAction",
+                nil_stock_id,
+                _("_Pin Snapshot of Variables"),
+                _("Remember the current values of the local variables "
+                  "and function arguments"),
+                sigc::mem_fun (*this, &Priv::on_pin_snapshot_action),
+                ui_utils::ActionEntry::DEFAULT,
+                "",
+                false
+            },
+            {
+                "CompareWithSnapshotMenuItemAction",
+                nil_stock_id,
+                _("Co_mpare With Snapshot..."),
+                _("Show the variables that changed since a pinned snapshot"),
+                sigc::mem_fun (*this, &Priv::on_compare_with_snapshot_action),
+                ui_utils::ActionEntry::DEFAULT,
+                "",
+                false
+            },
         };
 
         local_vars_inspector_action_group =
@@ -387,17 +534,6 @@ public:
         }
     }
 
-    /// Append a new local variable to this widget and then update the
-    /// content of all the local variables contained in the widget.
-    void
-    append_a_local_variable_and_update_all (const IDebugger::VariableSafePtr a_var)
-    {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
-
-        append_a_local_variable (a_var);
-        update_local_variables ();
-    }
-
     /// Erases a variable from a list of variables.
     void
     erase_variable_from_list (const IDebugger::VariableSafePtr a_var,
@@ -559,19 +695,14 @@ public:
         if (is_new_frame || inspector_is_empty ()) {
             LOG_DD ("init tree view");
             re_init_tree_view ();
-            LOG_DD ("list local variables");
-            debugger->list_local_variables
-                (sigc::mem_fun
-                 (*this, &Priv::add_new_local_vars_and_update_olders));
-            LOG_DD ("list frames arguments");
-            debugger->list_frames_arguments (a_frame.level (),
-                                             a_frame.level (),
-                                             sigc::mem_fun
-                                             (*this, &Priv::on_function_args_listed),
-                                             "");
+            LOG_DD ("list local variables and function arguments");
+            debugger->list_frame_variables
+                (sigc::mem_fun (*this, &Priv::on_frame_variables_listed));
         } else {
             LOG_DD ("update local variables and function arguments");
-            maybe_update_list_of_local_vars_and_then_update_older_ones ();
+            debugger->list_frame_variables
+                (sigc::mem_fun (*this, &Priv::on_frame_variables_refreshed));
+            update_local_variables ();
             update_function_arguments ();
         }
         previous_function_name = a_frame.function_name ();
@@ -600,112 +731,319 @@ public:
                                 message);
     }
 
-    /// Add the new local variables @a_vars to the list of local
-    /// variables for the current function.  Then, update the content
-    /// of all the local variables that we already had previous to
-    /// calling this function.
+    /// Return true if the plain variable a_var -- that is, a
+    /// variable that has no backend variable object yet -- might have
+    /// members.  The values of aggregates, arrays and unions are not
+    /// reported by IDebugger::list_frame_variables, and pointers and
+    /// references can be dereferenced.
+    bool
+    plain_variable_might_have_members (const IDebugger::VariableSafePtr a_var)
+    {
+        if (a_var->value ().empty ())
+            return true;
+        UString type = a_var->type ();
+        type.chomp ();
+        if (type.empty ())
+            return false;
+        return (type[type.size () - 1] == '&'
+                || vutil::is_type_a_pointer (type));
+    }
+
+    /// Make the rows of the plain variables a_vars expandable when
+    /// the variables might have members.  Expanding such a row
+    /// creates the backend variable object of the variable.
     void
-    add_new_local_vars_and_update_olders (const IDebugger::VariableList &a_vars)
+    mark_expandable_plain_variables (const IDebugger::VariableList &a_vars)
     {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        IDebugger::VariableList::const_iterator it;
+        for (it = a_vars.begin (); it != a_vars.end (); ++it)
+            if (plain_variable_might_have_members (*it))
+                (*it)->num_expected_children (1);
+    }
 
-        if (a_vars.empty ()) {
-            LOG_DD ("got empty list of new variables");
-            // There are no new variables to add.  This functions
-            // amounts to just updating the content of the local
-            // variables we already had.
-            update_local_variables ();
-            return;
+    /// Find the row of the variable a_var among the children rows of
+    /// a_parent_row_it.  Unlike vutil::find_a_variable, this
+    /// compares variables by identity, so it works for plain
+    /// variables that have no backend variable object.
+    bool
+    find_a_root_variable_row (const IDebugger::VariableSafePtr a_var,
+                              const Gtk::TreeModel::iterator &a_parent_row_it,
+                              Gtk::TreeModel::iterator &a_out_row_it)
+    {
+        Gtk::TreeModel::Children rows = a_parent_row_it->children ();
+        for (Gtk::TreeModel::iterator it = rows.begin ();
+             it != rows.end ();
+             ++it) {
+            IDebugger::VariableSafePtr var =
+                (*it)[vutil::get_variable_columns ().variable];
+            if (var == a_var) {
+                a_out_row_it = it;
+                return true;
+            }
         }
+        return false;
+    }
 
-        // For each new local variable name, create a backend variable
-        // object (and add it to the list of local variable managed by
-        // this widget) and then, when all new local variables are
-        // under control, update the older variables we already had in
-        // this widget.
-        bool added_new_vars = false;
+    /// Return the variable named a_name in a_vars, or a null pointer
+    /// if there is none.
+    IDebugger::VariableSafePtr
+    lookup_variable_by_name (const UString &a_name,
+                             const IDebugger::VariableList &a_vars)
+    {
         for (IDebugger::VariableList::const_iterator i = a_vars.begin ();
              i != a_vars.end ();
-             ++i) {
-            if ((*i)->name ().empty ())
-                continue;
+             ++i)
+            if (a_name == (*i)->name ())
+                return *i;
+        return IDebugger::VariableSafePtr ();
+    }
+
+    /// Replace the variable a_old by a_new in the list a_vars.
+    /// \return true if a_old was found in a_vars, false otherwise.
+    bool
+    replace_variable_in_list (const IDebugger::VariableSafePtr a_old,
+                              const IDebugger::VariableSafePtr a_new,
+                              IDebugger::VariableList &a_vars)
+    {
+        for (IDebugger::VariableList::iterator i = a_vars.begin ();
+             i != a_vars.end ();
+             ++i)
+            if (*i == a_old) {
+                *i = a_new;
+                return true;
+            }
+        return false;
+    }
+
+    /// Graphically update the plain variable a_old with the new
+    /// state a_new of the same variable, highlighting it if its
+    /// value changed since the previous stop.
+    void
+    update_a_plain_variable (const IDebugger::VariableSafePtr a_old,
+                             const IDebugger::VariableSafePtr a_new,
+                             Gtk::TreeModel::iterator &a_parent_row_it,
+                             IDebugger::VariableList &a_vars)
+    {
+        Gtk::TreeModel::iterator row_it;
+        if (!find_a_root_variable_row (a_old, a_parent_row_it, row_it))
+            return;
+        vutil::update_a_variable_node (a_new, *tree_view, row_it,
+                                       false /* do not truncate type */,
+                                       true /* handle highlight */,
+                                       false /* is not a new frame */);
+        replace_variable_in_list (a_old, a_new, a_vars);
+    }
+
+    /// Slot of IDebugger::list_frame_variables, called when the
+    /// debugger stopped in a new frame.  Fill the widget with the
+    /// locals and arguments of the frame, without creating any
+    /// backend variable object.  Those are created lazily, when
+    /// the user expands or edits a variable.
+    void
+    on_frame_variables_listed (const IDebugger::VariableList &a_locals,
+                               const IDebugger::VariableList &a_args)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY;
+
+        mark_expandable_plain_variables (a_locals);
+        mark_expandable_plain_variables (a_args);
+        set_local_variables (a_locals);
+        set_function_arguments (a_args);
+
+        // Fetch the members of the aggregates among them ahead of
+        // time, so that expanding them is instantaneous.
+        Gtk::TreeModel::iterator row_it;
+        if (get_local_variables_row_iterator (row_it))
+            child_prefetcher->prefetch_children_of
+                                        (tree_store->get_path (row_it));
+        if (get_function_arguments_row_iterator (row_it))
+            child_prefetcher->prefetch_children_of
+                                        (tree_store->get_path (row_it));
+
+        NEMIVER_CATCH;
+    }
+
+    /// Slot of IDebugger::list_frame_variables, called when the
+    /// debugger stopped again in the same frame.  Update the content
+    /// of the plain variables we already had.  If the user wants
+    /// the list of local variables to be updated at each stop, also
+    /// add the locals that appeared since the previous stop and
+    /// remove those that went out of scope.  Variables that have a
+    /// backend variable object are updated by update_local_variables
+    /// and update_function_arguments instead.
+    void
+    on_frame_variables_refreshed (const IDebugger::VariableList &a_locals,
+                                  const IDebugger::VariableList &a_args)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
 
-            if (!is_variable_in_list ((*i)->name (),
-                                      local_vars)) {
-                IDebugger::VariableList::const_iterator next_iterator = i;
-                next_iterator++;
-                if (next_iterator == a_vars.end ()) {
-                    // So we are on the last new local variable to
-                    // add.  Do not forget to update the content of
-                    // the list of all the (older) local variables
-                    // after adding this one.
-                    LOG_DD ("Creating a varobj for the last var " << (*i)->name ()
-                            << " and updating the content of all variables");
-                    debugger->create_variable
-                        ((*i)->name (),
-                         sigc::mem_fun
-                         (*this,
-                          &Priv::append_a_local_variable_and_update_all));
-                } else {
-                    LOG_DD ("Creating a varobj for var " << (*i)->name ());
-                    debugger->create_variable
-                        ((*i)->name (),
-                         sigc::mem_fun (*this,
-                                        &Priv::append_a_local_variable));
+        NEMIVER_TRY;
+
+        mark_expandable_plain_variables (a_locals);
+        mark_expandable_plain_variables (a_args);
+
+        IConfMgrSafePtr conf_mgr = workbench.get_configuration_manager ();
+        bool update_list = false;
+        conf_mgr->get_key_value (CONF_KEY_UPDATE_LOCAL_VARS_AT_EACH_STOP,
+                                 update_list);
+
+        Gtk::TreeModel::iterator parent_row_it;
+        IDebugger::VariableList::const_iterator i;
+        if (get_local_variables_row_iterator (parent_row_it)) {
+            for (i = a_locals.begin (); i != a_locals.end (); ++i) {
+                if ((*i)->name ().empty ())
+                    continue;
+                IDebugger::VariableSafePtr old =
+                    lookup_variable_by_name ((*i)->name (), local_vars);
+                if (!old) {
+                    if (update_list)
+                        append_a_local_variable (*i);
+                } else if (old->internal_name ().empty ()) {
+                    update_a_plain_variable (old, *i, parent_row_it,
+                                             local_vars);
                 }
-                added_new_vars = true;
             }
         }
 
-        // If some old variables we had don't exist anymore, remove
-        // them from the widget.
-        IDebugger::VariableList to_remove;
-        for (IDebugger::VariableList::const_iterator i = local_vars.begin ();
-             i != local_vars.end ();
-             ++i) {
-            if (!is_variable_in_list ((*i)->name (), a_vars))
-                to_remove.push_back (*i);
+        if (update_list) {
+            IDebugger::VariableList to_remove;
+            for (i = local_vars.begin (); i != local_vars.end (); ++i)
+                if (!is_variable_in_list ((*i)->name (), a_locals))
+                    to_remove.push_back (*i);
+            for (i = to_remove.begin (); i != to_remove.end (); ++i)
+                remove_a_local_variable (*i);
         }
-        for (IDebugger::VariableList::const_iterator i = to_remove.begin ();
-             i != to_remove.end ();
-             ++i)
-            remove_a_local_variable (*i);
-
-        // If we didn't add any new variable to the widget, let's not
-        // forget to update the content of the old ones we already
-        // had.
-        if (!added_new_vars) {
-            LOG_DD ("No new local variable was added.  "
-                    "Update existing local variables nonetheless");
-            update_local_variables ();
+
+        if (get_function_arguments_row_iterator (parent_row_it)) {
+            for (i = a_args.begin (); i != a_args.end (); ++i) {
+                IDebugger::VariableSafePtr old =
+                    lookup_variable_by_name ((*i)->name (),
+                                             function_arguments);
+                if (old && old->internal_name ().empty ())
+                    update_a_plain_variable (old, *i, parent_row_it,
+                                             function_arguments);
+            }
         }
+
+        NEMIVER_CATCH;
     }
 
-    /// First -- if the user wants the list of local variables to be
-    /// updated at each stop -- update the list of local variables.
-    /// That way, if new variables appeared in the current scope since
-    /// the previous stop, we'll get them.  Second, update the content
-    /// of all the variables that were already present at the previous
-    /// stop.
+    /// Create the backend variable object of the plain variable
+    /// shown at a_path, put it in place of the plain variable and
+    /// then call a_slot with it, or with a null pointer if the plain
+    /// variable is not shown anymore by then.
     void
-    maybe_update_list_of_local_vars_and_then_update_older_ones ()
+    create_varobj_of_row (const Gtk::TreeModel::Path &a_path,
+                          const IDebugger::ConstVariableSlot &a_slot)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
-        IConfMgrSafePtr conf_mgr = workbench.get_configuration_manager ();
-        bool do_update = false;
-        conf_mgr->get_key_value (CONF_KEY_UPDATE_LOCAL_VARS_AT_EACH_STOP,
-                                 do_update);
-        if (do_update) {
-            LOG_DD ("updating the list and content of local variables");
-            debugger->list_local_variables
-                (sigc::mem_fun
-                 (*this,
-                  &Priv::add_new_local_vars_and_update_olders));
-        } else {
-            LOG_DD ("just updating the content of local variables");
-            update_local_variables ();
+        Gtk::TreeModel::iterator row_it = tree_store->get_iter (a_path);
+        THROW_IF_FAIL (row_it);
+        IDebugger::VariableSafePtr var =
+            (*row_it)[vutil::get_variable_columns ().variable];
+        THROW_IF_FAIL (var && var->internal_name ().empty ());
+
+        LOG_DD ("creating varobj for " << var->name ());
+        debugger->create_variable
+            (var->name (),
+             sigc::bind (sigc::mem_fun (*this,
+                                        &Priv::on_varobj_of_row_created),
+                         var, a_path, a_slot));
+    }
+
+    void
+    on_varobj_of_row_created (const IDebugger::VariableSafePtr a_varobj,
+                              IDebugger::VariableSafePtr a_plain_var,
+                              Gtk::TreeModel::Path a_path,
+                              IDebugger::ConstVariableSlot a_slot)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY;
+
+        // The frame might have changed while the varobj was being
+        // created.  In that case, the plain variable is not shown
+        // anymore and a_varobj is just dropped.
+        if (!replace_variable_in_list (a_plain_var, a_varobj, local_vars)
+            && !replace_variable_in_list (a_plain_var, a_varobj,
+                                          function_arguments)) {
+            a_slot (IDebugger::VariableSafePtr ());
+            return;
         }
+
+        Gtk::TreeModel::iterator row_it = tree_store->get_iter (a_path);
+        THROW_IF_FAIL (row_it);
+        IDebugger::VariableSafePtr var =
+            (*row_it)[vutil::get_variable_columns ().variable];
+        THROW_IF_FAIL (var == a_plain_var);
+        // The plain variable has no value if it is an aggregate or
+        // if its type has a pretty printer, as it was listed with
+        // --simple-values.  The varobj has one, so show it.
+        vutil::update_a_variable_node (a_varobj, *tree_view, row_it,
+                                       false /* do not truncate type */,
+                                       false /* do not highlight variable */,
+                                       false /* frame ain't new */);
+        a_slot (a_varobj);
+
+        NEMIVER_CATCH;
+    }
+
+    /// Fetch the members of the variable a_var shown at a_path.
+    void
+    unfold_variable_row (const IDebugger::VariableSafePtr a_var,
+                         const Gtk::TreeModel::Path a_path)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        if (!a_var)
+            return;
+        if (!a_var->needs_unfolding ()) {
+            // This was a plain variable that turned out to have no
+            // members: remove the dummy child row that made it
+            // expandable.
+            Gtk::TreeModel::iterator row_it = tree_store->get_iter (a_path);
+            THROW_IF_FAIL (row_it);
+            Gtk::TreeModel::Children rows = row_it->children ();
+            for (Gtk::TreeModel::iterator it = rows.begin ();
+                 it != rows.end ();)
+                it = tree_store->erase (it);
+            (*row_it)[vutil::get_variable_columns ().needs_unfolding] = false;
+            return;
+        }
+        debugger->unfold_variable
+            (a_var,
+             sigc::bind  (sigc::mem_fun (*this,
+                                         &Priv::on_variable_unfolded_signal),
+                          a_path));
+    }
+
+    /// Assign a_value to the variable a_var shown at a_path.
+    void
+    assign_variable_row (const IDebugger::VariableSafePtr a_var,
+                         const UString &a_value,
+                         const UString &a_path)
+    {
+        if (!a_var)
+            return;
+        debugger->assign_variable
+            (a_var, a_value,
+             sigc::bind (sigc::mem_fun
+                                 (*this, &Priv::on_variable_assigned_signal),
+                         a_path));
+    }
+
+    /// Copy the value of the variable a_var to the clipboard.
+    void
+    copy_variable_value_to_clipboard (const IDebugger::VariableSafePtr a_var)
+    {
+        if (!a_var)
+            return;
+        IVarWalkerSafePtr walker = get_varobj_walker ();
+        walker->connect (debugger.get (), a_var);
+        walker->do_walk_variable ();
     }
 
     /// Return true if a variable named @a_name is present among the
@@ -742,6 +1080,9 @@ public:
         for (IDebugger::VariableList::const_iterator it = local_vars.begin ();
              it != local_vars.end ();
              ++it) {
+            // Plain variables are updated by on_frame_variables_refreshed.
+            if ((*it)->internal_name ().empty ())
+                continue;
             debugger->list_changed_variables
                     (*it,
                      sigc::mem_fun (*this,
@@ -771,6 +1112,8 @@ public:
                                             function_arguments.begin ();
              it != function_arguments.end ();
              ++it) {
+            if ((*it)->internal_name ().empty ())
+                continue;
             debugger->list_changed_variables
                     (*it,
                      sigc::mem_fun (*this,
@@ -828,10 +1171,265 @@ public:
                                         column,
                                         cell_x,
                                         cell_y)) {
+            Glib::RefPtr<Gtk::Action> compare_action =
+                get_ui_manager ()->get_action
+                ("/LocalVarsInspectorPopup/CompareWithSnapshotMenuItem");
+            THROW_IF_FAIL (compare_action);
+            std::vector<std::pair<unsigned, UString> > pinned;
+            snapshots.get_snapshots (pinned);
+            compare_action->set_sensitive (!pinned.empty ());
             menu->popup (a_event->button, a_event->time);
         }
     }
 
+    /// Append the leaves of the variables shown under a given row to
+    /// a_leaves.  A leaf is a variable which members are not shown,
+    /// either because it has none or because they haven't been
+    /// fetched yet.
+    ///
+    /// \param a_parent_it the row to consider.
+    ///
+    /// \param a_parent_path the path of the variable of a_parent_it,
+    /// e.g "foo.bar".  Empty for the top level rows.
+    ///
+    /// \param a_leaves the resulting leaves.
+    void
+    collect_leaves (const Gtk::TreeModel::iterator &a_parent_it,
+                    const UString &a_parent_path,
+                    std::vector<LocalsSnapshots::Leaf> &a_leaves)
+    {
+        Gtk::TreeModel::Children rows = a_parent_it->children ();
+        for (Gtk::TreeModel::iterator it = rows.begin ();
+             it != rows.end ();
+             ++it) {
+            IDebugger::VariableSafePtr var =
+                (*it)[vutil::get_variable_columns ().variable];
+            if (!var)
+                // The dummy row of a variable that needs unfolding.
+                continue;
+            UString name =
+                (Glib::ustring) (*it)[vutil::get_variable_columns ().name];
+            UString path = a_parent_path;
+            if (!path.empty () && name.raw ()[0] != '[')
+                path += ".";
+            path += name;
+            if (it->children ().empty ()
+                || (*it)[vutil::get_variable_columns ().needs_unfolding]) {
+                UString value =
+                    (Glib::ustring) (*it)[vutil::get_variable_columns ().value];
+                a_leaves.push_back (LocalsSnapshots::Leaf (path, value));
+            } else {
+                collect_leaves (it, path, a_leaves);
+            }
+        }
+    }
+
+    /// Get the leaves of the local variables and function arguments
+    /// currently shown.
+    void
+    collect_leaves (std::vector<LocalsSnapshots::Leaf> &a_leaves)
+    {
+        Gtk::TreeModel::iterator it;
+        if (get_local_variables_row_iterator (it))
+            collect_leaves (it, "", a_leaves);
+        if (get_function_arguments_row_iterator (it))
+            collect_leaves (it, "", a_leaves);
+    }
+
+    /// \return what identifies the scope of the variables of the
+    /// current frame, for the snapshots.
+    UString
+    get_current_snapshot_scope () const
+    {
+        return saved_frame.function_name () + "@" + saved_frame.file_name ();
+    }
+
+    /// Fill a_store with the differences between the snapshot a_id
+    /// and the variables currently shown.  Nothing is compared if the
+    /// snapshot was taken in another function.
+    ///
+    /// \param a_summary a label that gets the number of differences.
+    void
+    fill_snapshot_diff (unsigned a_id,
+                        Glib::RefPtr<Gtk::ListStore> a_store,
+                        Gtk::Label *a_summary)
+    {
+        a_store->clear ();
+
+        UString scope;
+        if (!snapshots.get_snapshot_scope (a_id, scope))
+            return;
+        if (scope != get_current_snapshot_scope ()) {
+            UString message;
+            message.printf (_("The snapshot was not taken in %s: "
+                              "its variables can't be compared with "
+                              "the current ones"),
+                            saved_frame.function_name ().c_str ());
+            a_summary->set_text (message);
+            return;
+        }
+
+        std::vector<LocalsSnapshots::Leaf> leaves;
+        collect_leaves (leaves);
+        std::vector<LocalsSnapshots::LeafDiff> diffs;
+        if (!snapshots.diff (a_id, leaves, diffs))
+            return;
+
+        int nb_changed = 0, nb_added = 0, nb_removed = 0;
+        std::vector<LocalsSnapshots::LeafDiff>::const_iterator it;
+        for (it = diffs.begin (); it != diffs.end (); ++it) {
+            Gtk::TreeModel::iterator row = a_store->append ();
+            (*row)[get_snapshot_diff_columns ().path] = it->path;
+            (*row)[get_snapshot_diff_columns ().old_value] = it->old_value;
+            (*row)[get_snapshot_diff_columns ().new_value] = it->new_value;
+            switch (it->kind) {
+                case LocalsSnapshots::LEAF_CHANGED:
+                    (*row)[get_snapshot_diff_columns ().change] =
+                                                        _("changed");
+                    ++nb_changed;
+                    break;
+                case LocalsSnapshots::LEAF_ADDED:
+                    (*row)[get_snapshot_diff_columns ().change] = _("added");
+                    ++nb_added;
+                    break;
+                case LocalsSnapshots::LEAF_REMOVED:
+                    (*row)[get_snapshot_diff_columns ().change] =
+                                                        _("removed");
+                    ++nb_removed;
+                    break;
+            }
+            if (it->has_delta) {
+                UString delta;
+                if (it->delta_is_integer)
+                    delta.printf ("%+lld", (long long) it->delta);
+                else
+                    delta.printf ("%+g", it->delta);
+                (*row)[get_snapshot_diff_columns ().delta] = delta;
+            }
+        }
+
+        UString summary;
+        summary.printf (_("%d changed, %d added, %d removed"),
+                        nb_changed, nb_added, nb_removed);
+        a_summary->set_text (summary);
+    }
+
+    void
+    on_snapshot_combo_changed (Gtk::ComboBoxText *a_combo,
+                               const std::vector<unsigned> *a_ids,
+                               Glib::RefPtr<Gtk::ListStore> a_store,
+                               Gtk::Label *a_summary)
+    {
+        NEMIVER_TRY
+
+        int row = a_combo->get_active_row_number ();
+        if (row < 0 || (unsigned) row >= a_ids->size ())
+            return;
+        fill_snapshot_diff ((*a_ids)[row], a_store, a_summary);
+
+        NEMIVER_CATCH
+    }
+
+    /// Forget the snapshot selected in a_combo, and select the most
+    /// recent snapshot left.  Close a_dialog if none is left.
+    void
+    on_forget_snapshot_clicked (Gtk::Dialog *a_dialog,
+                                Gtk::ComboBoxText *a_combo,
+                                std::vector<unsigned> *a_ids)
+    {
+        NEMIVER_TRY
+
+        int row = a_combo->get_active_row_number ();
+        if (row < 0 || (unsigned) row >= a_ids->size ())
+            return;
+        snapshots.forget_snapshot ((*a_ids)[row]);
+        a_ids->erase (a_ids->begin () + row);
+        a_combo->remove_text (row);
+        if (a_ids->empty ()) {
+            a_dialog->response (Gtk::RESPONSE_CLOSE);
+            return;
+        }
+        a_combo->set_active (a_ids->size () - 1);
+
+        NEMIVER_CATCH
+    }
+
+    /// Show a dialog listing the leaves of the variables that changed,
+    /// appeared or disappeared since a pinned snapshot.  The most
+    /// recent snapshot is selected by default.
+    void
+    show_snapshot_diff_dialog ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        std::vector<std::pair<unsigned, UString> > pinned;
+        snapshots.get_snapshots (pinned);
+        if (pinned.empty ())
+            return;
+
+        Gtk::Dialog dialog (_("Compare With Snapshot"),
+                            workbench.get_root_window (),
+                            true);
+        dialog.add_button (Gtk::Stock::CLOSE, Gtk::RESPONSE_CLOSE);
+        dialog.set_default_size (560, 400);
+
+        Gtk::ComboBoxText combo;
+        std::vector<unsigned> ids;
+        std::vector<std::pair<unsigned, UString> >::const_iterator it;
+        for (it = pinned.begin (); it != pinned.end (); ++it) {
+            ids.push_back (it->first);
+            combo.append (it->second);
+        }
+
+        Glib::RefPtr<Gtk::ListStore> store =
+            Gtk::ListStore::create (get_snapshot_diff_columns ());
+        Gtk::Label summary_label;
+        summary_label.set_alignment (0, 0.5);
+
+        Gtk::TreeView diff_view (store);
+        diff_view.append_column (_("Variable"),
+                                 get_snapshot_diff_columns ().path);
+        diff_view.append_column (_("Change"),
+                                 get_snapshot_diff_columns ().change);
+        diff_view.append_column (_("Snapshot Value"),
+                                 get_snapshot_diff_columns ().old_value);
+        diff_view.append_column (_("Current Value"),
+                                 get_snapshot_diff_columns ().new_value);
+        diff_view.append_column (_("Delta"),
+                                 get_snapshot_diff_columns ().delta);
+        Gtk::ScrolledWindow scr;
+        scr.set_policy (Gtk::POLICY_AUTOMATIC, Gtk::POLICY_AUTOMATIC);
+        scr.set_shadow_type (Gtk::SHADOW_IN);
+        scr.add (diff_view);
+
+        combo.signal_changed ().connect
+            (sigc::bind (sigc::mem_fun (*this,
+                                        &Priv::on_snapshot_combo_changed),
+                         &combo, &ids, store, &summary_label));
+        combo.set_active (ids.size () - 1);
+
+        Gtk::Button forget_button (_("_Forget Snapshot"), true);
+        forget_button.set_tooltip_text
+                        (_("Drop the selected snapshot of the variables"));
+        forget_button.signal_clicked ().connect
+            (sigc::bind (sigc::mem_fun (*this,
+                                        &Priv::on_forget_snapshot_clicked),
+                         &dialog, &combo, &ids));
+
+        Gtk::Box combo_box (Gtk::ORIENTATION_HORIZONTAL, 6);
+        combo_box.pack_start (combo);
+        combo_box.pack_start (forget_button, Gtk::PACK_SHRINK);
+
+        Gtk::Box *box = dialog.get_content_area ();
+        THROW_IF_FAIL (box);
+        box->set_spacing (6);
+        box->pack_start (combo_box, Gtk::PACK_SHRINK);
+        box->pack_start (summary_label, Gtk::PACK_SHRINK);
+        box->pack_start (scr);
+        dialog.show_all ();
+        dialog.run ();
+    }
+
     DynamicModuleManager*
     get_module_manager ()
     {
@@ -957,64 +1555,6 @@ public:
         NEMIVER_CATCH
     }
 
-    // Slot of IDebugger::create_variable, for creating backend variables
-    // objects for frame parameter variables.
-    void
-    on_function_arg_var_created_signal (const IDebugger::VariableSafePtr a_var)
-    {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
-
-        NEMIVER_TRY
-
-        if (is_new_frame) {
-            LOG_DD ("appending an argument to substree");
-            append_a_function_argument (a_var);
-        } else {
-            if (is_function_arguments_subtree_empty ()) {
-                LOG_DD ("appending an argument to substree");
-                append_a_function_argument (a_var);
-            } else {
-                LOG_DD ("updating an argument in substree");
-                if (!update_a_function_argument (a_var)) {
-                    append_a_function_argument (a_var);
-                }
-            }
-        }
-
-        NEMIVER_CATCH
-    }
-
-    void
-    on_function_args_listed (const map<int, IDebugger::VariableList> &a_args)
-    {
-        LOG_FUNCTION_SCOPE_NORMAL_DD;
-
-        NEMIVER_TRY;
-
-        UString name;
-        map<int, IDebugger::VariableList>::const_iterator frame_it;
-        frame_it = a_args.find (debugger->get_current_frame_level ());
-        if (frame_it == a_args.end ()) {
-            LOG_DD ("Got empty frames parameters");
-            return;
-        }
-        IDebugger::VariableList::const_iterator it;
-        for (it = frame_it->second.begin ();
-             it != frame_it->second.end ();
-             ++it)  {
-            name = (*it)->name ();
-            if (name.empty ()) {
-                continue;
-            }
-            LOG_DD ("creating variable '" << name << "'");
-            debugger->create_variable
-                (name,
-                 sigc::mem_fun (*this,
-                                &Priv::on_function_arg_var_created_signal));
-        }
-        NEMIVER_CATCH;
-    }
-
     void
     on_function_args_updated_signal (const IDebugger::VariableList &a_vars)
     {
@@ -1087,6 +1627,7 @@ public:
                                          var_it,
                                          false /* do not truncate type */);
         tree_view->expand_row (a_var_node, false);
+        child_prefetcher->prefetch_children_of (a_var_node);
         NEMIVER_CATCH
     }
 
@@ -1095,7 +1636,10 @@ public:
     {
         NEMIVER_TRY
 
-        Gtk::Clipboard::get ()->set_text (a_var->path_expression ());
+        if (a_var->internal_name ().empty ())
+            Gtk::Clipboard::get ()->set_text (a_var->name ());
+        else
+            Gtk::Clipboard::get ()->set_text (a_var->path_expression ());
 
         NEMIVER_CATCH
     }
@@ -1106,7 +1650,10 @@ public:
     {
         NEMIVER_TRY
 
-        debugger->set_watchpoint (a_var->path_expression ());
+        if (a_var->internal_name ().empty ())
+            debugger->set_watchpoint (a_var->name ());
+        else
+            debugger->set_watchpoint (a_var->path_expression ());
 
         NEMIVER_CATCH
     }
@@ -1171,17 +1718,25 @@ public:
         NEMIVER_TRY
 
         if (!(*a_it)[vutil::get_variable_columns ().needs_unfolding]) {
+            child_prefetcher->prefetch_children_of (a_path);
             return;
         }
         LOG_DD ("A variable needs unfolding");
 
         IDebugger::VariableSafePtr var =
             (*a_it)[vutil::get_variable_columns ().variable];
-        debugger->unfold_variable
-            (var,
-             sigc::bind  (sigc::mem_fun (*this,
-                                         &Priv::on_variable_unfolded_signal),
-                          a_path));
+        THROW_IF_FAIL (var);
+        if (child_prefetcher->take_over_expansion (var, a_path))
+            return;
+        if (var->internal_name ().empty ()) {
+            create_varobj_of_row
+                (a_path,
+                 sigc::bind (sigc::mem_fun (*this,
+                                            &Priv::unfold_variable_row),
+                             a_path));
+            return;
+        }
+        unfold_variable_row (var, a_path);
 
         NEMIVER_CATCH
     }
@@ -1249,11 +1804,15 @@ public:
             (*row)[vutil::get_variable_columns ().variable];
         THROW_IF_FAIL (var);
 
-        debugger->assign_variable
-            (var, a_text,
-             sigc::bind (sigc::mem_fun
-                                 (*this, &Priv::on_variable_assigned_signal),
-                         a_path));
+        if (var->internal_name ().empty ()) {
+            create_varobj_of_row
+                (tree_store->get_path (row),
+                 sigc::bind (sigc::mem_fun (*this,
+                                            &Priv::assign_variable_row),
+                             a_text, a_path));
+            return;
+        }
+        assign_variable_row (var, a_text, a_path);
 
         NEMIVER_CATCH
     }
@@ -1293,6 +1852,12 @@ public:
                 (vutil::get_variable_columns ().variable);
         THROW_IF_FAIL (variable);
 
+        // The path expression of a variable that has no backend
+        // variable object is its name.
+        if (variable->internal_name ().empty ()) {
+            on_variable_path_expression_signal (variable);
+            return;
+        }
         debugger->query_variable_path_expr
             (variable,
              sigc::mem_fun (*this, &Priv::on_variable_path_expression_signal));
@@ -1314,9 +1879,53 @@ public:
                 (vutil::get_variable_columns ().variable);
         THROW_IF_FAIL (variable);
 
-        IVarWalkerSafePtr walker = get_varobj_walker ();
-        walker->connect (debugger.get (), variable);
-        walker->do_walk_variable ();
+        if (variable->internal_name ().empty ()) {
+            if (!variable->needs_unfolding ()) {
+                Gtk::Clipboard::get ()->set_text (variable->value ());
+                return;
+            }
+            // The members of the variable are needed, so walk its
+            // backend variable object.
+            create_varobj_of_row
+                (tree_store->get_path (cur_selected_row),
+                 sigc::mem_fun (*this,
+                                &Priv::copy_variable_value_to_clipboard));
+            return;
+        }
+        copy_variable_value_to_clipboard (variable);
+
+        NEMIVER_CATCH
+    }
+
+    void
+    on_pin_snapshot_action ()
+    {
+        NEMIVER_TRY
+
+        std::vector<LocalsSnapshots::Leaf> leaves;
+        collect_leaves (leaves);
+
+        UString label;
+        label.printf (_("#%d: %s, %s:%d"),
+                      ++nb_pinned_snapshots,
+                      saved_frame.function_name ().c_str (),
+                      saved_frame.file_name ().c_str (),
+                      saved_frame.line ());
+        snapshots.take_snapshot (label, get_current_snapshot_scope (),
+                                 leaves);
+        LOG_DD ("pinned " << leaves.size () << " leaves, "
+                << snapshots.nb_interned_strings ()
+                << " strings interned");
+
+        NEMIVER_CATCH
+    }
+
+    void
+    on_compare_with_snapshot_action ()
+    {
+        NEMIVER_TRY
+
+        show_snapshot_diff_dialog ();
 
         NEMIVER_CATCH
     }
@@ -1331,6 +1940,10 @@ public:
                 (vutil::get_variable_columns ().variable);
         THROW_IF_FAIL (variable);
 
+        if (variable->internal_name ().empty ()) {
+            on_variable_path_expression_signal_set_wpt (variable);
+            return;
+        }
         debugger->query_variable_path_expr
             (variable,
              sigc::mem_fun
@@ -1360,6 +1973,15 @@ LocalVarsInspector::widget () const
     return *m_priv->tree_view;
 }
 
+/// \return the box to search the variables shown by the inspector.
+Gtk::Widget&
+LocalVarsInspector::search_bar () const
+{
+    THROW_IF_FAIL (m_priv);
+    THROW_IF_FAIL (m_priv->search_bar);
+    return *m_priv->search_bar;
+}
+
 /// List the local variables of the current function, as well as its
 /// arguments.
 ///
@@ -1375,15 +1997,8 @@ LocalVarsInspector::show_local_variables_of_current_function
     m_priv->saved_frame = a_frame;
 
     re_init_widget ();
-    m_priv->debugger->list_local_variables
-        (sigc::mem_fun (*m_priv, &Priv::add_new_local_vars_and_update_olders));
-
-    int frame_level = m_priv->debugger->get_current_frame_level ();
-    LOG_DD ("current frame level: " <<  (int)frame_level);
-    m_priv->debugger->list_frames_arguments (frame_level, frame_level,
-                                             sigc::mem_fun
-                                             (*m_priv, &Priv::on_function_args_listed),
-                                             "");
+    m_priv->debugger->list_frame_variables
+        (sigc::mem_fun (*m_priv, &Priv::on_frame_variables_listed));
 }
 
 /// Re-visualize the local variables of the current function, possibly
@@ -1398,12 +2013,17 @@ LocalVarsInspector::visualize_local_variables_of_current_function ()
     IDebugger::VariableList::const_iterator it;
     for (it = m_priv->local_vars.begin ();
          it != m_priv->local_vars.end ();
-         ++it)
+         ++it) {
+        // Plain variables have no backend variable object to
+        // re-visualize yet.
+        if ((*it)->internal_name ().empty ())
+            continue;
         m_priv->debugger->revisualize_variable
             (*it,
              sigc::mem_fun
              (*m_priv,
               &Priv::on_local_var_visualized_signal));
+    }
 }
 
 void
@@ -1415,5 +2035,28 @@ LocalVarsInspector::re_init_widget ()
     m_priv->re_init_tree_view ();
 }
 
+/// Get the values of the local variables and function arguments of
+/// the current function, as shown by the inspector.  No command is
+/// sent to the debugger.
+///
+/// \param a_values the values, keyed by variable name.
+///
+/// \return false if the values shown are not up to date.
+bool
+LocalVarsInspector::get_variable_values
+                            (std::map<UString, UString> &a_values) const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->get_variable_values (a_values);
+}
+
+/// A signal emitted when the values shown by the inspector changed.
+sigc::signal<void>&
+LocalVarsInspector::values_changed_signal () const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->values_changed_signal;
+}
+
 NEMIVER_END_NAMESPACE (nemiver)
 
@@ -26,6 +26,7 @@
 #define __NMV_LOCAL_VARS_INSPECTOR_H__
 
 #include <list>
+#include <map>
 #include "common/nmv-object.h"
 #include "common/nmv-safe-ptr-utils.h"
 #include "nmv-i-perspective.h"
@@ -57,12 +58,15 @@ public:
                          IPerspective &a_perspective);
     virtual ~LocalVarsInspector ();
     Gtk::Widget& widget () const;
+    Gtk::Widget& search_bar () const;
     void set_local_variables
       (const std::list<IDebugger::VariableSafePtr> &a_vars);
     void show_local_variables_of_current_function
       (const IDebugger::Frame &a_frame);
     void visualize_local_variables_of_current_function ();
     void re_init_widget ();
+    bool get_variable_values (std::map<UString, UString> &a_values) const;
+    sigc::signal<void>& values_changed_signal () const;
 };//end LocalVarsInspector
 
 NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,326 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <cstdlib>
+#include <map>
+#include <algorithm>
+#include "common/nmv-exception.h"
+#include "common/nmv-string-pool.h"
+#include "nmv-locals-snapshots.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+using nemiver::common::StringPool;
+
+/// A number parsed from the value of a variable.
+struct Number {
+    bool is_integer;
+    // The bits of the number if is_integer is true.  Addresses are
+    // unsigned, so they are subtracted as such.
+    unsigned long long integer;
+    double real;
+};
+
+/// Parse a value that is a number, as printed by GDB: e.g "42",
+/// "-1.5", "65 'A'" for a char or "0x400 \"foo\"" for a char
+/// pointer.
+///
+/// \return true if a_value is a number, possibly followed by the
+/// character of a char or by what an address points to.  A value that
+/// merely starts with a number, e.g "3 apples", is not a number.
+static bool
+parse_number (const UString &a_value, Number &a_number)
+{
+    const string &value = a_value.raw ();
+    string::size_type len = value.find (' ');
+    if (len == string::npos)
+        len = value.size ();
+    if (!len)
+        return false;
+    string number = value.substr (0, len);
+    const char *str = number.c_str ();
+    char *end = 0;
+    bool is_address = number.compare (0, 2, "0x") == 0;
+
+    if (len < value.size ()) {
+        // Only a char and an address are followed by something.
+        if (!is_address && value[len + 1] != '\'')
+            return false;
+    }
+
+    if (is_address) {
+        a_number.integer = strtoull (str, &end, 16);
+        a_number.is_integer = true;
+        a_number.real = a_number.integer;
+    } else {
+        a_number.integer = strtoll (str, &end, 10);
+        a_number.is_integer = (*end == 0);
+        if (!a_number.is_integer)
+            a_number.real = strtod (str, &end);
+        else
+            a_number.real = (long long) a_number.integer;
+    }
+    return end != str && *end == 0;
+}
+
+struct LocalsSnapshots::Priv {
+    struct Entry {
+        StringPool::Id path;
+        StringPool::Id value;
+    };
+
+    struct Snapshot {
+        UString label;
+        UString scope;
+        // Sorted by path.
+        std::vector<Entry> entries;
+    };
+
+    typedef std::map<unsigned, Snapshot> Snapshots;
+
+    // The paths and values of all the snapshots.  A StringPool never
+    // drops a string, so the pool is replaced once no snapshot is
+    // left.
+    SafePtr<StringPool> strings;
+    Snapshots snapshots;
+    unsigned last_id;
+
+    Priv () :
+        strings (new StringPool),
+        last_id (0)
+    {
+    }
+
+    void reset_strings ()
+    {
+        strings.reset (new StringPool);
+    }
+
+    static bool leaf_less (const Leaf &a_l, const Leaf &a_r)
+    {
+        return a_l.first < a_r.first;
+    }
+
+    static bool leaf_path_equal (const Leaf &a_l, const Leaf &a_r)
+    {
+        return a_l.first == a_r.first;
+    }
+
+    /// Sort a set of leaves by path, keeping only the first leaf of
+    /// a given path.
+    static void sort_leaves (std::vector<Leaf> &a_leaves)
+    {
+        std::stable_sort (a_leaves.begin (), a_leaves.end (), leaf_less);
+        a_leaves.erase (std::unique (a_leaves.begin (), a_leaves.end (),
+                                     leaf_path_equal),
+                        a_leaves.end ());
+    }
+};//end struct LocalsSnapshots::Priv
+
+LocalsSnapshots::LocalsSnapshots ()
+{
+    m_priv.reset (new Priv);
+}
+
+LocalsSnapshots::~LocalsSnapshots ()
+{
+}
+
+/// Record a snapshot of a set of variables.
+///
+/// \param a_label a text describing where the snapshot was taken.
+///
+/// \param a_scope what identifies the scope of the variables, e.g
+/// the function they are local to.
+///
+/// \param a_leaves the leaves of the variables.  If several leaves
+/// have the same path, only the first one is kept.
+///
+/// \return the identifier of the new snapshot.  It is never zero.
+unsigned
+LocalsSnapshots::take_snapshot (const UString &a_label,
+                                const UString &a_scope,
+                                const std::vector<Leaf> &a_leaves)
+{
+    std::vector<Leaf> leaves (a_leaves);
+    Priv::sort_leaves (leaves);
+
+    unsigned id = ++m_priv->last_id;
+    Priv::Snapshot &snapshot = m_priv->snapshots[id];
+    snapshot.label = a_label;
+    snapshot.scope = a_scope;
+    snapshot.entries.reserve (leaves.size ());
+    std::vector<Leaf>::const_iterator it;
+    for (it = leaves.begin (); it != leaves.end (); ++it) {
+        Priv::Entry entry;
+        entry.path = m_priv->strings->intern (it->first.raw ());
+        entry.value = m_priv->strings->intern (it->second.raw ());
+        snapshot.entries.push_back (entry);
+    }
+    return id;
+}
+
+/// Get the identifiers and labels of the recorded snapshots, oldest
+/// first.
+void
+LocalsSnapshots::get_snapshots
+            (std::vector<std::pair<unsigned, UString> > &a_snapshots) const
+{
+    Priv::Snapshots::const_iterator it;
+    for (it = m_priv->snapshots.begin ();
+         it != m_priv->snapshots.end ();
+         ++it)
+        a_snapshots.push_back (std::make_pair (it->first, it->second.label));
+}
+
+/// \return true if a snapshot with the identifier a_id is recorded.
+bool
+LocalsSnapshots::has_snapshot (unsigned a_id) const
+{
+    return m_priv->snapshots.find (a_id) != m_priv->snapshots.end ();
+}
+
+/// Get the scope a snapshot was taken in.
+///
+/// \return false if there is no snapshot a_id.
+bool
+LocalsSnapshots::get_snapshot_scope (unsigned a_id, UString &a_scope) const
+{
+    Priv::Snapshots::const_iterator it = m_priv->snapshots.find (a_id);
+    if (it == m_priv->snapshots.end ())
+        return false;
+    a_scope = it->second.scope;
+    return true;
+}
+
+/// Drop a snapshot.
+void
+LocalsSnapshots::forget_snapshot (unsigned a_id)
+{
+    Priv::Snapshots::iterator it = m_priv->snapshots.find (a_id);
+    if (it == m_priv->snapshots.end ())
+        return;
+    m_priv->snapshots.erase (it);
+    if (m_priv->snapshots.empty ())
+        m_priv->reset_strings ();
+}
+
+/// Drop all the snapshots.
+void
+LocalsSnapshots::clear ()
+{
+    m_priv->snapshots.clear ();
+    m_priv->reset_strings ();
+}
+
+/// Compare a snapshot with the current leaves of the variables.
+///
+/// \param a_id the identifier of the snapshot.
+///
+/// \param a_leaves the current leaves.
+///
+/// \param a_diffs the leaves that changed, appeared or disappeared
+/// since the snapshot, sorted by path.
+///
+/// \return false if there is no snapshot a_id.
+bool
+LocalsSnapshots::diff (unsigned a_id,
+                       const std::vector<Leaf> &a_leaves,
+                       std::vector<LeafDiff> &a_diffs) const
+{
+    Priv::Snapshots::const_iterator snapshot = m_priv->snapshots.find (a_id);
+    if (snapshot == m_priv->snapshots.end ())
+        return false;
+
+    std::vector<Leaf> leaves (a_leaves);
+    Priv::sort_leaves (leaves);
+
+    // Both sequences are sorted by path: merge them.
+    const StringPool &strings = *m_priv->strings;
+    const std::vector<Priv::Entry> &entries = snapshot->second.entries;
+    std::vector<Priv::Entry>::const_iterator old_it = entries.begin ();
+    std::vector<Leaf>::const_iterator new_it = leaves.begin ();
+    while (old_it != entries.end () || new_it != leaves.end ()) {
+        LeafDiff d;
+        d.has_delta = false;
+        d.delta = 0;
+        d.delta_is_integer = false;
+        if (new_it == leaves.end ()
+            || (old_it != entries.end ()
+                && strings.get (old_it->path) < new_it->first)) {
+            d.kind = LEAF_REMOVED;
+            d.path = strings.get (old_it->path);
+            d.old_value = strings.get (old_it->value);
+            ++old_it;
+        } else if (old_it == entries.end ()
+                   || new_it->first < strings.get (old_it->path)) {
+            d.kind = LEAF_ADDED;
+            d.path = new_it->first;
+            d.new_value = new_it->second;
+            ++new_it;
+        } else {
+            const UString &old_value = strings.get (old_it->value);
+            if (old_value == new_it->second) {
+                ++old_it;
+                ++new_it;
+                continue;
+            }
+            d.kind = LEAF_CHANGED;
+            d.path = new_it->first;
+            d.old_value = old_value;
+            d.new_value = new_it->second;
+            Number old_number, new_number;
+            if (parse_number (old_value, old_number)
+                && parse_number (new_it->second, new_number)) {
+                if (old_number.is_integer && new_number.is_integer) {
+                    d.delta_is_integer = true;
+                    d.delta = (long long) (new_number.integer
+                                           - old_number.integer);
+                } else {
+                    d.delta = new_number.real - old_number.real;
+                }
+                // E.g only the string a pointer points to changed.
+                d.has_delta = (d.delta != 0);
+                if (!d.has_delta)
+                    d.delta_is_integer = false;
+            }
+            ++old_it;
+            ++new_it;
+        }
+        a_diffs.push_back (d);
+    }
+    return true;
+}
+
+/// \return the number of distinct non empty paths and values held by
+/// the snapshots.
+unsigned
+LocalsSnapshots::nb_interned_strings () const
+{
+    // Don't count the empty string the pool always holds.
+    return m_priv->strings->size () - 1;
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
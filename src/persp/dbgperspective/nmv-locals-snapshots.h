@@ -0,0 +1,118 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_LOCALS_SNAPSHOTS_H__
+#define __NMV_LOCALS_SNAPSHOTS_H__
+
+#include <vector>
+#include <utility>
+#include "common/nmv-object.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "common/nmv-ustring.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+using nemiver::common::UString;
+
+/// Snapshots of the local variables of a frame, taken at given stops
+/// of the inferior, that can be compared with the variables of a
+/// later stop.
+///
+/// A snapshot is the list of the leaves of the variables, that is,
+/// of the (path, value) pairs of the variables that have no member,
+/// e.g ("foo.bar[2]", "42").  Each snapshot also records the scope
+/// it was taken in, e.g the function of the frame, as comparing the
+/// locals of two different functions makes no sense.  The paths and
+/// values are interned in a common::StringPool shared by all the
+/// snapshots, so a snapshot costs a couple of ids per leaf, plus the
+/// strings no other snapshot uses.  The pool is dropped with the last
+/// snapshot.
+class NEMIVER_API LocalsSnapshots : public nemiver::common::Object {
+    //non copyable
+    LocalsSnapshots (const LocalsSnapshots&);
+    LocalsSnapshots& operator= (const LocalsSnapshots&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+public:
+
+    /// A leaf of a set of variables: its path and its value.
+    typedef std::pair<UString, UString> Leaf;
+
+    /// How a leaf differs between a snapshot and the current state.
+    enum ChangeKind {
+        LEAF_CHANGED = 0,
+        LEAF_ADDED,
+        LEAF_REMOVED
+    };
+
+    /// The difference of one leaf between a snapshot and the current
+    /// state of the variables.
+    struct LeafDiff {
+        ChangeKind kind;
+        UString path;
+        /// The value in the snapshot.  Empty for an added leaf.
+        UString old_value;
+        /// The current value.  Empty for a removed leaf.
+        UString new_value;
+        /// True if both values are different numbers, in which case
+        /// delta is new_value - old_value.  An address, or a char,
+        /// is a number: the string or the character printed after
+        /// it is not part of the number.
+        bool has_delta;
+        double delta;
+        /// True if both numbers are integers or addresses, in which
+        /// case delta holds an integer and should be shown as such.
+        bool delta_is_integer;
+    };
+
+    LocalsSnapshots ();
+    virtual ~LocalsSnapshots ();
+
+    unsigned take_snapshot (const UString &a_label,
+                            const UString &a_scope,
+                            const std::vector<Leaf> &a_leaves);
+
+    void get_snapshots
+        (std::vector<std::pair<unsigned, UString> > &a_snapshots) const;
+
+    bool has_snapshot (unsigned a_id) const;
+
+    bool get_snapshot_scope (unsigned a_id, UString &a_scope) const;
+
+    void forget_snapshot (unsigned a_id);
+
+    void clear ();
+
+    bool diff (unsigned a_id,
+               const std::vector<Leaf> &a_leaves,
+               std::vector<LeafDiff> &a_diffs) const;
+
+    unsigned nb_interned_strings () const;
+};//end LocalsSnapshots
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_LOCALS_SNAPSHOTS_H__
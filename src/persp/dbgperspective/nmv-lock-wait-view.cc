@@ -0,0 +1,591 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <glib/gi18n.h>
+#include <gtkmm/box.h>
+#include <gtkmm/drawingarea.h>
+#include <gtkmm/label.h>
+#include <gtkmm/paned.h>
+#include <gtkmm/scrolledwindow.h>
+#include <gtkmm/tooltip.h>
+#include <gtkmm/treestore.h>
+#include <gtkmm/treeview.h>
+#include "common/nmv-exception.h"
+#include "nmv-lock-wait-graph.h"
+#include "nmv-lock-wait-view.h"
+#include "nmv-ui-utils.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// Radius of the node of a thread in the wait-for graph, in pixels.
+static const double LOCK_WAIT_NODE_RADIUS = 16;
+
+struct LockWaitColumns : public Gtk::TreeModelColumnRecord {
+    Gtk::TreeModelColumn<Glib::ustring> object;
+    /// Number of waiters of a lock, or zero for the thread rows.
+    Gtk::TreeModelColumn<int> nb_waiters;
+    Gtk::TreeModelColumn<Glib::ustring> details;
+    /// The thread a row designates, or zero if it doesn't designate
+    /// a thread.
+    Gtk::TreeModelColumn<int> thread_id;
+    Gtk::TreeModelColumn<Gdk::RGBA> fg_color;
+
+    LockWaitColumns ()
+    {
+        add (object);
+        add (nb_waiters);
+        add (details);
+        add (thread_id);
+        add (fg_color);
+    }
+};//end LockWaitColumns
+
+static LockWaitColumns&
+get_columns ()
+{
+    static LockWaitColumns s_cols;
+    return s_cols;
+}
+
+static UString
+kind_to_string (LockWaitGraph::LockKind a_kind)
+{
+    switch (a_kind) {
+        case LockWaitGraph::LOCK_MUTEX: return _("mutex");
+        case LockWaitGraph::LOCK_RWLOCK: return _("read-write lock");
+        case LockWaitGraph::LOCK_CONDITION: return _("condition");
+        case LockWaitGraph::LOCK_SEMAPHORE: return _("semaphore");
+        case LockWaitGraph::LOCK_BARRIER: return _("barrier");
+        case LockWaitGraph::LOCK_JOIN: return _("thread join");
+        case LockWaitGraph::LOCK_FUTEX: return _("futex");
+        case LockWaitGraph::LOCK_NONE: break;
+    }
+    return _("unknown");
+}
+
+/// Format a lock, e.g "mutex 0x601040".
+static UString
+lock_to_string (LockWaitGraph::LockKind a_kind, size_t a_address)
+{
+    UString result = kind_to_string (a_kind);
+    if (a_address) {
+        UString address;
+        address.printf (" %#lx", (unsigned long) a_address);
+        result += address;
+    }
+    return result;
+}
+
+static UString
+thread_to_string (int a_thread_id)
+{
+    return _("Thread ") + UString::from_int (a_thread_id);
+}
+
+/// Format the location of a frame, e.g "main at foo.cc:42".
+static UString
+frame_location (const IDebugger::Frame &a_frame)
+{
+    UString result = a_frame.function_name ().empty ()
+        ? UString (a_frame.address ().to_string ())
+        : UString (a_frame.function_name ());
+    if (!a_frame.file_name ().empty ()) {
+        result += " at " + a_frame.file_name ();
+        if (a_frame.line ())
+            result += ":" + UString::from_int (a_frame.line ());
+    }
+    return result;
+}
+
+/// Where a thread is drawn in the wait-for graph.
+struct ThreadNode {
+    int thread_id;
+    double x;
+    double y;
+};
+
+struct LockWaitView::Priv {
+    IDebuggerSafePtr debugger;
+    LockWaitCollector collector;
+    LockWaitGraph graph;
+    SafePtr<Gtk::Box> vbox;
+    SafePtr<Gtk::Label> summary_label;
+    SafePtr<Gtk::TreeView> tree_view;
+    Glib::RefPtr<Gtk::TreeStore> tree_store;
+    SafePtr<Gtk::DrawingArea> graph_area;
+    std::vector<ThreadNode> nodes;
+    bool is_up2date;
+
+    Priv (IDebuggerSafePtr &a_debugger) :
+        debugger (a_debugger),
+        collector (a_debugger),
+        is_up2date (true)
+    {
+        build_widget ();
+        connect_to_debugger_signals ();
+        connect_to_widget_signals ();
+    }
+
+    void build_widget ()
+    {
+        summary_label.reset (new Gtk::Label);
+        summary_label->set_alignment (0, 0.5);
+        summary_label->set_padding (3, 3);
+
+        tree_store = Gtk::TreeStore::create (get_columns ());
+        tree_view.reset (new Gtk::TreeView (tree_store));
+        tree_view->append_column (_("Lock"), get_columns ().object);
+        tree_view->append_column (_("Waiters"), get_columns ().nb_waiters);
+        tree_view->append_column (_("Details"), get_columns ().details);
+        for (int i = 0; i < 3; ++i) {
+            Gtk::TreeViewColumn *col = tree_view->get_column (i);
+            THROW_IF_FAIL (col);
+            col->add_attribute (*col->get_first_cell (),
+                                "foreground-rgba",
+                                get_columns ().fg_color);
+        }
+        tree_view->set_headers_visible (true);
+        tree_view->set_tooltip_text
+            (_("Activate a thread to select it"));
+        Gtk::ScrolledWindow *scr = Gtk::manage (new Gtk::ScrolledWindow);
+        scr->set_policy (Gtk::POLICY_AUTOMATIC, Gtk::POLICY_AUTOMATIC);
+        scr->set_shadow_type (Gtk::SHADOW_IN);
+        scr->add (*tree_view);
+
+        graph_area.reset (new Gtk::DrawingArea);
+        graph_area->set_has_tooltip (true);
+        graph_area->add_events (Gdk::BUTTON_PRESS_MASK);
+        graph_area->set_size_request (200, 200);
+
+        Gtk::Paned *paned =
+            Gtk::manage (new Gtk::Paned (Gtk::ORIENTATION_HORIZONTAL));
+        paned->pack1 (*scr, true, true);
+        paned->pack2 (*graph_area, true, true);
+
+        vbox.reset (new Gtk::Box (Gtk::ORIENTATION_VERTICAL));
+        vbox->pack_start (*summary_label, Gtk::PACK_SHRINK);
+        vbox->pack_start (*paned);
+        vbox->show_all ();
+    }
+
+    void connect_to_debugger_signals ()
+    {
+        THROW_IF_FAIL (debugger);
+        debugger->stopped_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_debugger_stopped_signal));
+    }
+
+    void connect_to_widget_signals ()
+    {
+        tree_view->signal_row_activated ().connect
+            (sigc::mem_fun (*this, &Priv::on_row_activated_signal));
+        tree_view->signal_draw ().connect_notify
+            (sigc::mem_fun (*this, &Priv::on_draw_signal));
+        graph_area->signal_draw ().connect
+            (sigc::mem_fun (*this, &Priv::on_graph_draw_signal));
+        graph_area->signal_query_tooltip ().connect
+            (sigc::mem_fun (*this, &Priv::on_graph_query_tooltip_signal));
+        graph_area->signal_button_press_event ().connect
+            (sigc::mem_fun (*this, &Priv::on_graph_button_press_signal));
+    }
+
+    bool should_process_now ()
+    {
+        THROW_IF_FAIL (tree_view);
+        return tree_view->get_is_drawable ();
+    }
+
+    void clear ()
+    {
+        collector.cancel ();
+        graph.clear ();
+        nodes.clear ();
+        tree_store->clear ();
+        summary_label->set_text ("");
+        graph_area->queue_draw ();
+    }
+
+    void refresh ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        collector.collect (sigc::mem_fun (*this, &Priv::on_graph_collected));
+    }
+
+    Gdk::RGBA row_color (bool a_in_cycle)
+    {
+        if (a_in_cycle)
+            return Gdk::RGBA ("red");
+        return tree_view->get_style_context ()->get_color
+                                                    (Gtk::STATE_FLAG_NORMAL);
+    }
+
+    const LockWaitGraph::Wait* find_wait (int a_thread_id) const
+    {
+        for (std::vector<LockWaitGraph::Wait>::const_iterator it =
+                 graph.waits ().begin ();
+             it != graph.waits ().end ();
+             ++it)
+            if (it->thread_id == a_thread_id)
+                return &*it;
+        return 0;
+    }
+
+    void fill_tree ()
+    {
+        const LockWaitColumns &cols = get_columns ();
+        tree_store->clear ();
+        for (std::vector<LockWaitGraph::Lock>::const_iterator it =
+                 graph.locks ().begin ();
+             it != graph.locks ().end ();
+             ++it) {
+            Gtk::TreeModel::iterator lock_row = tree_store->append ();
+            (*lock_row)[cols.object] = lock_to_string (it->kind, it->address);
+            (*lock_row)[cols.nb_waiters] = it->waiters.size ();
+            (*lock_row)[cols.thread_id] = it->owner_thread_id;
+            (*lock_row)[cols.fg_color] = row_color (it->in_cycle);
+            if (it->owner_thread_id)
+                (*lock_row)[cols.details] =
+                    _("held by ") + thread_to_string (it->owner_thread_id);
+
+            for (std::vector<int>::const_iterator w = it->waiters.begin ();
+                 w != it->waiters.end ();
+                 ++w) {
+                Gtk::TreeModel::iterator row =
+                    tree_store->append (lock_row->children ());
+                (*row)[cols.object] = thread_to_string (*w);
+                (*row)[cols.thread_id] = *w;
+                (*row)[cols.fg_color] = row_color (graph.is_in_cycle (*w));
+                const LockWaitGraph::Wait *wait = find_wait (*w);
+                if (wait)
+                    (*row)[cols.details] = frame_location (wait->caller);
+            }
+        }
+        tree_view->expand_all ();
+    }
+
+    void on_graph_collected (const LockWaitGraph &a_graph)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        graph = a_graph;
+        fill_tree ();
+
+        UString summary;
+        if (graph.waits ().empty ())
+            summary = _("No thread is blocked on a lock");
+        else if (graph.nb_threads_in_cycles ())
+            summary.printf (_("%d threads blocked on %d locks, "
+                              "%d of them deadlocked"),
+                            (int) graph.waits ().size (),
+                            (int) graph.locks ().size (),
+                            (int) graph.nb_threads_in_cycles ());
+        else
+            summary.printf (_("%d threads blocked on %d locks"),
+                            (int) graph.waits ().size (),
+                            (int) graph.locks ().size ());
+        summary_label->set_text (summary);
+        graph_area->queue_draw ();
+
+        NEMIVER_CATCH
+    }
+
+    /// Place the threads involved in a wait on a circle, waiters
+    /// next to the threads they wait for.
+    void layout_nodes (double a_width, double a_height)
+    {
+        std::vector<int> thread_ids;
+        std::set<int> seen;
+        for (std::vector<LockWaitGraph::Lock>::const_iterator it =
+                 graph.locks ().begin ();
+             it != graph.locks ().end ();
+             ++it) {
+            if (it->owner_thread_id && seen.insert (it->owner_thread_id).second)
+                thread_ids.push_back (it->owner_thread_id);
+            for (std::vector<int>::const_iterator w = it->waiters.begin ();
+                 w != it->waiters.end ();
+                 ++w)
+                if (seen.insert (*w).second)
+                    thread_ids.push_back (*w);
+        }
+
+        nodes.clear ();
+        double radius = std::min (a_width, a_height) / 2
+                        - 2 * LOCK_WAIT_NODE_RADIUS;
+        for (size_t i = 0; i < thread_ids.size (); ++i) {
+            double angle = 2 * M_PI * i / thread_ids.size () - M_PI / 2;
+            ThreadNode node = {thread_ids[i],
+                               a_width / 2,
+                               a_height / 2};
+            if (thread_ids.size () > 1) {
+                node.x += radius * cos (angle);
+                node.y += radius * sin (angle);
+            }
+            nodes.push_back (node);
+        }
+    }
+
+    const ThreadNode* find_node (int a_thread_id) const
+    {
+        for (std::vector<ThreadNode>::const_iterator it = nodes.begin ();
+             it != nodes.end ();
+             ++it)
+            if (it->thread_id == a_thread_id)
+                return &*it;
+        return 0;
+    }
+
+    const ThreadNode* node_at (double a_x, double a_y) const
+    {
+        for (std::vector<ThreadNode>::const_iterator it = nodes.begin ();
+             it != nodes.end ();
+             ++it)
+            if (hypot (a_x - it->x, a_y - it->y) <= LOCK_WAIT_NODE_RADIUS)
+                return &*it;
+        return 0;
+    }
+
+    void draw_edge (const Cairo::RefPtr<Cairo::Context> &a_cr,
+                    const ThreadNode &a_from,
+                    const ThreadNode &a_to)
+    {
+        if (&a_from == &a_to) {
+            // A thread waiting for itself.
+            a_cr->arc (a_from.x, a_from.y - LOCK_WAIT_NODE_RADIUS,
+                       LOCK_WAIT_NODE_RADIUS * 0.7, 0, 2 * M_PI);
+            a_cr->stroke ();
+            return;
+        }
+        double dx = a_to.x - a_from.x, dy = a_to.y - a_from.y;
+        double length = hypot (dx, dy);
+        if (length <= 2 * LOCK_WAIT_NODE_RADIUS)
+            return;
+        dx /= length;
+        dy /= length;
+        double x0 = a_from.x + dx * LOCK_WAIT_NODE_RADIUS;
+        double y0 = a_from.y + dy * LOCK_WAIT_NODE_RADIUS;
+        double x1 = a_to.x - dx * LOCK_WAIT_NODE_RADIUS;
+        double y1 = a_to.y - dy * LOCK_WAIT_NODE_RADIUS;
+        a_cr->move_to (x0, y0);
+        a_cr->line_to (x1, y1);
+        a_cr->stroke ();
+        // The arrow head.
+        double size = LOCK_WAIT_NODE_RADIUS / 2;
+        a_cr->move_to (x1, y1);
+        a_cr->line_to (x1 - size * (dx - dy / 2), y1 - size * (dy + dx / 2));
+        a_cr->line_to (x1 - size * (dx + dy / 2), y1 - size * (dy - dx / 2));
+        a_cr->close_path ();
+        a_cr->fill ();
+    }
+
+    bool on_graph_draw_signal (const Cairo::RefPtr<Cairo::Context> &a_cr)
+    {
+        NEMIVER_TRY
+
+        if (!is_up2date) {
+            is_up2date = true;
+            refresh ();
+        }
+
+        layout_nodes (graph_area->get_allocated_width (),
+                      graph_area->get_allocated_height ());
+        if (nodes.empty ())
+            return false;
+
+        // An edge goes from each waiter to the thread it waits for.
+        a_cr->set_line_width (2);
+        for (std::vector<ThreadNode>::const_iterator it = nodes.begin ();
+             it != nodes.end ();
+             ++it) {
+            const ThreadNode *to =
+                find_node (graph.waited_thread (it->thread_id));
+            if (!to)
+                continue;
+            if (graph.is_in_cycle (it->thread_id))
+                a_cr->set_source_rgb (0.8, 0, 0);
+            else
+                a_cr->set_source_rgb (0.5, 0.5, 0.5);
+            draw_edge (a_cr, *it, *to);
+        }
+
+        // Deadlocked threads are red, other blocked threads orange,
+        // and the threads that only hold locks blue.
+        a_cr->set_font_size (LOCK_WAIT_NODE_RADIUS * 0.8);
+        for (std::vector<ThreadNode>::const_iterator it = nodes.begin ();
+             it != nodes.end ();
+             ++it) {
+            if (graph.is_in_cycle (it->thread_id))
+                a_cr->set_source_rgb (0.9, 0.2, 0.2);
+            else if (find_wait (it->thread_id))
+                a_cr->set_source_rgb (1, 0.65, 0.2);
+            else
+                a_cr->set_source_rgb (0.5, 0.7, 1);
+            a_cr->arc (it->x, it->y, LOCK_WAIT_NODE_RADIUS, 0, 2 * M_PI);
+            a_cr->fill ();
+
+            string label = UString::from_int (it->thread_id).raw ();
+            Cairo::TextExtents extents;
+            a_cr->get_text_extents (label, extents);
+            a_cr->set_source_rgb (0, 0, 0);
+            a_cr->move_to (it->x - extents.width / 2 - extents.x_bearing,
+                           it->y - extents.height / 2 - extents.y_bearing);
+            a_cr->show_text (label);
+        }
+
+        NEMIVER_CATCH
+        return true;
+    }
+
+    bool on_graph_query_tooltip_signal
+                            (int a_x, int a_y, bool,
+                             const Glib::RefPtr<Gtk::Tooltip> &a_tooltip)
+    {
+        NEMIVER_TRY
+
+        const ThreadNode *node = node_at (a_x, a_y);
+        if (!node)
+            return false;
+        UString text = thread_to_string (node->thread_id);
+        const LockWaitGraph::Wait *wait = find_wait (node->thread_id);
+        if (wait) {
+            text += "\n";
+            text += _("waits on ")
+                    + lock_to_string (wait->kind, wait->address);
+            text += "\n";
+            text += _("in ") + frame_location (wait->caller);
+            int owner = graph.waited_thread (node->thread_id);
+            if (owner) {
+                text += "\n";
+                text += _("held by ") + thread_to_string (owner);
+            }
+        }
+        a_tooltip->set_text (text);
+        return true;
+
+        NEMIVER_CATCH
+        return false;
+    }
+
+    bool on_graph_button_press_signal (GdkEventButton *a_event)
+    {
+        NEMIVER_TRY
+
+        if (a_event->type != GDK_2BUTTON_PRESS)
+            return false;
+        const ThreadNode *node = node_at (a_event->x, a_event->y);
+        if (!node)
+            return false;
+        THROW_IF_FAIL (debugger);
+        debugger->select_thread (node->thread_id);
+        return true;
+
+        NEMIVER_CATCH
+        return false;
+    }
+
+    void on_debugger_stopped_signal (IDebugger::StopReason a_reason,
+                                     bool /*a_has_frame*/,
+                                     const IDebugger::Frame &/*a_frame*/,
+                                     int /*a_thread_id*/,
+                                     const string &/*a_bp_num*/,
+                                     const UString &/*a_cookie*/)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (IDebugger::is_exited (a_reason)) {
+            clear ();
+            return;
+        }
+
+        if (should_process_now ())
+            refresh ();
+        else
+            is_up2date = false;
+
+        NEMIVER_CATCH
+    }
+
+    void on_row_activated_signal (const Gtk::TreeModel::Path &a_path,
+                                  Gtk::TreeViewColumn */*a_col*/)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        Gtk::TreeModel::iterator it = tree_store->get_iter (a_path);
+        if (!it)
+            return;
+        int thread_id = (*it)[get_columns ().thread_id];
+        if (thread_id <= 0)
+            return;
+        THROW_IF_FAIL (debugger);
+        debugger->select_thread (thread_id);
+
+        NEMIVER_CATCH
+    }
+
+    void on_draw_signal (const Cairo::RefPtr<Cairo::Context> &)
+    {
+        NEMIVER_TRY
+
+        if (!is_up2date) {
+            is_up2date = true;
+            refresh ();
+        }
+
+        NEMIVER_CATCH
+    }
+};//end struct LockWaitView::Priv
+
+LockWaitView::LockWaitView (IDebuggerSafePtr &a_debugger)
+{
+    m_priv.reset (new Priv (a_debugger));
+}
+
+LockWaitView::~LockWaitView ()
+{
+}
+
+Gtk::Widget&
+LockWaitView::widget () const
+{
+    THROW_IF_FAIL (m_priv && m_priv->vbox);
+    return *m_priv->vbox;
+}
+
+void
+LockWaitView::clear ()
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->clear ();
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,63 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_LOCK_WAIT_VIEW_H__
+#define __NMV_LOCK_WAIT_VIEW_H__
+
+#include <gtkmm/widget.h>
+#include "common/nmv-object.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "nmv-i-debugger.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// A view that shows which threads of the stopped inferior are
+/// blocked on which locks, and who holds these locks.
+///
+/// Each time the inferior stops, the threads blocked in a mutex, a
+/// condition variable, a futex and the like are found from their
+/// stacks.  The locks they wait on are listed, the most contended
+/// first, and the wait-for graph of the threads is drawn.  Threads
+/// and locks that are part of a cycle of that graph, i.e that are
+/// deadlocked, are shown in red.  Activating a thread selects it in
+/// the debugger.
+class NEMIVER_API LockWaitView : public nemiver::common::Object {
+    //non copyable
+    LockWaitView (const LockWaitView&);
+    LockWaitView& operator= (const LockWaitView&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+public:
+
+    LockWaitView (IDebuggerSafePtr &a_debugger);
+    virtual ~LockWaitView ();
+    Gtk::Widget& widget () const;
+    void clear ();
+};//end LockWaitView
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_LOCK_WAIT_VIEW_H__
@@ -38,6 +38,8 @@
 
 namespace nemiver {
 
+static const char *COOKIE_MEMORY_VIEW_READ = "cookie-memory-view-read";
+
 class GroupingComboBox : public Gtk::ComboBox
 {
     public:
@@ -190,7 +192,8 @@ public:
         if (validate_address (addr)) {
             LOG_DD ("Fetching " << editor_cpl * editor_lines << " bytes");
             // read as much memory as will fill the hex editor widget
-            m_debugger->read_memory (addr, editor_cpl * editor_lines);
+            m_debugger->read_memory (addr, editor_cpl * editor_lines,
+                                     COOKIE_MEMORY_VIEW_READ);
         }
         NEMIVER_CATCH
     }
@@ -253,9 +256,12 @@ public:
 
     void on_memory_read_response (size_t a_addr,
                                   const std::vector<uint8_t> &a_values,
-                                  const UString& /*a_cookie*/)
+                                  const UString& a_cookie)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
+        // Other views (e.g. the array view) read memory too.
+        if (a_cookie != COOKIE_MEMORY_VIEW_READ)
+            return;
         NEMIVER_TRY
         THROW_IF_FAIL (m_address_entry);
         ostringstream addr;
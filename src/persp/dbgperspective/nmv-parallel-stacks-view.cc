@@ -0,0 +1,442 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <glib/gi18n.h>
+#include <gtkmm/box.h>
+#include <gtkmm/label.h>
+#include <gtkmm/scrolledwindow.h>
+#include <gtkmm/treestore.h>
+#include <gtkmm/treeview.h>
+#include "common/nmv-exception.h"
+#include "nmv-parallel-stacks-view.h"
+#include "nmv-ui-utils.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+static const char *COOKIE_PARALLEL_STACKS_THREADS =
+                                    "cookie-parallel-stacks-threads";
+
+/// Maximum number of frames fetched per thread.  Deeper stacks are
+/// truncated; their innermost frames are what tells threads apart
+/// anyway.
+static const int PARALLEL_STACKS_MAX_DEPTH = 64;
+
+/// Maximum number of thread rows shown under a group of threads.
+static const size_t PARALLEL_STACKS_MAX_THREAD_ROWS = 256;
+
+struct ParallelStacksColumns : public Gtk::TreeModelColumnRecord {
+    /// Number of threads of a group, or zero for the other rows.
+    Gtk::TreeModelColumn<int> nb_threads;
+    Gtk::TreeModelColumn<Glib::ustring> location;
+    Gtk::TreeModelColumn<Glib::ustring> details;
+    /// The thread a row designates, or zero if it doesn't designate
+    /// a thread.
+    Gtk::TreeModelColumn<int> thread_id;
+
+    ParallelStacksColumns ()
+    {
+        add (nb_threads);
+        add (location);
+        add (details);
+        add (thread_id);
+    }
+};//end ParallelStacksColumns
+
+static ParallelStacksColumns&
+get_columns ()
+{
+    static ParallelStacksColumns s_cols;
+    return s_cols;
+}
+
+/// What identifies a frame when comparing two stacks: the interned
+/// name of its function, or its address when there is no function
+/// name (e.g, in a stripped library).
+typedef std::pair<StringPool::Id, size_t> FrameKey;
+typedef std::vector<FrameKey> StackSignature;
+
+static StackSignature
+stack_signature (const vector<IDebugger::Frame> &a_frames)
+{
+    StackSignature result;
+    result.reserve (a_frames.size ());
+    for (vector<IDebugger::Frame>::const_iterator it = a_frames.begin ();
+         it != a_frames.end ();
+         ++it) {
+        if (it->function_name_id ())
+            result.push_back (FrameKey (it->function_name_id (), 0));
+        else
+            result.push_back (FrameKey (0, it->pc ()));
+    }
+    return result;
+}
+
+/// Format the location of a frame, e.g "main at foo.cc:42".
+static UString
+frame_location (const IDebugger::Frame &a_frame)
+{
+    UString result = a_frame.function_name ().empty ()
+        ? UString (a_frame.address ().to_string ())
+        : UString (a_frame.function_name ());
+    if (!a_frame.file_name ().empty ()) {
+        result += " at " + a_frame.file_name ();
+        if (a_frame.line ())
+            result += ":" + UString::from_int (a_frame.line ());
+    } else if (!a_frame.library ().empty ()) {
+        result += " from " + UString (a_frame.library ());
+    }
+    return result;
+}
+
+/// A set of threads which stacks are identical.
+struct StackGroup {
+    /// The frames of the first thread of the group.  They are
+    /// representative of the frames of all the threads of the group.
+    vector<IDebugger::Frame> frames;
+    list<int> thread_ids;
+};//end StackGroup
+
+static bool
+group_is_bigger (const StackGroup *a_l, const StackGroup *a_r)
+{
+    if (a_l->thread_ids.size () != a_r->thread_ids.size ())
+        return a_l->thread_ids.size () > a_r->thread_ids.size ();
+    return a_l->thread_ids.front () < a_r->thread_ids.front ();
+}
+
+struct ParallelStacksView::Priv {
+    IDebuggerSafePtr debugger;
+    SafePtr<Gtk::Box> vbox;
+    SafePtr<Gtk::Label> summary_label;
+    SafePtr<Gtk::TreeView> tree_view;
+    Glib::RefPtr<Gtk::TreeStore> tree_store;
+
+    // Incremented at each stop.  Stacks fetched before the last stop
+    // are stale and are dropped.
+    unsigned generation;
+    bool is_up2date;
+
+    Priv (IDebuggerSafePtr &a_debugger) :
+        debugger (a_debugger),
+        generation (0),
+        is_up2date (true)
+    {
+        build_widget ();
+        connect_to_debugger_signals ();
+        connect_to_widget_signals ();
+    }
+
+    void build_widget ()
+    {
+        summary_label.reset (new Gtk::Label);
+        summary_label->set_alignment (0, 0.5);
+        summary_label->set_padding (3, 3);
+
+        tree_store = Gtk::TreeStore::create (get_columns ());
+        tree_view.reset (new Gtk::TreeView (tree_store));
+        tree_view->append_column (_("Threads"), get_columns ().nb_threads);
+        tree_view->append_column (_("Location"), get_columns ().location);
+        tree_view->append_column (_("Details"), get_columns ().details);
+        tree_view->set_headers_visible (true);
+        tree_view->set_tooltip_text
+            (_("Activate a thread to select it"));
+        Gtk::ScrolledWindow *scr = Gtk::manage (new Gtk::ScrolledWindow);
+        scr->set_policy (Gtk::POLICY_AUTOMATIC, Gtk::POLICY_AUTOMATIC);
+        scr->set_shadow_type (Gtk::SHADOW_IN);
+        scr->add (*tree_view);
+
+        vbox.reset (new Gtk::Box (Gtk::ORIENTATION_VERTICAL));
+        vbox->pack_start (*summary_label, Gtk::PACK_SHRINK);
+        vbox->pack_start (*scr);
+        vbox->show_all ();
+    }
+
+    void connect_to_debugger_signals ()
+    {
+        THROW_IF_FAIL (debugger);
+        debugger->stopped_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_debugger_stopped_signal));
+        debugger->threads_info_listed_signal ().connect
+            (sigc::mem_fun (*this,
+                            &Priv::on_debugger_threads_info_listed_signal));
+    }
+
+    void connect_to_widget_signals ()
+    {
+        tree_view->signal_row_activated ().connect
+            (sigc::mem_fun (*this, &Priv::on_row_activated_signal));
+        tree_view->signal_draw ().connect_notify
+            (sigc::mem_fun (*this, &Priv::on_draw_signal));
+    }
+
+    bool should_process_now ()
+    {
+        THROW_IF_FAIL (tree_view);
+        return tree_view->get_is_drawable ();
+    }
+
+    void clear ()
+    {
+        ++generation;
+        tree_store->clear ();
+        summary_label->set_text ("");
+    }
+
+    /// Start fetching the stacks of all the threads.  This first
+    /// lists the threads; their stacks are requested when the list
+    /// comes back.
+    void refresh ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        THROW_IF_FAIL (debugger);
+        ++generation;
+        debugger->list_threads_info (COOKIE_PARALLEL_STACKS_THREADS);
+    }
+
+    void set_stacks (const map<int, vector<IDebugger::Frame> > &a_stacks)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        typedef std::map<StackSignature, StackGroup> GroupMap;
+        GroupMap groups;
+        for (map<int, vector<IDebugger::Frame> >::const_iterator it =
+                 a_stacks.begin ();
+             it != a_stacks.end ();
+             ++it) {
+            StackGroup &group = groups[stack_signature (it->second)];
+            if (group.thread_ids.empty ())
+                group.frames = it->second;
+            group.thread_ids.push_back (it->first);
+        }
+
+        std::vector<const StackGroup*> sorted;
+        sorted.reserve (groups.size ());
+        for (GroupMap::const_iterator it = groups.begin ();
+             it != groups.end ();
+             ++it)
+            sorted.push_back (&it->second);
+        std::sort (sorted.begin (), sorted.end (), group_is_bigger);
+
+        tree_store->clear ();
+        for (std::vector<const StackGroup*>::const_iterator it =
+                 sorted.begin ();
+             it != sorted.end ();
+             ++it)
+            append_group (**it);
+
+        UString summary;
+        summary.printf (_("%d threads in %d distinct stacks"),
+                        (int) a_stacks.size (), (int) groups.size ());
+        summary_label->set_text (summary);
+    }
+
+    void append_group (const StackGroup &a_group)
+    {
+        const ParallelStacksColumns &cols = get_columns ();
+        Gtk::TreeModel::iterator group_it = tree_store->append ();
+        (*group_it)[cols.nb_threads] = a_group.thread_ids.size ();
+        (*group_it)[cols.location] = a_group.frames.empty ()
+            ? UString (_("<no frames>"))
+            : frame_location (a_group.frames.front ());
+        (*group_it)[cols.thread_id] =
+            a_group.thread_ids.size () == 1 ? a_group.thread_ids.front () : 0;
+
+        UString ids;
+        size_t i = 0;
+        for (list<int>::const_iterator it = a_group.thread_ids.begin ();
+             it != a_group.thread_ids.end ();
+             ++it, ++i) {
+            if (i == PARALLEL_STACKS_MAX_THREAD_ROWS) {
+                ids += ", ...";
+                break;
+            }
+            if (!ids.empty ())
+                ids += ", ";
+            ids += UString::from_int (*it);
+        }
+        (*group_it)[cols.details] = ids;
+
+        for (vector<IDebugger::Frame>::const_iterator it =
+                 a_group.frames.begin ();
+             it != a_group.frames.end ();
+             ++it) {
+            Gtk::TreeModel::iterator row =
+                tree_store->append (group_it->children ());
+            (*row)[cols.location] = frame_location (*it);
+            (*row)[cols.details] = "#" + UString::from_int (it->level ());
+            (*row)[cols.thread_id] = 0;
+        }
+        if ((int) a_group.frames.size () == PARALLEL_STACKS_MAX_DEPTH) {
+            Gtk::TreeModel::iterator row =
+                tree_store->append (group_it->children ());
+            (*row)[cols.location] = _("...");
+            (*row)[cols.thread_id] = 0;
+        }
+
+        if (a_group.thread_ids.size () < 2)
+            return;
+
+        i = 0;
+        for (list<int>::const_iterator it = a_group.thread_ids.begin ();
+             it != a_group.thread_ids.end ()
+                 && i < PARALLEL_STACKS_MAX_THREAD_ROWS;
+             ++it, ++i) {
+            Gtk::TreeModel::iterator row =
+                tree_store->append (group_it->children ());
+            (*row)[cols.location] = _("Thread ") + UString::from_int (*it);
+            (*row)[cols.thread_id] = *it;
+        }
+    }
+
+    void on_threads_frames_listed (const map<int,
+                                             vector<IDebugger::Frame> > &a_stacks,
+                                   unsigned a_generation)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (a_generation != generation) {
+            LOG_DD ("dropping stale stacks");
+            return;
+        }
+        set_stacks (a_stacks);
+
+        NEMIVER_CATCH
+    }
+
+    void on_debugger_threads_info_listed_signal
+                        (const vector<IDebugger::ThreadInfo> &a_threads,
+                         int /*a_current_thread_id*/,
+                         const UString &a_cookie)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (a_cookie != COOKIE_PARALLEL_STACKS_THREADS)
+            return;
+
+        list<int> thread_ids;
+        for (vector<IDebugger::ThreadInfo>::const_iterator it =
+                 a_threads.begin ();
+             it != a_threads.end ();
+             ++it) {
+            // Running threads have no stack to show.
+            if (!it->is_running ())
+                thread_ids.push_back (it->id ());
+        }
+        debugger->list_threads_frames
+            (thread_ids, PARALLEL_STACKS_MAX_DEPTH,
+             sigc::bind (sigc::mem_fun (*this,
+                                        &Priv::on_threads_frames_listed),
+                         generation));
+
+        NEMIVER_CATCH
+    }
+
+    void on_debugger_stopped_signal (IDebugger::StopReason a_reason,
+                                     bool /*a_has_frame*/,
+                                     const IDebugger::Frame &/*a_frame*/,
+                                     int /*a_thread_id*/,
+                                     const string &/*a_bp_num*/,
+                                     const UString &/*a_cookie*/)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (IDebugger::is_exited (a_reason)) {
+            clear ();
+            return;
+        }
+
+        if (should_process_now ())
+            refresh ();
+        else
+            is_up2date = false;
+
+        NEMIVER_CATCH
+    }
+
+    void on_row_activated_signal (const Gtk::TreeModel::Path &a_path,
+                                  Gtk::TreeViewColumn */*a_col*/)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        Gtk::TreeModel::iterator it = tree_store->get_iter (a_path);
+        if (!it)
+            return;
+        int thread_id = (*it)[get_columns ().thread_id];
+        if (thread_id <= 0)
+            return;
+        THROW_IF_FAIL (debugger);
+        debugger->select_thread (thread_id);
+
+        NEMIVER_CATCH
+    }
+
+    void on_draw_signal (const Cairo::RefPtr<Cairo::Context> &)
+    {
+        NEMIVER_TRY
+
+        if (!is_up2date) {
+            is_up2date = true;
+            refresh ();
+        }
+
+        NEMIVER_CATCH
+    }
+};//end struct ParallelStacksView::Priv
+
+ParallelStacksView::ParallelStacksView (IDebuggerSafePtr &a_debugger)
+{
+    m_priv.reset (new Priv (a_debugger));
+}
+
+ParallelStacksView::~ParallelStacksView ()
+{
+}
+
+Gtk::Widget&
+ParallelStacksView::widget () const
+{
+    THROW_IF_FAIL (m_priv && m_priv->vbox);
+    return *m_priv->vbox;
+}
+
+void
+ParallelStacksView::clear ()
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->clear ();
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,62 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_PARALLEL_STACKS_VIEW_H__
+#define __NMV_PARALLEL_STACKS_VIEW_H__
+
+#include <gtkmm/widget.h>
+#include "common/nmv-object.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "nmv-i-debugger.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// A view that shows the call stacks of all the threads of the
+/// inferior at once.
+///
+/// Each time the inferior stops, the backtraces of all the threads
+/// are fetched in one batch, with a bounded depth.  Threads which
+/// stacks are identical are then grouped together, pstack style, so
+/// that a thousand workers blocked in the same place show up as a
+/// single row.  Expanding a group shows its frames and its threads;
+/// activating a thread selects it in the debugger.
+class NEMIVER_API ParallelStacksView : public nemiver::common::Object {
+    //non copyable
+    ParallelStacksView (const ParallelStacksView&);
+    ParallelStacksView& operator= (const ParallelStacksView&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+public:
+
+    ParallelStacksView (IDebuggerSafePtr &a_debugger);
+    virtual ~ParallelStacksView ();
+    Gtk::Widget& widget () const;
+    void clear ();
+};//end ParallelStacksView
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_PARALLEL_STACKS_VIEW_H__
@@ -87,6 +87,7 @@ public:
     Gtk::CheckButton *show_lines_check_button;
     Gtk::CheckButton *launch_terminal_check_button;
     Gtk::CheckButton *highlight_source_check_button;
+    Gtk::CheckButton *show_inline_values_check_button;
     Gtk::RadioButton *always_reload_radio_button;
     Gtk::RadioButton *never_reload_radio_button;
     Gtk::RadioButton *confirm_reload_radio_button;
@@ -98,6 +99,7 @@ public:
     Gtk::SpinButton  *default_num_asm_instrs_spin_button;
     Gtk::FileChooserButton *gdb_binary_path_chooser_button;
     Gtk::CheckButton *pretty_printing_check_button;
+    Gtk::CheckButton *non_stop_mode_check_button;
     Glib::RefPtr<Gtk::Builder> gtkbuilder;
     SafePtr<LayoutSelector> layout_selector;
 
@@ -115,6 +117,7 @@ public:
         show_lines_check_button (0),
         launch_terminal_check_button (0),
         highlight_source_check_button (0),
+        show_inline_values_check_button (0),
         always_reload_radio_button (0),
         never_reload_radio_button (0),
         confirm_reload_radio_button (0),
@@ -126,6 +129,7 @@ public:
         default_num_asm_instrs_spin_button (0),
         gdb_binary_path_chooser_button (0),
         pretty_printing_check_button (0),
+        non_stop_mode_check_button (0),
         gtkbuilder (a_gtkbuilder)
     {
         init ();
@@ -201,6 +205,12 @@ public:
         update_highlight_source_keys ();
     }
 
+    void
+    on_show_inline_values_toggled_signal ()
+    {
+        update_show_inline_values_key ();
+    }
+
     void
     on_system_font_toggled_signal ()
     {
@@ -269,6 +279,12 @@ public:
         update_pretty_printing_key ();
     }
 
+    void
+    on_non_stop_mode_toggled_signal ()
+    {
+        update_non_stop_mode_key ();
+    }
+
     void
     init ()
     {
@@ -339,6 +355,15 @@ public:
             (*this,
              &PreferencesDialog::Priv::on_highlight_source_toggled_signal));
 
+        show_inline_values_check_button  =
+            ui_utils::get_widget_from_gtkbuilder<Gtk::CheckButton>
+                                    (gtkbuilder, "showinlinevaluescheckbutton");
+        THROW_IF_FAIL (show_inline_values_check_button);
+        show_inline_values_check_button->signal_toggled ().connect
+        (sigc::mem_fun
+            (*this,
+             &PreferencesDialog::Priv::on_show_inline_values_toggled_signal));
+
         system_font_check_button =
             ui_utils::get_widget_from_gtkbuilder<Gtk::CheckButton>
             (gtkbuilder, "systemfontcheckbutton");
@@ -505,6 +530,16 @@ public:
              (*this,
               &PreferencesDialog::Priv::on_pretty_printing_toggled_signal));
 
+        non_stop_mode_check_button =
+            ui_utils::get_widget_from_gtkbuilder<Gtk::CheckButton>
+            (gtkbuilder,
+             "nonstopmodecheckbutton");
+        THROW_IF_FAIL (non_stop_mode_check_button);
+        non_stop_mode_check_button->signal_toggled ().connect
+            (sigc::mem_fun
+             (*this,
+              &PreferencesDialog::Priv::on_non_stop_mode_toggled_signal));
+
 
         // *************************************
         // Handle the "Layout" preferences tab
@@ -599,6 +634,14 @@ public:
                      is_on);
     }
 
+    void
+    update_show_inline_values_key ()
+    {
+        THROW_IF_FAIL (show_inline_values_check_button);
+        bool is_on = show_inline_values_check_button->get_active ();
+        conf_manager ().set_key_value (CONF_KEY_SHOW_INLINE_VALUES, is_on);
+    }
+
     void
     update_widget_from_source_dirs_key ()
     {
@@ -749,12 +792,22 @@ public:
         conf_manager ().set_key_value (CONF_KEY_PRETTY_PRINTING, is_on);
     }
 
+    void
+    update_non_stop_mode_key ()
+    {
+        THROW_IF_FAIL (non_stop_mode_check_button);
+
+        bool is_on = non_stop_mode_check_button->get_active ();
+        conf_manager ().set_key_value (CONF_KEY_NON_STOP_MODE, is_on);
+    }
+
     void
     update_widget_from_editor_keys ()
     {
         THROW_IF_FAIL (show_lines_check_button);
         THROW_IF_FAIL (launch_terminal_check_button);
         THROW_IF_FAIL (highlight_source_check_button);
+        THROW_IF_FAIL (show_inline_values_check_button);
         THROW_IF_FAIL (system_font_check_button);
         THROW_IF_FAIL (custom_font_button);
         THROW_IF_FAIL (custom_font_box);
@@ -785,6 +838,14 @@ public:
             highlight_source_check_button->set_active (is_on);
         }
 
+        is_on = true;
+        if (!conf_manager ().get_key_value
+                (CONF_KEY_SHOW_INLINE_VALUES, is_on)) {
+            LOG_ERROR ("failed to get conf key");
+        } else {
+            show_inline_values_check_button->set_active (is_on);
+        }
+
         is_on = true;
         if (!conf_manager ().get_key_value
                 (CONF_KEY_USE_SYSTEM_FONT, is_on)) {
@@ -906,6 +967,14 @@ public:
                        << CONF_KEY_PRETTY_PRINTING);
         }
         pretty_printing_check_button->set_active (is_on);
+
+        is_on = false;
+        if (!conf_manager ().get_key_value (CONF_KEY_NON_STOP_MODE,
+                                            is_on)) {
+            LOG_ERROR ("failed to get conf key "
+                       << CONF_KEY_NON_STOP_MODE);
+        }
+        non_stop_mode_check_button->set_active (is_on);
     }
 
     void
@@ -0,0 +1,636 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <algorithm>
+#include <glib/gi18n.h>
+#include <glibmm/main.h>
+#include <glibmm/timer.h>
+#include <gtkmm/box.h>
+#include <gtkmm/button.h>
+#include <gtkmm/comboboxtext.h>
+#include <gtkmm/drawingarea.h>
+#include <gtkmm/label.h>
+#include <gtkmm/notebook.h>
+#include <gtkmm/scrolledwindow.h>
+#include <gtkmm/spinbutton.h>
+#include <gtkmm/togglebutton.h>
+#include <gtkmm/tooltip.h>
+#include <gtkmm/treestore.h>
+#include <gtkmm/treeview.h>
+#include "common/nmv-exception.h"
+#include "nmv-stack-profile.h"
+#include "nmv-profiler-view.h"
+#include "nmv-ui-utils.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// Maximum number of frames sampled per thread.
+static const int PROFILER_MAX_DEPTH = 128;
+
+/// Default number of samples per second.
+static const int PROFILER_DEFAULT_RATE = 20;
+
+/// How often the call tree and the flame graph are rebuilt while
+/// sampling, in milliseconds.
+static const unsigned PROFILER_REFRESH_PERIOD = 1000;
+
+/// Height of a row of the flame graph, in pixels.
+static const double FLAME_GRAPH_ROW_HEIGHT = 18;
+
+/// Functions narrower than this, in pixels, are not drawn in the
+/// flame graph.
+static const double FLAME_GRAPH_MIN_WIDTH = 1;
+
+struct ProfilerColumns : public Gtk::TreeModelColumnRecord {
+    Gtk::TreeModelColumn<Glib::ustring> function;
+    Gtk::TreeModelColumn<Glib::ustring> total;
+    Gtk::TreeModelColumn<Glib::ustring> self;
+    Gtk::TreeModelColumn<unsigned> nb_samples;
+
+    ProfilerColumns ()
+    {
+        add (function);
+        add (total);
+        add (self);
+        add (nb_samples);
+    }
+};//end ProfilerColumns
+
+static ProfilerColumns&
+get_columns ()
+{
+    static ProfilerColumns s_cols;
+    return s_cols;
+}
+
+static UString
+percentage (unsigned a_part, unsigned a_total)
+{
+    UString result;
+    result.printf ("%.1f %%", a_total ? 100.0 * a_part / a_total : 0.0);
+    return result;
+}
+
+static unsigned
+call_tree_depth (const StackProfile::Node &a_node)
+{
+    unsigned depth = 0;
+    std::vector<StackProfile::Node>::const_iterator it;
+    for (it = a_node.children.begin (); it != a_node.children.end (); ++it)
+        depth = std::max (depth, call_tree_depth (*it));
+    return depth + 1;
+}
+
+struct ProfilerView::Priv {
+    IDebuggerSafePtr debugger;
+    SafePtr<Gtk::Box> vbox;
+    SafePtr<Gtk::ToggleButton> sample_button;
+    SafePtr<Gtk::SpinButton> rate_spin;
+    SafePtr<Gtk::ComboBoxText> thread_combo;
+    SafePtr<Gtk::Button> clear_button;
+    SafePtr<Gtk::Label> stats_label;
+    SafePtr<Gtk::TreeView> tree_view;
+    Glib::RefPtr<Gtk::TreeStore> tree_store;
+    SafePtr<Gtk::DrawingArea> flame_graph;
+    sigc::connection thread_combo_connection;
+    sigc::connection sampling_connection;
+    sigc::connection refresh_connection;
+
+    StackProfile profile;
+    StackProfile::Node call_tree;
+    // The threads listed in thread_combo.
+    std::vector<int> thread_ids;
+
+    // The boxes of the flame graph, as last drawn.  They are used to
+    // find the function under the mouse pointer.
+    struct FlameBox {
+        double x;
+        double y;
+        double width;
+        const StackProfile::Node *node;
+    };
+    std::vector<FlameBox> flame_boxes;
+
+    bool inferior_is_running;
+    bool sample_in_flight;
+    bool needs_refresh;
+
+    // Measures the time during which sampling was on and the
+    // inferior was running, and the time the inferior spent
+    // interrupted to be sampled.
+    Glib::Timer active_timer;
+    bool active_timer_is_on;
+    double active_time;
+    Glib::Timer sample_timer;
+    double sampled_time;
+
+    Priv (IDebuggerSafePtr &a_debugger) :
+        debugger (a_debugger),
+        inferior_is_running (false),
+        sample_in_flight (false),
+        needs_refresh (false),
+        active_timer_is_on (false),
+        active_time (0),
+        sampled_time (0)
+    {
+        active_timer.stop ();
+        sample_timer.stop ();
+        build_widget ();
+        connect_to_debugger_signals ();
+        connect_to_widget_signals ();
+        update_stats ();
+    }
+
+    ~Priv ()
+    {
+        sampling_connection.disconnect ();
+        refresh_connection.disconnect ();
+    }
+
+    void build_widget ()
+    {
+        sample_button.reset (new Gtk::ToggleButton (_("Sample")));
+        sample_button->set_tooltip_text
+            (_("Periodically interrupt the program to sample the stacks "
+               "of its threads"));
+        rate_spin.reset (new Gtk::SpinButton);
+        rate_spin->set_range (1, 1000);
+        rate_spin->set_increments (1, 10);
+        rate_spin->set_value (PROFILER_DEFAULT_RATE);
+        thread_combo.reset (new Gtk::ComboBoxText);
+        clear_button.reset (new Gtk::Button (_("Clear")));
+
+        Gtk::Box *hbox =
+            Gtk::manage (new Gtk::Box (Gtk::ORIENTATION_HORIZONTAL));
+        hbox->set_spacing (6);
+        hbox->set_border_width (3);
+        hbox->pack_start (*sample_button, Gtk::PACK_SHRINK);
+        hbox->pack_start (*Gtk::manage (new Gtk::Label (_("Samples per second:"))),
+                          Gtk::PACK_SHRINK);
+        hbox->pack_start (*rate_spin, Gtk::PACK_SHRINK);
+        hbox->pack_start (*Gtk::manage (new Gtk::Label (_("Thread:"))),
+                          Gtk::PACK_SHRINK);
+        hbox->pack_start (*thread_combo, Gtk::PACK_SHRINK);
+        hbox->pack_start (*clear_button, Gtk::PACK_SHRINK);
+
+        stats_label.reset (new Gtk::Label);
+        stats_label->set_alignment (0, 0.5);
+        stats_label->set_padding (3, 0);
+
+        tree_store = Gtk::TreeStore::create (get_columns ());
+        tree_view.reset (new Gtk::TreeView (tree_store));
+        tree_view->append_column (_("Function"), get_columns ().function);
+        tree_view->append_column (_("Total"), get_columns ().total);
+        tree_view->append_column (_("Self"), get_columns ().self);
+        tree_view->append_column (_("Samples"), get_columns ().nb_samples);
+        Gtk::ScrolledWindow *tree_scr = Gtk::manage (new Gtk::ScrolledWindow);
+        tree_scr->set_policy (Gtk::POLICY_AUTOMATIC, Gtk::POLICY_AUTOMATIC);
+        tree_scr->set_shadow_type (Gtk::SHADOW_IN);
+        tree_scr->add (*tree_view);
+
+        flame_graph.reset (new Gtk::DrawingArea);
+        flame_graph->set_has_tooltip (true);
+        Gtk::ScrolledWindow *flame_scr =
+            Gtk::manage (new Gtk::ScrolledWindow);
+        flame_scr->set_policy (Gtk::POLICY_NEVER, Gtk::POLICY_AUTOMATIC);
+        flame_scr->set_shadow_type (Gtk::SHADOW_IN);
+        flame_scr->add (*flame_graph);
+
+        Gtk::Notebook *notebook = Gtk::manage (new Gtk::Notebook);
+        notebook->append_page (*tree_scr, _("Call Tree"));
+        notebook->append_page (*flame_scr, _("Flame Graph"));
+
+        vbox.reset (new Gtk::Box (Gtk::ORIENTATION_VERTICAL));
+        vbox->pack_start (*hbox, Gtk::PACK_SHRINK);
+        vbox->pack_start (*stats_label, Gtk::PACK_SHRINK);
+        vbox->pack_start (*notebook);
+        vbox->show_all ();
+
+        fill_thread_combo ();
+    }
+
+    void connect_to_debugger_signals ()
+    {
+        THROW_IF_FAIL (debugger);
+        debugger->stopped_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_debugger_stopped_signal));
+        debugger->running_signal ().connect
+            (sigc::mem_fun (*this, &Priv::on_debugger_running_signal));
+    }
+
+    void connect_to_widget_signals ()
+    {
+        sample_button->signal_toggled ().connect
+            (sigc::mem_fun (*this, &Priv::on_sample_button_toggled_signal));
+        rate_spin->signal_value_changed ().connect
+            (sigc::mem_fun (*this, &Priv::on_rate_changed_signal));
+        thread_combo_connection = thread_combo->signal_changed ().connect
+            (sigc::mem_fun (*this, &Priv::on_thread_combo_changed_signal));
+        clear_button->signal_clicked ().connect
+            (sigc::mem_fun (*this, &Priv::on_clear_clicked_signal));
+        flame_graph->signal_draw ().connect
+            (sigc::mem_fun (*this, &Priv::on_flame_graph_draw_signal));
+        flame_graph->signal_query_tooltip ().connect
+            (sigc::mem_fun (*this, &Priv::on_flame_graph_query_tooltip_signal));
+    }
+
+    bool is_sampling () const
+    {
+        return sample_button->get_active ();
+    }
+
+    void update_active_timer ()
+    {
+        bool should_be_on = is_sampling () && inferior_is_running;
+        if (should_be_on == active_timer_is_on)
+            return;
+        if (should_be_on) {
+            active_timer.start ();
+        } else {
+            active_timer.stop ();
+            active_time += active_timer.elapsed ();
+        }
+        active_timer_is_on = should_be_on;
+    }
+
+    double elapsed_active_time ()
+    {
+        return active_time + (active_timer_is_on ? active_timer.elapsed () : 0);
+    }
+
+    void start_sampling ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        sampling_connection.disconnect ();
+        unsigned period = std::max (1, 1000 / rate_spin->get_value_as_int ());
+        sampling_connection = Glib::signal_timeout ().connect
+            (sigc::mem_fun (*this, &Priv::on_sampling_timeout), period);
+        if (!refresh_connection.connected ())
+            refresh_connection = Glib::signal_timeout ().connect
+                (sigc::mem_fun (*this, &Priv::on_refresh_timeout),
+                 PROFILER_REFRESH_PERIOD);
+        update_active_timer ();
+    }
+
+    void stop_sampling ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        sampling_connection.disconnect ();
+        refresh_connection.disconnect ();
+        update_active_timer ();
+        refresh ();
+    }
+
+    int selected_thread_id ()
+    {
+        Glib::ustring id = thread_combo->get_active_id ();
+        return id.empty () ? 0 : atoi (id.c_str ());
+    }
+
+    /// Make thread_combo list "All threads" and then thread_ids,
+    /// keeping the current selection.
+    void fill_thread_combo ()
+    {
+        int selected = selected_thread_id ();
+        thread_combo_connection.block (true);
+        thread_combo->remove_all ();
+        thread_combo->append ("0", _("All threads"));
+        std::vector<int>::const_iterator it;
+        for (it = thread_ids.begin (); it != thread_ids.end (); ++it) {
+            UString id = UString::from_int (*it);
+            thread_combo->append (id, _("Thread ") + id);
+        }
+        if (!thread_combo->set_active_id (UString::from_int (selected)))
+            thread_combo->set_active_id ("0");
+        thread_combo_connection.block (false);
+    }
+
+    void append_call_tree_node (const StackProfile::Node &a_node,
+                                const Gtk::TreeNodeChildren &a_rows)
+    {
+        const ProfilerColumns &cols = get_columns ();
+        std::vector<StackProfile::Node>::const_iterator it;
+        for (it = a_node.children.begin (); it != a_node.children.end (); ++it) {
+            Gtk::TreeModel::iterator row = tree_store->append (a_rows);
+            (*row)[cols.function] = it->function_name ();
+            (*row)[cols.total] = percentage (it->nb_samples,
+                                             call_tree.nb_samples);
+            (*row)[cols.self] = percentage (it->nb_self_samples,
+                                            call_tree.nb_samples);
+            (*row)[cols.nb_samples] = it->nb_samples;
+            append_call_tree_node (*it, row->children ());
+        }
+    }
+
+    /// Rebuild the call tree and the flame graph from the samples.
+    void refresh ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        needs_refresh = false;
+
+        std::vector<int> ids;
+        profile.thread_ids (ids);
+        if (ids != thread_ids) {
+            thread_ids.swap (ids);
+            fill_thread_combo ();
+        }
+
+        profile.build_call_tree (call_tree, selected_thread_id ());
+        tree_store->clear ();
+        append_call_tree_node (call_tree, tree_store->children ());
+        // Unfold the first level, which is usually the entry points of
+        // the threads.
+        Gtk::TreeNodeChildren rows = tree_store->children ();
+        for (Gtk::TreeModel::iterator it = rows.begin (); it != rows.end (); ++it)
+            tree_view->expand_row (tree_store->get_path (it), false);
+
+        flame_graph->set_size_request
+            (-1, call_tree_depth (call_tree) * FLAME_GRAPH_ROW_HEIGHT);
+        flame_graph->queue_draw ();
+        update_stats ();
+    }
+
+    void update_stats ()
+    {
+        double elapsed = elapsed_active_time ();
+        UString stats;
+        stats.printf (_("%u samples in %.1f s: %.1f samples per second, "
+                        "program interrupted %.1f %% of the time"),
+                      profile.nb_samples (),
+                      elapsed,
+                      elapsed > 0 ? profile.nb_samples () / elapsed : 0.0,
+                      elapsed > 0 ? 100.0 * sampled_time / elapsed : 0.0);
+        stats_label->set_text (stats);
+    }
+
+    void clear ()
+    {
+        profile.clear ();
+        call_tree = StackProfile::Node ();
+        thread_ids.clear ();
+        flame_boxes.clear ();
+        active_time = 0;
+        sampled_time = 0;
+        if (active_timer_is_on)
+            active_timer.start ();
+        fill_thread_combo ();
+        tree_store->clear ();
+        flame_graph->set_size_request (-1, -1);
+        flame_graph->queue_draw ();
+        update_stats ();
+    }
+
+    void draw_flame_node (const Cairo::RefPtr<Cairo::Context> &a_cr,
+                          const StackProfile::Node &a_node,
+                          const UString &a_label,
+                          double a_x,
+                          double a_y,
+                          double a_scale)
+    {
+        double width = a_node.nb_samples * a_scale;
+        FlameBox box = {a_x, a_y, width, &a_node};
+        flame_boxes.push_back (box);
+
+        // Warm colours, stable for a given function.
+        double shade = (a_node.function * 2654435761u % 1000) / 1000.0;
+        a_cr->set_source_rgb (0.9, 0.35 + 0.5 * shade, 0.2 * shade);
+        a_cr->rectangle (a_x, a_y, std::max (width - 1, 1.0),
+                         FLAME_GRAPH_ROW_HEIGHT - 1);
+        a_cr->fill ();
+
+        if (width > 3 * FLAME_GRAPH_ROW_HEIGHT) {
+            a_cr->save ();
+            a_cr->rectangle (a_x, a_y, width - 3, FLAME_GRAPH_ROW_HEIGHT);
+            a_cr->clip ();
+            a_cr->set_source_rgb (0, 0, 0);
+            a_cr->move_to (a_x + 2, a_y + FLAME_GRAPH_ROW_HEIGHT - 5);
+            a_cr->show_text (a_label.raw ());
+            a_cr->restore ();
+        }
+
+        double x = a_x;
+        std::vector<StackProfile::Node>::const_iterator it;
+        for (it = a_node.children.begin (); it != a_node.children.end (); ++it) {
+            double child_width = it->nb_samples * a_scale;
+            if (child_width >= FLAME_GRAPH_MIN_WIDTH)
+                draw_flame_node (a_cr, *it, it->function_name (),
+                                 x, a_y - FLAME_GRAPH_ROW_HEIGHT, a_scale);
+            x += child_width;
+        }
+    }
+
+    bool on_flame_graph_draw_signal (const Cairo::RefPtr<Cairo::Context> &a_cr)
+    {
+        NEMIVER_TRY
+
+        flame_boxes.clear ();
+        if (!call_tree.nb_samples)
+            return false;
+
+        double width = flame_graph->get_allocated_width ();
+        double height = flame_graph->get_allocated_height ();
+        a_cr->set_font_size (FLAME_GRAPH_ROW_HEIGHT * 0.6);
+        // The root is at the bottom, the innermost frames on top.
+        draw_flame_node (a_cr, call_tree, _("all"), 0,
+                         height - FLAME_GRAPH_ROW_HEIGHT,
+                         width / call_tree.nb_samples);
+
+        NEMIVER_CATCH
+        return true;
+    }
+
+    bool on_flame_graph_query_tooltip_signal
+                            (int a_x, int a_y, bool,
+                             const Glib::RefPtr<Gtk::Tooltip> &a_tooltip)
+    {
+        NEMIVER_TRY
+
+        std::vector<FlameBox>::const_iterator it;
+        for (it = flame_boxes.begin (); it != flame_boxes.end (); ++it) {
+            if (a_x < it->x || a_x >= it->x + it->width
+                || a_y < it->y || a_y >= it->y + FLAME_GRAPH_ROW_HEIGHT)
+                continue;
+            UString text;
+            text.printf (_("%s\n%u samples, %s"),
+                         it->node == &call_tree
+                         ? _("all")
+                         : it->node->function_name ().c_str (),
+                         it->node->nb_samples,
+                         percentage (it->node->nb_samples,
+                                     call_tree.nb_samples).c_str ());
+            a_tooltip->set_text (text);
+            return true;
+        }
+
+        NEMIVER_CATCH
+        return false;
+    }
+
+    bool on_sampling_timeout ()
+    {
+        NEMIVER_TRY
+
+        // Samples are only worth taking while the program runs, and
+        // one at a time.
+        if (inferior_is_running && !sample_in_flight) {
+            sample_in_flight = true;
+            sample_timer.start ();
+            debugger->sample_threads_stacks
+                (PROFILER_MAX_DEPTH,
+                 sigc::mem_fun (*this, &Priv::on_sample_signal));
+        }
+
+        NEMIVER_CATCH
+        return true;
+    }
+
+    bool on_refresh_timeout ()
+    {
+        NEMIVER_TRY
+
+        if (needs_refresh)
+            refresh ();
+        else
+            update_stats ();
+
+        NEMIVER_CATCH
+        return true;
+    }
+
+    void on_sample_signal (const map<int, vector<IDebugger::Frame> > &a_stacks)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        sample_in_flight = false;
+        sample_timer.stop ();
+        sampled_time += sample_timer.elapsed ();
+        // No stack means the program stopped for another reason
+        // before it could be sampled.
+        if (!a_stacks.empty ()) {
+            profile.add_sample (a_stacks);
+            needs_refresh = true;
+        }
+
+        NEMIVER_CATCH
+    }
+
+    void on_debugger_running_signal ()
+    {
+        NEMIVER_TRY
+
+        inferior_is_running = true;
+        update_active_timer ();
+
+        NEMIVER_CATCH
+    }
+
+    void on_debugger_stopped_signal (IDebugger::StopReason,
+                                     bool /*a_has_frame*/,
+                                     const IDebugger::Frame &/*a_frame*/,
+                                     int /*a_thread_id*/,
+                                     const string &/*a_bp_num*/,
+                                     const UString &/*a_cookie*/)
+    {
+        NEMIVER_TRY
+
+        inferior_is_running = false;
+        update_active_timer ();
+        if (needs_refresh)
+            refresh ();
+
+        NEMIVER_CATCH
+    }
+
+    void on_sample_button_toggled_signal ()
+    {
+        NEMIVER_TRY
+
+        if (is_sampling ())
+            start_sampling ();
+        else
+            stop_sampling ();
+
+        NEMIVER_CATCH
+    }
+
+    void on_rate_changed_signal ()
+    {
+        NEMIVER_TRY
+
+        if (is_sampling ())
+            start_sampling ();
+
+        NEMIVER_CATCH
+    }
+
+    void on_thread_combo_changed_signal ()
+    {
+        NEMIVER_TRY
+
+        refresh ();
+
+        NEMIVER_CATCH
+    }
+
+    void on_clear_clicked_signal ()
+    {
+        NEMIVER_TRY
+
+        clear ();
+
+        NEMIVER_CATCH
+    }
+};//end struct ProfilerView::Priv
+
+ProfilerView::ProfilerView (IDebuggerSafePtr &a_debugger)
+{
+    m_priv.reset (new Priv (a_debugger));
+}
+
+ProfilerView::~ProfilerView ()
+{
+}
+
+Gtk::Widget&
+ProfilerView::widget () const
+{
+    THROW_IF_FAIL (m_priv && m_priv->vbox);
+    return *m_priv->vbox;
+}
+
+/// Forget the samples taken so far.  Sampling goes on if it was on.
+void
+ProfilerView::clear ()
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->clear ();
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
@@ -0,0 +1,62 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_PROFILER_VIEW_H__
+#define __NMV_PROFILER_VIEW_H__
+
+#include <gtkmm/widget.h>
+#include "common/nmv-object.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "nmv-i-debugger.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+/// A poor man's sampling profiler.
+///
+/// While sampling is on and the inferior runs, the view asks the
+/// debugger for the stacks of all the threads at a regular rate (see
+/// IDebugger::sample_threads_stacks).  The samples are aggregated
+/// into a call tree and a flame graph, for all the threads or for a
+/// single one.  The achieved sampling rate and the share of the time
+/// the inferior spent interrupted are shown along, as they tell how
+/// much the numbers can be trusted.
+class NEMIVER_API ProfilerView : public nemiver::common::Object {
+    //non copyable
+    ProfilerView (const ProfilerView&);
+    ProfilerView& operator= (const ProfilerView&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+public:
+
+    ProfilerView (IDebuggerSafePtr &a_debugger);
+    virtual ~ProfilerView ();
+    Gtk::Widget& widget () const;
+    void clear ();
+};//end ProfilerView
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_PROFILER_VIEW_H__
@@ -42,7 +42,7 @@ using nemiver::common::ConnectionManager;
 using nemiver::common::Transaction;
 using nemiver::common::SQLStatement;
 
-static const char *REQUIRED_DB_SCHEMA_VERSION = "1.5";
+static const char *REQUIRED_DB_SCHEMA_VERSION = "1.6";
 static const char *DB_FILE_NAME = "nemivercommon.db";
 
 NEMIVER_BEGIN_NAMESPACE (nemiver)
@@ -347,7 +347,8 @@ SessMgr::store_session (Session &a_session,
 	  + UString::from_int (break_iter->enabled ()) + ", "
 	  + "'" + SQLStatement::escape_string (condition) + "'" + ", "
 	  + UString::from_int (break_iter->ignore_count ()) + ", "
-	  + UString::from_int (break_iter->is_countpoint ())
+	  + UString::from_int (break_iter->is_countpoint ()) + ", "
+	  + UString::from_int (break_iter->thread_id ())
 	  + ")";
         LOG_DD ("query: " << query);
         THROW_IF_FAIL
@@ -478,7 +479,7 @@ SessMgr::load_session (Session &a_session,
     query = "select breakpoints.filename, breakpoints.filefullname, "
       "breakpoints.linenumber, breakpoints.enabled, "
       "breakpoints.condition, breakpoints.ignorecount,"
-      "breakpoints.iscountpoint from "
+      "breakpoints.iscountpoint, breakpoints.threadid from "
       "breakpoints where breakpoints.sessionid = "
       + UString::from_int (session.session_id ());
 
@@ -486,7 +487,7 @@ SessMgr::load_session (Session &a_session,
     THROW_IF_FAIL (trans.get ().get_connection ().execute_statement (query));
     while (trans.get ().get_connection ().read_next_row ()) {
         UString filename, filefullname, linenumber,
-	  enabled, condition, ignorecount, is_countpoint;
+	  enabled, condition, ignorecount, is_countpoint, thread_id;
         THROW_IF_FAIL (trans.get ().get_connection ().get_column_content
                                                             (0, filename));
         THROW_IF_FAIL (trans.get ().get_connection ().get_column_content
@@ -502,19 +503,22 @@ SessMgr::load_session (Session &a_session,
                                                             (5, ignorecount));
 	THROW_IF_FAIL (trans.get ().get_connection ().get_column_content
                                                             (6, is_countpoint));
+        THROW_IF_FAIL (trans.get ().get_connection ().get_column_content
+                                                            (7, thread_id));
         LOG_DD ("filename, filefullname, linenumber, enabled, "
                 "condition, ignorecount:\n"
                 << filename << "," << filefullname << ","
                 << linenumber << "," << enabled << ","
                 << condition << "," << ignorecount
-		<< is_countpoint);
+		<< is_countpoint << "," << thread_id);
         session.breakpoints ().push_back (SessMgr::Breakpoint (filename,
                                                                filefullname,
                                                                linenumber,
                                                                enabled,
                                                                condition,
                                                                ignorecount,
-							       is_countpoint));
+							       is_countpoint,
+                                                               thread_id));
     }
 
     // load the watchpoints
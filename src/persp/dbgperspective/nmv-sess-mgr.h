@@ -63,6 +63,8 @@ public:
         UString m_condition;
         int m_ignore_count;
 	bool m_is_countpoint;
+        // The id of the only thread the breakpoint stops, or 0.
+        int m_thread_id;
 
     public:
         Breakpoint (const UString &a_file_name,
@@ -71,14 +73,16 @@ public:
                     const UString &a_enabled,
                     const UString &a_condition,
                     const UString &a_ignore_count,
-                    const UString &a_is_countpoint) :
+                    const UString &a_is_countpoint,
+                    const UString &a_thread_id) :
 	m_file_name (a_file_name),
             m_file_full_name (a_file_full_name),
             m_line_number (atoi (a_line_number.c_str ())),
             m_enabled (atoi (a_enabled.c_str ())),
             m_condition (a_condition),
             m_ignore_count (atoi (a_ignore_count.c_str ())),
-            m_is_countpoint (atoi (a_is_countpoint.c_str ()))
+            m_is_countpoint (atoi (a_is_countpoint.c_str ())),
+            m_thread_id (atoi (a_thread_id.c_str ()))
         {}
 
         Breakpoint (const UString &a_file_name,
@@ -87,21 +91,24 @@ public:
                     bool a_enabled,
                     const UString &a_condition,
                     unsigned a_ignore_count,
-		    bool a_is_countpoint) :
+		    bool a_is_countpoint,
+                    int a_thread_id = 0) :
 	m_file_name (a_file_name),
             m_file_full_name (a_file_full_name),
             m_line_number (a_line_number),
             m_enabled (a_enabled),
             m_condition (a_condition),
             m_ignore_count (a_ignore_count),
-            m_is_countpoint (a_is_countpoint)
+            m_is_countpoint (a_is_countpoint),
+            m_thread_id (a_thread_id)
         {}
 
         Breakpoint () :
         m_line_number (0),
             m_enabled (true),
             m_ignore_count (0),            
-            m_is_countpoint (false)
+            m_is_countpoint (false),
+            m_thread_id (0)
         {}
 
         const UString& file_name () const {return m_file_name;}
@@ -124,6 +131,9 @@ public:
 
         bool is_countpoint () const {return m_is_countpoint;}
         void is_countpoint (bool a) {m_is_countpoint = a;}
+
+        int thread_id () const {return m_thread_id;}
+        void thread_id (int a) {m_thread_id = a;}
     };
 
     class WatchPoint {
@@ -23,10 +23,17 @@
  *See COPYRIGHT file copyright information.
  */
 #include "config.h"
+#include <map>
 #include <glib/gi18n.h>
 #include <gtkmm/treeview.h>
 #include <gtkmm/treestore.h>
+#include <gtkmm/liststore.h>
+#include <gtkmm/label.h>
+#include <gtkmm/menu.h>
+#include <gtkmm/menuitem.h>
+#include <gtkmm/separatormenuitem.h>
 #include "common/nmv-exception.h"
+#include "common/nmv-proc-utils.h"
 #include "nmv-thread-list.h"
 #include "nmv-i-debugger.h"
 #include "nmv-ui-utils.h"
@@ -35,10 +42,40 @@ NEMIVER_BEGIN_NAMESPACE (nemiver)
 
 struct ThreadListColumns : public Gtk::TreeModelColumnRecord {
     Gtk::TreeModelColumn<int> thread_id;
+    Gtk::TreeModelColumn<Glib::ustring> target_id;
+    Gtk::TreeModelColumn<Glib::ustring> name;
+    Gtk::TreeModelColumn<Glib::ustring> state;
+    Gtk::TreeModelColumn<Glib::ustring> location;
+    // False when the thread may have moved since location was set.
+    Gtk::TreeModelColumn<bool> location_is_current;
+    // What the kernel tells about the thread.
+    Gtk::TreeModelColumn<int> lwp;
+    Gtk::TreeModelColumn<Glib::ustring> kernel_state;
+    Gtk::TreeModelColumn<Glib::ustring> user_time;
+    Gtk::TreeModelColumn<Glib::ustring> system_time;
+    Gtk::TreeModelColumn<Glib::ustring> cpu_delta;
+    Gtk::TreeModelColumn<Glib::ustring> processor;
+    // The CPU time spent since the previous stop, in seconds.  The
+    // rows are sorted on it.
+    Gtk::TreeModelColumn<double> cpu_delta_value;
+    Gtk::TreeModelColumn<Glib::ustring> affinity;
 
     ThreadListColumns ()
     {
         add (thread_id);
+        add (target_id);
+        add (name);
+        add (state);
+        add (location);
+        add (location_is_current);
+        add (lwp);
+        add (kernel_state);
+        add (user_time);
+        add (system_time);
+        add (cpu_delta);
+        add (processor);
+        add (cpu_delta_value);
+        add (affinity);
     }
 };//end class ThreadListColumns
 
@@ -49,22 +86,69 @@ thread_list_columns ()
     return s_thread_list_columns;
 }
 
+/// The threads are listed in one go with -thread-info.  After that,
+/// the list is kept up to date from the thread created and thread
+/// exited notifications of the debugger and from the stop events,
+/// rather than by listing the threads again at each stop.  A new
+/// listing is requested only when a thread appeared since the last
+/// one, to get its target id and name.
+///
+/// When the inferior is a local process, the state and the CPU usage
+/// of its threads are read from /proc at each stop the list is shown
+/// at.  The threads that used the most CPU since the previous such
+/// stop come first.
 struct ThreadList::Priv {
     IDebuggerSafePtr debugger;
     std::list<int> thread_ids;
     int current_thread;
     SafePtr<Gtk::TreeView> tree_view;
     Glib::RefPtr<Gtk::ListStore> list_store;
+    // The rows of list_store, by thread id.  The iterators of a
+    // Gtk::ListStore stay valid until their row is removed.
+    std::map<int, Gtk::TreeModel::iterator> rows;
     sigc::signal<void, int> thread_selected_signal;
+    sigc::signal<void, int> break_in_thread_requested_signal;
     int current_thread_id;
     sigc::connection tree_view_selection_changed_connection;
     bool is_up2date;
+    // True when the threads need to be listed again, either because
+    // they were never listed, or because some threads got created
+    // since the last listing.
+    bool needs_listing;
+    bool listing_in_flight;
+    // The thread the context menu was popped up for.
+    int menu_thread_id;
+    // The context menu of a thread, to resume or interrupt it on its
+    // own in non-stop mode, or to break only in it.
+    SafePtr<Gtk::Menu> thread_menu;
+    Gtk::MenuItem *continue_thread_menu_item;
+    Gtk::MenuItem *interrupt_thread_menu_item;
+    Gtk::MenuItem *break_in_thread_menu_item;
+    // The pid of the inferior, or 0 if it's unknown.
+    int target_pid;
+    // True if the inferior runs on a remote target.  Its pid doesn't
+    // name a process of this machine then, so /proc isn't read.
+    bool target_is_remote;
+    // The kernel ids of the threads, by thread id.
+    std::map<int, int> lwps;
+    // The CPU time of the threads at the last stop and at the stop
+    // before, by thread id.
+    std::map<int, double> cpu_times_at_last_stop;
+    std::map<int, double> cpu_times_at_previous_stop;
 
     Priv (IDebuggerSafePtr &a_debugger) :
         debugger (a_debugger),
         current_thread (0),
         current_thread_id (0),
-        is_up2date (true)
+        is_up2date (true),
+        needs_listing (true),
+        listing_in_flight (false),
+        menu_thread_id (0),
+        continue_thread_menu_item (0),
+        interrupt_thread_menu_item (0),
+        break_in_thread_menu_item (0),
+        target_pid (0),
+        target_is_remote (false)
     {
         build_widget ();
         connect_to_debugger_signals ();
@@ -74,7 +158,11 @@ struct ThreadList::Priv {
     void finish_handling_debugger_stopped_event ()
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
-        debugger->list_threads ();
+        update_kernel_stats (true);
+        if (needs_listing && !listing_in_flight) {
+            listing_in_flight = true;
+            debugger->list_threads_info ();
+        }
     }
 
     bool should_process_now ()
@@ -87,8 +175,8 @@ struct ThreadList::Priv {
     }
 
     void on_debugger_stopped_signal (IDebugger::StopReason a_reason,
-                                     bool /*a_has_frame*/,
-                                     const IDebugger::Frame &/*a_frame*/,
+                                     bool a_has_frame,
+                                     const IDebugger::Frame &a_frame,
                                      int a_thread_id,
                                      const string &/*bp_num*/,
                                      const UString &/*a_cookie*/)
@@ -98,9 +186,20 @@ struct ThreadList::Priv {
 
         if (a_reason == IDebugger::EXITED_SIGNALLED
             || a_reason == IDebugger::EXITED_NORMALLY) {
+            forget_kernel_stats ();
             return;
         }
-        current_thread_id = a_thread_id;
+
+        // Only the frame of the thread that caused the stop is known.
+        // The state of the threads is updated from
+        // IDebugger::thread_state_changed_signal.
+        if (a_thread_id > 0) {
+            Gtk::TreeModel::iterator it = get_or_add_row (a_thread_id);
+            if (a_has_frame)
+                set_row_location (it, a_frame);
+        }
+        select_thread_id (a_thread_id, false);
+
         if (should_process_now ()) {
             finish_handling_debugger_stopped_event ();
         } else {
@@ -109,31 +208,177 @@ struct ThreadList::Priv {
         NEMIVER_CATCH
     }
 
-    void on_debugger_threads_listed_signal (const std::list<int> &a_threads,
-                                            const UString &a_cookie)
+    void on_debugger_thread_state_changed_signal (int a_thread_id,
+                                                  bool a_is_running)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        NEMIVER_TRY
+
+        if (a_thread_id < 0) {
+            set_all_threads_state (a_is_running);
+        } else {
+            std::map<int, Gtk::TreeModel::iterator>::iterator row =
+                rows.find (a_thread_id);
+            if (row != rows.end ())
+                set_row_state (row->second, a_is_running);
+        }
+
+        NEMIVER_CATCH
+    }
+
+    bool on_button_press_event_signal (GdkEventButton *a_event)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        NEMIVER_TRY
+
+        if (a_event->type != GDK_BUTTON_PRESS
+            || a_event->button != 3)
+            return false;
+
+        Gtk::TreeModel::Path path;
+        Gtk::TreeViewColumn *column = 0;
+        int cell_x = 0, cell_y = 0;
+        if (!tree_view->get_path_at_pos (static_cast<int> (a_event->x),
+                                         static_cast<int> (a_event->y),
+                                         path, column, cell_x, cell_y))
+            return false;
+        Gtk::TreeModel::iterator it = list_store->get_iter (path);
+        if (!it)
+            return false;
+        int thread_id = (*it)[thread_list_columns ().thread_id];
+        bool is_running = debugger->is_thread_running (thread_id);
+        // Threads can be resumed or interrupted on their own only in
+        // non-stop mode.
+        bool non_stop = debugger->is_non_stop_mode ();
+
+        if (!thread_menu)
+            build_thread_menu ();
+        continue_thread_menu_item->set_sensitive (non_stop && !is_running);
+        interrupt_thread_menu_item->set_sensitive (non_stop && is_running);
+        menu_thread_id = thread_id;
+        thread_menu->popup (a_event->button, a_event->time);
+        return true;
+
+        NEMIVER_CATCH
+        return false;
+    }
+
+    void on_continue_thread_activated_signal ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        NEMIVER_TRY
+
+        if (menu_thread_id > 0)
+            debugger->continue_thread (menu_thread_id);
+
+        NEMIVER_CATCH
+    }
+
+    void on_interrupt_thread_activated_signal ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+        NEMIVER_TRY
+
+        if (menu_thread_id > 0)
+            debugger->interrupt_thread (menu_thread_id);
+
+        NEMIVER_CATCH
+    }
+
+    void on_break_in_thread_activated_signal ()
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
+        NEMIVER_TRY
+
+        if (menu_thread_id > 0)
+            break_in_thread_requested_signal.emit (menu_thread_id);
+
+        NEMIVER_CATCH
+    }
 
-        if (a_cookie.empty ()) {}
+    void on_debugger_threads_info_listed_signal
+                        (const vector<IDebugger::ThreadInfo> &a_threads,
+                         int a_current_thread_id,
+                         const UString &/*a_cookie*/)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
 
         NEMIVER_TRY
 
+        listing_in_flight = false;
+        needs_listing = false;
         clear_threads ();
-        set_thread_id_list (a_threads);
+        set_thread_infos (a_threads);
+        update_kernel_stats (false);
+        if (a_current_thread_id > 0)
+            current_thread_id = a_current_thread_id;
         select_thread_id (current_thread_id, false);
 
         NEMIVER_CATCH
     }
 
+    void on_debugger_thread_created_signal (int a_thread_id)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        Gtk::TreeModel::iterator it = get_or_add_row (a_thread_id);
+        set_row_state (it, true);
+        // Only a listing can tell the target id and the name of the
+        // new thread.
+        needs_listing = true;
+
+        NEMIVER_CATCH
+    }
+
+    void on_debugger_thread_exited_signal (int a_thread_id)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        remove_thread (a_thread_id);
+        lwps.erase (a_thread_id);
+        cpu_times_at_last_stop.erase (a_thread_id);
+        cpu_times_at_previous_stop.erase (a_thread_id);
+
+        NEMIVER_CATCH
+    }
+
+    void on_debugger_got_target_info_signal (int a_pid,
+                                             const UString &/*a_exe_path*/)
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        if (target_is_remote)
+            return;
+        if (a_pid != target_pid) {
+            forget_kernel_stats ();
+            target_pid = a_pid;
+        }
+        update_kernel_stats (false);
+
+        NEMIVER_CATCH
+    }
+
     void on_debugger_thread_selected_signal
                             (int a_tid,
-                             const IDebugger::Frame * const,
+                             const IDebugger::Frame * const a_frame,
                              const UString &/*a_cookie*/)
     {
         LOG_FUNCTION_SCOPE_NORMAL_DD;
 
         NEMIVER_TRY
 
+        if (a_frame) {
+            std::map<int, Gtk::TreeModel::iterator>::iterator row =
+                rows.find (a_tid);
+            if (row != rows.end ())
+                set_row_location (row->second, *a_frame);
+        }
         select_thread_id (a_tid, false);
         thread_selected_signal.emit (a_tid);
 
@@ -183,10 +428,176 @@ struct ThreadList::Priv {
         tree_view->get_selection ()->set_mode (Gtk::SELECTION_SINGLE);
         tree_view->append_column (_("Thread ID"),
                                   thread_list_columns ().thread_id);
-        Gtk::TreeViewColumn *column = tree_view->get_column (0);
+        tree_view->append_column (_("Target ID"),
+                                  thread_list_columns ().target_id);
+        tree_view->append_column (_("Name"), thread_list_columns ().name);
+        tree_view->append_column (_("State"), thread_list_columns ().state);
+        tree_view->append_column (_("TID"), thread_list_columns ().lwp);
+        int kernel_state_column =
+            tree_view->append_column (_("Kernel State"),
+                                      thread_list_columns ().kernel_state);
+        tree_view->append_column (_("User CPU"),
+                                  thread_list_columns ().user_time);
+        tree_view->append_column (_("System CPU"),
+                                  thread_list_columns ().system_time);
+        tree_view->append_column (_("CPU Since Last Stop"),
+                                  thread_list_columns ().cpu_delta);
+        tree_view->append_column (_("Last CPU"),
+                                  thread_list_columns ().processor);
+        tree_view->append_column (_("Affinity"),
+                                  thread_list_columns ().affinity);
+        int nb_columns =
+            tree_view->append_column (_("Location"),
+                                      thread_list_columns ().location);
+        for (int i = 0; i < nb_columns; ++i) {
+            Gtk::TreeViewColumn *column = tree_view->get_column (i);
+            THROW_IF_FAIL (column);
+            column->set_clickable (false);
+            column->set_reorderable (false);
+            column->set_resizable (true);
+        }
+
+        // The inferior is always stopped when /proc is read, so the
+        // kernel state of its threads is 't' but for the threads that
+        // still run in non-stop mode.
+        Gtk::TreeViewColumn *state_column =
+            tree_view->get_column (kernel_state_column - 1);
+        THROW_IF_FAIL (state_column);
+        Gtk::Label *state_label = Gtk::manage (new Gtk::Label
+                                                (_("Kernel State")));
+        state_label->set_tooltip_text
+            (_("The state of the thread as seen by the kernel, "
+               "when the debugger last stopped it.  A thread stopped "
+               "by the debugger is always in the \"t\" (traced) state, "
+               "so this column only tells apart the threads still "
+               "running in non-stop mode."));
+        state_label->show ();
+        state_column->set_widget (*state_label);
+
+        // Grey out the locations that may be out of date.
+        Gtk::TreeViewColumn *column = tree_view->get_column (nb_columns - 1);
         THROW_IF_FAIL (column);
-        column->set_clickable (false);
-        column->set_reorderable (false);
+        Gtk::CellRenderer *renderer = column->get_first_cell ();
+        THROW_IF_FAIL (renderer);
+        column->add_attribute (renderer->property_sensitive (),
+                               thread_list_columns ().location_is_current);
+
+        // The threads that burnt the most CPU come first.
+        int sort_column = thread_list_columns ().cpu_delta_value.index ();
+        list_store->set_sort_func
+            (sort_column, sigc::mem_fun (*this, &Priv::compare_cpu_deltas));
+        list_store->set_sort_column (sort_column, Gtk::SORT_DESCENDING);
+    }
+
+    int compare_cpu_deltas (const Gtk::TreeModel::iterator &a_l,
+                            const Gtk::TreeModel::iterator &a_r)
+    {
+        double l = (*a_l)[thread_list_columns ().cpu_delta_value];
+        double r = (*a_r)[thread_list_columns ().cpu_delta_value];
+        if (l != r)
+            return l < r ? -1 : 1;
+        // Keep the threads in increasing id order otherwise, given
+        // that the sort is descending.
+        int l_id = (*a_l)[thread_list_columns ().thread_id];
+        int r_id = (*a_r)[thread_list_columns ().thread_id];
+        return r_id - l_id;
+    }
+
+    /// Read the state and the CPU usage of the threads from /proc.
+    ///
+    /// \param a_new_stop true if the inferior stopped since the last
+    /// update.  The CPU time since the previous stop is then computed
+    /// from the CPU time at the last stop.
+    void update_kernel_stats (bool a_new_stop)
+    {
+        if (!target_pid || target_is_remote)
+            return;
+        if (a_new_stop)
+            cpu_times_at_previous_stop = cpu_times_at_last_stop;
+
+        std::map<int, Gtk::TreeModel::iterator>::iterator row;
+        for (row = rows.begin (); row != rows.end (); ++row) {
+            std::map<int, int>::const_iterator lwp = lwps.find (row->first);
+            common::ThreadStat stat;
+            if (lwp == lwps.end ()
+                || !common::read_thread_stat (target_pid, lwp->second, stat))
+                continue;
+            set_row_kernel_stats (row->second, row->first, stat);
+        }
+    }
+
+    void set_row_kernel_stats (Gtk::TreeModel::iterator &a_row,
+                               int a_thread_id,
+                               const common::ThreadStat &a_stat)
+    {
+        const ThreadListColumns &cols = thread_list_columns ();
+        double cpu_time = a_stat.user_time + a_stat.system_time;
+        std::map<int, double>::const_iterator previous =
+            cpu_times_at_previous_stop.find (a_thread_id);
+        double delta = cpu_time;
+        if (previous != cpu_times_at_previous_stop.end ())
+            delta -= previous->second;
+        cpu_times_at_last_stop[a_thread_id] = cpu_time;
+
+        UString str;
+        (*a_row)[cols.lwp] = lwps[a_thread_id];
+        (*a_row)[cols.kernel_state] = kernel_state_to_string (a_stat.state);
+        (*a_row)[cols.user_time] = str.printf ("%.2f", a_stat.user_time);
+        (*a_row)[cols.system_time] = str.printf ("%.2f", a_stat.system_time);
+        (*a_row)[cols.cpu_delta] = str.printf ("%.2f", delta);
+        (*a_row)[cols.processor] = a_stat.processor < 0
+                                   ? Glib::ustring ()
+                                   : UString::from_int (a_stat.processor);
+        (*a_row)[cols.affinity] = a_stat.cpus_allowed;
+        if (Glib::ustring ((*a_row)[cols.name]).empty ())
+            (*a_row)[cols.name] = a_stat.name;
+        // Last, as this may move the row.
+        (*a_row)[cols.cpu_delta_value] = delta;
+    }
+
+    static Glib::ustring kernel_state_to_string (char a_state)
+    {
+        UString str;
+        switch (a_state) {
+            case 'R': return str.printf (_("%c (running)"), a_state);
+            case 'S': return str.printf (_("%c (sleeping)"), a_state);
+            case 'D': return str.printf (_("%c (disk sleep)"), a_state);
+            case 'T': return str.printf (_("%c (stopped)"), a_state);
+            case 't': return str.printf (_("%c (traced)"), a_state);
+            case 'Z': return str.printf (_("%c (zombie)"), a_state);
+            default: return Glib::ustring (1, a_state);
+        }
+    }
+
+    void on_debugger_connected_to_server_signal ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        forget_kernel_stats ();
+        target_is_remote = true;
+
+        NEMIVER_CATCH
+    }
+
+    void on_debugger_detached_from_target_signal ()
+    {
+        LOG_FUNCTION_SCOPE_NORMAL_DD;
+
+        NEMIVER_TRY
+
+        forget_kernel_stats ();
+        target_is_remote = false;
+
+        NEMIVER_CATCH
+    }
+
+    void forget_kernel_stats ()
+    {
+        target_pid = 0;
+        cpu_times_at_last_stop.clear ();
+        cpu_times_at_previous_stop.clear ();
     }
 
     void connect_to_debugger_signals ()
@@ -196,11 +607,29 @@ struct ThreadList::Priv {
         debugger->stopped_signal ().connect (sigc::mem_fun
             (*this, &Priv::on_debugger_stopped_signal));
 
-        debugger->threads_listed_signal ().connect (sigc::mem_fun
-            (*this, &Priv::on_debugger_threads_listed_signal));
+        debugger->thread_state_changed_signal ().connect (sigc::mem_fun
+            (*this, &Priv::on_debugger_thread_state_changed_signal));
+
+        debugger->threads_info_listed_signal ().connect (sigc::mem_fun
+            (*this, &Priv::on_debugger_threads_info_listed_signal));
+
+        debugger->thread_created_signal ().connect (sigc::mem_fun
+            (*this, &Priv::on_debugger_thread_created_signal));
+
+        debugger->thread_exited_signal ().connect (sigc::mem_fun
+            (*this, &Priv::on_debugger_thread_exited_signal));
 
         debugger->thread_selected_signal ().connect (sigc::mem_fun
             (*this, &Priv::on_debugger_thread_selected_signal));
+
+        debugger->got_target_info_signal ().connect (sigc::mem_fun
+            (*this, &Priv::on_debugger_got_target_info_signal));
+
+        debugger->connected_to_server_signal ().connect (sigc::mem_fun
+            (*this, &Priv::on_debugger_connected_to_server_signal));
+
+        debugger->detached_from_target_signal ().connect (sigc::mem_fun
+            (*this, &Priv::on_debugger_detached_from_target_signal));
     }
 
     void connect_to_widget_signals ()
@@ -213,20 +642,123 @@ struct ThreadList::Priv {
                     (*this, &Priv::on_tree_view_selection_changed_signal));
         tree_view->signal_draw ().connect_notify
                     (sigc::mem_fun (*this, &Priv::on_draw_signal));
+        tree_view->signal_button_press_event ().connect
+                    (sigc::mem_fun (*this,
+                                    &Priv::on_button_press_event_signal),
+                     false);
+    }
+
+    void build_thread_menu ()
+    {
+        thread_menu.reset (new Gtk::Menu);
+        continue_thread_menu_item =
+            Gtk::manage (new Gtk::MenuItem (_("_Continue This Thread"), true));
+        continue_thread_menu_item->signal_activate ().connect
+            (sigc::mem_fun (*this,
+                            &Priv::on_continue_thread_activated_signal));
+        interrupt_thread_menu_item =
+            Gtk::manage (new Gtk::MenuItem (_("_Interrupt This Thread"), true));
+        interrupt_thread_menu_item->signal_activate ().connect
+            (sigc::mem_fun (*this,
+                            &Priv::on_interrupt_thread_activated_signal));
+        break_in_thread_menu_item =
+            Gtk::manage (new Gtk::MenuItem
+                         (_("_Break at Cursor Only in This Thread"), true));
+        break_in_thread_menu_item->signal_activate ().connect
+            (sigc::mem_fun (*this,
+                            &Priv::on_break_in_thread_activated_signal));
+        thread_menu->append (*continue_thread_menu_item);
+        thread_menu->append (*interrupt_thread_menu_item);
+        thread_menu->append
+            (*Gtk::manage (new Gtk::SeparatorMenuItem));
+        thread_menu->append (*break_in_thread_menu_item);
+        thread_menu->show_all ();
     }
 
-    void set_a_thread_id (int a_id)
+    /// \return the row of thread a_id, adding it if it is not in
+    /// the list yet.
+    Gtk::TreeModel::iterator get_or_add_row (int a_id)
     {
         THROW_IF_FAIL (list_store);
+        std::map<int, Gtk::TreeModel::iterator>::iterator row =
+            rows.find (a_id);
+        if (row != rows.end ())
+            return row->second;
+
         Gtk::TreeModel::iterator iter = list_store->append ();
         iter->set_value (thread_list_columns ().thread_id, a_id);
+        iter->set_value (thread_list_columns ().location_is_current, false);
+        rows[a_id] = iter;
+        thread_ids.push_back (a_id);
+        return iter;
+    }
+
+    void remove_thread (int a_id)
+    {
+        THROW_IF_FAIL (list_store);
+        std::map<int, Gtk::TreeModel::iterator>::iterator row =
+            rows.find (a_id);
+        if (row == rows.end ())
+            return;
+        list_store->erase (row->second);
+        rows.erase (row);
+        thread_ids.remove (a_id);
+    }
+
+    void set_row_state (Gtk::TreeModel::iterator &a_row, bool a_is_running)
+    {
+        a_row->set_value (thread_list_columns ().state,
+                          Glib::ustring (a_is_running
+                                         ? _("running")
+                                         : _("stopped")));
+        a_row->set_value (thread_list_columns ().location_is_current, false);
+    }
+
+    void set_all_threads_state (bool a_is_running)
+    {
+        std::map<int, Gtk::TreeModel::iterator>::iterator row;
+        for (row = rows.begin (); row != rows.end (); ++row)
+            set_row_state (row->second, a_is_running);
+    }
+
+    void set_row_location (Gtk::TreeModel::iterator &a_row,
+                           const IDebugger::Frame &a_frame)
+    {
+        UString location;
+        if (!a_frame.function_name ().empty ())
+            location = a_frame.function_name ();
+        else
+            location = a_frame.address ().to_string ();
+        if (!a_frame.file_name ().empty ()) {
+            location += " at " + a_frame.file_name () + ":"
+                        + UString::from_int (a_frame.line ());
+        } else if (!a_frame.library ().empty ()) {
+            location += " from " + UString (a_frame.library ());
+        }
+        a_row->set_value (thread_list_columns ().location,
+                          Glib::ustring (location));
+        a_row->set_value (thread_list_columns ().location_is_current, true);
     }
 
-    void set_thread_id_list (const std::list<int> &a_list)
+    void set_thread_info (const IDebugger::ThreadInfo &a_thread)
     {
-        std::list<int>::const_iterator it;
-        for (it = a_list.begin (); it != a_list.end (); ++it) {
-            set_a_thread_id (*it);
+        Gtk::TreeModel::iterator iter = get_or_add_row (a_thread.id ());
+        iter->set_value (thread_list_columns ().target_id,
+                         Glib::ustring (a_thread.target_id ()));
+        iter->set_value (thread_list_columns ().name,
+                         Glib::ustring (a_thread.name ()));
+        if (a_thread.lwp ())
+            lwps[a_thread.id ()] = a_thread.lwp ();
+        set_row_state (iter, a_thread.is_running ());
+        if (a_thread.has_frame ())
+            set_row_location (iter, a_thread.frame ());
+    }
+
+    void set_thread_infos (const vector<IDebugger::ThreadInfo> &a_threads)
+    {
+        vector<IDebugger::ThreadInfo>::const_iterator it;
+        for (it = a_threads.begin (); it != a_threads.end (); ++it) {
+            set_thread_info (*it);
         }
     }
 
@@ -234,26 +766,22 @@ struct ThreadList::Priv {
     {
         THROW_IF_FAIL (list_store);
         list_store->clear ();
+        rows.clear ();
+        thread_ids.clear ();
     }
 
     void select_thread_id (int a_tid, bool a_emit_signal)
     {
         THROW_IF_FAIL (list_store);
 
-        Gtk::TreeModel::iterator it;
-        for (it = list_store->children ().begin ();
-             it != list_store->children ().end ();
-             ++it) {
-            LOG_DD ("testing list row");
-            if ((int)(*it)->get_value
-                    (thread_list_columns ().thread_id) == a_tid) {
-                if (!a_emit_signal) {
-                    tree_view_selection_changed_connection.block (true);
-                }
-                tree_view->get_selection ()->select (it);
-                tree_view_selection_changed_connection.block (false);
+        std::map<int, Gtk::TreeModel::iterator>::iterator row =
+            rows.find (a_tid);
+        if (row != rows.end ()) {
+            if (!a_emit_signal) {
+                tree_view_selection_changed_connection.block (true);
             }
-            LOG_DD ("tested list row");
+            tree_view->get_selection ()->select (row->second);
+            tree_view_selection_changed_connection.block (false);
         }
         current_thread_id = a_tid;
     }
@@ -301,10 +829,11 @@ ThreadList::clear ()
     LOG_FUNCTION_SCOPE_NORMAL_DD;
 
     THROW_IF_FAIL (m_priv);
-    if (m_priv->list_store) {
-        m_priv->list_store->clear ();
-    }
+    m_priv->clear_threads ();
+    m_priv->forget_kernel_stats ();
     m_priv->current_thread_id = -1;
+    m_priv->needs_listing = true;
+    m_priv->listing_in_flight = false;
 }
 
 sigc::signal<void, int>&
@@ -314,5 +843,12 @@ ThreadList::thread_selected_signal () const
     return m_priv->thread_selected_signal;
 }
 
+sigc::signal<void, int>&
+ThreadList::break_in_thread_requested_signal () const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->break_in_thread_requested_signal;
+}
+
 NEMIVER_END_NAMESPACE (nemiver)
 
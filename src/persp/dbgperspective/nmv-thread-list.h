@@ -57,6 +57,11 @@ public:
     Gtk::Widget& widget () const;
     void clear ();
     sigc::signal<void, int>& thread_selected_signal () const;
+
+    /// Emitted when the user asks for the line of the cursor to
+    /// stop only a given thread.
+    sigc::signal<void, int/*thread id*/>&
+                            break_in_thread_requested_signal () const;
 };//end class ThreadList
 
 NEMIVER_END_NAMESPACE (nemiver)
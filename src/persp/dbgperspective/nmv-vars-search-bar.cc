@@ -0,0 +1,398 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#include "config.h"
+#include <list>
+#include <vector>
+#include <glib/gi18n.h>
+#include <gtkmm/entry.h>
+#include <gtkmm/checkbutton.h>
+#include <gtkmm/button.h>
+#include <gtkmm/progressbar.h>
+#include <gtkmm/stock.h>
+#include "common/nmv-exception.h"
+#include "nmv-vars-search-bar.h"
+#include "nmv-child-prefetcher.h"
+#include "nmv-variables-utils.h"
+
+namespace vutil = nemiver::variables_utils2;
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+struct VarsSearchBar::Priv : public sigc::trackable {
+    Gtk::Box &box;
+    Gtk::TreeView &tree_view;
+    Glib::RefPtr<Gtk::TreeStore> tree_store;
+    ChildPrefetcher *unfolder;
+    Gtk::Entry entry;
+    Gtk::CheckButton deep_check;
+    Gtk::ProgressBar progress_bar;
+    Gtk::Button stop_button;
+    // The case folded text searched for.
+    Glib::ustring text;
+    std::vector<Gtk::TreeRowReference> matches;
+    int current_match;
+    // The rows the deep search is to unfold, with their depth below
+    // the rows that were in the tree when the search started.
+    std::list<std::pair<Gtk::TreeRowReference, unsigned> > rows_to_unfold;
+    unsigned nb_unfolded;
+    bool deep_search_running;
+    // True once the deep search was started for the current text.
+    bool deep_search_started;
+    // Bumped by each new search, so that the replies to a cancelled
+    // deep search are ignored.
+    unsigned generation;
+
+    Priv (Gtk::Box &a_box,
+          Gtk::TreeView &a_tree_view,
+          const Glib::RefPtr<Gtk::TreeStore> &a_tree_store,
+          IDebugger *a_debugger,
+          ChildPrefetcher *a_unfolder) :
+        box (a_box),
+        tree_view (a_tree_view),
+        tree_store (a_tree_store),
+        unfolder (a_unfolder),
+        deep_check (_("_Deep"), true),
+        stop_button (Gtk::Stock::STOP),
+        current_match (-1),
+        nb_unfolded (0),
+        deep_search_running (false),
+        deep_search_started (false),
+        generation (0)
+    {
+        THROW_IF_FAIL (tree_store);
+
+        entry.set_icon_from_stock (Gtk::Stock::FIND);
+        entry.set_placeholder_text (_("Search variables"));
+        entry.signal_changed ().connect
+            (sigc::mem_fun (*this, &Priv::on_entry_changed_signal));
+        entry.signal_activate ().connect
+            (sigc::mem_fun (*this, &Priv::on_entry_activate_signal));
+
+        deep_check.set_tooltip_text
+            (_("Also fetch and search the members of the variables "
+               "that were not fetched yet"));
+        deep_check.set_sensitive (unfolder != 0);
+        deep_check.signal_toggled ().connect
+            (sigc::mem_fun (*this, &Priv::on_deep_check_toggled_signal));
+
+        progress_bar.set_show_text (true);
+        stop_button.signal_clicked ().connect
+            (sigc::mem_fun (*this, &Priv::cancel_deep_search));
+
+        box.set_spacing (6);
+        box.pack_start (entry);
+        box.pack_start (deep_check, Gtk::PACK_SHRINK);
+        box.pack_start (progress_bar, Gtk::PACK_SHRINK);
+        box.pack_start (stop_button, Gtk::PACK_SHRINK);
+        box.show_all ();
+        progress_bar.set_no_show_all ();
+        stop_button.set_no_show_all ();
+        progress_bar.hide ();
+        stop_button.hide ();
+
+        if (a_debugger)
+            a_debugger->running_signal ().connect
+                (sigc::mem_fun (*this, &Priv::cancel_deep_search));
+    }
+
+    bool
+    row_matches (const Gtk::TreeModel::iterator &a_it) const
+    {
+        Glib::ustring name = (*a_it)[vutil::get_variable_columns ().name];
+        if (name.casefold ().find (text) != Glib::ustring::npos)
+            return true;
+        Glib::ustring value = (*a_it)[vutil::get_variable_columns ().value];
+        return value.casefold ().find (text) != Glib::ustring::npos;
+    }
+
+    /// Look for matches among a_parent_it and its descendants, in
+    /// depth first order.  If a_depth is non zero, also queue the
+    /// rows which members are yet to be fetched for the deep search,
+    /// with a_depth as their depth.
+    void
+    search_rows (const Gtk::TreeModel::iterator &a_parent_it,
+                 unsigned a_depth)
+    {
+        Gtk::TreeModel::Children rows = a_parent_it->children ();
+        for (Gtk::TreeModel::iterator it = rows.begin ();
+             it != rows.end ();
+             ++it)
+            search_row (it, a_depth);
+    }
+
+    void
+    search_row (const Gtk::TreeModel::iterator &a_it, unsigned a_depth)
+    {
+        IDebugger::VariableSafePtr var =
+            (*a_it)[vutil::get_variable_columns ().variable];
+        // Skip the dummy rows of the variables that need unfolding,
+        // but not the title rows, like "Local Variables".
+        Glib::ustring name = (*a_it)[vutil::get_variable_columns ().name];
+        if (!var && name.empty ())
+            return;
+        Gtk::TreeModel::Path path = tree_store->get_path (a_it);
+        if (var && row_matches (a_it))
+            add_match (path);
+        if ((*a_it)[vutil::get_variable_columns ().needs_unfolding]) {
+            if (a_depth && a_depth <= VarsSearchBar::DEFAULT_MAX_DEPTH)
+                rows_to_unfold.push_back
+                    (std::make_pair (Gtk::TreeRowReference (tree_store, path),
+                                     a_depth));
+            return;
+        }
+        search_rows (a_it, a_depth);
+    }
+
+    void
+    add_match (const Gtk::TreeModel::Path &a_path)
+    {
+        matches.push_back (Gtk::TreeRowReference (tree_store, a_path));
+        if (current_match < 0)
+            next_match ();
+    }
+
+    /// Select the next match, wrapping around.
+    bool
+    next_match ()
+    {
+        for (unsigned i = 0; i < matches.size (); ++i) {
+            current_match = (current_match + 1) % matches.size ();
+            if (matches[current_match].is_valid ()) {
+                jump_to (matches[current_match].get_path ());
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void
+    jump_to (const Gtk::TreeModel::Path &a_path)
+    {
+        Gtk::TreeModel::Path parent = a_path;
+        if (parent.up () && !parent.empty ())
+            tree_view.expand_to_path (parent);
+        tree_view.get_selection ()->select (a_path);
+        tree_view.scroll_to_row (a_path, 0.5);
+    }
+
+    /// Look for a_text in the rows already in the tree.  If a_deep
+    /// is true, then fetch and search the members of the variables
+    /// that are not fetched yet.
+    void
+    search (const Glib::ustring &a_text, bool a_deep)
+    {
+        cancel_deep_search ();
+        matches.clear ();
+        current_match = -1;
+        text = a_text.casefold ();
+        deep_search_started = false;
+        if (text.empty ())
+            return;
+
+        bool deep = a_deep && unfolder && deep_check.get_active ();
+        deep_search_started = deep;
+        Gtk::TreeModel::Children rows = tree_store->children ();
+        for (Gtk::TreeModel::iterator it = rows.begin ();
+             it != rows.end ();
+             ++it)
+            search_row (it, deep ? 1 : 0);
+
+        if (!rows_to_unfold.empty ()) {
+            deep_search_running = true;
+            nb_unfolded = 0;
+            progress_bar.show ();
+            stop_button.show ();
+            unfold_next_row ();
+        }
+    }
+
+    void
+    update_progress ()
+    {
+        unsigned total = nb_unfolded + rows_to_unfold.size ();
+        UString msg;
+        msg.printf (_("%u variables fetched, %u matches"),
+                    nb_unfolded, (unsigned) matches.size ());
+        progress_bar.set_fraction (total ? (double) nb_unfolded / total : 1.0);
+        progress_bar.set_text (msg);
+    }
+
+    void
+    unfold_next_row ()
+    {
+        if (rows_to_unfold.empty ()
+            || nb_unfolded >= VarsSearchBar::DEFAULT_MAX_NB_UNFOLDS) {
+            finish_deep_search ();
+            return;
+        }
+        update_progress ();
+        std::pair<Gtk::TreeRowReference, unsigned> row = rows_to_unfold.front ();
+        rows_to_unfold.pop_front ();
+        if (!row.first.is_valid ()) {
+            unfold_next_row ();
+            return;
+        }
+        THROW_IF_FAIL (unfolder);
+        unfolder->unfold_row
+            (row.first.get_path (),
+             sigc::bind (sigc::mem_fun (*this, &Priv::on_row_unfolded),
+                         row.first, row.second, generation));
+    }
+
+    void
+    on_row_unfolded (Gtk::TreeRowReference a_row,
+                     unsigned a_depth,
+                     unsigned a_generation)
+    {
+        NEMIVER_TRY
+
+        if (a_generation != generation || !deep_search_running)
+            return;
+        ++nb_unfolded;
+        if (a_row.is_valid ()) {
+            Gtk::TreeModel::iterator it =
+                tree_store->get_iter (a_row.get_path ());
+            if (it && !(*it)[vutil::get_variable_columns ().needs_unfolding])
+                search_rows (it, a_depth + 1);
+        }
+        unfold_next_row ();
+
+        NEMIVER_CATCH
+    }
+
+    void
+    finish_deep_search ()
+    {
+        deep_search_running = false;
+        rows_to_unfold.clear ();
+        progress_bar.hide ();
+        stop_button.hide ();
+    }
+
+    void
+    cancel_deep_search ()
+    {
+        ++generation;
+        if (!deep_search_running)
+            return;
+        if (unfolder)
+            unfolder->cancel_row_unfolds ();
+        finish_deep_search ();
+    }
+
+    /// Only search the rows already in the tree while the text is
+    /// being typed: the deep search is started by Enter.
+    void
+    on_entry_changed_signal ()
+    {
+        NEMIVER_TRY
+        search (entry.get_text (), /*a_deep=*/false);
+        NEMIVER_CATCH
+    }
+
+    void
+    on_entry_activate_signal ()
+    {
+        NEMIVER_TRY
+        if (unfolder && deep_check.get_active ()
+            && !deep_search_started && !text.empty ())
+            search (entry.get_text (), /*a_deep=*/true);
+        else
+            next_match ();
+        NEMIVER_CATCH
+    }
+
+    void
+    on_deep_check_toggled_signal ()
+    {
+        NEMIVER_TRY
+        if (deep_check.get_active ())
+            search (entry.get_text (), /*a_deep=*/true);
+        else
+            cancel_deep_search ();
+        NEMIVER_CATCH
+    }
+};//end struct VarsSearchBar::Priv
+
+/// \param a_tree_view the tree view to search.
+///
+/// \param a_tree_store the model of a_tree_view.
+///
+/// \param a_debugger the debugger of the variables.  If non nil, the
+/// deep search is stopped when the inferior resumes.
+///
+/// \param a_unfolder the object used by the deep search to fetch the
+/// members of the variables.  If nil, the deep search is disabled.
+VarsSearchBar::VarsSearchBar (Gtk::TreeView &a_tree_view,
+                              const Glib::RefPtr<Gtk::TreeStore> &a_tree_store,
+                              IDebugger *a_debugger,
+                              ChildPrefetcher *a_unfolder) :
+    Gtk::Box (Gtk::ORIENTATION_HORIZONTAL)
+{
+    m_priv.reset (new Priv (*this, a_tree_view, a_tree_store,
+                            a_debugger, a_unfolder));
+}
+
+VarsSearchBar::~VarsSearchBar ()
+{
+}
+
+/// Search the tree for a text, as if it was typed in the search box,
+/// and select the first match.  Only the rows already in the tree are
+/// searched.
+void
+VarsSearchBar::search (const UString &a_text)
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->entry.set_text (a_text);
+}
+
+/// Select the next match, wrapping around.
+///
+/// \return false if there is no match.
+bool
+VarsSearchBar::next_match ()
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->next_match ();
+}
+
+/// \return the number of matches found so far.
+unsigned
+VarsSearchBar::nb_matches () const
+{
+    THROW_IF_FAIL (m_priv);
+    return m_priv->matches.size ();
+}
+
+/// Stop the deep search, if any.  The matches found so far are kept.
+void
+VarsSearchBar::cancel_deep_search ()
+{
+    THROW_IF_FAIL (m_priv);
+    m_priv->cancel_deep_search ();
+}
+
+NEMIVER_END_NAMESPACE (nemiver)
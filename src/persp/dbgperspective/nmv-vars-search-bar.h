@@ -0,0 +1,88 @@
+//Author: Dodji Seketeli
+/*
+ *This file is part of the Nemiver project
+ *
+ *Nemiver is free software; you can redistribute
+ *it and/or modify it under the terms of
+ *the GNU General Public License as published by the
+ *Free Software Foundation; either version 2,
+ *or (at your option) any later version.
+ *
+ *Nemiver is distributed in the hope that it will
+ *be useful, but WITHOUT ANY WARRANTY;
+ *without even the implied warranty of
+ *MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *See the GNU General Public License for more details.
+ *
+ *You should have received a copy of the
+ *GNU General Public License along with Nemiver;
+ *see the file COPYING.
+ *If not, write to the Free Software Foundation,
+ *Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *See COPYRIGHT file copyright information.
+ */
+#ifndef __NMV_VARS_SEARCH_BAR_H__
+#define __NMV_VARS_SEARCH_BAR_H__
+
+#include <gtkmm/box.h>
+#include <gtkmm/treeview.h>
+#include <gtkmm/treestore.h>
+#include "common/nmv-safe-ptr-utils.h"
+#include "common/nmv-ustring.h"
+#include "nmv-i-debugger.h"
+
+NEMIVER_BEGIN_NAMESPACE (nemiver)
+
+using nemiver::common::UString;
+
+class ChildPrefetcher;
+
+/// A search box for a tree of variables.
+///
+/// Typing in the box looks for the text in the names and values of
+/// the rows that are already in the tree, expanded or not, and jumps
+/// to the first match.  Pressing Enter jumps to the next one.
+///
+/// When "Deep" is checked, pressing Enter, or checking it, then goes
+/// on with the search by fetching the members of the variables that
+/// haven't been fetched yet, through a ChildPrefetcher, one variable
+/// at a time and at most DEFAULT_MAX_DEPTH levels below the rows
+/// already fetched.  Typing never starts that walk by itself.  It
+/// shows its progress and can be stopped; it is also stopped when
+/// the inferior resumes.
+///
+/// The tree is expected to use the columns of
+/// variables_utils2::get_variable_columns.
+class NEMIVER_API VarsSearchBar : public Gtk::Box {
+    //non copyable
+    VarsSearchBar (const VarsSearchBar&);
+    VarsSearchBar& operator= (const VarsSearchBar&);
+
+    struct Priv;
+    SafePtr<Priv> m_priv;
+
+public:
+
+    /// How many levels of members the deep search fetches below the
+    /// rows already in the tree.
+    static const unsigned DEFAULT_MAX_DEPTH = 4;
+
+    /// How many variables the deep search unfolds at most.
+    static const unsigned DEFAULT_MAX_NB_UNFOLDS = 512;
+
+    VarsSearchBar (Gtk::TreeView &a_tree_view,
+                   const Glib::RefPtr<Gtk::TreeStore> &a_tree_store,
+                   IDebugger *a_debugger = 0,
+                   ChildPrefetcher *a_unfolder = 0);
+    virtual ~VarsSearchBar ();
+
+    void search (const UString &a_text);
+    bool next_match ();
+    unsigned nb_matches () const;
+    void cancel_deep_search ();
+};//end VarsSearchBar
+
+NEMIVER_END_NAMESPACE (nemiver)
+
+#endif //__NMV_VARS_SEARCH_BAR_H__
@@ -1,6 +1,6 @@
 create table schemainfo (version text not null) ;
 
-insert into schemainfo (version) values ('1.5') ;
+insert into schemainfo (version) values ('1.6') ;
 
 create table sessions (id integer primary key) ;
 
@@ -22,7 +22,8 @@ create table breakpoints (id integer primary key,
                           enabled integer,
                           condition text,
                           ignorecount integer,
-			  iscountpoint integer) ;
+			  iscountpoint integer,
+                          threadid integer) ;
 
 create table watchpoints (id integer primary key,
                           sessionid integer,
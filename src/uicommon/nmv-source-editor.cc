@@ -24,7 +24,10 @@
  */
 #include "config.h"
 #include <map>
+#include <algorithm>
+#include <cctype>
 #include <glib/gi18n.h>
+#include <gdkmm/general.h>
 #include <gtkmm/table.h>
 #include <gtkmm/label.h>
 #include <gtkmm/scrolledwindow.h>
@@ -55,6 +58,14 @@ const char* WHERE_CATEGORY = "line-pointer-category";
 
 const char* WHERE_MARK = "where-marker";
 
+// How many lines before and after the current execution point get
+// the values of their variables displayed, when inline values are
+// shown.
+static const int INLINE_VALUES_NB_LINES_BEFORE = 8;
+static const int INLINE_VALUES_NB_LINES_AFTER = 8;
+// The maximum length of a value displayed inline.
+static const unsigned INLINE_VALUE_MAX_LENGTH = 40;
+
 void
 on_line_mark_activated_signal (GtkSourceView *a_view,
                                GtkTextIter *a_iter,
@@ -233,6 +244,14 @@ struct SourceEditor::Priv {
 
     sigc::signal<void, const Gtk::TextBuffer::iterator&>
                                                     insertion_changed_signal;
+    bool show_inline_values;
+    SourceEditor::InlineValuesSlot inline_values_provider;
+    // The annotations drawn at the end of the lines around the where
+    // marker, keyed by line.  They are rebuilt only when the values
+    // or the where marker change, not at each draw.
+    std::map<int, UString> inline_annotations;
+    bool inline_annotations_valid;
+    int inline_annotations_where_line;
 
 
     void
@@ -566,9 +585,144 @@ struct SourceEditor::Priv {
     //</signal slots>
     //**************
 
+    /// Draw the annotations of the visible lines that are around the
+    /// where marker, at the end of those lines.  The annotations are
+    /// only rebuilt when the where marker moved or after
+    /// invalidate_inline_annotations: nothing is queried from the
+    /// debugger here.
+    bool
+    on_draw_inline_values (const Cairo::RefPtr<Cairo::Context> &a_cr)
+    {
+        NEMIVER_TRY
+
+        if (!show_inline_values
+            || !inline_values_provider
+            || get_buffer_type () != SourceEditor::BUFFER_TYPE_SOURCE)
+            return false;
+
+        Glib::RefPtr<Gdk::Window> text_window =
+            source_view->get_window (Gtk::TEXT_WINDOW_TEXT);
+        if (!text_window
+            || !gtk_cairo_should_draw_window (a_cr->cobj (),
+                                              text_window->gobj ()))
+            return false;
+
+        Glib::RefPtr<Buffer> buf = source_view->get_source_buffer ();
+        Glib::RefPtr<Gtk::TextMark> where_marker = buf->get_mark (WHERE_MARK);
+        if (!where_marker || where_marker->get_deleted ())
+            return false;
+        int where_line = where_marker->get_iter ().get_line ();
+
+        if (!inline_annotations_valid
+            || where_line != inline_annotations_where_line)
+            build_inline_annotations (where_line);
+        if (inline_annotations.empty ())
+            return false;
+
+        // Only draw the annotations of the lines that are on screen.
+        Gdk::Rectangle visible;
+        source_view->get_visible_rect (visible);
+        Gtk::TextIter first, last;
+        int line_top = 0;
+        source_view->get_line_at_y (first, visible.get_y (), line_top);
+        source_view->get_line_at_y (last,
+                                    visible.get_y () + visible.get_height (),
+                                    line_top);
+        std::map<int, UString>::const_iterator it =
+            inline_annotations.lower_bound (first.get_line ());
+        if (it == inline_annotations.end ()
+            || it->first > last.get_line ())
+            return false;
+
+        a_cr->save ();
+        gtk_cairo_transform_to_window (a_cr->cobj (),
+                                       GTK_WIDGET (source_view->gobj ()),
+                                       text_window->gobj ());
+        Gdk::RGBA color = source_view->get_style_context ()->get_color
+                                                (Gtk::STATE_FLAG_INSENSITIVE);
+        Gdk::Cairo::set_source_rgba (a_cr, color);
+        // Leave a gap of about four characters after the code.
+        int gap = 0, gap_height = 0;
+        source_view->create_pango_layout ("    ")->get_pixel_size
+                                                        (gap, gap_height);
+
+        for (;
+             it != inline_annotations.end ()
+                 && it->first <= last.get_line ();
+             ++it) {
+            Gtk::TextIter end = buf->get_iter_at_line (it->first);
+            if (!end.ends_line ())
+                end.forward_to_line_end ();
+            Gdk::Rectangle rect;
+            source_view->get_iter_location (end, rect);
+            int x = 0, y = 0;
+            source_view->buffer_to_window_coords (Gtk::TEXT_WINDOW_TEXT,
+                                                  rect.get_x (),
+                                                  rect.get_y (),
+                                                  x, y);
+            Glib::RefPtr<Pango::Layout> layout =
+                source_view->create_pango_layout (it->second);
+            a_cr->move_to (x + gap, y);
+            layout->show_in_cairo_context (a_cr);
+        }
+        a_cr->restore ();
+
+        NEMIVER_CATCH
+
+        return false;
+    }
+
+    /// Rebuild the annotations of the lines around a_where_line from
+    /// the values returned by inline_values_provider.
+    void
+    build_inline_annotations (int a_where_line)
+    {
+        inline_annotations.clear ();
+        inline_annotations_valid = true;
+        inline_annotations_where_line = a_where_line;
+
+        std::map<UString, UString> values;
+        if (!inline_values_provider (values) || values.empty ())
+            return;
+
+        Glib::RefPtr<Buffer> buf = source_view->get_source_buffer ();
+        int from = std::max (0, a_where_line - INLINE_VALUES_NB_LINES_BEFORE);
+        int to = std::min (buf->get_line_count () - 1,
+                           a_where_line + INLINE_VALUES_NB_LINES_AFTER);
+        for (int line = from; line <= to; ++line) {
+            Gtk::TextIter begin = buf->get_iter_at_line (line);
+            Gtk::TextIter end = begin;
+            if (!end.ends_line ())
+                end.forward_to_line_end ();
+            UString annotation;
+            SourceEditor::build_inline_values_annotation
+                                    (buf->get_text (begin, end),
+                                     values, annotation);
+            if (!annotation.empty ())
+                inline_annotations[line] = annotation;
+        }
+    }
+
+    void
+    invalidate_inline_annotations ()
+    {
+        inline_annotations_valid = false;
+    }
+
+    void
+    on_buffer_changed_signal ()
+    {
+        NEMIVER_TRY
+        invalidate_inline_annotations ();
+        NEMIVER_CATCH
+    }
+
     void
     init_signals ()
     {
+        source_view->signal_draw ().connect
+            (sigc::mem_fun (*this, &SourceEditor::Priv::on_draw_inline_values),
+             true /* after the text */);
         source_view->marker_region_got_clicked_signal ().connect
             (sigc::mem_fun (*this,
                             &SourceEditor::Priv::on_marker_region_got_clicked));
@@ -585,6 +739,9 @@ struct SourceEditor::Priv {
             (sigc::mem_fun (*this, &SourceEditor::Priv::on_mark_set_signal));
         a_buf->signal_insert ().connect
             (sigc::mem_fun (*this, &SourceEditor::Priv::on_signal_insert));
+        a_buf->signal_changed ().connect
+            (sigc::mem_fun (*this,
+                            &SourceEditor::Priv::on_buffer_changed_signal));
         a_buf->signal_mark_set ().connect
             (sigc::mem_fun (*this, &SourceEditor::Priv::on_signal_mark_set));
     }
@@ -716,7 +873,10 @@ struct SourceEditor::Priv {
         source_view (Gtk::manage (new SourceView)),
         line_col_label (Gtk::manage (new Gtk::Label)),
         status_box (Gtk::manage (new Gtk::Box (Gtk::ORIENTATION_HORIZONTAL))),
-        non_asm_ctxt (-1, -1)
+        non_asm_ctxt (-1, -1),
+        show_inline_values (false),
+        inline_annotations_valid (false),
+        inline_annotations_where_line (-1)
 
     {
         init ();
@@ -731,7 +891,10 @@ struct SourceEditor::Priv {
         source_view (Gtk::manage (new SourceView (a_buf))),
         line_col_label (Gtk::manage (new Gtk::Label)),
         status_box (Gtk::manage (new Gtk::Box (Gtk::ORIENTATION_HORIZONTAL))),
-        non_asm_ctxt (-1, -1)
+        non_asm_ctxt (-1, -1),
+        show_inline_values (false),
+        inline_annotations_valid (false),
+        inline_annotations_where_line (-1)
     {
         Glib::RefPtr<Buffer> b;
         b = (a_buf) ? a_buf : source_view->get_source_buffer ();
@@ -750,7 +913,10 @@ struct SourceEditor::Priv {
         parent_window (a_parent_window),
         source_view (Gtk::manage (new SourceView (a_buf))),
         status_box (Gtk::manage (new Gtk::Box (Gtk::ORIENTATION_HORIZONTAL))),
-        non_asm_ctxt (-1, -1)
+        non_asm_ctxt (-1, -1),
+        show_inline_values (false),
+        inline_annotations_valid (false),
+        inline_annotations_where_line (-1)
     {
         Glib::RefPtr<Buffer> b;
         b = (a_buf) ? a_buf : source_view->get_source_buffer ();
@@ -808,6 +974,96 @@ SourceEditor::SourceEditor (Gtk::Window &a_parent_window,
     init ();
 }
 
+/// Show or hide the values of the variables used by the lines that
+/// surround the where marker, at the end of those lines.
+///
+/// \param a_show true to show the values, false to hide them.
+void
+SourceEditor::show_inline_values (bool a_show)
+{
+    if (m_priv->show_inline_values == a_show)
+        return;
+    m_priv->show_inline_values = a_show;
+    refresh_inline_values ();
+}
+
+/// \return true if the values of the variables are shown inline.
+bool
+SourceEditor::show_inline_values () const
+{
+    return m_priv->show_inline_values;
+}
+
+/// Set the slot the values shown inline come from.  It is called
+/// when the where marker moves or after refresh_inline_values, from
+/// the draw handler, so it must not query the debugger.
+void
+SourceEditor::set_inline_values_provider (const InlineValuesSlot &a_slot)
+{
+    m_priv->inline_values_provider = a_slot;
+    refresh_inline_values ();
+}
+
+/// Rebuild and redraw the values shown inline.  To be called
+/// whenever the values returned by the provider change.
+void
+SourceEditor::refresh_inline_values ()
+{
+    m_priv->invalidate_inline_annotations ();
+    source_view ().queue_draw ();
+}
+
+/// Build the text displayed at the end of a line, e.g
+/// "i = 3, count = 12", from the identifiers of the line that have a
+/// value.  Identifiers preceded by '.' or "->" are members of
+/// something else, so they are not considered.
+///
+/// \param a_line_text the text of the line.
+///
+/// \param a_values the values of the variables, keyed by their names.
+///
+/// \param a_annotation the resulting annotation.  It is left empty if
+/// no identifier of the line has a value.
+void
+SourceEditor::build_inline_values_annotation
+                            (const UString &a_line_text,
+                             const std::map<UString, UString> &a_values,
+                             UString &a_annotation)
+{
+    const std::string &text = a_line_text.raw ();
+    std::list<std::string> seen;
+    std::string::size_type i = 0;
+    while (i < text.size ()) {
+        unsigned char c = text[i];
+        if (!isalpha (c) && c != '_') {
+            ++i;
+            continue;
+        }
+        std::string::size_type start = i;
+        while (i < text.size ()
+               && (isalnum ((unsigned char) text[i]) || text[i] == '_'))
+            ++i;
+        if ((start > 0 && text[start - 1] == '.')
+            || (start > 1
+                && text[start - 1] == '>'
+                && text[start - 2] == '-'))
+            continue;
+        std::string name = text.substr (start, i - start);
+        if (std::find (seen.begin (), seen.end (), name) != seen.end ())
+            continue;
+        seen.push_back (name);
+        std::map<UString, UString>::const_iterator v = a_values.find (name);
+        if (v == a_values.end () || v->second.empty ())
+            continue;
+        UString value = v->second;
+        if (value.size () > INLINE_VALUE_MAX_LENGTH)
+            value = value.substr (0, INLINE_VALUE_MAX_LENGTH) + "...";
+        if (!a_annotation.empty ())
+            a_annotation += ", ";
+        a_annotation += name + " = " + value;
+    }
+}
+
 SourceEditor::~SourceEditor ()
 {
     LOG_D ("deleted", "destructor-domain");
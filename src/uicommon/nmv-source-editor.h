@@ -203,6 +203,26 @@ public:
 
     /// @}
 
+    /// \name Inline values of variables.
+    /// @{
+
+    /// A slot that fills its argument with the current values of
+    /// variables, keyed by their names.  It returns false if no
+    /// value is available, e.g because the inferior is running.
+    typedef sigc::slot<bool, std::map<UString, UString>&>
+                                                    InlineValuesSlot;
+
+    void show_inline_values (bool a_show);
+    bool show_inline_values () const;
+    void set_inline_values_provider (const InlineValuesSlot &a_slot);
+    void refresh_inline_values ();
+    static void build_inline_values_annotation
+                        (const UString &a_line_text,
+                         const std::map<UString, UString> &a_values,
+                         UString &a_annotation);
+
+    /// @}
+
     /// \name signals
     /// @{
     sigc::signal<void,
@@ -0,0 +1,49 @@
+#include <pthread.h>
+
+// Three threads end up blocked on two mutexes: the first two
+// deadlock, each holding the mutex the other one wants, and the
+// third one waits on the mutex of the first one.  The main thread
+// waits for them forever.
+
+pthread_mutex_t mutex_a = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t mutex_b = PTHREAD_MUTEX_INITIALIZER;
+pthread_barrier_t barrier;
+
+void*
+lock_a_then_b (void *)
+{
+    pthread_mutex_lock (&mutex_a);
+    pthread_barrier_wait (&barrier);
+    pthread_mutex_lock (&mutex_b);
+    return NULL;
+}
+
+void*
+lock_b_then_a (void *)
+{
+    pthread_mutex_lock (&mutex_b);
+    pthread_barrier_wait (&barrier);
+    pthread_mutex_lock (&mutex_a);
+    return NULL;
+}
+
+void*
+lock_a (void *)
+{
+    pthread_barrier_wait (&barrier);
+    pthread_mutex_lock (&mutex_a);
+    return NULL;
+}
+
+int
+main ()
+{
+    pthread_t threads[3];
+    pthread_barrier_init (&barrier, NULL, 3);
+    pthread_create (&threads[0], NULL, &lock_a_then_b, NULL);
+    pthread_create (&threads[1], NULL, &lock_b_then_a, NULL);
+    pthread_create (&threads[2], NULL, &lock_a, NULL);
+    for (int i = 0; i < 3; ++i)
+        pthread_join (threads[i], NULL);
+    return 0;
+}
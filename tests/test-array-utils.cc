@@ -0,0 +1,179 @@
+#include "config.h"
+#include <iostream>
+#include <cstring>
+#include <boost/test/minimal.hpp>
+#include "common/nmv-initializer.h"
+#include "common/nmv-exception.h"
+#include "nmv-array-utils.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+using namespace nemiver::array_utils;
+
+template<class T>
+static std::vector<uint8_t>
+to_bytes (const T *a_elems, size_t a_nb_elems)
+{
+    std::vector<uint8_t> bytes (a_nb_elems * sizeof (T));
+    memcpy (&bytes[0], a_elems, bytes.size ());
+    return bytes;
+}
+
+static void
+test_element_kinds ()
+{
+    BOOST_REQUIRE (element_type_to_kind ("double") == ELEMENT_KIND_FLOAT);
+    BOOST_REQUIRE (element_type_to_kind ("const float") == ELEMENT_KIND_FLOAT);
+    BOOST_REQUIRE (element_type_to_kind ("int") == ELEMENT_KIND_SIGNED);
+    BOOST_REQUIRE (element_type_to_kind ("long long") == ELEMENT_KIND_SIGNED);
+    BOOST_REQUIRE (element_type_to_kind ("unsigned char")
+                   == ELEMENT_KIND_UNSIGNED);
+    BOOST_REQUIRE (element_type_to_kind ("bool") == ELEMENT_KIND_UNSIGNED);
+    BOOST_REQUIRE (element_type_to_kind ("long double")
+                   == ELEMENT_KIND_UNSUPPORTED);
+    BOOST_REQUIRE (element_type_to_kind ("char *") == ELEMENT_KIND_UNSUPPORTED);
+    BOOST_REQUIRE (element_type_to_kind ("struct {...}")
+                   == ELEMENT_KIND_UNSUPPORTED);
+
+    size_t address = 0;
+    BOOST_REQUIRE (parse_address ("(double (*)[10]) 0x601040 <samples>",
+                                  address));
+    BOOST_REQUIRE (address == 0x601040);
+    BOOST_REQUIRE (!parse_address ("<optimized out>", address));
+}
+
+static void
+test_layouts ()
+{
+    ArrayLayout layout;
+    UString error;
+
+    BOOST_REQUIRE (type_to_array_layout ("samples", "double [500][2]",
+                                         layout, error));
+    BOOST_REQUIRE (layout.elem_type == "double");
+    BOOST_REQUIRE (layout.elem_kind == ELEMENT_KIND_FLOAT);
+    BOOST_REQUIRE (layout.nb_declared_elems == 1000);
+    BOOST_REQUIRE (layout.address_expr == "&(samples)");
+    BOOST_REQUIRE (layout.elem_size_expr == "sizeof (double)");
+    BOOST_REQUIRE (layout.count_expr.empty ());
+
+    BOOST_REQUIRE (type_to_array_layout ("p", "const short *",
+                                         layout, error));
+    BOOST_REQUIRE (layout.elem_kind == ELEMENT_KIND_SIGNED);
+    BOOST_REQUIRE (layout.address_expr == "p");
+    BOOST_REQUIRE (layout.nb_declared_elems == 0);
+    BOOST_REQUIRE (layout.count_expr.empty ());
+
+    BOOST_REQUIRE (type_to_array_layout
+                    ("v", "std::vector<float, std::allocator<float> >",
+                     layout, error));
+    BOOST_REQUIRE (layout.elem_type == "float");
+    BOOST_REQUIRE (layout.address_expr == "(v)._M_impl._M_start");
+    BOOST_REQUIRE (layout.count_expr
+                   == "(v)._M_impl._M_finish - (v)._M_impl._M_start");
+
+    // The elements of a std::vector<bool> are the bits of its words.
+    BOOST_REQUIRE (type_to_array_layout
+                    ("flags", "std::vector<bool, std::allocator<bool> >",
+                     layout, error));
+    BOOST_REQUIRE (layout.elem_type == "bool");
+    BOOST_REQUIRE (layout.elem_kind == ELEMENT_KIND_BIT);
+    BOOST_REQUIRE (layout.address_expr == "(flags)._M_impl._M_start._M_p");
+    BOOST_REQUIRE (layout.elem_size_expr
+                   == "sizeof (*(flags)._M_impl._M_start._M_p)");
+    BOOST_REQUIRE (layout.count_expr.find ("_M_finish._M_offset")
+                   != std::string::npos);
+
+    BOOST_REQUIRE (!type_to_array_layout ("s", "struct foo", layout, error));
+    BOOST_REQUIRE (!error.empty ());
+    error.clear ();
+    BOOST_REQUIRE (!type_to_array_layout ("a", "long double [4]",
+                                          layout, error));
+    BOOST_REQUIRE (!error.empty ());
+}
+
+static void
+test_decoding ()
+{
+    int ints[] = {-3, 7, 0, 42};
+    std::vector<uint8_t> data = to_bytes (ints, 4);
+    std::vector<double> values;
+    for (size_t i = 0; i < 4; ++i)
+        values.push_back (element_as_double (ELEMENT_KIND_SIGNED,
+                                             sizeof (int), data, i));
+    BOOST_REQUIRE (values[0] == -3 && values[3] == 42);
+    BOOST_REQUIRE (format_element (ELEMENT_KIND_SIGNED, sizeof (int),
+                                   data, 0) == "-3");
+
+    double min = 0, max = 0, mean = 0;
+    compute_stats (values, min, max, mean);
+    BOOST_REQUIRE (min == -3 && max == 42 && mean == 11.5);
+    compute_stats (std::vector<double> (), min, max, mean);
+    BOOST_REQUIRE (min == 0 && max == 0 && mean == 0);
+
+    // 64 bits integers are formatted without going through a double.
+    uint64_t big[] = {18446744073709551615ULL};
+    data = to_bytes (big, 1);
+    BOOST_REQUIRE (format_element (ELEMENT_KIND_UNSIGNED, 8, data, 0)
+                   == "18446744073709551615");
+
+    float floats[] = {0.5f, -1.25f};
+    data = to_bytes (floats, 2);
+    BOOST_REQUIRE (element_as_double (ELEMENT_KIND_FLOAT, sizeof (float),
+                                      data, 1) == -1.25);
+
+    BOOST_REQUIRE (storage_size (ELEMENT_KIND_FLOAT, 8, 10) == 80);
+    BOOST_REQUIRE (max_nb_elems (ELEMENT_KIND_FLOAT, 8, 85) == 10);
+}
+
+static void
+test_bits ()
+{
+    // 70 bits in 64 bits words: bits 0, 3, 63, 64 and 69 are set.
+    uint64_t words[] = {(1ULL << 63) | (1ULL << 3) | 1ULL,
+                        (1ULL << 5) | 1ULL};
+    std::vector<uint8_t> data = to_bytes (words, 2);
+
+    BOOST_REQUIRE (storage_size (ELEMENT_KIND_BIT, 8, 70) == 16);
+    BOOST_REQUIRE (storage_size (ELEMENT_KIND_BIT, 8, 64) == 8);
+    BOOST_REQUIRE (storage_size (ELEMENT_KIND_BIT, 8, 0) == 0);
+    BOOST_REQUIRE (max_nb_elems (ELEMENT_KIND_BIT, 8, 20) == 128);
+
+    std::vector<double> values;
+    for (size_t i = 0; i < 70; ++i) {
+        double v = element_as_double (ELEMENT_KIND_BIT, 8, data, i);
+        bool expected = i == 0 || i == 3 || i == 63 || i == 64 || i == 69;
+        BOOST_REQUIRE (v == (expected ? 1 : 0));
+        values.push_back (v);
+    }
+    BOOST_REQUIRE (format_element (ELEMENT_KIND_BIT, 8, data, 63) == "true");
+    BOOST_REQUIRE (format_element (ELEMENT_KIND_BIT, 8, data, 62) == "false");
+
+    double min = 0, max = 0, mean = 0;
+    compute_stats (values, min, max, mean);
+    BOOST_REQUIRE (min == 0 && max == 1 && mean == 5.0 / 70);
+
+    // Words of 32 bits.
+    uint32_t small_words[] = {1U << 31, 1U};
+    data = to_bytes (small_words, 2);
+    BOOST_REQUIRE (element_as_double (ELEMENT_KIND_BIT, 4, data, 31) == 1);
+    BOOST_REQUIRE (element_as_double (ELEMENT_KIND_BIT, 4, data, 32) == 1);
+    BOOST_REQUIRE (element_as_double (ELEMENT_KIND_BIT, 4, data, 33) == 0);
+}
+
+NEMIVER_API int
+test_main (int, char *[])
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+
+    test_element_kinds ();
+    test_layouts ();
+    test_decoding ();
+    test_bits ();
+
+    NEMIVER_CATCH_NOX;
+
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include "config.h"
+#include <iostream>
+#include <boost/test/minimal.hpp>
+#include <glibmm.h>
+#include "common/nmv-initializer.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "common/nmv-exception.h"
+#include "nmv-i-debugger.h"
+#include "nmv-debugger-utils.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+
+// Restore as many breakpoints as a big session can hold, some of
+// them disabled, plus a watchpoint.  Then disable, re-enable and
+// delete them all, and report how long each step takes.
+static const unsigned NB_BREAKPOINTS = 1000;
+// One breakpoint out of this many is restored disabled.
+static const unsigned DISABLED_EVERY = 10;
+
+static Glib::RefPtr<Glib::MainLoop> loop =
+    Glib::MainLoop::create (Glib::MainContext::get_default ());
+
+enum Step {
+    SETTING,
+    DISABLING,
+    ENABLING,
+    DELETING,
+    DONE
+};
+
+static Step step = SETTING;
+static Glib::Timer timer;
+static vector<string> bp_ids;
+static unsigned nb_set_disabled = 0;
+static bool watchpoint_set = false;
+static unsigned nb_disabled = 0;
+static unsigned nb_enabled = 0;
+static unsigned nb_deleted = 0;
+
+static void
+report_step (const char *a_step)
+{
+    MESSAGE (a_step << " " << NB_BREAKPOINTS << " breakpoints in "
+             << timer.elapsed () << "s");
+    timer.start ();
+}
+
+static void
+on_engine_died_signal ()
+{
+    MESSAGE ("engine died");
+    loop->quit ();
+}
+
+static void
+on_breakpoints_set_signal (const std::map<string, IDebugger::Breakpoint> &a_breaks,
+                           const UString &/*a_cookie*/)
+{
+    std::map<string, IDebugger::Breakpoint>::const_iterator it;
+    for (it = a_breaks.begin (); it != a_breaks.end (); ++it) {
+        bp_ids.push_back (it->first);
+        // Disabled breakpoints are inserted disabled right away.
+        if (!it->second.enabled ())
+            ++nb_set_disabled;
+    }
+}
+
+/// The breakpoints are listed once all of them are set, because of
+/// the watchpoint.
+static void
+on_breakpoints_list_signal (const std::map<string, IDebugger::Breakpoint> &a_breaks,
+                            const UString &/*a_cookie*/,
+                            IDebuggerSafePtr &a_debugger)
+{
+    if (step != SETTING)
+        return;
+
+    BOOST_REQUIRE (bp_ids.size () == NB_BREAKPOINTS);
+    unsigned nb_cached_disabled = 0;
+    std::map<string, IDebugger::Breakpoint>::const_iterator it;
+    for (it = a_breaks.begin (); it != a_breaks.end (); ++it) {
+        if (it->second.type () == IDebugger::Breakpoint::WATCHPOINT_TYPE)
+            watchpoint_set = true;
+        else if (!it->second.enabled ())
+            ++nb_cached_disabled;
+    }
+    BOOST_REQUIRE (watchpoint_set);
+    BOOST_REQUIRE (nb_cached_disabled == NB_BREAKPOINTS / DISABLED_EVERY);
+
+    report_step ("set");
+    step = DISABLING;
+    a_debugger->disable_breakpoints (bp_ids);
+}
+
+static void
+on_breakpoint_modified_signal (const IDebugger::Breakpoint &a_break,
+                               const string &/*a_break_number*/,
+                               const UString &/*a_cookie*/,
+                               IDebuggerSafePtr &a_debugger)
+{
+    if (step == DISABLING) {
+        BOOST_REQUIRE (!a_break.enabled ());
+        if (++nb_disabled == NB_BREAKPOINTS) {
+            report_step ("disabled");
+            step = ENABLING;
+            a_debugger->enable_breakpoints (bp_ids);
+        }
+    } else if (step == ENABLING) {
+        BOOST_REQUIRE (a_break.enabled ());
+        if (++nb_enabled == NB_BREAKPOINTS) {
+            report_step ("enabled");
+            IDebugger::Breakpoint bp;
+            vector<string>::const_iterator it;
+            for (it = bp_ids.begin (); it != bp_ids.end (); ++it) {
+                BOOST_REQUIRE (a_debugger->get_breakpoint_from_cache (*it,
+                                                                     bp));
+                BOOST_REQUIRE (bp.enabled ());
+            }
+            step = DELETING;
+            a_debugger->delete_breakpoints (bp_ids);
+        }
+    }
+}
+
+static void
+on_breakpoint_deleted_signal (const IDebugger::Breakpoint &/*a_break*/,
+                              const string &/*a_break_number*/,
+                              const UString &/*a_cookie*/)
+{
+    if (step != DELETING)
+        return;
+    if (++nb_deleted == NB_BREAKPOINTS) {
+        report_step ("deleted");
+        step = DONE;
+        loop->quit ();
+    }
+}
+
+static bool
+on_timeout ()
+{
+    MESSAGE ("timed out after " << bp_ids.size () << " breakpoints set, "
+             << nb_disabled << " disabled, " << nb_enabled << " enabled, "
+             << nb_deleted << " deleted");
+    loop->quit ();
+    return false;
+}
+
+NEMIVER_API int
+test_main (int, char *[])
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+
+    THROW_IF_FAIL (loop);
+
+    IDebuggerSafePtr debugger =
+        debugger_utils::load_debugger_iface_with_confmgr ();
+
+    debugger->set_event_loop_context (loop->get_context ());
+
+    debugger->engine_died_signal ().connect (&on_engine_died_signal);
+
+    debugger->breakpoints_set_signal ().connect
+        (&on_breakpoints_set_signal);
+
+    debugger->breakpoints_list_signal ().connect
+        (sigc::bind (&on_breakpoints_list_signal, debugger));
+
+    debugger->breakpoint_modified_signal ().connect
+        (sigc::bind (&on_breakpoint_modified_signal, debugger));
+
+    debugger->breakpoint_deleted_signal ().connect
+        (&on_breakpoint_deleted_signal);
+
+    std::vector<UString> args, source_search_dir;
+    source_search_dir.push_back (".");
+    debugger->load_program ("fooprog", args, ".",
+                            source_search_dir, "",
+                            false);
+
+    // GDB accepts several breakpoints at the same location, so set
+    // them all in the few lines of func1 and func2.
+    static const int lines[] = {13, 14, 15, 21, 22, 23};
+    vector<IDebugger::Breakpoint> breaks (NB_BREAKPOINTS);
+    for (unsigned i = 0; i < NB_BREAKPOINTS; ++i) {
+        breaks[i].type (IDebugger::Breakpoint::STANDARD_BREAKPOINT_TYPE);
+        breaks[i].file_name ("fooprog.cc");
+        breaks[i].line (lines[i % (sizeof (lines) / sizeof (lines[0]))]);
+        breaks[i].enabled (i % DISABLED_EVERY != 0);
+    }
+    IDebugger::Breakpoint watchpoint;
+    watchpoint.type (IDebugger::Breakpoint::WATCHPOINT_TYPE);
+    watchpoint.expression ("i");
+    watchpoint.is_write_watchpoint (true);
+    watchpoint.enabled (true);
+    breaks.push_back (watchpoint);
+
+    timer.start ();
+    debugger->set_breakpoints (breaks);
+
+    Glib::signal_timeout ().connect (&on_timeout, 120000);
+    loop->run ();
+
+    BOOST_REQUIRE (bp_ids.size () == NB_BREAKPOINTS);
+    BOOST_REQUIRE (nb_set_disabled == NB_BREAKPOINTS / DISABLED_EVERY);
+    BOOST_REQUIRE (watchpoint_set);
+    BOOST_REQUIRE (nb_disabled == NB_BREAKPOINTS);
+    BOOST_REQUIRE (nb_enabled == NB_BREAKPOINTS);
+    BOOST_REQUIRE (step == DONE);
+    // Only the watchpoint is left.
+    BOOST_REQUIRE (debugger->get_cached_breakpoints ().size () == 1);
+
+    NEMIVER_CATCH_NOX;
+
+    return 0;
+}
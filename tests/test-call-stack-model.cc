@@ -0,0 +1,178 @@
+#include "config.h"
+#include <iostream>
+#include <boost/test/minimal.hpp>
+#include <gtkmm/main.h>
+#include "common/nmv-initializer.h"
+#include "common/nmv-exception.h"
+#include "nmv-call-stack-model.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+
+/// Build the frames of the levels [a_first, a_last], which functions
+/// are given by a_functions, one character per level, e.g "fgggh".
+static void
+make_frames (int a_first,
+             int a_last,
+             const std::string &a_functions,
+             std::vector<IDebugger::Frame> &a_frames)
+{
+    a_frames.clear ();
+    for (int level = a_first; level <= a_last; ++level) {
+        IDebugger::Frame frame;
+        frame.level (level);
+        frame.function_name (std::string (1, a_functions[level]));
+        frame.file_name ("foo.cc");
+        frame.line (level + 1);
+        a_frames.push_back (frame);
+    }
+}
+
+static Glib::ustring
+function_name_of_row (const Glib::RefPtr<CallStackModel> &a_model, int a_row)
+{
+    Gtk::TreeModel::iterator it = a_model->children ()[a_row];
+    BOOST_REQUIRE (it);
+    return (*it)[get_call_stack_columns ().function_name];
+}
+
+// The runs of frames of g and of k are collapsed: the rows are
+// 0:f 1:g×3 2:h 3:k×2 4:m 5:n 6:main.
+static const std::string FUNCTIONS = "fggghkkmnM";
+
+static void
+test_rows_and_levels ()
+{
+    Glib::RefPtr<CallStackModel> model = CallStackModel::create ();
+    model->reset (FUNCTIONS.size ());
+    BOOST_REQUIRE (model->depth () == 10);
+    // Nothing is known about the frames yet: one row per level.
+    BOOST_REQUIRE (model->nb_rows () == 10);
+    for (int i = 0; i < 10; ++i) {
+        BOOST_REQUIRE (model->level_of_row (i) == i);
+        BOOST_REQUIRE (model->row_of_level (i) == i);
+    }
+    BOOST_REQUIRE (function_name_of_row (model, 4) == "...");
+
+    std::vector<IDebugger::Frame> frames;
+    make_frames (0, 9, FUNCTIONS, frames);
+    model->set_frames (frames);
+    BOOST_REQUIRE (model->nb_rows () == 7);
+
+    int row_of_levels[] = {0, 1, 1, 1, 2, 3, 3, 4, 5, 6};
+    for (int level = 0; level < 10; ++level)
+        BOOST_REQUIRE (model->row_of_level (level) == row_of_levels[level]);
+
+    int first_levels[] = {0, 1, 4, 5, 7, 8, 9};
+    int last_levels[] = {0, 3, 4, 6, 7, 8, 9};
+    for (int row = 0; row < 7; ++row) {
+        BOOST_REQUIRE (model->level_of_row (row) == first_levels[row]);
+        BOOST_REQUIRE (model->last_level_of_row (row) == last_levels[row]);
+    }
+
+    BOOST_REQUIRE (function_name_of_row (model, 0) == "f");
+    BOOST_REQUIRE (function_name_of_row (model, 1) == "g \xc3\x97" "3");
+    BOOST_REQUIRE (function_name_of_row (model, 3) == "k \xc3\x97" "2");
+    Gtk::TreeModel::iterator it = model->children ()[1];
+    Glib::ustring caption = (*it)[get_call_stack_columns ()
+                                                    .frame_index_caption];
+    BOOST_REQUIRE (caption == "1-3");
+    int nb_frames = (*it)[get_call_stack_columns ().nb_frames];
+    BOOST_REQUIRE (nb_frames == 3);
+
+    // One row per frame when the recursion isn't collapsed, and the
+    // runs come back when it is again.
+    model->collapse_recursion (false);
+    BOOST_REQUIRE (model->nb_rows () == 10);
+    BOOST_REQUIRE (model->row_of_level (3) == 3);
+    BOOST_REQUIRE (function_name_of_row (model, 2) == "g");
+    model->collapse_recursion (true);
+    BOOST_REQUIRE (model->nb_rows () == 7);
+    BOOST_REQUIRE (model->row_of_level (6) == 3);
+}
+
+static void
+test_runs_across_chunks ()
+{
+    Glib::RefPtr<CallStackModel> model = CallStackModel::create ();
+    model->reset (FUNCTIONS.size ());
+
+    // The run of g is cut in two by the chunks the frames are
+    // fetched in.
+    std::vector<IDebugger::Frame> frames;
+    make_frames (0, 2, FUNCTIONS, frames);
+    model->set_frames (frames);
+    BOOST_REQUIRE (model->nb_rows () == 9);
+    BOOST_REQUIRE (model->last_level_of_row (1) == 2);
+
+    make_frames (3, 9, FUNCTIONS, frames);
+    model->set_frames (frames);
+    BOOST_REQUIRE (model->nb_rows () == 7);
+    BOOST_REQUIRE (model->last_level_of_row (1) == 3);
+    BOOST_REQUIRE (model->level_of_row (2) == 4);
+}
+
+static void
+test_eviction ()
+{
+    const int depth = 3000;
+    std::string functions;
+    for (int i = 0; i < depth; ++i)
+        // Alternate between two functions so that no run forms.
+        functions += (i % 2) ? 'a' : 'b';
+
+    Glib::RefPtr<CallStackModel> model = CallStackModel::create ();
+    BOOST_REQUIRE (model->max_cached_frames ()
+                   == CallStackModel::DEFAULT_MAX_CACHED_FRAMES);
+    BOOST_REQUIRE (model->max_cached_frames () == 1024);
+    model->reset (depth);
+
+    // Scroll down the whole stack, a chunk at a time.
+    std::vector<IDebugger::Frame> frames;
+    for (int first = 0; first < depth; first += 100) {
+        make_frames (first, first + 99, functions, frames);
+        model->set_frames (frames);
+    }
+
+    std::vector<int> levels;
+    model->get_cached_levels (levels);
+    BOOST_REQUIRE (levels.size () == 1024);
+    // The frames the farthest from the last chunk went first.
+    BOOST_REQUIRE (levels.front () == depth - 1024);
+    BOOST_REQUIRE (levels.back () == depth - 1);
+    BOOST_REQUIRE (!model->has_frame (0));
+    BOOST_REQUIRE (model->has_frame (depth - 1));
+    // The rows of the evicted frames are still there.
+    BOOST_REQUIRE (model->nb_rows () == depth);
+    BOOST_REQUIRE (function_name_of_row (model, 0) == "...");
+
+    // The frames strictly inside a run are not kept.
+    std::string run = "fggggggh";
+    model->reset (run.size ());
+    make_frames (0, run.size () - 1, run, frames);
+    model->set_frames (frames);
+    model->get_cached_levels (levels);
+    BOOST_REQUIRE (levels.size () == 4);
+    BOOST_REQUIRE (model->has_frame (1));
+    BOOST_REQUIRE (!model->has_frame (3));
+    BOOST_REQUIRE (model->has_frame (6));
+    BOOST_REQUIRE (model->nb_rows () == 3);
+}
+
+NEMIVER_API int
+test_main (int, char *[])
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+    // The model is a GObject: no display is needed.
+    Gtk::Main::init_gtkmm_internals ();
+
+    test_rows_and_levels ();
+    test_runs_across_chunks ();
+    test_eviction ();
+
+    NEMIVER_CATCH_NOX;
+
+    return 0;
+}
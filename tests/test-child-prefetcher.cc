@@ -0,0 +1,323 @@
+#include "config.h"
+#include <iostream>
+#include <boost/test/minimal.hpp>
+#include <glibmm.h>
+#include <gtk/gtk.h>
+#include <gtkmm/main.h>
+#include <gtkmm/treeview.h>
+#include "nmv-i-debugger.h"
+#include "common/nmv-initializer.h"
+#include "common/nmv-exception.h"
+#include "nmv-debugger-utils.h"
+#include "nmv-child-prefetcher.h"
+#include "nmv-variables-utils.h"
+#include "test-utils.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+
+namespace vutil = nemiver::variables_utils2;
+
+static Glib::RefPtr<Glib::MainLoop> loop =
+    Glib::MainLoop::create (Glib::MainContext::get_default ());
+
+// The steps of the test.  Each of them starts at a stop in main,
+// once person is constructed.
+enum Phase {
+    // Stepping over the construction of person.
+    PHASE_START,
+    // With a budget of one member, only the first of two aggregates
+    // is prefetched.
+    PHASE_BUDGET,
+    // The inferior resumes while the first of two aggregates is
+    // prefetched: the second one is dropped.
+    PHASE_CANCEL,
+    // The user expands the row of an aggregate being prefetched: the
+    // prefetcher expands it once the members arrive.
+    PHASE_TAKE_OVER,
+    PHASE_DONE
+};
+
+static Phase phase = PHASE_START;
+static IDebuggerSafePtr debugger;
+static Glib::RefPtr<Gtk::TreeStore> tree_store;
+static SafePtr<Gtk::TreeView> tree_view;
+static SafePtr<ChildPrefetcher> prefetcher;
+static Gtk::TreeModel::iterator root_it;
+static int nb_varobjs_made = 0;
+// The varobj creation held back until the inferior stops again.
+static Gtk::TreeModel::Path held_path;
+static IDebugger::ConstVariableSlot held_slot;
+static bool took_over = false;
+
+static IDebugger::VariableSafePtr
+variable_of_row (int a_row)
+{
+    Gtk::TreeModel::iterator it = root_it->children ()[a_row];
+    BOOST_REQUIRE (it);
+    return (*it)[vutil::get_variable_columns ().variable];
+}
+
+static Gtk::TreeModel::Path
+path_of_row (int a_row)
+{
+    return tree_store->get_path (root_it->children ()[a_row]);
+}
+
+/// \return true if the members of the variable of the row a_row are
+/// shown.
+static bool
+row_is_unfolded (int a_row)
+{
+    Gtk::TreeModel::iterator it = root_it->children ()[a_row];
+    IDebugger::VariableSafePtr var = variable_of_row (a_row);
+    return !(*it)[vutil::get_variable_columns ().needs_unfolding]
+           && var
+           && !var->internal_name ().empty ()
+           && !var->members ().empty ();
+}
+
+/// \return true if the row a_row still shows the plain variable it
+/// was created with.
+static bool
+row_is_untouched (int a_row)
+{
+    Gtk::TreeModel::iterator it = root_it->children ()[a_row];
+    IDebugger::VariableSafePtr var = variable_of_row (a_row);
+    return (*it)[vutil::get_variable_columns ().needs_unfolding]
+           && var
+           && var->internal_name ().empty ();
+}
+
+/// Replace the rows under the root by two rows showing person as a
+/// plain variable, like the local variables inspector does.
+static void
+show_plain_variables ()
+{
+    Gtk::TreeModel::Children rows = root_it->children ();
+    for (Gtk::TreeModel::iterator it = rows.begin (); it != rows.end ();)
+        it = tree_store->erase (it);
+    for (int i = 0; i < 2; ++i) {
+        IDebugger::VariableSafePtr var
+                    (new IDebugger::Variable ("person", "", "Person"));
+        var->num_expected_children (1);
+        vutil::append_a_variable (var, *tree_view, root_it, false);
+    }
+    tree_view->expand_row (tree_store->get_path (root_it), false);
+    nb_varobjs_made = 0;
+}
+
+static void
+on_varobj_created (const IDebugger::VariableSafePtr a_varobj,
+                   Gtk::TreeRowReference a_row,
+                   IDebugger::ConstVariableSlot a_slot)
+{
+    NEMIVER_TRY
+
+    BOOST_REQUIRE (a_varobj);
+    BOOST_REQUIRE (a_row.is_valid ());
+    Gtk::TreeModel::iterator it = tree_store->get_iter (a_row.get_path ());
+    vutil::update_a_variable_node (a_varobj, *tree_view, it,
+                                   false /* do not truncate type */,
+                                   false /* do not highlight variable */,
+                                   false /* frame ain't new */);
+    a_slot (a_varobj);
+
+    NEMIVER_CATCH_NOX
+}
+
+static void
+create_varobj (const Gtk::TreeModel::Path &a_path,
+               const IDebugger::ConstVariableSlot &a_slot)
+{
+    Gtk::TreeModel::iterator it = tree_store->get_iter (a_path);
+    IDebugger::VariableSafePtr var =
+        (*it)[vutil::get_variable_columns ().variable];
+    debugger->create_variable
+        (var->name (),
+         sigc::bind (&on_varobj_created,
+                     Gtk::TreeRowReference (tree_store, a_path),
+                     a_slot));
+}
+
+/// The VarobjMaker of the prefetcher.
+static void
+make_varobj (const Gtk::TreeModel::Path &a_path,
+             const IDebugger::ConstVariableSlot &a_slot)
+{
+    NEMIVER_TRY
+
+    if (++nb_varobjs_made > 1) {
+        create_varobj (a_path, a_slot);
+        return;
+    }
+
+    // The first row goes first.
+    BOOST_REQUIRE (a_path == path_of_row (0));
+
+    if (phase == PHASE_CANCEL) {
+        held_path = a_path;
+        held_slot = a_slot;
+        debugger->step_over ();
+        return;
+    }
+
+    if (phase == PHASE_TAKE_OVER) {
+        // The row of an aggregate that is not being prefetched is
+        // left to the caller.
+        BOOST_REQUIRE (!prefetcher->take_over_expansion (variable_of_row (1),
+                                                         path_of_row (1)));
+        took_over = prefetcher->take_over_expansion (variable_of_row (0),
+                                                     a_path);
+        BOOST_REQUIRE (took_over);
+        BOOST_REQUIRE (!tree_view->row_expanded (a_path));
+    }
+
+    create_varobj (a_path, a_slot);
+
+    NEMIVER_CATCH_NOX
+}
+
+static void
+start_phase (Phase a_phase)
+{
+    phase = a_phase;
+    show_plain_variables ();
+    prefetcher->prefetch_children_of (tree_store->get_path (root_it));
+}
+
+/// Check the outcome of the current phase once the first row is
+/// unfolded, then go to the next phase.
+static bool
+on_poll ()
+{
+    NEMIVER_TRY
+
+    if (phase == PHASE_DONE)
+        return false;
+    if (phase == PHASE_START || !row_is_unfolded (0))
+        return true;
+
+    switch (phase) {
+        case PHASE_BUDGET:
+            // The backend object and the members of the first row
+            // used up the budget.
+            BOOST_REQUIRE (nb_varobjs_made == 1);
+            BOOST_REQUIRE (row_is_untouched (1));
+            // The budget is refilled at the next stop.  Until then,
+            // show rows that are not unfolded, so that the next poll
+            // waits.
+            prefetcher->child_budget (ChildPrefetcher::DEFAULT_CHILD_BUDGET);
+            phase = PHASE_CANCEL;
+            show_plain_variables ();
+            debugger->step_over ();
+            break;
+        case PHASE_CANCEL:
+            // The second row was dropped when the inferior resumed.
+            BOOST_REQUIRE (nb_varobjs_made == 1);
+            BOOST_REQUIRE (row_is_untouched (1));
+            start_phase (PHASE_TAKE_OVER);
+            break;
+        case PHASE_TAKE_OVER:
+            BOOST_REQUIRE (took_over);
+            BOOST_REQUIRE (tree_view->row_expanded (path_of_row (0)));
+            phase = PHASE_DONE;
+            debugger->do_continue ();
+            return false;
+        default:
+            break;
+    }
+
+    NEMIVER_CATCH_NOX
+
+    return true;
+}
+
+static void
+on_stopped_signal (IDebugger::StopReason a_reason,
+                   bool a_has_frame,
+                   const IDebugger::Frame &a_frame,
+                   int /*a_thread_id*/,
+                   const string& /*bp num*/,
+                   const UString &/*a_cookie*/)
+{
+    NEMIVER_TRY
+
+    if (a_reason == IDebugger::EXITED_NORMALLY) {
+        BOOST_REQUIRE (phase == PHASE_DONE);
+        loop->quit ();
+        return;
+    }
+    if (!a_has_frame || a_frame.function_name () != "main")
+        return;
+
+    switch (phase) {
+        case PHASE_START:
+            if (a_reason == IDebugger::BREAKPOINT_HIT) {
+                // Step over the construction of person.
+                debugger->step_over ();
+                return;
+            }
+            prefetcher->child_budget (1);
+            start_phase (PHASE_BUDGET);
+            break;
+        case PHASE_CANCEL:
+            if (!held_slot.empty ()) {
+                // The stop that follows the resumption of the
+                // inferior in make_varobj.
+                create_varobj (held_path, held_slot);
+                held_slot.disconnect ();
+            } else {
+                start_phase (PHASE_CANCEL);
+            }
+            break;
+        default:
+            break;
+    }
+
+    NEMIVER_CATCH_NOX
+}
+
+NEMIVER_API int
+test_main (int argc, char **argv)
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+    BOOST_REQUIRE (loop);
+
+    // The prefetcher drives a tree view, which needs a display.
+    if (!gtk_init_check (&argc, &argv)) {
+        std::cerr << "no display, skipping the test\n";
+        // The exit status automake reports as a skipped test.
+        return 77;
+    }
+    Gtk::Main::init_gtkmm_internals ();
+
+    debugger = debugger_utils::load_debugger_iface_with_confmgr ();
+    debugger->set_event_loop_context (Glib::MainContext::get_default ());
+
+    tree_store = Gtk::TreeStore::create (vutil::get_variable_columns ());
+    tree_view.reset (new Gtk::TreeView (tree_store));
+    root_it = tree_store->append ();
+    (*root_it)[vutil::get_variable_columns ().name] = "Locals";
+    prefetcher.reset (new ChildPrefetcher (*debugger, *tree_view,
+                                           tree_store));
+    prefetcher->set_varobj_maker (&make_varobj);
+
+    debugger->stopped_signal ().connect (&on_stopped_signal);
+    Glib::signal_timeout ().connect (&on_poll, 100);
+
+    vector<UString> args;
+    debugger->load_program ("fooprog", args, ".");
+    debugger->set_breakpoint ("main");
+    debugger->run ();
+
+    NEMIVER_SETUP_TIMEOUT (loop, 30);
+    loop->run ();
+
+    NEMIVER_CHECK_NO_TIMEOUT;
+
+    NEMIVER_CATCH_AND_RETURN_NOX (-1)
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include "config.h"
+#include <iostream>
+#include <boost/test/minimal.hpp>
+#include <glibmm.h>
+#include "nmv-i-debugger.h"
+#include "common/nmv-initializer.h"
+#include "nmv-debugger-utils.h"
+#include "test-utils.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+using namespace sigc;
+
+static Glib::RefPtr<Glib::MainLoop> loop =
+    Glib::MainLoop::create (Glib::MainContext::get_default ());
+
+static const int NB_EXPRESSIONS = 100;
+static int nb_serial_results = 0;
+static int nb_batch_callbacks = 0;
+static Glib::Timer timer;
+static double serial_time = 0;
+
+static UString
+nth_expression (int a_n)
+{
+    return UString::from_int (a_n) + "+1";
+}
+
+/// \return true if the expression a_n of the batch is one GDB cannot
+/// evaluate.
+static bool
+is_error_expression (int a_n)
+{
+    return a_n % 10 == 5;
+}
+
+/// \return the expression a_n of the batch.
+///
+/// The value of a valid expression is 1000 times the number of valid
+/// expressions GDB evaluated so far, counted in the convenience
+/// variable $nmv_seq, plus a_n.  So the value tells both the order
+/// GDB got the expressions in, and which expression the value is
+/// for.  An invalid expression names a symbol that doesn't exist,
+/// which GDB mentions in its error message.  There is no space in
+/// the expressions, as -data-evaluate-expression takes one word.
+static UString
+nth_batch_expression (int a_n)
+{
+    if (a_n == 0)
+        return "$nmv_seq=0";
+    if (is_error_expression (a_n))
+        return "no_such_symbol_" + UString::from_int (a_n);
+    return "($nmv_seq=$nmv_seq+1)*1000+" + UString::from_int (a_n);
+}
+
+void on_batch_evaluated (const vector<IDebugger::ExpressionResult> &a_results,
+                         IDebuggerSafePtr a_debugger);
+
+void
+evaluate_batch (IDebuggerSafePtr a_debugger)
+{
+    list<UString> exprs;
+    for (int i = 0; i < NB_EXPRESSIONS; ++i)
+        exprs.push_back (nth_batch_expression (i));
+
+    timer.start ();
+    a_debugger->evaluate_expressions
+        (exprs, sigc::bind (&on_batch_evaluated, a_debugger));
+}
+
+void
+on_serial_evaluated (const vector<IDebugger::ExpressionResult> &a_results,
+                     IDebuggerSafePtr a_debugger)
+{
+    BOOST_REQUIRE (a_results.size () == 1);
+    BOOST_REQUIRE (!a_results[0].is_error ());
+    BOOST_REQUIRE (a_results[0].value ()
+                   == UString::from_int (nb_serial_results + 1));
+
+    if (++nb_serial_results < NB_EXPRESSIONS) {
+        // Wait for the result of an expression before evaluating the
+        // next one, the way a caller of evaluate_expression would.
+        a_debugger->evaluate_expressions
+            (list<UString> (1, nth_expression (nb_serial_results)),
+             sigc::bind (&on_serial_evaluated, a_debugger));
+        return;
+    }
+    timer.stop ();
+    serial_time = timer.elapsed ();
+    MESSAGE ("evaluated " << NB_EXPRESSIONS
+             << " expressions one after the other in "
+             << serial_time << "s");
+    evaluate_batch (a_debugger);
+}
+
+void
+on_batch_evaluated (const vector<IDebugger::ExpressionResult> &a_results,
+                    IDebuggerSafePtr a_debugger)
+{
+    timer.stop ();
+    double batch_time = timer.elapsed ();
+    MESSAGE ("evaluated " << NB_EXPRESSIONS
+             << " expressions in one batch in " << batch_time << "s"
+             << " (" << serial_time << "s one after the other)");
+
+    // The slot is called once, with the results of all the
+    // expressions, in the order of the expressions.
+    ++nb_batch_callbacks;
+    BOOST_REQUIRE (nb_batch_callbacks == 1);
+    BOOST_REQUIRE (a_results.size () == NB_EXPRESSIONS);
+
+    BOOST_REQUIRE (!a_results[0].is_error ());
+    BOOST_REQUIRE (a_results[0].value () == "0");
+    int nb_valid = 0;
+    for (int i = 1; i < NB_EXPRESSIONS; ++i) {
+        BOOST_REQUIRE (a_results[i].expression () == nth_batch_expression (i));
+        if (is_error_expression (i)) {
+            // The error is that of this very expression, and doesn't
+            // spoil the expressions around it.
+            BOOST_REQUIRE (a_results[i].is_error ());
+            BOOST_REQUIRE (a_results[i].value ().empty ());
+            BOOST_REQUIRE (a_results[i].error ().find
+                            ("no_such_symbol_" + UString::from_int (i))
+                           != UString::npos);
+            continue;
+        }
+        ++nb_valid;
+        BOOST_REQUIRE (!a_results[i].is_error ());
+        // GDB evaluated the expressions in the order they were
+        // requested in.
+        BOOST_REQUIRE (a_results[i].value ()
+                       == UString::from_int (nb_valid * 1000 + i));
+    }
+
+    a_debugger->do_continue ();
+}
+
+void
+on_stopped_signal (IDebugger::StopReason a_reason,
+                   bool a_has_frame,
+                   const IDebugger::Frame &a_frame,
+                   int /*a_thread_id*/,
+                   const string& /*bp num*/,
+                   const UString &/*a_cookie*/,
+                   IDebuggerSafePtr &a_debugger)
+{
+    BOOST_REQUIRE (a_debugger);
+
+    if (a_reason == IDebugger::EXITED_NORMALLY) {
+        // No late second call of the slot of the batch either.
+        BOOST_REQUIRE (nb_batch_callbacks == 1);
+        loop->quit ();
+        return;
+    }
+
+    if (a_has_frame && a_frame.function_name () == "main") {
+        timer.start ();
+        a_debugger->evaluate_expressions
+            (list<UString> (1, nth_expression (0)),
+             sigc::bind (&on_serial_evaluated, a_debugger));
+    }
+}
+
+NEMIVER_API int
+test_main (int argc, char **argv)
+{
+    if (argc || argv) {}
+
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+    BOOST_REQUIRE (loop);
+
+    IDebuggerSafePtr debugger =
+      debugger_utils::load_debugger_iface_with_confmgr ();
+
+    //setup the debugger with the glib mainloop
+    debugger->set_event_loop_context (Glib::MainContext::get_default ());
+
+    debugger->stopped_signal ().connect (sigc::bind
+                                            (&on_stopped_signal, debugger));
+
+    vector<UString> args;
+    debugger->load_program (".libs/pointerderef", args, ".");
+    debugger->set_breakpoint ("main");
+
+    NEMIVER_SETUP_TIMEOUT (loop, 30);
+    loop->run ();
+
+    NEMIVER_CHECK_NO_TIMEOUT;
+
+    NEMIVER_CATCH_AND_RETURN_NOX(-1)
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "config.h"
+#include <iostream>
+#include <sstream>
+#include <boost/test/minimal.hpp>
+#include "common/nmv-initializer.h"
+#include "common/nmv-exception.h"
+#include "nmv-expr-history.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+
+static void
+test_record ()
+{
+    ExprHistory history (4);
+    BOOST_REQUIRE (!history.has_samples ("i"));
+
+    for (unsigned stop = 1; stop <= 6; ++stop)
+        history.add_sample ("i", stop, stop * G_USEC_PER_SEC, 1,
+                            UString::from_int (stop * 10));
+    BOOST_REQUIRE (history.has_samples ("i"));
+
+    // Only the 4 newest samples are kept, oldest first.
+    std::vector<ExprHistory::Sample> samples;
+    history.get_samples ("i", samples);
+    BOOST_REQUIRE (samples.size () == 4);
+    for (unsigned i = 0; i < samples.size (); ++i) {
+        BOOST_REQUIRE (samples[i].stop_number == i + 3);
+        BOOST_REQUIRE (samples[i].timestamp
+                       == (gint64) (i + 3) * G_USEC_PER_SEC);
+        BOOST_REQUIRE (samples[i].thread_id == 1);
+        BOOST_REQUIRE (*samples[i].value == UString::from_int ((i + 3) * 10));
+    }
+
+    // A second value at the same stop replaces the first one.
+    history.add_sample ("i", 6, 6 * G_USEC_PER_SEC, 2, "61");
+    history.get_samples ("i", samples);
+    BOOST_REQUIRE (samples.size () == 4);
+    BOOST_REQUIRE (*samples.back ().value == "61");
+    BOOST_REQUIRE (samples.back ().thread_id == 2);
+
+    std::list<UString> exprs;
+    exprs.push_back ("i");
+    std::ostringstream csv;
+    history.write_csv (exprs, csv);
+    BOOST_REQUIRE (csv.str ().find ("expression,stop,time,thread,value\n")
+                   == 0);
+    BOOST_REQUIRE (csv.str ().find ("i,6,6.000000,2,61\n")
+                   != std::string::npos);
+
+    history.forget_expression ("i");
+    BOOST_REQUIRE (!history.has_samples ("i"));
+    BOOST_REQUIRE (history.nb_distinct_values () == 0);
+}
+
+static void
+test_dedup ()
+{
+    ExprHistory history;
+    // A value that stays the same across stops, and is shared by two
+    // expressions, is stored once.
+    for (unsigned stop = 1; stop <= 100; ++stop) {
+        history.add_sample ("a", stop, 0, 1, "42");
+        history.add_sample ("b", stop, 0, 1, "42");
+    }
+    BOOST_REQUIRE (history.nb_distinct_values () == 1);
+    history.add_sample ("b", 101, 0, 1, "43");
+    BOOST_REQUIRE (history.nb_distinct_values () == 2);
+
+    // The values dropped from full histories don't pile up.
+    ExprHistory small (8);
+    for (unsigned stop = 1; stop <= 10000; ++stop)
+        small.add_sample ("counter", stop, 0, 1, UString::from_int (stop));
+    BOOST_REQUIRE (small.nb_distinct_values () < 2048);
+    std::vector<ExprHistory::Sample> samples;
+    small.get_samples ("counter", samples);
+    BOOST_REQUIRE (samples.size () == 8);
+    BOOST_REQUIRE (*samples.front ().value == "9993");
+    BOOST_REQUIRE (*samples.back ().value == "10000");
+
+    small.clear ();
+    BOOST_REQUIRE (small.nb_distinct_values () == 0);
+    BOOST_REQUIRE (!small.has_samples ("counter"));
+}
+
+static void
+test_lookup_by_stop ()
+{
+    ExprHistory history (5);
+    // Not sampled at every stop, e.g. because the monitor was hidden.
+    unsigned stops[] = {2, 3, 7, 8, 11, 12, 20};
+    for (unsigned i = 0; i < sizeof (stops) / sizeof (stops[0]); ++i)
+        history.add_sample ("p", stops[i], 0, 1,
+                            UString::from_int (stops[i] * 2));
+
+    ExprHistory::Sample sample;
+    // Dropped from the ring.
+    BOOST_REQUIRE (!history.get_sample_at_stop ("p", 2, sample));
+    BOOST_REQUIRE (!history.get_sample_at_stop ("p", 3, sample));
+    // Never sampled.
+    BOOST_REQUIRE (!history.get_sample_at_stop ("p", 9, sample));
+    BOOST_REQUIRE (!history.get_sample_at_stop ("p", 21, sample));
+    BOOST_REQUIRE (!history.get_sample_at_stop ("q", 7, sample));
+    // The ring wrapped around: look at both sides of 'oldest'.
+    for (unsigned i = 2; i < sizeof (stops) / sizeof (stops[0]); ++i) {
+        BOOST_REQUIRE (history.get_sample_at_stop ("p", stops[i], sample));
+        BOOST_REQUIRE (sample.stop_number == stops[i]);
+        BOOST_REQUIRE (*sample.value == UString::from_int (stops[i] * 2));
+    }
+}
+
+NEMIVER_API int
+test_main (int, char *[])
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+
+    test_record ();
+    test_dedup ();
+    test_lookup_by_stop ();
+
+    NEMIVER_CATCH_NOX;
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include "config.h"
+#include <iostream>
+#include <sstream>
+#include <new>
+#include <cstdlib>
+#include <sys/time.h>
+#include <boost/test/minimal.hpp>
+#include "common/nmv-initializer.h"
+#include "common/nmv-exception.h"
+#include "dbgengine/nmv-gdbmi-parser.h"
+
+using namespace std;
+using namespace nemiver;
+using nemiver::common::Initializer;
+using nemiver::common::UString;
+using nemiver::common::Address;
+
+// Measures what it costs to parse and hand around a backtrace of
+// NB_FRAMES frames, in memory allocations and in time.
+
+static const int NB_FRAMES = 10000;
+
+static unsigned long s_nb_allocations = 0;
+
+void*
+operator new (size_t a_size)
+{
+    ++s_nb_allocations;
+    void *result = malloc (a_size ? a_size : 1);
+    if (!result)
+        throw std::bad_alloc ();
+    return result;
+}
+
+void
+operator delete (void *a_ptr) throw ()
+{
+    free (a_ptr);
+}
+
+static double
+now ()
+{
+    struct timeval tv;
+    gettimeofday (&tv, 0);
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+/// Build the output of -stack-list-frames for a recursion of
+/// NB_FRAMES frames, like the one of dostackoverflow.
+static UString
+build_stack_output ()
+{
+    ostringstream os;
+    os << "^done,stack=[";
+    for (int i = 0; i < NB_FRAMES; ++i) {
+        if (i)
+            os << ",";
+        os << "frame={level=\"" << i << "\","
+           << "addr=\"0x000000000040087e\","
+           << "func=\"overflow_after_n_recursions\","
+           << "file=\"do-stack-overflow.cc\","
+           << "fullname=\"/home/dodji/devel/git/nemiver.git/tests/"
+              "do-stack-overflow.cc\","
+           << "line=\"8\"}";
+    }
+    os << "]\n(gdb)";
+    return os.str ();
+}
+
+int
+test_main (int, char **)
+{
+    NEMIVER_TRY
+
+    Initializer::do_init ();
+
+    UString input = build_stack_output ();
+
+    // Parse the listing.
+    GDBMIParser parser (input);
+    UString::size_type to = 0;
+    Output output;
+    unsigned long nb_allocations = s_nb_allocations;
+    double start = now ();
+    BOOST_REQUIRE (parser.parse_output_record (0, to, output));
+    double parse_time = now () - start;
+    unsigned long parse_allocations = s_nb_allocations - nb_allocations;
+
+    BOOST_REQUIRE (output.has_result_record ());
+    BOOST_REQUIRE (output.result_record ().has_call_stack ());
+    const vector<IDebugger::Frame> &frames =
+        output.result_record ().call_stack ();
+    BOOST_REQUIRE (frames.size () == (unsigned) NB_FRAMES);
+    for (int i = 0; i < NB_FRAMES; ++i) {
+        BOOST_REQUIRE (frames[i].level () == i);
+        BOOST_REQUIRE (frames[i].line () == 8);
+        BOOST_REQUIRE (frames[i].address ().to_string ()
+                       == "0x000000000040087e");
+        BOOST_REQUIRE (frames[i].function_name ()
+                       == "overflow_after_n_recursions");
+        BOOST_REQUIRE (frames[i].file_name () == "do-stack-overflow.cc");
+        BOOST_REQUIRE (frames[i].function_name_id ()
+                       == frames[0].function_name_id ());
+    }
+
+    // The frames are shared, not copied, by the copies of the
+    // output, like the ones made on their way to the slots of
+    // the engine.
+    nb_allocations = s_nb_allocations;
+    start = now ();
+    Output output_copy = output;
+    double share_time = now () - start;
+    unsigned long share_allocations = s_nb_allocations - nb_allocations;
+    BOOST_REQUIRE (&output_copy.result_record ().call_stack ()
+                   == &frames);
+
+    // Copying the frames, like a call stack widget caching them
+    // does, costs one allocation for the whole vector.
+    nb_allocations = s_nb_allocations;
+    start = now ();
+    vector<IDebugger::Frame> frames_copy (frames);
+    double copy_time = now () - start;
+    unsigned long copy_allocations = s_nb_allocations - nb_allocations;
+    BOOST_REQUIRE (frames_copy.size () == frames.size ());
+    BOOST_REQUIRE (copy_allocations == 1);
+
+    // The address of a frame round-trips the way GDB wrote it.
+    IDebugger::Frame frame;
+    BOOST_REQUIRE (frame.has_empty_address ());
+    frame.address (Address ("0x0804afb0"));
+    BOOST_REQUIRE (frame.address ().to_string () == "0x0804afb0");
+    BOOST_REQUIRE (frame.pc () == 0x0804afb0);
+    frame.clear ();
+    BOOST_REQUIRE (frame.has_empty_address ());
+    BOOST_REQUIRE (frame.function_name ().empty ());
+
+    cout << "sizeof (IDebugger::Frame): "
+         << sizeof (IDebugger::Frame) << " bytes\n"
+         << "parsing " << NB_FRAMES << " frames: "
+         << parse_time << " ms, "
+         << parse_allocations << " allocations\n"
+         << "sharing them: "
+         << share_time << " ms, "
+         << share_allocations << " allocations\n"
+         << "copying them: "
+         << copy_time << " ms, "
+         << copy_allocations << " allocations\n";
+
+    NEMIVER_CATCH_NOX
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "config.h"
+#include <iostream>
+#include <map>
+#include <boost/test/minimal.hpp>
+#include "common/nmv-initializer.h"
+#include "common/nmv-exception.h"
+#include "nmv-source-editor.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+
+static void
+test_annotation ()
+{
+    std::map<UString, UString> values;
+    values["i"] = "3";
+    values["count"] = "12";
+    values["unused"] = "7";
+
+    UString annotation;
+    SourceEditor::build_inline_values_annotation ("    count += i;",
+                                                  values, annotation);
+    BOOST_REQUIRE (annotation == "count = 12, i = 3");
+
+    // Each identifier appears once, in the order of the line.
+    annotation.clear ();
+    SourceEditor::build_inline_values_annotation ("i = i + count * i;",
+                                                  values, annotation);
+    BOOST_REQUIRE (annotation == "i = 3, count = 12");
+
+    // No identifier of the line has a value.
+    annotation.clear ();
+    SourceEditor::build_inline_values_annotation ("return foo (bar);",
+                                                  values, annotation);
+    BOOST_REQUIRE (annotation.empty ());
+
+    // Identifiers that merely contain a known name don't match.
+    annotation.clear ();
+    SourceEditor::build_inline_values_annotation ("int i2 = counter;",
+                                                  values, annotation);
+    BOOST_REQUIRE (annotation.empty ());
+}
+
+static void
+test_members_are_skipped ()
+{
+    std::map<UString, UString> values;
+    values["s"] = "{...}";
+    values["p"] = "0x601010";
+    values["count"] = "12";
+
+    UString annotation;
+    SourceEditor::build_inline_values_annotation ("s.count = p->count;",
+                                                  values, annotation);
+    BOOST_REQUIRE (annotation == "s = {...}, p = 0x601010");
+}
+
+static void
+test_empty_and_long_values ()
+{
+    std::map<UString, UString> values;
+    values["empty"] = "";
+    values["str"] = "\"" + std::string (60, 'a') + "\"";
+
+    UString annotation;
+    SourceEditor::build_inline_values_annotation ("puts (str); empty++;",
+                                                  values, annotation);
+    // Values are truncated to 40 characters; empty values are not shown.
+    BOOST_REQUIRE (annotation
+                   == UString ("str = \"" + std::string (39, 'a') + "..."));
+}
+
+NEMIVER_API int
+test_main (int, char *[])
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+
+    test_annotation ();
+    test_members_are_skipped ();
+    test_empty_and_long_values ();
+
+    NEMIVER_CATCH_NOX;
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "config.h"
+#include <iostream>
+#include <boost/test/minimal.hpp>
+#include "common/nmv-initializer.h"
+#include "common/nmv-exception.h"
+#include "nmv-locals-snapshots.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+
+typedef LocalsSnapshots::Leaf Leaf;
+typedef LocalsSnapshots::LeafDiff LeafDiff;
+
+static void
+test_diff ()
+{
+    LocalsSnapshots snapshots;
+
+    std::vector<Leaf> before;
+    // Out of order on purpose: the snapshot sorts the leaves.
+    before.push_back (Leaf ("i", "1"));
+    before.push_back (Leaf ("c", "65 'A'"));
+    before.push_back (Leaf ("gone", "7"));
+    before.push_back (Leaf ("s.name", "0x400 \"foo\""));
+    before.push_back (Leaf ("same", "3"));
+    before.push_back (Leaf ("p", "0x7fffffffe3f0"));
+    before.push_back (Leaf ("apples", "3 apples"));
+    before.push_back (Leaf ("big", "1000000"));
+    unsigned id = snapshots.take_snapshot ("line 10", "main@foo.cc", before);
+    BOOST_REQUIRE (id);
+    BOOST_REQUIRE (snapshots.has_snapshot (id));
+    UString scope;
+    BOOST_REQUIRE (snapshots.get_snapshot_scope (id, scope));
+    BOOST_REQUIRE (scope == "main@foo.cc");
+
+    std::vector<Leaf> after;
+    after.push_back (Leaf ("same", "3"));
+    after.push_back (Leaf ("i", "3.5"));
+    after.push_back (Leaf ("c", "66 'B'"));
+    after.push_back (Leaf ("s.name", "0x400 \"bar\""));
+    after.push_back (Leaf ("new", "12"));
+    after.push_back (Leaf ("p", "0x7fffffffe400 \"baz\""));
+    after.push_back (Leaf ("apples", "5 apples"));
+    after.push_back (Leaf ("big", "3000000"));
+
+    std::vector<LeafDiff> diffs;
+    BOOST_REQUIRE (snapshots.diff (id, after, diffs));
+    // Sorted by path; "same" did not change.
+    BOOST_REQUIRE (diffs.size () == 8);
+
+    // Not a number: it merely starts with one.
+    BOOST_REQUIRE (diffs[0].path == "apples");
+    BOOST_REQUIRE (diffs[0].kind == LocalsSnapshots::LEAF_CHANGED);
+    BOOST_REQUIRE (!diffs[0].has_delta);
+
+    // An integer delta that %g would print as 2e+06.
+    BOOST_REQUIRE (diffs[1].path == "big");
+    BOOST_REQUIRE (diffs[1].has_delta);
+    BOOST_REQUIRE (diffs[1].delta_is_integer);
+    BOOST_REQUIRE (diffs[1].delta == 2000000);
+
+    BOOST_REQUIRE (diffs[2].path == "c");
+    BOOST_REQUIRE (diffs[2].kind == LocalsSnapshots::LEAF_CHANGED);
+    BOOST_REQUIRE (diffs[2].old_value == "65 'A'");
+    BOOST_REQUIRE (diffs[2].new_value == "66 'B'");
+    BOOST_REQUIRE (diffs[2].has_delta);
+    BOOST_REQUIRE (diffs[2].delta_is_integer);
+    BOOST_REQUIRE (diffs[2].delta == 1);
+
+    BOOST_REQUIRE (diffs[3].path == "gone");
+    BOOST_REQUIRE (diffs[3].kind == LocalsSnapshots::LEAF_REMOVED);
+    BOOST_REQUIRE (diffs[3].old_value == "7");
+    BOOST_REQUIRE (diffs[3].new_value.empty ());
+    BOOST_REQUIRE (!diffs[3].has_delta);
+
+    BOOST_REQUIRE (diffs[4].path == "i");
+    BOOST_REQUIRE (diffs[4].kind == LocalsSnapshots::LEAF_CHANGED);
+    BOOST_REQUIRE (diffs[4].has_delta);
+    BOOST_REQUIRE (!diffs[4].delta_is_integer);
+    BOOST_REQUIRE (diffs[4].delta == 2.5);
+
+    BOOST_REQUIRE (diffs[5].path == "new");
+    BOOST_REQUIRE (diffs[5].kind == LocalsSnapshots::LEAF_ADDED);
+    BOOST_REQUIRE (diffs[5].old_value.empty ());
+    BOOST_REQUIRE (diffs[5].new_value == "12");
+    BOOST_REQUIRE (!diffs[5].has_delta);
+
+    // A pointer that moved: the delta is an integer number of bytes.
+    BOOST_REQUIRE (diffs[6].path == "p");
+    BOOST_REQUIRE (diffs[6].kind == LocalsSnapshots::LEAF_CHANGED);
+    BOOST_REQUIRE (diffs[6].has_delta);
+    BOOST_REQUIRE (diffs[6].delta_is_integer);
+    BOOST_REQUIRE (diffs[6].delta == 16);
+
+    // Only the pointed to string changed, not the pointer: there is
+    // no delta to show.
+    BOOST_REQUIRE (diffs[7].path == "s.name");
+    BOOST_REQUIRE (diffs[7].kind == LocalsSnapshots::LEAF_CHANGED);
+    BOOST_REQUIRE (diffs[7].new_value == "0x400 \"bar\"");
+    BOOST_REQUIRE (!diffs[7].has_delta);
+
+    std::vector<Leaf> text_before, text_after;
+    text_before.push_back (Leaf ("e", "RED"));
+    text_after.push_back (Leaf ("e", "GREEN"));
+    unsigned text_id = snapshots.take_snapshot ("line 12", "main@foo.cc",
+                                                text_before);
+    diffs.clear ();
+    BOOST_REQUIRE (snapshots.diff (text_id, text_after, diffs));
+    BOOST_REQUIRE (diffs.size () == 1);
+    BOOST_REQUIRE (diffs[0].kind == LocalsSnapshots::LEAF_CHANGED);
+    BOOST_REQUIRE (!diffs[0].has_delta);
+
+    // Comparing a snapshot with itself gives nothing.
+    diffs.clear ();
+    BOOST_REQUIRE (snapshots.diff (id, before, diffs));
+    BOOST_REQUIRE (diffs.empty ());
+
+    // An unknown snapshot.
+    BOOST_REQUIRE (!snapshots.diff (id + 100, after, diffs));
+    BOOST_REQUIRE (!snapshots.get_snapshot_scope (id + 100, scope));
+}
+
+static void
+test_forget ()
+{
+    LocalsSnapshots snapshots;
+    BOOST_REQUIRE (snapshots.nb_interned_strings () == 0);
+
+    std::vector<Leaf> leaves;
+    leaves.push_back (Leaf ("a", "1"));
+    leaves.push_back (Leaf ("b", "1"));
+    // Only the first leaf of a path is kept.
+    leaves.push_back (Leaf ("b", "2"));
+    unsigned first = snapshots.take_snapshot ("first", "f@a.cc", leaves);
+    unsigned second = snapshots.take_snapshot ("second", "g@a.cc", leaves);
+    BOOST_REQUIRE (first != second);
+    // "a", "b" and "1" are shared by both snapshots.
+    BOOST_REQUIRE (snapshots.nb_interned_strings () == 3);
+
+    std::vector<std::pair<unsigned, UString> > list;
+    snapshots.get_snapshots (list);
+    BOOST_REQUIRE (list.size () == 2);
+    BOOST_REQUIRE (list[0].first == first);
+    BOOST_REQUIRE (list[0].second == "first");
+    BOOST_REQUIRE (list[1].first == second);
+
+    snapshots.forget_snapshot (first);
+    BOOST_REQUIRE (!snapshots.has_snapshot (first));
+    BOOST_REQUIRE (snapshots.has_snapshot (second));
+    std::vector<LeafDiff> diffs;
+    BOOST_REQUIRE (snapshots.diff (second, leaves, diffs));
+    BOOST_REQUIRE (diffs.empty ());
+
+    // The strings go away with the last snapshot.
+    snapshots.forget_snapshot (second);
+    BOOST_REQUIRE (snapshots.nb_interned_strings () == 0);
+
+    // The identifiers are never reused.
+    unsigned third = snapshots.take_snapshot ("third", "f@a.cc", leaves);
+    BOOST_REQUIRE (third != first && third != second);
+    BOOST_REQUIRE (snapshots.nb_interned_strings () == 3);
+    snapshots.clear ();
+    list.clear ();
+    snapshots.get_snapshots (list);
+    BOOST_REQUIRE (list.empty ());
+    BOOST_REQUIRE (snapshots.nb_interned_strings () == 0);
+}
+
+NEMIVER_API int
+test_main (int, char *[])
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+
+    test_diff ();
+    test_forget ();
+
+    NEMIVER_CATCH_NOX;
+
+    return 0;
+}
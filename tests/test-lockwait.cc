@@ -0,0 +1,227 @@
+#include "config.h"
+#include <iostream>
+#include <boost/test/minimal.hpp>
+#include "common/nmv-initializer.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "common/nmv-exception.h"
+#include "nmv-debugger-utils.h"
+#include "nmv-lock-wait-graph.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+
+static Glib::RefPtr<Glib::MainLoop> loop =
+    Glib::MainLoop::create (Glib::MainContext::get_default ());
+
+static SafePtr<LockWaitCollector> collector;
+static bool graph_checked = false;
+
+static LockWaitGraph::Wait
+make_wait (int a_thread_id, size_t a_address)
+{
+    LockWaitGraph::Wait wait;
+    wait.thread_id = a_thread_id;
+    wait.kind = LockWaitGraph::LOCK_MUTEX;
+    wait.address = a_address;
+    return wait;
+}
+
+static void
+test_classification ()
+{
+    BOOST_REQUIRE (LockWaitGraph::classify_function ("pthread_mutex_lock")
+                   == LockWaitGraph::LOCK_MUTEX);
+    BOOST_REQUIRE (LockWaitGraph::classify_function
+                                            ("__GI___pthread_mutex_lock")
+                   == LockWaitGraph::LOCK_MUTEX);
+    BOOST_REQUIRE (LockWaitGraph::classify_function
+                                    ("pthread_cond_wait@@GLIBC_2.3.2")
+                   == LockWaitGraph::LOCK_CONDITION);
+    BOOST_REQUIRE (LockWaitGraph::classify_function ("__lll_lock_wait")
+                   == LockWaitGraph::LOCK_FUTEX);
+    BOOST_REQUIRE (LockWaitGraph::classify_function ("pthread_join")
+                   == LockWaitGraph::LOCK_JOIN);
+    BOOST_REQUIRE (LockWaitGraph::classify_function ("main")
+                   == LockWaitGraph::LOCK_NONE);
+
+    // A thread blocked in pthread_mutex_lock, called from worker.
+    const char *functions[] = {"syscall", "__lll_lock_wait",
+                               "pthread_mutex_lock", "worker",
+                               "start_thread"};
+    vector<IDebugger::Frame> frames (5);
+    for (int i = 0; i < 5; ++i) {
+        frames[i].level (i);
+        frames[i].function_name (functions[i]);
+    }
+    LockWaitGraph::LockKind kind = LockWaitGraph::LOCK_NONE;
+    int level = -1;
+    BOOST_REQUIRE (LockWaitGraph::find_wait (frames, kind, level));
+    BOOST_REQUIRE (kind == LockWaitGraph::LOCK_MUTEX && level == 2);
+
+    // A thread that is not blocked.
+    frames.erase (frames.begin (), frames.begin () + 3);
+    BOOST_REQUIRE (!LockWaitGraph::find_wait (frames, kind, level));
+}
+
+static void
+test_analysis ()
+{
+    // Threads 1 and 2 deadlock on the mutexes at 0x10 and 0x20.
+    // Threads 3 and 4 also wait on 0x10, and thread 5 waits on
+    // something unknown.
+    LockWaitGraph graph;
+    for (int i = 1; i <= 5; ++i)
+        graph.add_thread (i, 100 + i);
+    graph.add_wait (make_wait (1, 0x20));
+    graph.add_wait (make_wait (2, 0x10));
+    graph.add_wait (make_wait (3, 0x10));
+    graph.add_wait (make_wait (4, 0x10));
+    graph.add_wait (make_wait (5, 0));
+    graph.set_owner_lwp (0x10, 101);
+    graph.set_owner_lwp (0x20, 102);
+    graph.analyze ();
+
+    const std::vector<LockWaitGraph::Lock> &locks = graph.locks ();
+    BOOST_REQUIRE (locks.size () == 3);
+    BOOST_REQUIRE (locks[0].address == 0x10);
+    BOOST_REQUIRE (locks[0].waiters.size () == 3);
+    BOOST_REQUIRE (locks[0].owner_thread_id == 1);
+    BOOST_REQUIRE (locks[0].in_cycle);
+    BOOST_REQUIRE (locks[1].address == 0x20);
+    BOOST_REQUIRE (locks[1].owner_thread_id == 2);
+    BOOST_REQUIRE (locks[1].in_cycle);
+    BOOST_REQUIRE (locks[2].address == 0 && !locks[2].in_cycle);
+
+    BOOST_REQUIRE (graph.nb_threads_in_cycles () == 2);
+    BOOST_REQUIRE (graph.is_in_cycle (1) && graph.is_in_cycle (2));
+    BOOST_REQUIRE (!graph.is_in_cycle (3) && !graph.is_in_cycle (5));
+    BOOST_REQUIRE (graph.waited_thread (3) == 1);
+    BOOST_REQUIRE (graph.waited_thread (5) == 0);
+
+    // A thread relocking a mutex it owns deadlocks on its own.
+    graph.clear ();
+    graph.add_thread (1, 101);
+    graph.add_wait (make_wait (1, 0x10));
+    graph.set_owner_lwp (0x10, 101);
+    graph.analyze ();
+    BOOST_REQUIRE (graph.is_in_cycle (1));
+    BOOST_REQUIRE (graph.locks ().size () == 1
+                   && graph.locks ()[0].in_cycle);
+}
+
+static void
+on_engine_died_signal ()
+{
+    MESSAGE ("engine died");
+    loop->quit ();
+}
+
+static void
+on_program_finished_signal ()
+{
+    MESSAGE ("program finished");
+    loop->quit ();
+}
+
+static void
+on_graph_collected (const LockWaitGraph &a_graph)
+{
+    // The three threads of the lockwait program are blocked in
+    // pthread_mutex_lock.
+    int nb_mutex_waits = 0;
+    bool addresses_known = true;
+    for (std::vector<LockWaitGraph::Wait>::const_iterator it =
+             a_graph.waits ().begin ();
+         it != a_graph.waits ().end ();
+         ++it) {
+        if (it->kind != LockWaitGraph::LOCK_MUTEX)
+            continue;
+        ++nb_mutex_waits;
+        if (!it->address)
+            addresses_known = false;
+    }
+    BOOST_REQUIRE (nb_mutex_waits == 3);
+
+    // The objects can only be found with the debug info of the C
+    // library, or on x86-64.
+    if (addresses_known) {
+        const std::vector<LockWaitGraph::Lock> &locks = a_graph.locks ();
+        BOOST_REQUIRE (locks.size () >= 2);
+        BOOST_REQUIRE (locks[0].kind == LockWaitGraph::LOCK_MUTEX);
+        BOOST_REQUIRE (locks[0].waiters.size () == 2);
+        BOOST_REQUIRE (locks[0].in_cycle);
+        BOOST_REQUIRE (a_graph.nb_threads_in_cycles () == 2);
+    } else {
+        MESSAGE ("could not find the mutexes the threads wait on");
+    }
+    graph_checked = true;
+    loop->quit ();
+}
+
+static void
+on_stopped_signal (IDebugger::StopReason a_reason,
+                   bool /*a_has_frame*/,
+                   const IDebugger::Frame &/*a_frame*/,
+                   int /*a_thread_id*/,
+                   const string &/*a_bp_num*/,
+                   const UString &/*a_cookie*/,
+                   IDebuggerSafePtr &a_debugger)
+{
+    if (IDebugger::is_exited (a_reason))
+        return;
+    if (!collector)
+        collector.reset (new LockWaitCollector (a_debugger));
+    collector->collect (sigc::ptr_fun (&on_graph_collected));
+}
+
+/// Interrupt the lockwait program once its threads are deadlocked.
+static bool
+on_timeout (IDebuggerSafePtr a_debugger)
+{
+    a_debugger->stop_target ();
+    return false;
+}
+
+NEMIVER_API int
+test_main (int, char *[])
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+
+    test_classification ();
+    test_analysis ();
+
+    THROW_IF_FAIL (loop);
+
+    IDebuggerSafePtr debugger =
+        debugger_utils::load_debugger_iface_with_confmgr ();
+
+    debugger->set_event_loop_context (loop->get_context ());
+
+    debugger->engine_died_signal ().connect (&on_engine_died_signal);
+
+    debugger->program_finished_signal ().connect
+        (&on_program_finished_signal);
+
+    debugger->stopped_signal ().connect
+        (sigc::bind (&on_stopped_signal, debugger));
+
+    std::vector<UString> args, source_search_dir;
+    source_search_dir.push_back (".");
+    debugger->load_program ("lockwait", args, ".",
+                            source_search_dir, "",
+                            false);
+    debugger->run ();
+
+    Glib::signal_timeout ().connect
+        (sigc::bind (&on_timeout, debugger), 1000);
+    loop->run ();
+
+    BOOST_REQUIRE (graph_checked);
+    collector.reset ();
+
+    NEMIVER_CATCH_NOX;
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "config.h"
+#include <iostream>
+#include <cstdlib>
+#include <boost/test/minimal.hpp>
+#include <glibmm.h>
+#include "nmv-i-debugger.h"
+#include "common/nmv-initializer.h"
+#include "nmv-debugger-utils.h"
+#include "test-utils.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+using namespace sigc;
+
+static Glib::RefPtr<Glib::MainLoop> loop =
+    Glib::MainLoop::create (Glib::MainContext::get_default ());
+
+// The number of pipelined requests, and the index of the request
+// that is preceded by a request that can't be pipelined.
+static const int NB_REQUESTS = 40;
+static const int BARRIER = 20;
+// The value the barrier sets $nmv_seq to.
+static const int BARRIER_SEQ = 100;
+
+static vector<IDebugger::VariableSafePtr> variables;
+static int nb_values = 0;
+static bool got_barrier = false;
+
+/// \return the expression of the request a_n.
+///
+/// Each expression bumps the convenience variable $nmv_seq, so its
+/// value is 1000 times the number of expressions GDB evaluated so
+/// far, plus a_n.  That tells the order GDB got the requests in,
+/// and which request the value is for.
+static UString
+nth_expression (int a_n)
+{
+    return "($nmv_seq=$nmv_seq+1)*1000+" + UString::from_int (a_n);
+}
+
+static UString
+nth_expected_value (int a_n)
+{
+    int seq = a_n < BARRIER
+              ? a_n + 1
+              : BARRIER_SEQ + a_n - BARRIER + 1;
+    return UString::from_int (seq * 1000 + a_n);
+}
+
+static void
+request_values (IDebuggerSafePtr &a_debugger)
+{
+    // -data-evaluate-expression isn't pipelined when it doesn't come
+    // from get_variable_value: it waits for the requests before it,
+    // and the requests after it wait for it.
+    a_debugger->print_variable_value ("$nmv_seq=0", "init");
+    for (int i = 0; i < NB_REQUESTS; ++i) {
+        if (i == BARRIER)
+            a_debugger->print_variable_value
+                ("$nmv_seq=" + UString::from_int (BARRIER_SEQ), "barrier");
+        IDebugger::VariableSafePtr var
+                    (new IDebugger::Variable (nth_expression (i)));
+        variables.push_back (var);
+        a_debugger->get_variable_value (var, UString::from_int (i));
+    }
+}
+
+static void
+on_variable_value_signal (const UString &/*a_name*/,
+                          const IDebugger::VariableSafePtr a_var,
+                          const UString &a_cookie)
+{
+    BOOST_REQUIRE (a_var);
+    if (a_cookie == "init") {
+        BOOST_REQUIRE (nb_values == 0);
+        BOOST_REQUIRE (a_var->value () == "0");
+    } else if (a_cookie == "barrier") {
+        // All the requests before the barrier are answered, none of
+        // the ones after it.
+        BOOST_REQUIRE (nb_values == BARRIER);
+        BOOST_REQUIRE (a_var->value () == UString::from_int (BARRIER_SEQ));
+        got_barrier = true;
+    }
+}
+
+static void
+on_variable_value_set_signal (const IDebugger::VariableSafePtr a_var,
+                              const UString &a_cookie,
+                              IDebuggerSafePtr &a_debugger)
+{
+    BOOST_REQUIRE (a_var);
+    int index = atoi (a_cookie.c_str ());
+
+    // The results come in the order of the requests, and each of them
+    // is handed to the variable it was requested for.
+    BOOST_REQUIRE (index == nb_values);
+    BOOST_REQUIRE (index < NB_REQUESTS);
+    BOOST_REQUIRE (a_var.get () == variables[index].get ());
+    BOOST_REQUIRE (a_var->value () == nth_expected_value (index));
+    BOOST_REQUIRE (got_barrier == (index >= BARRIER));
+
+    if (++nb_values == NB_REQUESTS)
+        a_debugger->do_continue ();
+}
+
+static void
+on_stopped_signal (IDebugger::StopReason a_reason,
+                   bool a_has_frame,
+                   const IDebugger::Frame &a_frame,
+                   int /*a_thread_id*/,
+                   const string& /*bp num*/,
+                   const UString &/*a_cookie*/,
+                   IDebuggerSafePtr &a_debugger)
+{
+    BOOST_REQUIRE (a_debugger);
+
+    if (a_reason == IDebugger::EXITED_NORMALLY) {
+        BOOST_REQUIRE (nb_values == NB_REQUESTS);
+        loop->quit ();
+        return;
+    }
+
+    if (a_has_frame && a_frame.function_name () == "main")
+        request_values (a_debugger);
+}
+
+NEMIVER_API int
+test_main (int argc, char **argv)
+{
+    if (argc || argv) {}
+
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+    BOOST_REQUIRE (loop);
+
+    IDebuggerSafePtr debugger =
+      debugger_utils::load_debugger_iface_with_confmgr ();
+
+    //setup the debugger with the glib mainloop
+    debugger->set_event_loop_context (Glib::MainContext::get_default ());
+
+    debugger->stopped_signal ().connect (sigc::bind
+                                            (&on_stopped_signal, debugger));
+    debugger->variable_value_signal ().connect (&on_variable_value_signal);
+    debugger->variable_value_set_signal ().connect
+                    (sigc::bind (&on_variable_value_set_signal, debugger));
+
+    vector<UString> args;
+    debugger->load_program (".libs/pointerderef", args, ".");
+    debugger->set_breakpoint ("main");
+
+    NEMIVER_SETUP_TIMEOUT (loop, 30);
+    loop->run ();
+
+    NEMIVER_CHECK_NO_TIMEOUT;
+
+    NEMIVER_CATCH_AND_RETURN_NOX(-1)
+    return 0;
+}
@@ -0,0 +1,379 @@
+#include "config.h"
+#include <iostream>
+#include <boost/test/minimal.hpp>
+#include "common/nmv-initializer.h"
+#include "common/nmv-safe-ptr-utils.h"
+#include "common/nmv-exception.h"
+#include "nmv-debugger-utils.h"
+#include "nmv-stack-profile.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+
+static Glib::RefPtr<Glib::MainLoop> loop =
+    Glib::MainLoop::create (Glib::MainContext::get_default ());
+
+static StackProfile profile;
+static bool sample_requested = false;
+
+// The sampling of the lockwait program while it runs.
+static StackProfile running_profile;
+static bool running_sample_taken = false;
+static bool resumed_after_sample = false;
+static bool checked_running_after_sample = false;
+static bool stopped_sample_taken = false;
+static int nb_threads_created = 0;
+static int nb_stops_while_running = 0;
+
+/// Return the frames of a stack, innermost first, made of the
+/// functions named in a_functions, outermost first.
+static vector<IDebugger::Frame>
+make_stack (const char *a_functions[], unsigned a_nb)
+{
+    vector<IDebugger::Frame> frames (a_nb);
+    for (unsigned i = 0; i < a_nb; ++i) {
+        frames[i].level (i);
+        frames[i].function_name (a_functions[a_nb - 1 - i]);
+    }
+    return frames;
+}
+
+static const StackProfile::Node*
+find_child (const StackProfile::Node &a_node, const string &a_function)
+{
+    for (unsigned i = 0; i < a_node.children.size (); ++i)
+        if (a_node.children[i].function_name ().raw () == a_function)
+            return &a_node.children[i];
+    return 0;
+}
+
+/// Return true if a_function appears anywhere in the tree.
+static bool
+call_tree_has (const StackProfile::Node &a_node, const string &a_function)
+{
+    if (a_node.function_name ().raw () == a_function)
+        return true;
+    for (unsigned i = 0; i < a_node.children.size (); ++i)
+        if (call_tree_has (a_node.children[i], a_function))
+            return true;
+    return false;
+}
+
+/// Aggregate hand made samples and check the resulting call tree.
+static void
+test_aggregation ()
+{
+    const char *compute[] = {"main", "run", "compute"};
+    const char *wait[] = {"main", "run", "wait"};
+    const char *worker[] = {"start_thread", "worker"};
+
+    StackProfile p;
+    map<int, vector<IDebugger::Frame> > sample;
+    sample[1] = make_stack (compute, 3);
+    sample[2] = make_stack (worker, 2);
+    p.add_sample (sample);
+    p.add_sample (sample);
+    sample[1] = make_stack (wait, 3);
+    // A thread which stack couldn't be listed.
+    sample[3] = vector<IDebugger::Frame> ();
+    p.add_sample (sample);
+
+    BOOST_REQUIRE (p.nb_samples () == 3);
+    BOOST_REQUIRE (p.nb_stacks () == 6);
+    std::vector<int> ids;
+    p.thread_ids (ids);
+    BOOST_REQUIRE (ids.size () == 2 && ids[0] == 1 && ids[1] == 2);
+
+    StackProfile::Node root;
+    p.build_call_tree (root);
+    BOOST_REQUIRE (root.nb_samples == 6);
+    BOOST_REQUIRE (root.children.size () == 2);
+    const StackProfile::Node *node = find_child (root, "main");
+    BOOST_REQUIRE (node && node->nb_samples == 3);
+    const StackProfile::Node *run = find_child (*node, "run");
+    BOOST_REQUIRE (run && run->nb_samples == 3 && run->nb_self_samples == 0);
+    node = find_child (*run, "compute");
+    BOOST_REQUIRE (node
+                   && node->nb_samples == 2
+                   && node->nb_self_samples == 2);
+    // Children come hottest first.
+    BOOST_REQUIRE (run->children[0].function == node->function);
+    node = find_child (*run, "wait");
+    BOOST_REQUIRE (node && node->nb_samples == 1);
+
+    // Only the stacks of thread 2.
+    p.build_call_tree (root, 2);
+    BOOST_REQUIRE (root.nb_samples == 3);
+    BOOST_REQUIRE (root.children.size () == 1);
+    node = find_child (root, "start_thread");
+    BOOST_REQUIRE (node && find_child (*node, "worker"));
+
+    // A frame without function name is labelled by its address.
+    vector<IDebugger::Frame> unnamed = make_stack (worker, 2);
+    unnamed[0].function_name ("");
+    unnamed[0].address (Address ("0x400123"));
+    p.add_stack (4, unnamed);
+    p.add_stack (4, unnamed);
+    p.build_call_tree (root, 4);
+    node = find_child (root, "start_thread");
+    BOOST_REQUIRE (node && node->children.size () == 1);
+    BOOST_REQUIRE (node->children[0].function_name ().raw () == "0x400123");
+    BOOST_REQUIRE (node->children[0].nb_samples == 2);
+
+    p.clear ();
+    BOOST_REQUIRE (p.nb_samples () == 0 && p.nb_stacks () == 0);
+}
+
+/// Sample many frames without function names, as found in stripped
+/// code, so that memory checkers get a chance to see how their
+/// addresses are handled.
+static void
+test_unnamed_frames ()
+{
+    const char *names[] = {"start_thread", "worker", "leaf"};
+    static const unsigned NB_ADDRESSES = 64;
+    static const unsigned NB_SAMPLES = 500;
+
+    StackProfile p;
+    for (unsigned i = 0; i < NB_SAMPLES; ++i) {
+        vector<IDebugger::Frame> frames = make_stack (names, 3);
+        // Both innermost frames are unnamed.  The leaf one lands on
+        // one of a few addresses, so most of them are seen again.
+        frames[0].function_name ("");
+        frames[0].address
+            (Address (UString::from_int (0x400000 + i % NB_ADDRESSES).raw ()));
+        frames[1].function_name ("");
+        frames[1].address (Address ("0x500000"));
+        p.add_stack (1, frames);
+    }
+    BOOST_REQUIRE (p.nb_stacks () == NB_SAMPLES);
+
+    StackProfile::Node root;
+    p.build_call_tree (root);
+    const StackProfile::Node *node = find_child (root, "start_thread");
+    BOOST_REQUIRE (node && node->children.size () == 1);
+    node = &node->children[0];
+    BOOST_REQUIRE (node->function_name ().raw () == "0x500000");
+    BOOST_REQUIRE (node->nb_samples == NB_SAMPLES);
+    BOOST_REQUIRE (node->children.size () == NB_ADDRESSES);
+    unsigned nb_samples = 0;
+    for (unsigned i = 0; i < node->children.size (); ++i) {
+        BOOST_REQUIRE (!node->children[i].function_name ().empty ());
+        nb_samples += node->children[i].nb_samples;
+    }
+    BOOST_REQUIRE (nb_samples == NB_SAMPLES);
+}
+
+static void
+on_engine_died_signal ()
+{
+    MESSAGE ("engine died");
+    loop->quit ();
+}
+
+static void
+on_program_finished_signal ()
+{
+    MESSAGE ("program finished");
+    BOOST_REQUIRE (profile.nb_samples () == 1);
+
+    // The sample was taken while a thread was stopped in
+    // thread_func.
+    StackProfile::Node root;
+    profile.build_call_tree (root);
+    BOOST_REQUIRE (root.nb_samples > 0);
+    BOOST_REQUIRE (call_tree_has (root, "thread_func"));
+    loop->quit ();
+}
+
+static void
+on_sample_signal (const map<int, vector<IDebugger::Frame> > &a_stacks,
+                  IDebuggerSafePtr &a_debugger)
+{
+    BOOST_REQUIRE (!a_stacks.empty ());
+    profile.add_sample (a_stacks);
+    a_debugger->do_continue ();
+}
+
+static void
+on_stopped_signal (IDebugger::StopReason a_reason,
+                   bool /*a_has_frame*/,
+                   const IDebugger::Frame &/*a_frame*/,
+                   int /*a_thread_id*/,
+                   const string &/*a_bp_num*/,
+                   const UString &/*a_cookie*/,
+                   IDebuggerSafePtr &a_debugger)
+{
+    if (a_reason == IDebugger::BREAKPOINT_HIT && !sample_requested) {
+        sample_requested = true;
+        a_debugger->sample_threads_stacks
+            (64, sigc::bind (&on_sample_signal, a_debugger));
+        return;
+    }
+    a_debugger->do_continue ();
+}
+
+static void
+on_running_stopped_signal (IDebugger::StopReason a_reason,
+                           bool /*a_has_frame*/,
+                           const IDebugger::Frame &/*a_frame*/,
+                           int /*a_thread_id*/,
+                           const string &/*a_bp_num*/,
+                           const UString &/*a_cookie*/)
+{
+    if (IDebugger::is_exited (a_reason))
+        return;
+    // The stop caused by sampling must not be reported, only the one
+    // requested at the end of the test.
+    ++nb_stops_while_running;
+    loop->quit ();
+}
+
+/// The user asked to stop the inferior while it was being sampled:
+/// the sample is given up.
+static void
+on_stopped_sample_signal (const map<int, vector<IDebugger::Frame> > &a_stacks)
+{
+    BOOST_REQUIRE (a_stacks.empty ());
+    stopped_sample_taken = true;
+}
+
+/// Check that the inferior runs again after it was sampled, then
+/// sample it again and stop it while it is being sampled.
+static bool
+on_check_running_idle (IDebuggerSafePtr a_debugger)
+{
+    BOOST_REQUIRE (a_debugger->get_state () == IDebugger::RUNNING);
+    checked_running_after_sample = true;
+    a_debugger->sample_threads_stacks (64, &on_stopped_sample_signal);
+    a_debugger->stop_target ();
+    return false;
+}
+
+static void
+on_running_thread_state_changed_signal (int /*a_thread_id*/,
+                                        bool a_is_running,
+                                        IDebuggerSafePtr a_debugger)
+{
+    if (!running_sample_taken || !a_is_running || resumed_after_sample)
+        return;
+    resumed_after_sample = true;
+    Glib::signal_idle ().connect
+        (sigc::bind (&on_check_running_idle, a_debugger));
+}
+
+static void
+on_running_sample_signal (const map<int, vector<IDebugger::Frame> > &a_stacks)
+{
+    BOOST_REQUIRE (!a_stacks.empty ());
+    running_profile.add_sample (a_stacks);
+    running_sample_taken = true;
+}
+
+/// Sample the lockwait program once all its threads exist.
+static bool
+on_sample_running_idle (IDebuggerSafePtr a_debugger)
+{
+    BOOST_REQUIRE (a_debugger->get_state () == IDebugger::RUNNING);
+    a_debugger->sample_threads_stacks (64, &on_running_sample_signal);
+    return false;
+}
+
+static void
+on_running_thread_created_signal (int /*a_thread_id*/,
+                                  IDebuggerSafePtr a_debugger)
+{
+    // The main thread and the three threads it creates.
+    if (++nb_threads_created == 4)
+        Glib::signal_idle ().connect
+            (sigc::bind (&on_sample_running_idle, a_debugger));
+}
+
+/// Sample the stacks of a running inferior: it must be interrupted
+/// behind the back of the user, and resumed right after, unless the
+/// user asked to stop it in the meantime.
+static void
+test_sampling_running_inferior ()
+{
+    IDebuggerSafePtr debugger =
+        debugger_utils::load_debugger_iface_with_confmgr ();
+
+    debugger->set_event_loop_context (loop->get_context ());
+
+    debugger->engine_died_signal ().connect (&on_engine_died_signal);
+
+    debugger->stopped_signal ().connect (&on_running_stopped_signal);
+
+    debugger->thread_state_changed_signal ().connect
+        (sigc::bind (&on_running_thread_state_changed_signal, debugger));
+
+    debugger->thread_created_signal ().connect
+        (sigc::bind (&on_running_thread_created_signal, debugger));
+
+    std::vector<UString> args, source_search_dir;
+    debugger->enable_pretty_printing (false);
+    source_search_dir.push_back (".");
+    debugger->load_program ("lockwait", args, ".",
+                            source_search_dir, "",
+                            false);
+    debugger->run ();
+    loop->run ();
+
+    BOOST_REQUIRE (running_sample_taken);
+    BOOST_REQUIRE (checked_running_after_sample);
+    BOOST_REQUIRE (stopped_sample_taken);
+    BOOST_REQUIRE (nb_stops_while_running == 1);
+    // The inferior was left stopped.
+    BOOST_REQUIRE (debugger->get_state () != IDebugger::RUNNING);
+    BOOST_REQUIRE (running_profile.nb_samples () == 1);
+    // The main thread and the three blocked threads.
+    BOOST_REQUIRE (running_profile.nb_stacks () >= 4);
+    StackProfile::Node root;
+    running_profile.build_call_tree (root);
+    BOOST_REQUIRE (call_tree_has (root, "main"));
+}
+
+NEMIVER_API int
+test_main (int, char *[])
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+
+    test_aggregation ();
+    test_unnamed_frames ();
+
+    THROW_IF_FAIL (loop);
+
+    IDebuggerSafePtr debugger =
+        debugger_utils::load_debugger_iface_with_confmgr ();
+
+    debugger->set_event_loop_context (loop->get_context ());
+
+    debugger->engine_died_signal ().connect (&on_engine_died_signal);
+
+    debugger->program_finished_signal ().connect
+        (&on_program_finished_signal);
+
+    debugger->stopped_signal ().connect
+        (sigc::bind (&on_stopped_signal, debugger));
+
+    // Profile the threads sample program, stopped in one of its
+    // threads.
+    std::vector<UString> args, source_search_dir;
+    debugger->enable_pretty_printing (false);
+    source_search_dir.push_back (".");
+    debugger->load_program ("threads", args, ".",
+                            source_search_dir, "",
+                            false);
+    debugger->set_breakpoint ("threads.cc", 32);
+
+    debugger->run ();
+    loop->run ();
+
+    test_sampling_running_inferior ();
+
+    NEMIVER_CATCH_NOX;
+
+    return 0;
+}
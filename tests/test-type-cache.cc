@@ -0,0 +1,121 @@
+#include "config.h"
+#include <iostream>
+#include <boost/test/minimal.hpp>
+#include <glibmm.h>
+#include "nmv-i-debugger.h"
+#include "common/nmv-initializer.h"
+#include "nmv-debugger-utils.h"
+#include "test-utils.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+
+static Glib::RefPtr<Glib::MainLoop> loop =
+    Glib::MainLoop::create (Glib::MainContext::get_default ());
+
+static int nb_ptypes = 0;
+static int nb_types_set = 0;
+static UString description;
+
+static void
+on_log_message_signal (const UString &a_message)
+{
+    if (!a_message.raw ().compare (0, 6, "ptype "))
+        ++nb_ptypes;
+}
+
+static void
+on_variable_created_signal (const IDebugger::VariableSafePtr a_var,
+                            IDebuggerSafePtr a_debugger)
+{
+    BOOST_REQUIRE (a_var);
+    // The variable object carries the name of its type: its
+    // description comes from the cache.
+    BOOST_REQUIRE (a_var->type () == "baz");
+    a_debugger->get_variable_type (a_var);
+}
+
+static void
+on_variable_type_set_signal (const IDebugger::VariableSafePtr &a_var,
+                             const UString &/*a_cookie*/,
+                             IDebuggerSafePtr a_debugger)
+{
+    BOOST_REQUIRE (a_var);
+    MESSAGE ("type of '" << a_var->name () << "': " << a_var->type ());
+    BOOST_REQUIRE (a_var->type ().find ("m_a") != UString::npos);
+    if (description.empty ())
+        description = a_var->type ();
+    BOOST_REQUIRE (a_var->type () == description);
+
+    if (++nb_types_set == 2) {
+        // Both instances of baz are typed; expand a third one,
+        // through a variable object this time.
+        a_debugger->create_variable
+            ("b", sigc::bind (&on_variable_created_signal, a_debugger));
+    } else if (nb_types_set == 3) {
+        a_debugger->do_continue ();
+    }
+}
+
+static void
+on_stopped_signal (IDebugger::StopReason a_reason,
+                   bool a_has_frame,
+                   const IDebugger::Frame &a_frame,
+                   int /*a_thread_id*/,
+                   const string &/*a_bp_num*/,
+                   const UString &/*a_cookie*/,
+                   IDebuggerSafePtr a_debugger)
+{
+    if (IDebugger::is_exited (a_reason)) {
+        loop->quit ();
+        return;
+    }
+    if (a_reason != IDebugger::BREAKPOINT_HIT
+        || !a_has_frame
+        || a_frame.function_name () != "main") {
+        a_debugger->do_continue ();
+        return;
+    }
+    // Two variables of the same type which type name is not known
+    // yet, queried back to back: only one "ptype" must be sent.
+    a_debugger->get_variable_type
+        (IDebugger::VariableSafePtr (new IDebugger::Variable ("b")));
+    a_debugger->get_variable_type
+        (IDebugger::VariableSafePtr (new IDebugger::Variable ("*baz_ptr")));
+}
+
+NEMIVER_API int
+test_main (int, char **)
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+    BOOST_REQUIRE (loop);
+
+    IDebuggerSafePtr debugger =
+        debugger_utils::load_debugger_iface_with_confmgr ();
+
+    debugger->set_event_loop_context (Glib::MainContext::get_default ());
+
+    debugger->stopped_signal ().connect
+        (sigc::bind (&on_stopped_signal, debugger));
+    debugger->variable_type_set_signal ().connect
+        (sigc::bind (&on_variable_type_set_signal, debugger));
+    debugger->log_message_signal ().connect (&on_log_message_signal);
+
+    vector<UString> args;
+    debugger->load_program (".libs/pointerderef", args, ".");
+    debugger->set_breakpoint ("pointer-deref.cc", 140);
+    debugger->run ();
+
+    NEMIVER_SETUP_TIMEOUT (loop, 10);
+    loop->run ();
+
+    NEMIVER_CHECK_NO_TIMEOUT;
+
+    BOOST_REQUIRE (nb_types_set == 3);
+    BOOST_REQUIRE (nb_ptypes == 1);
+
+    NEMIVER_CATCH_AND_RETURN_NOX (-1);
+    return 0;
+}
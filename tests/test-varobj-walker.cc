@@ -2,6 +2,7 @@
 #include <iostream>
 #include <sstream>
 #include <map>
+#include <list>
 #include <string>
 #include <boost/test/minimal.hpp>
 #include <glibmm.h>
@@ -17,6 +18,12 @@ Glib::RefPtr<Glib::MainLoop> s_loop =
     Glib::MainLoop::create (Glib::MainContext::get_default ());
 
 static std::string serialized_variable;
+// The same variable, walked depth first, one node after the other.
+static std::string depth_first_serialized_variable;
+static unsigned nb_walker_visited_nodes = 0;
+static unsigned nb_depth_first_nodes = 0;
+// The nodes the depth first walk has yet to visit, next one first.
+static std::list<IDebugger::VariableSafePtr> depth_first_nodes;
 
 static IVarWalkerSafePtr
 create_varobj_walker ()
@@ -95,13 +102,94 @@ on_program_finished_signal ()
     s_loop->quit ();
 }
 
+/// Visit the node at the front of depth_first_nodes, whose members
+/// are known, and put its members at the front of the nodes to
+/// visit.
 static void
-on_variable_visited_signal (const IDebugger::VariableSafePtr a_var)
+visit_depth_first_node ()
+{
+    IDebugger::VariableSafePtr node = depth_first_nodes.front ();
+    depth_first_nodes.pop_front ();
+    ++nb_depth_first_nodes;
+    IDebugger::VariableList::const_reverse_iterator it;
+    for (it = node->members ().rbegin ();
+         it != node->members ().rend ();
+         ++it)
+        depth_first_nodes.push_front (*it);
+}
+
+static void walk_depth_first (IDebuggerSafePtr a_debugger,
+                              IDebugger::VariableSafePtr a_root);
+
+static void
+on_depth_first_node_unfolded (const IDebugger::VariableSafePtr,
+                              IDebuggerSafePtr a_debugger,
+                              IDebugger::VariableSafePtr a_root)
+{
+    NEMIVER_TRY
+
+    visit_depth_first_node ();
+    walk_depth_first (a_debugger, a_root);
+
+    NEMIVER_CATCH_NOX
+}
+
+/// Walk the nodes of depth_first_nodes depth first, waiting for the
+/// members of each node before going on, the way the walkers used to
+/// do.  Once done, serialize a_root to compare it with the walk of
+/// the varobj walker.
+static void
+walk_depth_first (IDebuggerSafePtr a_debugger,
+                  IDebugger::VariableSafePtr a_root)
+{
+    while (!depth_first_nodes.empty ()) {
+        IDebugger::VariableSafePtr node = depth_first_nodes.front ();
+        if (node->needs_unfolding ()
+            && a_debugger->get_language_trait ().is_variable_compound
+                                                                (node)) {
+            a_debugger->unfold_variable
+                (node, sigc::bind (&on_depth_first_node_unfolded,
+                                   a_debugger, a_root));
+            return;
+        }
+        visit_depth_first_node ();
+    }
+    dump_variable_value (a_root, 0, depth_first_serialized_variable);
+    s_loop->quit ();
+}
+
+static void
+on_depth_first_variable_created (const IDebugger::VariableSafePtr a_var,
+                                 IDebuggerSafePtr a_debugger)
+{
+    NEMIVER_TRY
+
+    BOOST_REQUIRE (a_var);
+    depth_first_nodes.push_back (a_var);
+    walk_depth_first (a_debugger, a_var);
+
+    NEMIVER_CATCH_NOX
+}
+
+static void
+on_variable_node_visited_signal (const IDebugger::VariableSafePtr)
+{
+    ++nb_walker_visited_nodes;
+}
+
+static void
+on_variable_visited_signal (const IDebugger::VariableSafePtr a_var,
+                            IDebuggerSafePtr a_debugger)
 {
     MESSAGE ("dumping the variable ...");
     dump_variable_value (a_var, 0, serialized_variable);
     MESSAGE ("dumping the variable: DONE");
-    s_loop->quit ();
+
+    // Now walk the same variable depth first, to check the varobj
+    // walker, that walks it level by level, finds the same tree.
+    a_debugger->create_variable
+        ("person", sigc::bind (&on_depth_first_variable_created,
+                               a_debugger));
 }
 
 
@@ -112,7 +200,10 @@ do_varobj_walker_stuff (IDebuggerSafePtr a_debugger)
 
     IVarWalkerSafePtr var_walker = get_varobj_walker ();
 
-    var_walker->visited_variable_signal ().connect (&on_variable_visited_signal);
+    var_walker->visited_variable_node_signal ().connect
+                                        (&on_variable_node_visited_signal);
+    var_walker->visited_variable_signal ().connect
+                    (sigc::bind (&on_variable_visited_signal, a_debugger));
     var_walker->connect (a_debugger.get (), "person");
     var_walker->do_walk_variable ();
 }
@@ -186,6 +277,12 @@ test_main (int, char **)
     BOOST_REQUIRE (!serialized_variable.empty ());
     MESSAGE (serialized_variable);
 
+    // Walking the tree level by level finds the same nodes, in the
+    // same order, as walking it depth first.
+    BOOST_REQUIRE (serialized_variable == depth_first_serialized_variable);
+    BOOST_REQUIRE (nb_walker_visited_nodes > 1);
+    BOOST_REQUIRE (nb_walker_visited_nodes == nb_depth_first_nodes);
+
     return 0;
 }
 
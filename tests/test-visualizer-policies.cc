@@ -0,0 +1,128 @@
+#include "config.h"
+#include <iostream>
+#include <boost/test/minimal.hpp>
+#include "common/nmv-initializer.h"
+#include "common/nmv-exception.h"
+#include "nmv-debugger-utils.h"
+
+using namespace nemiver;
+using namespace nemiver::common;
+using namespace nemiver::debugger_utils;
+
+static void
+test_parse ()
+{
+    UString pattern;
+    IDebugger::VisualizerPolicy policy = IDebugger::VISUALIZER_POLICY_FULL;
+    unsigned max_nb_children = 42;
+
+    BOOST_REQUIRE (parse_type_visualizer_policy ("std::map<*=raw",
+                                                 pattern, policy,
+                                                 max_nb_children));
+    BOOST_REQUIRE (pattern == "std::map<*");
+    BOOST_REQUIRE (policy == IDebugger::VISUALIZER_POLICY_RAW);
+    BOOST_REQUIRE (max_nb_children == 0);
+
+    BOOST_REQUIRE (parse_type_visualizer_policy (" std::vector<*> = limit:100 ",
+                                                 pattern, policy,
+                                                 max_nb_children));
+    BOOST_REQUIRE (pattern == "std::vector<*>");
+    BOOST_REQUIRE (policy == IDebugger::VISUALIZER_POLICY_LIMIT_CHILDREN);
+    BOOST_REQUIRE (max_nb_children == 100);
+
+    BOOST_REQUIRE (parse_type_visualizer_policy ("std::string=full",
+                                                 pattern, policy,
+                                                 max_nb_children));
+    BOOST_REQUIRE (policy == IDebugger::VISUALIZER_POLICY_FULL);
+    BOOST_REQUIRE (max_nb_children == 0);
+
+    // The policy follows the last '=', so it can be part of a type.
+    BOOST_REQUIRE (parse_type_visualizer_policy ("Foo<a==b>=raw",
+                                                 pattern, policy,
+                                                 max_nb_children));
+    BOOST_REQUIRE (pattern == "Foo<a==b>");
+
+    // Malformed entries leave the out parameters alone.
+    pattern = "unchanged";
+    BOOST_REQUIRE (!parse_type_visualizer_policy ("std::map<*", pattern,
+                                                  policy, max_nb_children));
+    BOOST_REQUIRE (!parse_type_visualizer_policy ("=raw", pattern,
+                                                  policy, max_nb_children));
+    BOOST_REQUIRE (!parse_type_visualizer_policy ("Foo=", pattern,
+                                                  policy, max_nb_children));
+    BOOST_REQUIRE (!parse_type_visualizer_policy ("Foo=pretty", pattern,
+                                                  policy, max_nb_children));
+    BOOST_REQUIRE (!parse_type_visualizer_policy ("Foo=limit:0", pattern,
+                                                  policy, max_nb_children));
+    BOOST_REQUIRE (!parse_type_visualizer_policy ("Foo=limit:x", pattern,
+                                                  policy, max_nb_children));
+    BOOST_REQUIRE (pattern == "unchanged");
+}
+
+static void
+test_match ()
+{
+    BOOST_REQUIRE (type_matches_visualizer_pattern ("std::map<*",
+                                                    "std::map<int, int>"));
+    BOOST_REQUIRE (!type_matches_visualizer_pattern ("std::map<*",
+                                                     "std::multimap<int, int>"));
+    // Const types and references are matched as the type itself.
+    BOOST_REQUIRE (type_matches_visualizer_pattern
+                        ("std::map<*", "const std::map<int, int> &"));
+    BOOST_REQUIRE (type_matches_visualizer_pattern ("Foo", "Foo&"));
+    // But not pointers.
+    BOOST_REQUIRE (!type_matches_visualizer_pattern ("Foo", "Foo *"));
+    BOOST_REQUIRE (type_matches_visualizer_pattern ("*", "int"));
+    BOOST_REQUIRE (!type_matches_visualizer_pattern ("*", ""));
+}
+
+/// The policies set at run time take precedence over the configured
+/// ones.
+static void
+test_lookup ()
+{
+    IDebuggerSafePtr debugger = load_debugger_iface_with_confmgr ();
+
+    IDebugger::VisualizerPolicy policy = IDebugger::VISUALIZER_POLICY_FULL;
+    unsigned max_nb_children = 0;
+    debugger->set_type_visualizer_policy ("std::vector<*",
+                                          IDebugger::VISUALIZER_POLICY_RAW);
+    debugger->set_type_visualizer_policy
+        ("std::*", IDebugger::VISUALIZER_POLICY_LIMIT_CHILDREN, 10);
+    BOOST_REQUIRE (debugger->get_type_visualizer_policy
+                        ("const std::vector<int> &", policy,
+                         max_nb_children));
+    BOOST_REQUIRE (policy == IDebugger::VISUALIZER_POLICY_RAW);
+    // The first matching policy applies.
+    BOOST_REQUIRE (debugger->get_type_visualizer_policy
+                        ("std::list<int>", policy, max_nb_children));
+    BOOST_REQUIRE (policy == IDebugger::VISUALIZER_POLICY_LIMIT_CHILDREN);
+    BOOST_REQUIRE (max_nb_children == 10);
+
+    // Setting a pattern again replaces its policy.
+    debugger->set_type_visualizer_policy ("std::vector<*",
+                                          IDebugger::VISUALIZER_POLICY_FULL);
+    BOOST_REQUIRE (debugger->get_type_visualizer_policy
+                        ("std::vector<int>", policy, max_nb_children));
+    BOOST_REQUIRE (policy == IDebugger::VISUALIZER_POLICY_FULL);
+
+    debugger->clear_type_visualizer_policies ();
+    BOOST_REQUIRE (!debugger->get_type_visualizer_policy
+                        ("MyOwnType", policy, max_nb_children));
+}
+
+NEMIVER_API int
+test_main (int, char *[])
+{
+    NEMIVER_TRY;
+
+    Initializer::do_init ();
+
+    test_parse ();
+    test_match ();
+    test_lookup ();
+
+    NEMIVER_CATCH_NOX;
+
+    return 0;
+}